@@ -166,6 +166,23 @@ void room_file_header::WriteFromFile(Common::Stream *out)
 
 int usesmisccond = 0;
 
+// Reads the format of the images which follow, if the room stores it
+static RoomImageFormat read_image_format(Stream *in, const room_file_header &rfh) {
+  if (rfh.version < kRoomVersion_3405)
+    return kRoomImage_Legacy;
+  const int format = in->ReadByte();
+  if (format != kRoomImage_Legacy && format != kRoomImage_LZ)
+    quit("Load_room: unknown room image format");
+  return (RoomImageFormat)format;
+}
+
+// Loads the room mask stored in the given format
+static long load_room_mask(Stream *in, RoomImageFormat format, Bitmap **mask, color *pal, long tesl) {
+  if (format == kRoomImage_LZ)
+    return load_lz_image(in, mask, NULL);
+  return loadcompressed_allegro(in, mask, pal, tesl);
+}
+
 void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_file_header rfh) {
   int   f, gsmod, NUMREAD;
   char  buffre[3000];
@@ -481,7 +498,10 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 
   update_polled_stuff_if_runtime();
 
-  if (rfh.version >= kRoomVersion_pre114_5) {
+  const RoomImageFormat image_format = read_image_format(in, rfh);
+  if (image_format == kRoomImage_LZ)
+    tesl = load_lz_image(in, &rstruc->ebscene[0], rstruc->pal);
+  else if (rfh.version >= kRoomVersion_pre114_5) {
     tesl = load_lzw(in, rstruc->ebscene[0], rstruc->pal);
     rstruc->ebscene[0] = recalced;
   }
@@ -493,22 +513,22 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 
   update_polled_stuff_if_runtime();
   if (rfh.version >= kRoomVersion_255b)
-    tesl = loadcompressed_allegro(in, &rstruc->regions, rstruc->pal, tesl);
+    tesl = load_room_mask(in, image_format, &rstruc->regions, rstruc->pal, tesl);
   else if (rfh.version >= kRoomVersion_114) {
-    tesl = loadcompressed_allegro(in, &rstruc->regions, rstruc->pal, tesl);
+    tesl = load_room_mask(in, image_format, &rstruc->regions, rstruc->pal, tesl);
     // an old version - ->Clear the 'shadow' area into a blank regions bmp
     delete rstruc->regions;
     rstruc->regions = NULL;
   }
 
   update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->walls, rstruc->pal, tesl);
+  tesl = load_room_mask(in, image_format, &rstruc->walls, rstruc->pal, tesl);
 
   update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->object, rstruc->pal, tesl);
+  tesl = load_room_mask(in, image_format, &rstruc->object, rstruc->pal, tesl);
 
   update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->lookat, rstruc->pal, tesl);
+  tesl = load_room_mask(in, image_format, &rstruc->lookat, rstruc->pal, tesl);
 
   if (rfh.version < kRoomVersion_255b) {
     // Old version - copy walkable areas to Regions
@@ -534,7 +554,7 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 
 extern bool load_room_is_version_bad(roomstruct *rstruc);
 
-void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
+void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes, Common::Stream *in) {
   Common::Stream *opty; // CHECKME why "opty"??
   room_file_header  rfh;
   int i;
@@ -580,7 +600,7 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
 
   update_polled_stuff_if_runtime();
 
-  opty = Common::AssetManager::OpenAsset(files);
+  opty = in ? in : Common::AssetManager::OpenAsset(files);
   if (opty == NULL) {
     char errbuffr[500];
     sprintf(errbuffr,"Load_room: Unable to load the room file '%s'\n"
@@ -664,6 +684,7 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
         opty->Read(&rstruc->ebpalShared[0], rstruc->num_bscenes);
       else
         memset (&rstruc->ebpalShared[0], 0, rstruc->num_bscenes);
+      const RoomImageFormat image_format = read_image_format(opty, rfh);
 
       fpos = opty->GetPosition();
 //        fclose(opty);
@@ -671,8 +692,12 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
       for (ct = 1; ct < rstruc->num_bscenes; ct++) {
         update_polled_stuff_if_runtime();
 //          fpos = load_lzw(files,rstruc->ebscene[ct],rstruc->pal,fpos);
-        fpos = load_lzw(opty, rstruc->ebscene[ct], rstruc->bpalettes[ct]);
-        rstruc->ebscene[ct] = recalced;
+        if (image_format == kRoomImage_LZ)
+          fpos = load_lz_image(opty, &rstruc->ebscene[ct], rstruc->bpalettes[ct]);
+        else {
+          fpos = load_lzw(opty, rstruc->ebscene[ct], rstruc->bpalettes[ct]);
+          rstruc->ebscene[ct] = recalced;
+        }
       }
 //        opty = Common::AssetManager::OpenAsset(files, "rb");
 //        Seek(opty, fpos, SEEK_SET);
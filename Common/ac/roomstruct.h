@@ -56,6 +56,7 @@ using AGS::Common::InteractionVariable;
 28:  v3.0.3 - remove hotspot name length limit
 29:  v3.0.3 - high-res coords for object x/y, edges and hotspot walk-to point
 30:  v3.4.0.4 - tint luminance for regions
+  v3.4.0.5 - images may be stored in the LZ format
 */
 enum RoomFileVersion
 {
@@ -87,7 +88,17 @@ enum RoomFileVersion
     kRoomVersion_303a       = 28,
     kRoomVersion_303b       = 29,
     kRoomVersion_3404       = 30,
-    kRoomVersion_Current    = kRoomVersion_3404
+    kRoomVersion_3405       = 31,
+    kRoomVersion_Current    = kRoomVersion_3405
+};
+
+// How the room backgrounds and masks are stored; since kRoomVersion_3405
+// the format is written before the main background and before the other
+// backgrounds in the animated backgrounds block
+enum RoomImageFormat
+{
+    kRoomImage_Legacy       = 0,  // LZW backgrounds and RLE masks
+    kRoomImage_LZ           = 1   // LZ streams, see save_lz_image
 };
 
 // thisroom.options[0] = startup music
@@ -231,7 +242,9 @@ struct room_file_header {
 
 extern int _acroom_bpp;  // bytes per pixel of currently loading room
 
-extern void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes);
+// Loads the room from the file, or from the given stream which then is
+// deleted when the room has been read
+extern void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes, Common::Stream *in = NULL);
 
 
 // Those are, in fact, are project-dependent and are implemented in runtime and AGS.Native
@@ -54,6 +54,7 @@ SpriteCache::SpriteCache(int32_t maxElements)
   offsets = NULL;
   sprite0InitialOffset = 0;
   spritesAreCompressed = false;
+  deferredLoader = NULL;
   init();
 }
 
@@ -113,12 +114,20 @@ void SpriteCache::reset()
 void SpriteCache::set(int index, Bitmap *sprite)
 {
   images[index] = sprite;
+  flags[index] &= ~SPRCACHEFLAG_DEFERRED;
 }
 
 void SpriteCache::setNonDiscardable(int index, Bitmap *sprite)
 {
   images[index] = sprite;
   offsets[index] = SPRITE_LOCKED;
+  flags[index] &= ~SPRCACHEFLAG_DEFERRED;
+}
+
+void SpriteCache::setDeferred(int index)
+{
+  images[index] = NULL;
+  flags[index] |= SPRCACHEFLAG_DEFERRED;
 }
 
 void SpriteCache::removeSprite(int index, bool freeMemory)
@@ -128,6 +137,7 @@ void SpriteCache::removeSprite(int index, bool freeMemory)
 
   images[index] = NULL;
   offsets[index] = 0;
+  flags[index] &= ~SPRCACHEFLAG_DEFERRED;
 }
 
 int SpriteCache::enlargeTo(int32_t newsize) {
@@ -160,7 +170,8 @@ int SpriteCache::findFreeSlot()
   int i;
   for (i = 1; i < elements; i++) {
     // slot empty
-    if ((images[i] == NULL) && ((offsets[i] == 0) || (offsets[i] == sprite0InitialOffset)))
+    if ((images[i] == NULL) && ((offsets[i] == 0) || (offsets[i] == sprite0InitialOffset)) &&
+        ((flags[i] & SPRCACHEFLAG_DEFERRED) == 0))
       return i;
   }
   // no free slot found yet
@@ -173,7 +184,7 @@ int SpriteCache::findFreeSlot()
 }
 
 int SpriteCache::doesSpriteExist(int index) {
-  if (images[index] != NULL)
+  if ((images[index] != NULL) || (flags[index] & SPRCACHEFLAG_DEFERRED))
     return 1;
   
   if (flags[index] & SPRCACHEFLAG_DOESNOTEXIST)
@@ -191,6 +202,12 @@ Bitmap *SpriteCache::operator [] (int index)
   if ((index < 0) || (index >= elements))
     return NULL;
 
+  // Sprite which image is only made when it is first needed
+  if (flags[index] & SPRCACHEFLAG_DEFERRED) {
+    flags[index] &= ~SPRCACHEFLAG_DEFERRED;
+    images[index] = deferredLoader ? deferredLoader(index) : NULL;
+  }
+
   // Dynamically added sprite, don't put it on the sprite list
   if ((images[index] != NULL) && 
       ((offsets[index] == 0) || ((flags[index] & SPRCACHEFLAG_DOESNOTEXIST) != 0)))
@@ -315,6 +332,9 @@ void SpriteCache::precache(int index)
 
   int sprSize = 0;
 
+  if (flags[index] & SPRCACHEFLAG_DEFERRED)
+    (*this)[index];
+
   if (images[index] == NULL) {
     sprSize = loadSprite(index);
   }
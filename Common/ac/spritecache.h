@@ -28,6 +28,8 @@ using namespace AGS; // FIXME later
 // this is changed to reference the Bluecup sprite. Therefore we need
 // a definite way of knowing whether the sprite existed in the sprite file.
 #define SPRCACHEFLAG_DOESNOTEXIST 1
+// The sprite image is made by the deferred loader on first access
+#define SPRCACHEFLAG_DEFERRED     2
 
 // Max size of the sprite cache, in bytes
 #if defined (PSP_VERSION)
@@ -50,6 +52,7 @@ public:
   void precache(int);           // preloads and locks in memory
   void set(int, Common::Bitmap *);
   void setNonDiscardable(int, Common::Bitmap *);
+  void setDeferred(int);        // image is made by deferredLoader when needed
   void removeSprite(int, bool);
   void removeOldest();
   void reset();                 // wipes all data 
@@ -79,6 +82,8 @@ public:
   int lastLoad;
   int32_t maxCacheSize;
   int32_t lockedSize;              // size in bytes of currently locked images
+  // makes the images of the deferred sprites
+  Common::Bitmap *(*deferredLoader)(int index);
 
 private:
     void compressSprite(Common::Bitmap *sprite, Common::Stream *out);
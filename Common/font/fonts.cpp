@@ -37,6 +37,35 @@ static IAGSFontRenderer2* fontRenderers2[MAX_FONTS];
 static TTFFontRenderer ttfRenderer;
 static WFNFontRenderer wfnRenderer;
 
+// Fonts which were requested but not loaded yet, see wloadfont_lazy
+struct PendingFont
+{
+  bool Pending;
+  int  Size;
+  FontRenderParams Params;
+
+  PendingFont()
+    : Pending(false)
+    , Size(0)
+  {
+  }
+};
+static PendingFont pendingFonts[MAX_FONTS];
+
+// Loads the font if it was only requested so far
+static void ensure_font_loaded(int fontNumber)
+{
+  if (!pendingFonts[fontNumber].Pending)
+    return;
+  pendingFonts[fontNumber].Pending = false;
+  if (!wloadfont_size(fontNumber, pendingFonts[fontNumber].Size, &pendingFonts[fontNumber].Params))
+  {
+    char errorMsg[100];
+    sprintf(errorMsg, "Unable to load font %d, no renderer could load a matching file", fontNumber);
+    quit(errorMsg);
+  }
+}
+
 void init_font_renderer()
 {
 #ifdef USE_ALFONT
@@ -48,6 +77,7 @@ void init_font_renderer()
   {
     fontRenderers[i] = NULL;
     fontRenderers2[i] = NULL;
+    pendingFonts[i].Pending = false;
   }
 }
 
@@ -61,15 +91,18 @@ void shutdown_font_renderer()
 
 void adjust_y_coordinate_for_text(int* ypos, int fontnum)
 {
+  ensure_font_loaded(fontnum);
   fontRenderers[fontnum]->AdjustYCoordinateForFont(ypos, fontnum);
 }
 
 bool font_first_renderer_loaded() {
+    ensure_font_loaded(0);
     return fontRenderers[0] != NULL;
 }
 
 IAGSFontRenderer* font_replace_renderer(int fontNumber, IAGSFontRenderer* renderer)
 {
+  ensure_font_loaded(fontNumber);
   IAGSFontRenderer* oldRender = fontRenderers[fontNumber];
   fontRenderers[fontNumber] = renderer;
   fontRenderers2[fontNumber] = NULL;
@@ -78,21 +111,25 @@ IAGSFontRenderer* font_replace_renderer(int fontNumber, IAGSFontRenderer* render
 
 bool font_supports_extended_characters(int fontNumber)
 {
+  ensure_font_loaded(fontNumber);
   return fontRenderers[fontNumber]->SupportsExtendedCharacters(fontNumber);
 }
 
 void ensure_text_valid_for_font(char *text, int fontnum)
 {
+  ensure_font_loaded(fontnum);
   fontRenderers[fontnum]->EnsureTextValidForFont(text, fontnum);
 }
 
 int wgettextwidth(const char *texx, int fontNumber)
 {
+  ensure_font_loaded(fontNumber);
   return fontRenderers[fontNumber]->GetTextWidth(texx, fontNumber);
 }
 
 int wgettextheight(const char *text, int fontNumber)
 {
+  ensure_font_loaded(fontNumber);
   return fontRenderers[fontNumber]->GetTextHeight(text, fontNumber);
 }
 
@@ -101,6 +138,7 @@ void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t te
   if (yyy > ds->GetClip().Bottom)
     return;                   // each char is clipped but this speeds it up
 
+  ensure_font_loaded(fontNumber);
   if (fontRenderers[fontNumber] != NULL)
   {
     fontRenderers[fontNumber]->RenderText(texx, fontNumber, (BITMAP*)ds->GetAllegroBitmap(), xxx, yyy, text_color);
@@ -125,6 +163,15 @@ bool wloadfont_size(int fontNumber, int fsize, const FontRenderParams *params)
   return false;
 }
 
+// Remembers the font to be loaded when it is first used
+void wloadfont_lazy(int fontNumber, int fsize, const FontRenderParams *params)
+{
+  wfreefont(fontNumber);
+  pendingFonts[fontNumber].Pending = true;
+  pendingFonts[fontNumber].Size = fsize;
+  pendingFonts[fontNumber].Params = params ? *params : FontRenderParams();
+}
+
 void wgtprintf(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t text_color, char *fmt, ...)
 {
   char tbuffer[2000];
@@ -138,6 +185,7 @@ void wgtprintf(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t tex
 
 void wfreefont(int fontNumber)
 {
+  pendingFonts[fontNumber].Pending = false;
   if (fontRenderers[fontNumber] != NULL)
     fontRenderers[fontNumber]->FreeMemory(fontNumber);
 
@@ -46,6 +46,9 @@ int wgettextheight(const char *text, int fontNumber);
 void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t text_color, const char *texx);
 // Loads a font from disk
 bool wloadfont_size(int fontNumber, int fsize, const FontRenderParams *params = NULL);
+// Registers a font to be loaded from disk on its first use; the program quits
+// if it cannot be loaded by then
+void wloadfont_lazy(int fontNumber, int fsize, const FontRenderParams *params = NULL);
 void wgtprintf(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t text_color, char *fmt, ...);
 void wfreefont(int fontNumber);
 
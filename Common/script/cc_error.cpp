@@ -27,14 +27,14 @@ char ccErrorString[400];
 char ccErrorCallStack[400];
 bool ccErrorIsUserError = false;
 const char *ccCurScriptName = "";
+bool (*ccErrorHandler)(const char *message) = NULL;
 
 void cc_error(const char *descr, ...)
 {
-    ccErrorCallStack[0] = 0;
-    ccErrorIsUserError = false;
+    bool is_user_error = false;
     if (descr[0] == '!')
     {
-        ccErrorIsUserError = true;
+        is_user_error = true;
         descr++;
     }
 
@@ -45,6 +45,12 @@ void cc_error(const char *descr, ...)
     vsprintf(displbuf, descr, ap);
     va_end(ap);
 
+    if (ccErrorHandler && ccErrorHandler(displbuf))
+        return;
+
+    ccErrorCallStack[0] = 0;
+    ccErrorIsUserError = is_user_error;
+
     if (currentline > 0) {
         // [IKM] Implementation is project-specific
         cc_error_at_line(ccErrorString, displbuf);
@@ -30,5 +30,8 @@ extern char ccErrorString[400]; // description of the error
 extern char ccErrorCallStack[400];
 extern bool ccErrorIsUserError;
 extern const char *ccCurScriptName; // name of currently compiling script
+// if set, gets the error message first; returns true if it has dealt with
+// the error, which is then not reported as usual
+extern bool (*ccErrorHandler)(const char *message);
 
 #endif // __CC_ERROR_H
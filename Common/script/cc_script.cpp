@@ -362,9 +362,13 @@ void ccScript::Free()
     if (imports != NULL)
     {
         free(imports);
+        imports = NULL;
+    }
+
+    if (exports != NULL)
+    {
         free(exports);
         free(export_addr);
-        imports = NULL;
         exports = NULL;
         export_addr = NULL;
     }
@@ -12,27 +12,124 @@
 //
 //=============================================================================
 
+#include <cstdlib>
 #include <cstring>
 #include "cc_treemap.h"
 
+static const int INITIAL_SLOTS = 64;
+
+unsigned int ccTreeMap::hashKey(const char *key) {
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (; key && *key; key++) {
+        hash ^= (unsigned char)*key;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+ccTreeMap::ccTreeMap() {
+    count = 0;
+}
+
+ccTreeMap::ccTreeMap(const ccTreeMap &src) {
+    count = 0;
+    *this = src;
+}
+
+ccTreeMap &ccTreeMap::operator=(const ccTreeMap &src) {
+    if (this == &src)
+        return *this;
+    clear();
+    slots = src.slots;
+    count = src.count;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].key)
+            slots[i].key = strdup(slots[i].key);
+    }
+    return *this;
+}
+
+int ccTreeMap::findSlot(const char *key, unsigned int hash) {
+    // linear probing; there is always a free slot to stop at
+    int mask = (int)slots.size() - 1;
+    for (int i = hash & mask; ; i = (i + 1) & mask) {
+        if (slots[i].key == NULL)
+            return i;
+        if ((slots[i].hash == hash) && (strcmp(slots[i].key, key) == 0))
+            return i;
+    }
+}
+
+void ccTreeMap::grow(size_t size) {
+    std::vector<Slot> old;
+    old.swap(slots);
+    Slot empty = { NULL, 0, 0 };
+    slots.assign(size, empty);
+    int mask = (int)slots.size() - 1;
+    for (size_t i = 0; i < old.size(); i++) {
+        if (old[i].key == NULL)
+            continue;
+        int j = old[i].hash & mask;
+        while (slots[j].key)
+            j = (j + 1) & mask;
+        slots[j] = old[i];
+    }
+}
+
 int ccTreeMap::findValue(const char *key) {
-	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+    if (!key || !key[0]) { return -1; }
+    return findValue(key, hashKey(key));
+}
+
+int ccTreeMap::findValue(const char *key, unsigned int hash) {
+    if (!key || !key[0] || (count == 0)) { return -1; }
+    int slot = findSlot(key, hash);
+    return slots[slot].key ? slots[slot].value : -1;
 }
 
-void ccTreeMap::addEntry(const char* ntx, int p_value) {
-    // don't add if it's an empty string or if it's already here
-    if (!ntx || strlen(ntx) <= 0) { return; }
+const char *ccTreeMap::findKey(const char *key) {
+    if (!key || !key[0] || (count == 0)) { return NULL; }
+    return slots[findSlot(key, hashKey(key))].key;
+}
 
-    this->storage[std::string(ntx)] = p_value;
+const char *ccTreeMap::addEntry(const char* ntx, int p_value) {
+    if (!ntx || !ntx[0]) { return NULL; }
+    return addEntry(ntx, hashKey(ntx), p_value);
+}
+
+const char *ccTreeMap::addEntry(const char* ntx, unsigned int hash, int p_value) {
+    // don't add if it's an empty string; replace the value if it's already here
+    if (!ntx || !ntx[0]) { return NULL; }
+
+    // keep at most half of the slots used
+    if ((count + 1) * 2 > (int)slots.size())
+        grow(slots.empty() ? INITIAL_SLOTS : slots.size() * 2);
+    int slot = findSlot(ntx, hash);
+    if (slots[slot].key == NULL) {
+        slots[slot].key = strdup(ntx);
+        slots[slot].hash = hash;
+        count++;
+    }
+    slots[slot].value = p_value;
+    return slots[slot].key;
+}
+
+void ccTreeMap::reserve(int count) {
+    size_t size = slots.empty() ? INITIAL_SLOTS : slots.size();
+    while ((int)size < count * 2)
+        size *= 2;
+    if (size > slots.size())
+        grow(size);
 }
 
 void ccTreeMap::clear() {
-    this->storage.clear();
+    for (size_t i = 0; i < slots.size(); i++)
+        free(slots[i].key);
+    slots.clear();
+    count = 0;
 }
 
 ccTreeMap::~ccTreeMap() {
-    this->storage.clear();
-}
\ No newline at end of file
+    clear();
+}
@@ -19,18 +19,42 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
-#include <string>
+#include <vector>
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface but keeps the entries in a hash table; the keys
+// are copied into the map, so that their copies may be used as the names
 struct ccTreeMap {
+    // hash of the key, as used by the map
+    static unsigned int hashKey(const char *key);
+
     int findValue(const char *key);
-    void addEntry(const char *ntx, int p_value);
+    int findValue(const char *key, unsigned int hash);
+    // returns the copy of the key kept by the map, or NULL if not found
+    const char *findKey(const char *key);
+    // returns the copy of the key kept by the map
+    const char *addEntry(const char *ntx, int p_value);
+    const char *addEntry(const char *ntx, unsigned int hash, int p_value);
     void clear();
+    // makes room for the given number of keys
+    void reserve(int count);
+
+    ccTreeMap();
+    ccTreeMap(const ccTreeMap &src);
+    ccTreeMap &operator=(const ccTreeMap &src);
     ~ccTreeMap();
 
 private:
-    std::map<std::string, int> storage;
+    struct Slot {
+        char *key;   // NULL if free
+        unsigned int hash;
+        int value;
+    };
+
+    std::vector<Slot> slots;   // size is a power of two
+    int count;
+
+    int  findSlot(const char *key, unsigned int hash);
+    void grow(size_t size);
 };
 
 #endif // __CC_TREEMAP_H
\ No newline at end of file
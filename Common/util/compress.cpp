@@ -14,6 +14,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <vector>
 #include "ac/common.h"	// quit()
 #include "ac/roomstruct.h"
 #include "util/compress.h"
@@ -29,6 +31,8 @@
 #include "util/misc.h"
 #include "util/stream.h"
 #include "util/filestream.h"
+#include "util/lzstream.h"
+#include "util/math.h"
 #include "gfx/bitmap.h"
 
 using namespace AGS::Common;
@@ -204,9 +208,8 @@ int cunpackbitl(unsigned char *line, int size, Stream *in)
 
   while (n < size) {
     int ix = in->ReadByte();     // get index byte
-    // TODO: revise when new error handling system is implemented
-    if (ferror(((Common::FileStream*)in)->GetHandle()))
-      break;
+    if (ix < 0)                  // end of stream or read error
+      return -1;
 
     char cx = ix;
     if (cx == -128)
@@ -234,8 +237,7 @@ int cunpackbitl(unsigned char *line, int size, Stream *in)
     }
   }
 
-  // TODO: revise when new error handling system is implemented
-  return ferror(((Common::FileStream*)in)->GetHandle());
+  return 0;
 }
 
 int cunpackbitl16(unsigned short *line, int size, Stream *in)
@@ -244,9 +246,8 @@ int cunpackbitl16(unsigned short *line, int size, Stream *in)
 
   while (n < size) {
     int ix = in->ReadByte();     // get index byte
-    // TODO: revise when new error handling system is implemented
-    if (ferror(((Common::FileStream*)in)->GetHandle()))
-      break;
+    if (ix < 0)                  // end of stream or read error
+      return -1;
 
     char cx = ix;
     if (cx == -128)
@@ -274,8 +275,7 @@ int cunpackbitl16(unsigned short *line, int size, Stream *in)
     }
   }
 
-  // TODO: revise when new error handling system is implemented
-  return ferror(((Common::FileStream*)in)->GetHandle());
+  return 0;
 }
 
 int cunpackbitl32(unsigned int *line, int size, Stream *in)
@@ -284,9 +284,8 @@ int cunpackbitl32(unsigned int *line, int size, Stream *in)
 
   while (n < size) {
     int ix = in->ReadByte();     // get index byte
-    // TODO: revise when new error handling system is implemented
-    if (ferror(((Common::FileStream*)in)->GetHandle()))
-      break;
+    if (ix < 0)                  // end of stream or read error
+      return -1;
 
     char cx = ix;
     if (cx == -128)
@@ -314,8 +313,7 @@ int cunpackbitl32(unsigned int *line, int size, Stream *in)
     }
   }
 
-  // TODO: revise when new error handling system is implemented
-  return ferror(((Common::FileStream*)in)->GetHandle());
+  return 0;
 }
 
 //=============================================================================
@@ -364,70 +362,58 @@ long save_lzw(char *fnn, Bitmap *bmpp, color *pall, long offe) {
   return toret;
 }
 
+#if defined(AGS_BIG_ENDIAN)
+// Converts the line of pixels between the file's and the native byte order
+static void swap_line_bytes(uint8_t *line, int count, int bpp) {
+  if (bpp == 2) {
+    short *sp = (short *)line;
+    for (int i = 0; i < count; ++i)
+      sp[i] = AGS::Common::BBOp::SwapBytesInt16(sp[i]);
+  }
+  else if (bpp == 4) {
+    int *ip = (int *)line;
+    for (int i = 0; i < count; ++i)
+      ip[i] = AGS::Common::BBOp::SwapBytesInt32(ip[i]);
+  }
+}
+#endif // defined(AGS_BIG_ENDIAN)
+
 /*long load_lzw(char*fnn,Bitmap*bmm,color*pall,long ooff) {
   recalced=bmm;
   FILE*iii=clibfopen(fnn,"rb");
   Seek(iii,ooff,SEEK_SET);*/
 
 long load_lzw(Stream *in, Common::Bitmap *bmm, color *pall) {
-  int          uncompsiz, *loptr;
-  unsigned char *membuffer;
-  int           arin;
+  int           line_len, height;
+  long          end_pos;
 
   recalced = bmm;
   // MACPORT FIX (HACK REALLY)
   in->Read(&pall[0], sizeof(color)*256);
-  maxsize = in->ReadInt32();
-  uncompsiz = in->ReadInt32();
-
-  uncompsiz += in->GetPosition();
-  outbytes = 0; putbytes = 0;
+  in->ReadInt32();  // unpacked size
+  const int packed_size = in->ReadInt32();
+  end_pos = in->GetPosition() + packed_size;
 
-  update_polled_stuff_if_runtime();
-  membuffer = lzwexpand_to_mem(in);
   update_polled_stuff_if_runtime();
 
-  loptr = (int *)&membuffer[0];
-  membuffer += 8;
+  // the unpacked data begins with the line length in bytes and the height,
+  // the bitmap is unpacked right into its lines after them
+  LzwExpander lzw(in, packed_size);
+  int32_t dims[2];
+  if (!lzw.Expand((uint8_t*)dims, sizeof(dims)))
+    quit("Read error decompressing image - file is corrupt");
 #if defined(AGS_BIG_ENDIAN)
-  loptr[0] = AGS::Common::BBOp::SwapBytesInt32(loptr[0]);
-  loptr[1] = AGS::Common::BBOp::SwapBytesInt32(loptr[1]);
-  int bitmapNumPixels = loptr[0]*loptr[1]/_acroom_bpp;
-  switch (_acroom_bpp) // bytes per pixel!
-  {
-    case 1:
-    {
-      // all done
-      break;
-    }
-    case 2:
-    {
-      short *sp = (short *)membuffer;
-      for (int i = 0; i < bitmapNumPixels; ++i)
-      {
-        sp[i] = AGS::Common::BBOp::SwapBytesInt16(sp[i]);
-      }
-      // all done
-      break;
-    }
-    case 4:
-    {
-      int *ip = (int *)membuffer;
-      for (int i = 0; i < bitmapNumPixels; ++i)
-      {
-        ip[i] = AGS::Common::BBOp::SwapBytesInt32(ip[i]);
-      }
-      // all done
-      break;
-    }
-  }
-#endif // defined(AGS_BIG_ENDIAN)
+  dims[0] = AGS::Common::BBOp::SwapBytesInt32(dims[0]);
+  dims[1] = AGS::Common::BBOp::SwapBytesInt32(dims[1]);
+#endif
+  line_len = dims[0];
+  height = dims[1];
+  if (line_len <= 0 || height <= 0 || line_len % _acroom_bpp != 0)
+    quit("Read error decompressing image - file is corrupt");
 
   delete bmm;
 
-  update_polled_stuff_if_runtime();
-
-  bmm = BitmapHelper::CreateBitmap((loptr[0] / _acroom_bpp), loptr[1], _acroom_bpp * 8);
+  bmm = BitmapHelper::CreateBitmap(line_len / _acroom_bpp, height, _acroom_bpp * 8);
   if (bmm == NULL)
     quit("!load_room: not enough memory to load room background");
 
@@ -436,21 +422,25 @@ long load_lzw(Stream *in, Common::Bitmap *bmm, color *pall) {
   bmm->Acquire ();
   recalced = bmm;
 
-  for (arin = 0; arin < loptr[1]; arin++)
-    memcpy(&bmm->GetScanLineForWriting(arin)[0], &membuffer[arin * loptr[0]], loptr[0]);
+  for (int y = 0; y < height; y++) {
+    uint8_t *line = &bmm->GetScanLineForWriting(y)[0];
+    if (!lzw.Expand(line, line_len))
+      quit("Read error decompressing image - file is corrupt");
+#if defined(AGS_BIG_ENDIAN)
+    swap_line_bytes(line, line_len / _acroom_bpp, _acroom_bpp);
+#endif
+    if (y % 64 == 0)
+      update_polled_stuff_if_runtime();
+  }
 
   bmm->Release ();
 
-  update_polled_stuff_if_runtime();
-
-  free(membuffer-8);
-
-  if (in->GetPosition() != uncompsiz)
-    in->Seek(uncompsiz, kSeekBegin);
+  if (in->GetPosition() != end_pos)
+    in->Seek(end_pos, kSeekBegin);
 
   update_polled_stuff_if_runtime();
 
-  return uncompsiz;
+  return end_pos;
 }
 
 long savecompressed_allegro(char *fnn, Common::Bitmap *bmpp, color *pall, long write_at) {
@@ -468,9 +458,72 @@ long savecompressed_allegro(char *fnn, Common::Bitmap *bmpp, color *pall, long w
   return toret;
 }
 
+// Size of the block in which the packed lines are read
+const size_t RleInputBlock = 64 * 1024;
+// The longest run or sequence takes its index byte and 128 bytes of data
+const size_t RleMaxToken = 129;
+
+// Unpacks the 8-bit lines packed by cpackbitl straight into the bitmap,
+// reading the stream by large blocks; the stream is left right after the
+// packed lines. Some old rooms have masks with the runs and sequences going
+// past the end of the line; these are cut at the line end, as cunpackbitl
+// always did, and the rest of a sequence is read as the next tokens.
+// Returns false if the data ends too early.
+static bool unpack_bitmap_lines(Stream *in, Bitmap *bmp)
+{
+  const int width = bmp->GetWidth();
+  const int height = bmp->GetHeight();
+  std::vector<uint8_t> buf(RleInputBlock);
+  size_t pos = 0, end = 0;
+  bool input_ended = false;
+
+  for (int y = 0; y < height; y++) {
+    uint8_t *line = &bmp->GetScanLineForWriting(y)[0];
+    int n = 0;
+    while (n < width) {
+      // keep at least the whole token in the buffer
+      if (end - pos < RleMaxToken && !input_ended) {
+        memmove(&buf[0], &buf[pos], end - pos);
+        end -= pos;
+        pos = 0;
+        const size_t len = in->Read(&buf[end], buf.size() - end);
+        input_ended = len < buf.size() - end;
+        end += len;
+      }
+      if (pos == end)
+        return false;
+
+      int cx = (int8_t)buf[pos++];
+      if (cx == -128)
+        cx = 0;
+
+      if (cx < 0) {                //.............run
+        const int count = Math::Min(1 - cx, width - n);
+        if (pos == end)
+          return false;
+        memset(line + n, buf[pos++], count);
+        n += count;
+      } else {                     //.....................seq
+        const int count = Math::Min(cx + 1, width - n);
+        if ((size_t)count > end - pos)
+          return false;
+        memcpy(line + n, &buf[pos], count);
+        pos += count;
+        n += count;
+      }
+    }
+    if (y % 64 == 0)
+      update_polled_stuff_if_runtime();
+  }
+
+  // give back what was read past the packed lines
+  if (pos < end)
+    in->Seek(-(int)(end - pos), kSeekCurrent);
+  return true;
+}
+
 long loadcompressed_allegro(Stream *in, Common::Bitmap **bimpp, color *pall, long read_at) {
   short widd,hitt;
-  int   ii;
 
   Bitmap *bim = *bimpp;
   delete bim;
@@ -482,15 +535,67 @@ long loadcompressed_allegro(Stream *in, Common::Bitmap **bimpp, color *pall, lon
     quit("!load_room: not enough memory to decompress masks");
   *bimpp = bim;
 
-  for (ii = 0; ii < hitt; ii++) {
-    cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd, in);
-    if (ii % 20 == 0)
-      update_polled_stuff_if_runtime();
-  }
+  if (!unpack_bitmap_lines(in, bim))
+    quit("Read error decompressing image - file is corrupt");
 
   in->Seek(768);  // skip palette
 
   return in->GetPosition();
 }
 
+//=============================================================================
+
+void save_lz_image(Stream *out, Common::Bitmap *bmp, const color *pall) {
+  const int line_len = bmp->GetWidth() * bmp->GetBPP();
+  const int height = bmp->GetHeight();
+
+  if (pall != NULL)
+    out->WriteArray(&pall[0], sizeof(color), 256);
+  out->WriteInt32(bmp->GetWidth());
+  out->WriteInt32(height);
+  out->WriteInt32(bmp->GetBPP());
 
+  // the bitmap's lines are not necessarily adjacent in memory
+  std::vector<uint8_t> data(line_len * height);
+  for (int y = 0; y < height; y++) {
+    memcpy(&data[y * line_len], bmp->GetScanLine(y), line_len);
+#if defined(AGS_BIG_ENDIAN)
+    swap_line_bytes(&data[y * line_len], bmp->GetWidth(), bmp->GetBPP());
+#endif
+  }
+  LZ::WriteStream(out, data.empty() ? NULL : &data[0], data.size());
+}
+
+long load_lz_image(Stream *in, Common::Bitmap **bimpp, color *pall) {
+  if (pall != NULL)
+    in->Read(&pall[0], sizeof(color)*256);
+  const int width = in->ReadInt32();
+  const int height = in->ReadInt32();
+  const int bpp = in->ReadInt32();
+  if (width <= 0 || height <= 0 || (bpp != 1 && bpp != 2 && bpp != 4))
+    quit("Read error decompressing image - file is corrupt");
+
+  delete *bimpp;
+  Bitmap *bmp = BitmapHelper::CreateBitmap(width, height, bpp * 8);
+  if (bmp == NULL)
+    quit("!load_room: not enough memory to load room image");
+  *bimpp = bmp;
+
+  const size_t line_len = width * bpp;
+  LzReadStream lz(in, kReleaseAfterUse);
+  for (int y = 0; y < height; y++) {
+    uint8_t *line = &bmp->GetScanLineForWriting(y)[0];
+    if (lz.Read(line, line_len) != line_len)
+      quit("Read error decompressing image - file is corrupt");
+#if defined(AGS_BIG_ENDIAN)
+    swap_line_bytes(line, width, bpp);
+#endif
+    if (y % 64 == 0)
+      update_polled_stuff_if_runtime();
+  }
+  // read the end of the packed stream
+  if (lz.ReadByte() != -1 || !lz.IsValid())
+    quit("Read error decompressing image - file is corrupt");
+
+  return in->GetPosition();
+}
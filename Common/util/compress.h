@@ -45,6 +45,13 @@ long load_lzw(Common::Stream *in, Common::Bitmap *bmm, color *pall);
 long savecompressed_allegro(char *fnn, Common::Bitmap *bmpp, color *pall, long write_at);
 long loadcompressed_allegro(Common::Stream *in, Common::Bitmap **bimpp, color *pall, long read_at);
 
+// Saves the bitmap's lines as the LZ stream (see util/lzstream.h), which is
+// unpacked much faster than LZW; the palette is saved if it is given
+void save_lz_image(Common::Stream *out, Common::Bitmap *bmp, const color *pall);
+// Loads the bitmap saved by save_lz_image, replacing the one in *bimpp; the
+// palette is read if it is given, and must be if it was saved
+long load_lz_image(Common::Stream *in, Common::Bitmap **bimpp, color *pall);
+
 //extern char *lztempfnm;
 extern Common::Bitmap *recalced;
 
@@ -63,5 +63,27 @@ Rect PlaceInRect(const Rect &place, const Rect &item, const RectPlacement &place
     }
 }
 
+Rect IntersectRects(const Rect &r1, const Rect &r2)
+{
+    return Rect(AGSMath::Max(r1.Left, r2.Left), AGSMath::Max(r1.Top, r2.Top),
+                AGSMath::Min(r1.Right, r2.Right), AGSMath::Min(r1.Bottom, r2.Bottom));
+}
+
+Rect UnionRects(const Rect &r1, const Rect &r2)
+{
+    if (r1.IsEmpty())
+        return r2;
+    if (r2.IsEmpty())
+        return r1;
+    return Rect(AGSMath::Min(r1.Left, r2.Left), AGSMath::Min(r1.Top, r2.Top),
+                AGSMath::Max(r1.Right, r2.Right), AGSMath::Max(r1.Bottom, r2.Bottom));
+}
+
+bool AreRectsAdjacent(const Rect &r1, const Rect &r2)
+{
+    return r1.Left <= r2.Right + 1 && r2.Left <= r1.Right + 1 &&
+           r1.Top <= r2.Bottom + 1 && r2.Top <= r1.Bottom + 1;
+}
+
 //} // namespace Common
 //} // namespace AGS
@@ -311,6 +311,12 @@ Size ProportionalStretch(const Size &dest, const Size &item);
 Rect OffsetRect(const Rect &r, const Point off);
 Rect CenterInRect(const Rect &place, const Rect &item);
 Rect PlaceInRect(const Rect &place, const Rect &item, const RectPlacement &placement);
+// Returns rectangle covered by both r1 and r2; result is empty if they do not overlap
+Rect IntersectRects(const Rect &r1, const Rect &r2);
+// Returns smallest rectangle that contains both r1 and r2
+Rect UnionRects(const Rect &r1, const Rect &r2);
+// Tells if two rectangles overlap or touch each other's sides
+bool AreRectsAdjacent(const Rect &r1, const Rect &r2);
 //} // namespace Common
 //} // namespace AGS
 
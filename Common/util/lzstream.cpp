@@ -0,0 +1,326 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/lzstream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace LZ
+{
+
+// Every sequence starts with the token, holding the literal run length in
+// the high 4 bits and the match length in the low 4 bits; value 15 means
+// that more length bytes follow (each adding up to 255). The literals are
+// followed by the 16-bit match offset. The last sequence has no match.
+const size_t MinMatch  = 4;
+const size_t MaxOffset = 0xFFFF;
+const int    HashBits  = 13;
+
+inline uint32_t Read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t Hash(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - HashBits);
+}
+
+static void WriteLength(std::vector<uint8_t> &dst, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        dst.push_back(255);
+    dst.push_back((uint8_t)len);
+}
+
+static void WriteSequence(std::vector<uint8_t> &dst, const uint8_t *literals, size_t lit_len,
+                          size_t offset, size_t match_len)
+{
+    const size_t match_code = match_len > 0 ? match_len - MinMatch : 0;
+    dst.push_back((uint8_t)(((lit_len < 15 ? lit_len : 15) << 4) | (match_code < 15 ? match_code : 15)));
+    if (lit_len >= 15)
+        WriteLength(dst, lit_len - 15);
+    dst.insert(dst.end(), literals, literals + lit_len);
+    if (match_len == 0)
+        return;
+    dst.push_back((uint8_t)(offset & 0xFF));
+    dst.push_back((uint8_t)(offset >> 8));
+    if (match_code >= 15)
+        WriteLength(dst, match_code - 15);
+}
+
+size_t Compress(const uint8_t *src, size_t src_len, std::vector<uint8_t> &dst)
+{
+    const size_t dst_start = dst.size();
+    // positions of the recent 4-byte sequences, plus one (zero means none)
+    std::vector<uint32_t> table(1 << HashBits, 0);
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MinMatch <= src_len)
+    {
+        const uint32_t seq = Read32(src + i);
+        uint32_t &slot = table[Hash(seq)];
+        const size_t ref = slot;
+        slot = (uint32_t)(i + 1);
+        if (ref == 0 || i - (ref - 1) > MaxOffset || Read32(src + ref - 1) != seq)
+        {
+            i++;
+            continue;
+        }
+
+        const size_t match_from = ref - 1;
+        size_t len = MinMatch;
+        while (i + len < src_len && src[match_from + len] == src[i + len])
+            len++;
+        WriteSequence(dst, src + anchor, i - anchor, i - match_from, len);
+        i += len;
+        anchor = i;
+    }
+    if (anchor < src_len)
+        WriteSequence(dst, src + anchor, src_len - anchor, 0, 0);
+    return dst.size() - dst_start;
+}
+
+static bool ReadLength(const uint8_t *&ip, const uint8_t *ip_end, size_t &len)
+{
+    for (;;)
+    {
+        if (ip >= ip_end)
+            return false;
+        const uint8_t b = *ip++;
+        len += b;
+        if (b != 255)
+            return true;
+    }
+}
+
+bool Decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+{
+    const uint8_t *ip = src;
+    const uint8_t *ip_end = src + src_len;
+    uint8_t *op = dst;
+    uint8_t *op_end = dst + dst_len;
+    while (op < op_end)
+    {
+        if (ip >= ip_end)
+            return false;
+        const uint8_t token = *ip++;
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !ReadLength(ip, ip_end, lit_len))
+            return false;
+        if (lit_len > (size_t)(ip_end - ip) || lit_len > (size_t)(op_end - op))
+            return false;
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (op == op_end)
+            break;
+
+        if (ip_end - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 0xF;
+        if (match_len == 15 && !ReadLength(ip, ip_end, match_len))
+            return false;
+        match_len += MinMatch;
+        if (offset == 0 || offset > (size_t)(op - dst) || match_len > (size_t)(op_end - op))
+            return false;
+        // the match may overlap the bytes it produces
+        const uint8_t *match = op - offset;
+        for (size_t n = 0; n < match_len; ++n)
+            op[n] = match[n];
+        op += match_len;
+    }
+    return ip == ip_end;
+}
+
+void WriteStream(Stream *out, const uint8_t *data, size_t size)
+{
+    std::vector<uint8_t> packed;
+    for (size_t pos = 0; pos < size; pos += ChunkSize)
+    {
+        const size_t len = size - pos < ChunkSize ? size - pos : ChunkSize;
+        packed.clear();
+        Compress(data + pos, len, packed);
+        out->WriteInt32(len);
+        // data that did not get smaller is stored as is
+        if (packed.size() >= len)
+        {
+            out->WriteInt32(len);
+            out->Write(data + pos, len);
+        }
+        else
+        {
+            out->WriteInt32(packed.size());
+            out->Write(&packed[0], packed.size());
+        }
+    }
+    out->WriteInt32(0);
+}
+
+} // namespace LZ
+
+
+LzReadStream::LzReadStream(Stream *stream, ObjectOwnershipPolicy stream_ownership_policy,
+                           DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _stream(stream)
+    , _streamOwnershipPolicy(stream_ownership_policy)
+    , _chunkPos(0)
+    , _position(0)
+    , _eos(false)
+    , _broken(false)
+{
+}
+
+LzReadStream::~LzReadStream()
+{
+    Close();
+}
+
+void LzReadStream::Close()
+{
+    if (_stream && _streamOwnershipPolicy == kDisposeAfterUse)
+    {
+        delete _stream;
+    }
+    _stream = NULL;
+}
+
+bool LzReadStream::Flush()
+{
+    return false;
+}
+
+bool LzReadStream::IsValid() const
+{
+    return _stream && _stream->IsValid() && !_broken;
+}
+
+bool LzReadStream::EOS() const
+{
+    return _chunkPos >= _chunk.size() && (_eos || !IsValid());
+}
+
+size_t LzReadStream::GetLength() const
+{
+    return 0;
+}
+
+size_t LzReadStream::GetPosition() const
+{
+    return _position;
+}
+
+bool LzReadStream::CanRead() const
+{
+    return IsValid();
+}
+
+bool LzReadStream::CanWrite() const
+{
+    return false;
+}
+
+bool LzReadStream::CanSeek() const
+{
+    return false;
+}
+
+bool LzReadStream::ReadChunk()
+{
+    if (_eos || !IsValid())
+        return false;
+    const size_t raw_len = _stream->ReadInt32();
+    if (raw_len == 0)
+    {
+        _eos = true;
+        return false;
+    }
+    const size_t packed_len = _stream->ReadInt32();
+    if (raw_len > LZ::ChunkSize || packed_len > raw_len)
+    {
+        _broken = true;
+        return false;
+    }
+
+    _chunk.resize(raw_len);
+    _chunkPos = 0;
+    if (packed_len == raw_len)
+    {
+        _broken = _stream->Read(&_chunk[0], raw_len) != raw_len;
+    }
+    else
+    {
+        _packed.resize(packed_len);
+        _broken = _stream->Read(&_packed[0], packed_len) != packed_len ||
+            !LZ::Decompress(&_packed[0], packed_len, &_chunk[0], raw_len);
+    }
+    if (_broken)
+        _chunk.clear();
+    return !_broken;
+}
+
+size_t LzReadStream::Read(void *buffer, size_t size)
+{
+    uint8_t *dst = (uint8_t*)buffer;
+    size_t done = 0;
+    while (done < size)
+    {
+        if (_chunkPos >= _chunk.size() && !ReadChunk())
+            break;
+        size_t len = _chunk.size() - _chunkPos;
+        if (len > size - done)
+            len = size - done;
+        if (dst)
+            memcpy(dst + done, &_chunk[_chunkPos], len);
+        _chunkPos += len;
+        done += len;
+    }
+    _position += done;
+    return done;
+}
+
+int32_t LzReadStream::ReadByte()
+{
+    uint8_t b;
+    return Read(&b, 1) == 1 ? b : -1;
+}
+
+size_t LzReadStream::Write(const void *buffer, size_t size)
+{
+    return 0;
+}
+
+int32_t LzReadStream::WriteByte(uint8_t b)
+{
+    return -1;
+}
+
+size_t LzReadStream::Seek(int offset, StreamSeek origin)
+{
+    if (origin == kSeekCurrent && offset >= 0)
+        Read(NULL, offset);
+    return _position;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,98 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Fast LZ77 compression, meant for the large blocks of data which have to be
+// written quickly rather than packed tightly, such as saved games.
+//
+// The compressed block is a sequence of literal runs, each followed by a back
+// reference to the earlier output (up to 64 KB back). The compressed stream
+// is a sequence of chunks, each one having the unpacked and packed sizes and
+// the packed data; the chunk of zero size ends the stream. LzReadStream reads
+// such stream, unpacking one chunk at a time.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LZSTREAM_H
+#define __AGS_CN_UTIL__LZSTREAM_H
+
+#include <vector>
+#include "util/datastream.h"
+#include "util/proxystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace LZ
+{
+    // Size of the data put in one chunk of the compressed stream
+    const size_t ChunkSize = 128 * 1024;
+
+    // Compresses the data, appending it to dst; returns the compressed size
+    size_t Compress(const uint8_t *src, size_t src_len, std::vector<uint8_t> &dst);
+    // Decompresses the data, which must unpack into exactly dst_len bytes;
+    // returns false if the data is broken
+    bool   Decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len);
+    // Writes the data as the compressed stream
+    void   WriteStream(Stream *out, const uint8_t *data, size_t size);
+} // namespace LZ
+
+class LzReadStream : public DataStream
+{
+public:
+    LzReadStream(Stream *stream, ObjectOwnershipPolicy stream_ownership_policy = kReleaseAfterUse,
+        DataEndianess stream_endianess = kLittleEndian);
+    virtual ~LzReadStream();
+
+    virtual void    Close();
+    virtual bool    Flush();
+
+    // Is stream valid (underlying data initialized properly)
+    virtual bool    IsValid() const;
+    // Is end of stream
+    virtual bool    EOS() const;
+    // Total length of stream is not known until it is read
+    virtual size_t  GetLength() const;
+    // Number of bytes unpacked so far
+    virtual size_t  GetPosition() const;
+    virtual bool    CanRead() const;
+    virtual bool    CanWrite() const;
+    virtual bool    CanSeek() const;
+
+    virtual size_t  Read(void *buffer, size_t size);
+    virtual int32_t ReadByte();
+    virtual size_t  Write(const void *buffer, size_t size);
+    virtual int32_t WriteByte(uint8_t b);
+
+    // Only supports skipping forward from the current position
+    virtual size_t  Seek(int offset, StreamSeek origin);
+
+private:
+    // Unpacks the next chunk; returns false at the end of stream or on error
+    bool            ReadChunk();
+
+    Stream                  *_stream;
+    ObjectOwnershipPolicy   _streamOwnershipPolicy;
+    std::vector<uint8_t>    _packed;
+    std::vector<uint8_t>    _chunk;
+    size_t                  _chunkPos;
+    size_t                  _position;
+    bool                    _eos;
+    bool                    _broken;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__LZSTREAM_H
@@ -20,7 +20,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ac/common.h"
+#include "util/lzw.h"
 #include "util/stream.h"
 
 using AGS::Common::Stream;
@@ -52,7 +54,7 @@ void _delete(int);
 char *lzbuffer;
 int *node;
 int pos;
-long outbytes = 0, maxsize = 0, putbytes = 0;
+long outbytes = 0;
 
 int insert(int i, int run)
 {
@@ -200,80 +202,121 @@ void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
   free(lzbuffer);
 }
 
-int expand_to_mem = 0;
-unsigned char *membfptr = NULL;
-void myputc(int ccc, Stream *out)
+// Size of the block in which the packed data is read
+const size_t LzwInputBlock = 64 * 1024;
+// The group of 8 tokens takes at most its flags byte and 8 matches
+const size_t LzwMaxGroup = 1 + 8 * 2;
+
+LzwExpander::LzwExpander(Stream *in, size_t packed_size)
+  : _in(in)
+  , _packedLeft(packed_size)
+  , _inPos(0)
+  , _inEnd(0)
+  , _windowPos(N - F)
+  , _flags(0)
+  , _matchPos(0)
+  , _matchLeft(0)
 {
-  if (maxsize > 0) {
-    putbytes++;
-    if (putbytes > maxsize)
-      return;
-  }
-
-  outbytes++;
-  if (expand_to_mem) {
-    membfptr[0] = ccc;
-    membfptr++;
-  } else
-    out->WriteInt8(ccc);
+  memset(_window, 0, sizeof(_window));
 }
 
-void lzwexpand(Stream *lzw_in, Stream *out)
+bool LzwExpander::FillInput()
 {
-  int bits, ch, i, j, len, mask;
-  char *lzbuffer;
-//  printf(" UnShrinking: %s ",filena);
-  putbytes = 0;
+  if (_packedLeft == 0)
+    return false;
+  if (_input.empty())
+    _input.resize(LzwInputBlock);
+  size_t len = min(_packedLeft, _input.size());
+  len = _in->Read(&_input[0], len);
+  _packedLeft = len > 0 ? _packedLeft - len : 0;
+  _inPos = 0;
+  _inEnd = len;
+  return len > 0;
+}
 
-  lzbuffer = (char *)malloc(N);
-  if (lzbuffer == NULL) {
-    quit("compress.cpp: unable to decompress: insufficient memory");
+uint8_t *LzwExpander::CopyMatch(uint8_t *op, uint8_t *op_end)
+{
+  int len = min(_matchLeft, (int)(op_end - op));
+  _matchLeft -= len;
+  while (len--) {
+    const uint8_t ch = _window[_matchPos];
+    _window[_windowPos] = ch;
+    *op++ = ch;
+    _matchPos = (_matchPos + 1) & (N - 1);
+    _windowPos = (_windowPos + 1) & (N - 1);
   }
-  i = N - F;
-
-  // this end condition just checks for EOF, which is no good to us
-  while ((bits = lzw_in->ReadByte()) != -1) {
-    for (mask = 0x01; mask & 0xFF; mask <<= 1) {
-      if (bits & mask) {
-        // MACPORT FIX: read to short and expand
-        short jshort = 0;
-        jshort = lzw_in->ReadInt16();
-        j = jshort;
-
-        len = ((j >> 12) & 15) + 3;
-        j = (i - j - 1) & (N - 1);
-
-        while (len--) {
-          myputc(lzbuffer[i] = lzbuffer[j], out);
-          j = (j + 1) & (N - 1);
-          i = (i + 1) & (N - 1);
+  return op;
+}
+
+bool LzwExpander::Expand(uint8_t *dst, size_t size)
+{
+  uint8_t *op = dst;
+  uint8_t *const op_end = dst + size;
+  // finish the match which did not fit into the previous part
+  op = CopyMatch(op, op_end);
+
+  while (op < op_end) {
+    // each group of 8 tokens starts with their flags, lowest bit first;
+    // when the whole group is in the input and fits into the output, it
+    // is expanded without checking either of them
+    if (_flags <= 1 && _inEnd - _inPos >= LzwMaxGroup && op_end - op >= 8 * (15 + THRESHOLD)) {
+      const uint8_t *ip = &_input[_inPos];
+      int bits = *ip++;
+      int wpos = _windowPos;
+      for (int k = 0; k < 8; k++, bits >>= 1) {
+        if (bits & 1) {
+          const int j = ip[0] | (ip[1] << 8);
+          ip += 2;
+          int len = ((j >> 12) & 15) + THRESHOLD;
+          int mpos = (wpos - j - 1) & (N - 1);
+          while (len--) {
+            const uint8_t ch = _window[mpos];
+            _window[wpos] = ch;
+            *op++ = ch;
+            mpos = (mpos + 1) & (N - 1);
+            wpos = (wpos + 1) & (N - 1);
+          }
+        } else {
+          const uint8_t ch = *ip++;
+          _window[wpos] = ch;
+          *op++ = ch;
+          wpos = (wpos + 1) & (N - 1);
         }
-      } else {
-        ch = lzw_in->ReadByte();
-        myputc(lzbuffer[i] = ch, out);
-        i = (i + 1) & (N - 1);
       }
+      _windowPos = wpos;
+      _inPos = ip - &_input[0];
+      continue;
+    }
 
-      if ((putbytes >= maxsize) && (maxsize > 0))
-        break;
-
-      if ((lzw_in->EOS()) && (maxsize > 0))
-        quit("Read error decompressing image - file is corrupt");
-    }                           // end for mask
-
-    if ((putbytes >= maxsize) && (maxsize > 0))
-      break;
+    // otherwise one token at a time; the bit above the flags tells when
+    // the group is over
+    if (_flags <= 1) {
+      const int bits = NextByte();
+      if (bits < 0)
+        return false;
+      _flags = bits | 0x100;
+    }
+    const int is_match = _flags & 1;
+    _flags >>= 1;
+
+    if (is_match) {
+      // 12-bit offset back from the current position, 4-bit length
+      const int lo = NextByte();
+      const int hi = NextByte();
+      if (hi < 0)
+        return false;
+      const int j = lo | (hi << 8);
+      _matchLeft = ((j >> 12) & 15) + THRESHOLD;
+      _matchPos = (_windowPos - j - 1) & (N - 1);
+      op = CopyMatch(op, op_end);
+    } else {
+      const int ch = NextByte();
+      if (ch < 0)
+        return false;
+      _window[_windowPos] = (uint8_t)ch;
+      _windowPos = (_windowPos + 1) & (N - 1);
+      *op++ = (uint8_t)ch;
+    }
   }
-
-  free(lzbuffer);
-  expand_to_mem = 0;
-}
-
-unsigned char *lzwexpand_to_mem(Common::Stream *in)
-{
-  unsigned char *membuff = (unsigned char *)malloc(maxsize + 10);
-  expand_to_mem = 1;
-  membfptr = membuff;
-  lzwexpand(in, NULL);
-  return membuff;
+  return true;
 }
@@ -18,12 +18,53 @@
 #ifndef __AGS_CN_UTIL__LZW_H
 #define __AGS_CN_UTIL__LZW_H
 
+#include <vector>
+#include "core/types.h"
+
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
 
 void lzwcompress(Common::Stream *lzw_in, Common::Stream *out);
-unsigned char *lzwexpand_to_mem(Common::Stream *in);
 
-extern long outbytes, maxsize, putbytes;
+extern long outbytes;
+
+// Expands the LZW data a part at a time, so that it may be written straight
+// into the destination, such as the bitmap's scanlines. The packed data is
+// read from the stream by large blocks, never past its end.
+class LzwExpander
+{
+public:
+    LzwExpander(Common::Stream *in, size_t packed_size);
+
+    // Expands the next size bytes into dst; returns false if the packed data
+    // has ended before that
+    bool Expand(uint8_t *dst, size_t size);
+
+private:
+    // Reads the next block of the packed data; returns false if none left
+    bool FillInput();
+    // Copies the bytes of the current match, as many as there is room for
+    uint8_t *CopyMatch(uint8_t *op, uint8_t *op_end);
+
+    inline int NextByte()
+    {
+        if (_inPos == _inEnd && !FillInput())
+            return -1;
+        return _input[_inPos++];
+    }
+
+    enum { WindowSize = 4096 };
+
+    Common::Stream      *_in;
+    size_t               _packedLeft;
+    std::vector<uint8_t> _input;
+    size_t               _inPos;
+    size_t               _inEnd;
+    uint8_t              _window[WindowSize];
+    int                  _windowPos;
+    int                  _flags;      // the group's flag bits left, over the end marker bit
+    int                  _matchPos;
+    int                  _matchLeft;
+};
 
 #endif // __AGS_CN_UTIL__LZW_H
@@ -0,0 +1,146 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryStream::MemoryStream(DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _pos(0)
+{
+}
+
+MemoryStream::~MemoryStream()
+{
+}
+
+void MemoryStream::Close()
+{
+    Clear();
+}
+
+bool MemoryStream::Flush()
+{
+    return true;
+}
+
+void MemoryStream::Clear()
+{
+    _buffer.clear();
+    _pos = 0;
+}
+
+void MemoryStream::Swap(std::vector<uint8_t> &buffer)
+{
+    _buffer.swap(buffer);
+    _pos = 0;
+}
+
+bool MemoryStream::IsValid() const
+{
+    return true;
+}
+
+bool MemoryStream::EOS() const
+{
+    return _pos >= _buffer.size();
+}
+
+size_t MemoryStream::GetLength() const
+{
+    return _buffer.size();
+}
+
+size_t MemoryStream::GetPosition() const
+{
+    return _pos;
+}
+
+bool MemoryStream::CanRead() const
+{
+    return true;
+}
+
+bool MemoryStream::CanWrite() const
+{
+    return true;
+}
+
+bool MemoryStream::CanSeek() const
+{
+    return true;
+}
+
+size_t MemoryStream::Read(void *buffer, size_t size)
+{
+    if (!buffer || _pos >= _buffer.size())
+        return 0;
+    if (size > _buffer.size() - _pos)
+        size = _buffer.size() - _pos;
+    memcpy(buffer, &_buffer[_pos], size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::ReadByte()
+{
+    if (_pos >= _buffer.size())
+        return -1;
+    return _buffer[_pos++];
+}
+
+size_t MemoryStream::Write(const void *buffer, size_t size)
+{
+    if (!buffer || size == 0)
+        return 0;
+    if (_pos + size > _buffer.size())
+        _buffer.resize(_pos + size);
+    memcpy(&_buffer[_pos], buffer, size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::WriteByte(uint8_t val)
+{
+    if (_pos >= _buffer.size())
+        _buffer.resize(_pos + 1);
+    _buffer[_pos++] = val;
+    return val;
+}
+
+size_t MemoryStream::Seek(int offset, StreamSeek origin)
+{
+    size_t base;
+    switch (origin)
+    {
+    case kSeekBegin:    base = 0; break;
+    case kSeekCurrent:  base = _pos; break;
+    case kSeekEnd:      base = _buffer.size(); break;
+    default:
+        return -1;
+    }
+    if (offset < 0 && (size_t)-offset > base)
+        _pos = 0;
+    else
+        _pos = base + offset;
+    return _pos;
+}
+
+} // namespace Common
+} // namespace AGS
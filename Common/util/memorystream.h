@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// MemoryStream reads and writes the growing buffer in memory. Writing past
+// the end of the buffer appends to it.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYSTREAM_H
+#define __AGS_CN_UTIL__MEMORYSTREAM_H
+
+#include <vector>
+#include "util/datastream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MemoryStream : public DataStream
+{
+public:
+    MemoryStream(DataEndianess stream_endianess = kLittleEndian);
+    virtual ~MemoryStream();
+
+    virtual void    Close();
+    virtual bool    Flush();
+
+    // Gets the whole buffer, regardless of the current position
+    inline const uint8_t *GetData() const
+    {
+        return _buffer.empty() ? NULL : &_buffer[0];
+    }
+    // Removes all data
+    void            Clear();
+    // Exchanges the buffer with the given one and rewinds the stream
+    void            Swap(std::vector<uint8_t> &buffer);
+
+    // Is stream valid (underlying data initialized properly)
+    virtual bool    IsValid() const;
+    // Is end of stream
+    virtual bool    EOS() const;
+    // Total length of stream (if known)
+    virtual size_t  GetLength() const;
+    // Current position (if known)
+    virtual size_t  GetPosition() const;
+    virtual bool    CanRead() const;
+    virtual bool    CanWrite() const;
+    virtual bool    CanSeek() const;
+
+    virtual size_t  Read(void *buffer, size_t size);
+    virtual int32_t ReadByte();
+    virtual size_t  Write(const void *buffer, size_t size);
+    virtual int32_t WriteByte(uint8_t b);
+
+    virtual size_t  Seek(int offset, StreamSeek origin);
+
+private:
+    std::vector<uint8_t> _buffer;
+    size_t               _pos;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYSTREAM_H
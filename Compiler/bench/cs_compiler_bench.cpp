@@ -0,0 +1,417 @@
+//
+// Compiler benchmark: compiles a corpus of scripts through ccCompileText,
+// reports the speed and the size of the work, and compares the compiled
+// scripts with the golden outputs kept next to this file.
+//
+// Usage: compiler_bench [-update] [-repeat N] [-only name] [-dir benchdir]
+//   -update  rewrites the golden outputs instead of comparing with them
+//   -repeat  number of compilations timed for each script (default 50)
+//   -only    runs only the corpus entries with this name
+//   -dir     directory with the 'corpus' and 'golden' subdirectories
+//            (default: the directory of this source file)
+// Returns the number of the scripts which failed to compile or differ
+// from their golden outputs.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <vector>
+#include "script/cs_compiler.h"
+#include "script/cc_compilecontext.h"
+#include "script/cc_options.h"
+#include "script/cc_error.h"
+#include "script/cc_script.h"
+#include "script/script_common.h"
+
+#if defined(WINDOWS_VERSION)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Error reports, formatted as by the editor
+//-----------------------------------------------------------------------------
+
+void cc_error_at_line(char *buffer, const char *error_msg)
+{
+    sprintf(ccErrorString, "Error (line %d): %s", currentline, error_msg);
+}
+
+void cc_error_without_line(char *buffer, const char *error_msg)
+{
+    sprintf(ccErrorString, "Error (line unknown): %s", error_msg);
+}
+
+//-----------------------------------------------------------------------------
+// Allocation counting; only the C++ allocations are seen, the compiled
+// script grows its arrays with realloc
+//-----------------------------------------------------------------------------
+
+static long allocCount = 0;
+static long allocBytes = 0;
+
+void *operator new(size_t size) {
+    allocCount++;
+    allocBytes += (long)size;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) throw() {
+    free(p);
+}
+
+void operator delete[](void *p) throw() {
+    free(p);
+}
+
+//-----------------------------------------------------------------------------
+// Timer
+//-----------------------------------------------------------------------------
+
+static double get_seconds() {
+#if defined(WINDOWS_VERSION)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Synthetic scripts; the generated text only depends on the arguments
+//-----------------------------------------------------------------------------
+
+static unsigned int randomSeed;
+
+static int next_random(int range) {
+    randomSeed = randomSeed * 1103515245 + 12345;
+    return (int)((randomSeed >> 16) % range);
+}
+
+static void append_format(std::string &text, const char *format, int a, int b = 0, int c = 0) {
+    char buffer[200];
+    sprintf(buffer, format, a, b, c);
+    text += buffer;
+}
+
+// a large header with many structs, and a script which uses all of them
+static void make_structs(int count, std::string &header, std::string &script) {
+    for (int i = 0; i < count; i++) {
+        append_format(header, "struct Thing%d {\n", i);
+        header += "  int a;\n  int b;\n  short c;\n  char d;\n  int arr[4];\n";
+        header += "  import int Set(int value);\n";
+        header += "  import int Get(int index);\n";
+        header += "  import attribute int Value;\n";
+        header += "  import static int Make(int seed);\n";
+        header += "};\n";
+        append_format(header, "import Thing%d things%d[3];\n", i, i);
+        append_format(header, "import int helper%d(int a, int b);\n", i);
+    }
+    for (int i = 0; i < count; i++) {
+        append_format(script, "int use%d(int n) {\n", i);
+        append_format(script, "  things%d[n %% 3].a = helper%d(n, things%d[0].b);\n", i, i, i);
+        append_format(script, "  things%d[1].arr[n & 3] += things%d[2].Get(n) + Thing%d.Make(n);\n", i, i, i);
+        append_format(script, "  things%d[2].Value = things%d[0].c + things%d[1].d;\n", i, i, i);
+        append_format(script, "  things%d[0].Set(things%d[2].Value);\n", i, i);
+        append_format(script, "  return things%d[n %% 3].a;\n}\n", i);
+    }
+}
+
+static void append_expression(std::string &text, int depth) {
+    static const char *operators[] = { "+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>",
+        "<", ">", "==", "!=", "&&", "||" };
+    if (depth <= 0) {
+        static const char *leaves[] = { "a", "b", "c", "1", "7", "255" };
+        text += leaves[next_random(6)];
+        return;
+    }
+    text += "(";
+    append_expression(text, depth - 1 - next_random(2));
+    text += " ";
+    text += operators[next_random(16)];
+    text += " ";
+    append_expression(text, depth - 1 - next_random(3));
+    text += ")";
+}
+
+// functions which are one deep expression each
+static void make_expressions(int count, int depth, std::string &script) {
+    randomSeed = 4242;
+    for (int i = 0; i < count; i++) {
+        append_format(script, "int expr%d(int a, int b, int c) {\n  return ", i);
+        append_expression(script, depth);
+        script += ";\n}\n";
+    }
+}
+
+// many functions with the locals, loops and branches, calling each other
+static void make_functions(int count, std::string &script) {
+    script += "int total;\nint table[50];\n";
+    for (int i = 0; i < count; i++) {
+        append_format(script, "int func%d(int n, int m) {\n", i);
+        script += "  int sum = 0;\n";
+        script += "  for (int i = 0; i < n; i++) {\n";
+        script += "    if (i % 4 == 1)\n      continue;\n";
+        append_format(script, "    sum += table[(i + %d) %% 50] * m;\n", i);
+        script += "    if (sum > 10000)\n      break;\n";
+        script += "  }\n";
+        script += "  int j = m;\n";
+        script += "  while (j > 0 && sum < 500) {\n    j--;\n    sum += j << 1;\n  }\n";
+        if (i > 0)
+            append_format(script, "  sum += func%d(n - 1, m + %d);\n", i - 1, i);
+        script += "  switch (sum % 3) {\n";
+        script += "    case 0: total++; break;\n";
+        script += "    case 1: total += sum; break;\n";
+        script += "    default: total -= 1;\n";
+        script += "  }\n";
+        script += "  return sum;\n}\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Golden outputs
+//-----------------------------------------------------------------------------
+
+static bool read_file(const std::string &path, std::string &text) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f == NULL)
+        return false;
+    text.clear();
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        text.append(buffer, got);
+    fclose(f);
+    return true;
+}
+
+static bool write_file(const std::string &path, const std::string &text) {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f == NULL)
+        return false;
+    fwrite(text.c_str(), 1, text.size(), f);
+    fclose(f);
+    return true;
+}
+
+// the compiled script as text, so that the differences can be read
+static void dump_script(ccScript *scrip, std::string &text) {
+    append_format(text, "code %d\n", scrip->codesize);
+    for (int i = 0; i < scrip->codesize; i++) {
+        append_format(text, (i % 16 == 15) ? "%d\n" : "%d ", (int)scrip->code[i]);
+    }
+    if (scrip->codesize % 16 != 0)
+        text += "\n";
+    append_format(text, "fixups %d\n", scrip->numfixups);
+    for (int i = 0; i < scrip->numfixups; i++)
+        append_format(text, "%d %d\n", scrip->fixups[i], scrip->fixuptypes[i]);
+    append_format(text, "globaldata %d\n", scrip->globaldatasize);
+    for (int i = 0; i < scrip->globaldatasize; i++) {
+        append_format(text, (i % 32 == 31) ? "%02x\n" : "%02x", (unsigned char)scrip->globaldata[i]);
+    }
+    if (scrip->globaldatasize % 32 != 0)
+        text += "\n";
+    append_format(text, "strings %d\n", scrip->stringssize);
+    for (int i = 0; i < scrip->stringssize; i += (int)strlen(&scrip->strings[i]) + 1) {
+        text += &scrip->strings[i];
+        text += "\n";
+    }
+    append_format(text, "imports %d\n", scrip->numimports);
+    for (int i = 0; i < scrip->numimports; i++) {
+        text += scrip->imports[i];
+        text += "\n";
+    }
+    append_format(text, "exports %d\n", scrip->numexports);
+    for (int i = 0; i < scrip->numexports; i++) {
+        text += scrip->exports[i];
+        append_format(text, " %d\n", scrip->export_addr[i]);
+    }
+    append_format(text, "sections %d\n", scrip->numSections);
+    for (int i = 0; i < scrip->numSections; i++) {
+        text += scrip->sectionNames[i];
+        append_format(text, " %d\n", scrip->sectionOffsets[i]);
+    }
+}
+
+// returns the first line which differs, or 0 if none does
+static int find_difference(const std::string &expected, const std::string &actual) {
+    int line = 1;
+    size_t i = 0;
+    for (; (i < expected.size()) && (i < actual.size()); i++) {
+        if (expected[i] != actual[i])
+            return line;
+        if (expected[i] == '\n')
+            line++;
+    }
+    return (expected.size() == actual.size()) ? 0 : line;
+}
+
+//-----------------------------------------------------------------------------
+// Benchmark
+//-----------------------------------------------------------------------------
+
+struct BenchCase {
+    std::string name;
+    std::string header;
+    std::string script;
+};
+
+static void add_case(std::vector<BenchCase> &cases, const char *name,
+                     const std::string &header, const std::string &script) {
+    BenchCase bench;
+    bench.name = name;
+    bench.header = header;
+    bench.script = script;
+    cases.push_back(bench);
+}
+
+// compiles the case the given number of times, reports it and checks the
+// result; returns 0 if it went well
+static int run_case(const BenchCase &bench, int optimize, int repeat, bool update,
+                    const std::string &goldenDir) {
+    ccRemoveDefaultHeaders();
+    ccClearHeaderSnapshots();
+    if (!bench.header.empty())
+        ccAddDefaultHeader((char*)bench.header.c_str(), "Header");
+    ccSetOption(SCOPT_OPTIMIZE, optimize);
+
+    ccCompileContext *context = ccGetCompileContext();
+    context->numTokens = 0;
+    allocCount = 0;
+    allocBytes = 0;
+    ccScript *result = NULL;
+    double start = get_seconds();
+    for (int i = 0; i < repeat; i++) {
+        // compile the header each time, as a single compilation would
+        ccClearHeaderSnapshots();
+        ccScript *scrip = ccCompileText(bench.script.c_str(), bench.name.c_str());
+        if (scrip == NULL) {
+            printf("%-12s %-4s %s\n", bench.name.c_str(), optimize ? "opt" : "", ccErrorString);
+            return 1;
+        }
+        if (result == NULL)
+            result = scrip;
+        else
+            delete scrip;
+    }
+    double seconds = get_seconds() - start;
+    long allocs = allocCount / repeat;
+    long allocKB = allocBytes / repeat / 1024;
+    int tokens = context->numTokens / repeat;
+    int symbols = (int)ccGetSymbolTable().entries.size();
+
+    std::string dump;
+    dump_script(result, dump);
+    std::string goldenPath = goldenDir + bench.name + (optimize ? ".opt.txt" : ".txt");
+    std::string golden;
+    const char *status = "ok";
+    int failed = 0;
+    char mismatch[40];
+    if (update) {
+        status = write_file(goldenPath, dump) ? "updated" : "cannot write";
+    }
+    else if (!read_file(goldenPath, golden)) {
+        status = "no golden";
+        failed = 1;
+    }
+    else {
+        int line = find_difference(golden, dump);
+        if (line > 0) {
+            sprintf(mismatch, "differs at line %d", line);
+            status = mismatch;
+            failed = 1;
+        }
+    }
+
+    printf("%-12s %-4s %8d %8d %8d %7d %8ld %8ld %9.3f %9.0f  %s\n",
+        bench.name.c_str(), optimize ? "opt" : "", tokens, symbols, result->codesize,
+        result->numfixups, allocs, allocKB, seconds * 1000.0 / repeat,
+        (seconds > 0) ? context->numTokens / seconds / 1000.0 : 0.0, status);
+
+    delete result;
+    return failed;
+}
+
+static std::string get_source_dir() {
+    std::string path = __FILE__;
+    size_t slash = path.find_last_of("/\\");
+    return (slash == std::string::npos) ? std::string("./") : path.substr(0, slash + 1);
+}
+
+int main(int argc, char **argv) {
+    bool update = false;
+    int repeat = 50;
+    const char *only = NULL;
+    std::string benchDir = get_source_dir();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-update") == 0)
+            update = true;
+        else if ((strcmp(argv[i], "-repeat") == 0) && (i + 1 < argc))
+            repeat = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-only") == 0) && (i + 1 < argc))
+            only = argv[++i];
+        else if ((strcmp(argv[i], "-dir") == 0) && (i + 1 < argc)) {
+            benchDir = argv[++i];
+            benchDir += "/";
+        }
+        else {
+            printf("Usage: %s [-update] [-repeat N] [-only name] [-dir benchdir]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (repeat < 1)
+        repeat = 1;
+
+    std::vector<BenchCase> cases;
+    std::string header, script;
+    if (!read_file(benchDir + "corpus/game.ash", header) ||
+        !read_file(benchDir + "corpus/room.asc", script)) {
+        printf("Cannot read the corpus in %scorpus\n", benchDir.c_str());
+        return -1;
+    }
+    add_case(cases, "room", header, script);
+    header.clear();
+    script.clear();
+    make_structs(60, header, script);
+    add_case(cases, "structs", header, script);
+    script.clear();
+    make_expressions(50, 9, script);
+    add_case(cases, "expressions", "", script);
+    script.clear();
+    make_functions(60, script);
+    add_case(cases, "functions", "", script);
+
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LEFTTORIGHT, 1);
+
+    printf("%-12s %-4s %8s %8s %8s %7s %8s %8s %9s %9s  %s\n", "script", "", "tokens", "symbols",
+        "code", "fixups", "allocs", "alloc KB", "ms", "Ktok/s", "golden");
+    int failed = 0;
+    for (size_t i = 0; i < cases.size(); i++) {
+        if (only && (cases[i].name != only))
+            continue;
+        for (int optimize = 0; optimize <= 1; optimize++)
+            failed += run_case(cases[i], optimize, repeat, update, benchDir + "golden/");
+    }
+
+    ccRemoveDefaultHeaders();
+    ccClearHeaderSnapshots();
+    return failed;
+}
@@ -0,0 +1,115 @@
+
+#include <stdio.h>
+#include <string.h>
+#include "cc_compilecontext.h"
+#include "script/cc_error.h"
+#include "script/script_common.h"   // currentline
+
+#if defined(WINDOWS_VERSION)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+extern int ccCompOptions;   // in cc_options
+
+static ccCompileContext *get_thread_context();
+
+// Errors of the compilations on other threads are kept in their contexts,
+// the main one reports them as usual
+static bool handle_compile_error(const char *message) {
+    ccCompileContext *context = get_thread_context();
+    if (context == NULL)
+        return false;
+    if (context->currentline > 0)
+        sprintf(context->errorString, "Error (line %d): %.370s", context->currentline, message);
+    else
+        sprintf(context->errorString, "Error (line unknown): %.370s", message);
+    context->error = 1;
+    context->errorLine = context->currentline;
+    return true;
+}
+
+ccCompileContext::ccCompileContext()
+    : currentline(::currentline)
+    , error(ccError)
+    , errorLine(ccErrorLine)
+    , errorString(ccErrorString)
+    , scriptName(ccCurScriptName)
+    , options(ccCompOptions) {
+    init();
+    ccErrorHandler = handle_compile_error;
+}
+
+ccCompileContext::ccCompileContext(int compileOptions)
+    : currentline(ownLine)
+    , error(ownError)
+    , errorLine(ownErrorLine)
+    , errorString(ownErrorString)
+    , scriptName(ownScriptName)
+    , options(ownOptions) {
+    ownLine = 0;
+    ownError = 0;
+    ownErrorLine = 0;
+    ownErrorString[0] = 0;
+    ownScriptName = "";
+    ownOptions = compileOptions;
+    init();
+}
+
+void ccCompileContext::init() {
+    scriptNameBuffer[0] = 0;
+    readcmdLastCalledWith = 0;
+    readonlyCannotCauseError = 0;
+    tokenSaynoNextChar = 0;
+    tokenNextIsEscaped = 0;
+    numTokens = 0;
+}
+
+int ccCompileContext::getOption(int optbit) {
+    return (options & optbit) ? 1 : 0;
+}
+
+ccCompileContext ccCompileContext::mainContext;
+
+#if defined(WINDOWS_VERSION)
+static DWORD contextSlot = TlsAlloc();
+
+static ccCompileContext *get_thread_context() {
+    return (ccCompileContext*)TlsGetValue(contextSlot);
+}
+
+static void set_thread_context(ccCompileContext *context) {
+    TlsSetValue(contextSlot, context);
+}
+#else
+static pthread_key_t make_context_slot() {
+    pthread_key_t key;
+    pthread_key_create(&key, NULL);
+    return key;
+}
+
+static pthread_key_t contextSlot = make_context_slot();
+
+static ccCompileContext *get_thread_context() {
+    return (ccCompileContext*)pthread_getspecific(contextSlot);
+}
+
+static void set_thread_context(ccCompileContext *context) {
+    pthread_setspecific(contextSlot, context);
+}
+#endif
+
+ccCompileContext *ccGetCompileContext() {
+    ccCompileContext *context = get_thread_context();
+    return context ? context : &ccCompileContext::mainContext;
+}
+
+void ccSetCompileContext(ccCompileContext *context) {
+    set_thread_context(context);
+}
+
+symbolTable &ccGetSymbolTable() {
+    return ccGetCompileContext()->symbols;
+}
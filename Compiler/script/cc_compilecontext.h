@@ -0,0 +1,62 @@
+#ifndef __CC_COMPILECONTEXT_H
+#define __CC_COMPILECONTEXT_H
+
+//-----------------------------------------------------------------------------
+//  Should be used only internally by the compiler
+//-----------------------------------------------------------------------------
+
+#include "cc_macrotable.h"
+#include "cc_symboltable.h"
+
+// State of one script compilation. The compiler works with the context of
+// the calling thread, so that the scripts may be compiled on several
+// threads at once. The main context keeps the line, error and options in
+// the global variables that the rest of the program reads; the contexts
+// of the other threads have them of their own.
+struct ccCompileContext {
+    symbolTable symbols;
+    MacroTable  macros;
+
+    int        &currentline;
+    int        &error;
+    int        &errorLine;
+    char       *errorString;    // 400 chars, as ccErrorString
+    const char *&scriptName;
+    int        &options;
+
+    // parser state kept between the calls
+    char scriptNameBuffer[256];
+    int  readcmdLastCalledWith;
+    int  readonlyCannotCauseError;
+    int  tokenSaynoNextChar;
+    int  tokenNextIsEscaped;
+
+    // statistics, never reset by the compiler
+    int  numTokens;     // symbols read by the tokenizer
+
+    // makes the context with the state of its own
+    ccCompileContext(int compileOptions);
+
+    int  getOption(int optbit);
+
+private:
+    friend ccCompileContext *ccGetCompileContext();
+    // makes the main context
+    ccCompileContext();
+    static ccCompileContext mainContext;
+    void init();
+
+    int         ownLine;
+    int         ownError;
+    int         ownErrorLine;
+    char        ownErrorString[400];
+    const char *ownScriptName;
+    int         ownOptions;
+};
+
+// gets the context of the compilation running on this thread
+extern ccCompileContext *ccGetCompileContext();
+// sets the context for this thread; NULL returns to the main context
+extern void ccSetCompileContext(ccCompileContext *context);
+
+#endif // __CC_COMPILECONTEXT_H
@@ -4,8 +4,9 @@
 #include <string.h>
 #include "cc_compiledscript.h"
 #include "script/script_common.h"       // macro definitions
+#include "cc_compilecontext.h"
 #include "cc_symboltable.h"     // symbolTable
-#include "script/cc_options.h"      // ccGetOption
+#include "script/cc_options.h"      // SCOPT_*
 #include "script/cc_error.h"
 
 void ccCompiledScript::write_cmd(int cmdd) {
@@ -43,6 +44,22 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    // the new code is appended to the copy, so it is allocated as is
+    codeallocated = codesize;
+    for (int aa = 0; aa < src.numfunctions; aa++) {
+        functions[aa] = (char*)malloc(strlen(src.functions[aa])+20);
+        strcpy(functions[aa], src.functions[aa]);
+        funccodeoffs[aa] = src.funccodeoffs[aa];
+        funcnumparams[aa] = src.funcnumparams[aa];
+    }
+    numfunctions = src.numfunctions;
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
@@ -117,6 +134,7 @@ int ccCompiledScript::add_new_import(const char*namm)
     return numimports-1;
 }
 int ccCompiledScript::remove_any_import (const char*namm, SymbolDef *oldSym) {
+    symbolTable &sym = ccGetSymbolTable();
     // Remove any import with the specified name
     int i, sidx;
     sidx = sym.find(namm);
@@ -130,7 +148,7 @@ int ccCompiledScript::remove_any_import (const char*namm, SymbolDef *oldSym) {
         return -1;
     }
     // if they set the No Override Imports flag, don't allow it
-    if (ccGetOption(SCOPT_NOIMPORTOVERRIDE)) {
+    if (ccGetCompileContext()->getOption(SCOPT_NOIMPORTOVERRIDE)) {
         cc_error("Variable '%s' is already imported", namm);
         return -1;
     }
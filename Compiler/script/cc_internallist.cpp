@@ -1,8 +1,7 @@
 
 #include <stdlib.h>
 #include "cc_internallist.h"
-
-extern int currentline;  // in script_common
+#include "cc_compilecontext.h"
 
 void ccInternalList::startread() {
     pos=0;
@@ -26,6 +25,7 @@ long ccInternalList::peeknext() {
 	}
 }
 long ccInternalList::getnext() {
+    int &currentline = ccGetCompileContext()->currentline;
     // process line numbers internally
     while (isPosValid(pos) && script[pos] == SCODE_META) {
 		long bytesRemaining = length - pos;
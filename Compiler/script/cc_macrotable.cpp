@@ -13,6 +13,7 @@ void MacroTable::shutdown() {
         name[rr]=NULL;
     }
     num = 0;
+    nameIndex.clear();
 }
 void MacroTable::merge(MacroTable *others) {
 
@@ -22,11 +23,7 @@ void MacroTable::merge(MacroTable *others) {
 
 }
 int MacroTable::find_name(char* namm) {
-    int ss;
-    for (ss=0;ss<num;ss++) {
-        if (strcmp(namm,name[ss])==0) return ss;
-    }
-    return -1;
+    return nameIndex.findValue(namm);
 }
 void MacroTable::add(char*namm,char*mac) {
     if (find_name(namm) >= 0) {
@@ -41,6 +38,7 @@ void MacroTable::add(char*namm,char*mac) {
     strcpy(name[num],namm);
     macro[num]=(char*)malloc(strlen(mac)+5);
     strcpy(macro[num],mac);
+    nameIndex.addEntry(namm, num);
     num++;
 }
 void MacroTable::remove(int index) {
@@ -49,8 +47,7 @@ void MacroTable::remove(int index) {
         return;
     }
     // just blank out the entry, don't bother to remove it
+    nameIndex.addEntry(name[index], -1);
     name[index][0] = 0;
     macro[index][0] = 0;
 }
-
-MacroTable macros;
\ No newline at end of file
@@ -1,14 +1,18 @@
 #ifndef __CC_MACROTABLE_H
 #define __CC_MACROTABLE_H
 
+#include "script/cc_treemap.h"
+
 #define MAX_LINE_LENGTH 500
 #define MAXDEFINES 1500
 struct MacroTable {
     int num;
     char*name[MAXDEFINES];
     char*macro[MAXDEFINES];
+    ccTreeMap nameIndex;   // name to the entry; -1 if removed
     void init() {
-        num=0; }
+        num=0;
+        nameIndex.clear(); }
     void shutdown();
     int  find_name(char*);
     void add(char*,char*);
@@ -21,6 +25,4 @@ struct MacroTable {
 };
 
 
-extern MacroTable macros;
-
 #endif // __CC_MACROTABLE_H
\ No newline at end of file
@@ -10,6 +10,33 @@ symbolTable::symbolTable() {
 	stringStructSym = 0;
 }
 
+symbolTable::symbolTable(const symbolTable &src) {
+    *this = src;
+}
+
+symbolTable &symbolTable::operator=(const symbolTable &src) {
+    if (this == &src)
+        return *this;
+	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
+		free(it->second);
+	}
+	nameGenCache.clear();
+
+    normalIntSym = src.normalIntSym;
+    normalStringSym = src.normalStringSym;
+    normalFloatSym = src.normalFloatSym;
+    normalVoidSym = src.normalVoidSym;
+    nullSym = src.nullSym;
+    stringStructSym = src.stringStructSym;
+    entries = src.entries;
+    symbolTree = src.symbolTree;
+    memberCache = src.memberCache;
+    symbolTreeNames.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+        symbolTreeNames[i] = symbolTree.findKey(entries[i].sname.c_str());
+    return *this;
+}
+
 int SymbolTableEntry::get_num_args() {
 	// TODO: assert is func?
     return sscope % 100;
@@ -56,6 +83,8 @@ void symbolTable::reset() {
 
     stringStructSym = 0;
     symbolTree.clear();
+    symbolTreeNames.clear();
+    memberCache.clear();
 
     add_ex("___dummy__sym0",999,0);
     normalIntSym = add_ex("int",SYM_VARTYPE,4);
@@ -186,8 +215,14 @@ std::string symbolTable::get_name_string(int idx) {
 }
 
 const char *symbolTable::get_name(int idx) {
-	if (nameGenCache.count(idx) > 0) {
-		return nameGenCache[idx];
+	// the plain symbols are named by the keys of the symbol tree
+	if ((idx >= 0) && (idx < (int)symbolTreeNames.size()) && (symbolTreeNames[idx] != NULL)) {
+		return symbolTreeNames[idx];
+	}
+
+	std::map<int, char*>::iterator cached = nameGenCache.find(idx);
+	if (cached != nameGenCache.end()) {
+		return cached->second;
 	}
 
 	std::size_t actualIdx = idx & STYPE_MASK;
@@ -203,8 +238,54 @@ const char *symbolTable::get_name(int idx) {
 int symbolTable::add(const char*nta) {
     return add_ex(nta,0,0);
 }
+int symbolTable::find_or_add(const char*nta) {
+    // hash the name once for both the lookup and the insertion
+    unsigned int hash = ccTreeMap::hashKey(nta);
+    int symdex = symbolTree.findValue(nta, hash);
+    if (symdex < 0) {
+        symdex = add_ex(nta, hash, 0, 0);
+    }
+    return symdex;
+}
+void symbolTable::make_member_name(char *buffer, int structSym, int memberSym) {
+    const char *memberName = get_name(memberSym);
+    // de-mangle name, if appropriate
+    if (memberName[0] == '.')
+        memberName = &memberName[1];
+    sprintf(buffer, "%s::%s", get_name(structSym), memberName);
+}
+int symbolTable::find_member(int structSym, int memberSym) {
+    std::pair<int, int> key(structSym, memberSym);
+    std::map<std::pair<int, int>, int>::iterator cached = memberCache.find(key);
+    if (cached != memberCache.end())
+        return cached->second;
+
+    char fullName[MAX_SYM_LEN];
+    make_member_name(fullName, structSym, memberSym);
+    int symdex = find(fullName);
+    // the member may still be declared later, so only the found ones are kept
+    if (symdex >= 0)
+        memberCache[key] = symdex;
+    return symdex;
+}
+int symbolTable::find_or_add_member(int structSym, int memberSym) {
+    std::pair<int, int> key(structSym, memberSym);
+    std::map<std::pair<int, int>, int>::iterator cached = memberCache.find(key);
+    if (cached != memberCache.end())
+        return cached->second;
+
+    char fullName[MAX_SYM_LEN];
+    make_member_name(fullName, structSym, memberSym);
+    int symdex = find_or_add(fullName);
+    if (symdex >= 0)
+        memberCache[key] = symdex;
+    return symdex;
+}
 int symbolTable::add_ex(const char*nta,int typo,char sizee) {
-	if (find(nta) >= 0) {
+    return add_ex(nta, ccTreeMap::hashKey(nta), typo, sizee);
+}
+int symbolTable::add_ex(const char*nta,unsigned int hash,int typo,char sizee) {
+	if (symbolTree.findValue(nta, hash) >= 0) {
 		return -1;
 	}
 
@@ -225,7 +306,7 @@ int symbolTable::add_ex(const char*nta,int typo,char sizee) {
 	entry.funcParamHasDefaultValues = std::vector<bool>(MAX_FUNCTION_PARAMETERS + 1);
 	entries.push_back(entry);
 
-    symbolTree.addEntry(nta, p_value);
+    symbolTreeNames.push_back(symbolTree.addEntry(nta, hash, p_value));
     return p_value;
 }
 int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
@@ -235,5 +316,3 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
 	}
     return nss;
 }
-
-symbolTable sym;
@@ -48,10 +48,18 @@ struct symbolTable {
 	std::vector<SymbolTableEntry> entries;
 
     symbolTable();
+    // copies the symbols; the generated names are not shared
+    symbolTable(const symbolTable &src);
+    symbolTable &operator=(const symbolTable &src);
     void reset();    // clears table
     int  find(const char*);  // returns ID of symbol, or -1
     int  add_ex(const char*,int,char);  // adds new symbol of type and size
     int  add(const char*);   // adds new symbol, returns -1 if already exists
+    int  find_or_add(const char*);  // returns ID of symbol, adding it if new
+    // returns ID of the "struct::member" symbol, or -1; the full name
+    // is only made the first time that the member is looked up
+    int  find_member(int structSym, int memberSym);
+    int  find_or_add_member(int structSym, int memberSym);
 
     std::string symbolTable::get_friendly_name(int idx);  // inclue ptr
     std::string symbolTable::get_name_string(int idx);
@@ -63,14 +71,19 @@ struct symbolTable {
 private:
 
     std::map<int, char *> nameGenCache;
+    std::map<std::pair<int, int>, int> memberCache;   // struct and member to the full symbol
 
     ccTreeMap symbolTree;
-    std::vector<char *> symbolTreeNames;
+    std::vector<const char *> symbolTreeNames;   // copies of the names kept by symbolTree
+
+    int  add_ex(const char*,unsigned int hash,int,char);
+    void make_member_name(char *buffer, int structSym, int memberSym);
 
     int  add_operator(const char*, int priority, int vcpucmd); // adds new operator
 };
 
 
-extern symbolTable sym;
+// the symbol table of the compilation running on this thread
+extern symbolTable &ccGetSymbolTable();
 
 #endif //__CC_SYMBOLTABLE_H
@@ -2,8 +2,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <vector>
 #include "cs_compiler.h"
 #include "cc_macrotable.h"
+#include "cc_compilecontext.h"
 #include "cc_compiledscript.h"
 #include "cc_symboltable.h"
 #include "script/cc_error.h"
@@ -12,6 +15,15 @@
 
 #include "cs_prepro.h"
 #include "cs_parser.h"
+#include "cs_optimizer.h"
+
+#if defined(WINDOWS_VERSION)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 const char *ccSoftwareVersion = "1.0";
 
@@ -21,6 +33,120 @@ static int numheaders=0;
 static int capacityHeaders=0;
 
 MacroTable predefinedMacros;
+// changes whenever the predefined macros do
+static int macrosVersion = 0;
+
+// Compiled state of the first default headers; compilations that use
+// the same headers start from the copy of it instead of compiling them
+// again. Module scripts see the headers of the modules before them, so
+// every compilation usually extends the snapshot made by the previous
+// one, and all the room scripts use the last one.
+struct HeaderSnapshot {
+    std::vector<std::string> headers;
+    std::vector<std::string> names;
+    int options;
+    int macros;
+    symbolTable symbols;
+    ccCompiledScript *script;
+};
+
+// the most recently used snapshot is at the end
+static std::vector<HeaderSnapshot*> headerSnapshots;
+static const size_t MAX_HEADER_SNAPSHOTS = 8;
+
+// Guards the header snapshots, and the job list of the batch compilation
+#if defined(WINDOWS_VERSION)
+struct CompilerLock {
+    CRITICAL_SECTION cs;
+    CompilerLock()  { InitializeCriticalSection(&cs); }
+    ~CompilerLock() { DeleteCriticalSection(&cs); }
+    void lock()     { EnterCriticalSection(&cs); }
+    void unlock()   { LeaveCriticalSection(&cs); }
+};
+#else
+struct CompilerLock {
+    pthread_mutex_t mutex;
+    CompilerLock()  { pthread_mutex_init(&mutex, NULL); }
+    ~CompilerLock() { pthread_mutex_destroy(&mutex); }
+    void lock()     { pthread_mutex_lock(&mutex); }
+    void unlock()   { pthread_mutex_unlock(&mutex); }
+};
+#endif
+
+static CompilerLock snapshotLock;
+
+// options which affect the compilation of the headers
+static int get_header_options() {
+    const int optbits[] = { SCOPT_EXPORTALL, SCOPT_LINENUMBERS, SCOPT_NOIMPORTOVERRIDE,
+        SCOPT_LEFTTORIGHT, SCOPT_OLDSTRINGS };
+    int options = 0;
+    for (size_t i = 0; i < sizeof(optbits) / sizeof(optbits[0]); i++) {
+        if (ccGetCompileContext()->getOption(optbits[i]))
+            options |= optbits[i];
+    }
+    return options;
+}
+
+static const char *get_header_name(int index) {
+    if (defaultHeaderNames[index] != NULL)
+        return defaultHeaderNames[index];
+    return "Internal header file";
+}
+
+// finds the snapshot of the most headers from the start of the list
+static int find_header_snapshot(int options, int header_count) {
+    int found = -1;
+    size_t found_count = 0;
+    for (size_t i = 0; i < headerSnapshots.size(); i++) {
+        HeaderSnapshot *snap = headerSnapshots[i];
+        if ((snap->options != options) || (snap->macros != macrosVersion) ||
+            (snap->headers.size() > (size_t)header_count) ||
+            (snap->headers.size() <= found_count))
+            continue;
+        size_t hh;
+        for (hh = 0; hh < snap->headers.size(); hh++) {
+            if ((snap->headers[hh] != defaultheaders[hh]) ||
+                (snap->names[hh] != get_header_name(hh)))
+                break;
+        }
+        if (hh == snap->headers.size()) {
+            found = i;
+            found_count = hh;
+        }
+    }
+    return found;
+}
+
+static void add_header_snapshot(int options, int header_count, ccCompiledScript *scrip) {
+    symbolTable &sym = ccGetSymbolTable();
+    snapshotLock.lock();
+    if (headerSnapshots.size() >= MAX_HEADER_SNAPSHOTS) {
+        delete headerSnapshots[0]->script;
+        delete headerSnapshots[0];
+        headerSnapshots.erase(headerSnapshots.begin());
+    }
+    HeaderSnapshot *snap = new HeaderSnapshot();
+    for (int hh = 0; hh < header_count; hh++) {
+        snap->headers.push_back(defaultheaders[hh]);
+        snap->names.push_back(get_header_name(hh));
+    }
+    snap->options = options;
+    snap->macros = macrosVersion;
+    snap->symbols = sym;
+    snap->script = new ccCompiledScript(*scrip);
+    headerSnapshots.push_back(snap);
+    snapshotLock.unlock();
+}
+
+void ccClearHeaderSnapshots() {
+    snapshotLock.lock();
+    for (size_t i = 0; i < headerSnapshots.size(); i++) {
+        delete headerSnapshots[i]->script;
+        delete headerSnapshots[i];
+    }
+    headerSnapshots.clear();
+    snapshotLock.unlock();
+}
 
 int ccAddDefaultHeader(char* nhead, char *nName)
 {
@@ -43,50 +169,73 @@ void ccRemoveDefaultHeaders() {
 
 void ccDefineMacro(const char *macro, const char *definition) {
     predefinedMacros.add((char*)macro, (char*)definition);
+    macrosVersion++;
 }
 
 void ccClearAllMacros() {
     predefinedMacros.shutdown();
     predefinedMacros.init();
+    macrosVersion++;
 }
 
 void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
+// compiles the script after the first header_count default headers,
+// in the compile context of the calling thread
+static ccScript *compile_with_headers(const char *texo, const char *scriptName, int header_count) {
+    symbolTable &sym = ccGetSymbolTable();
     int t;
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
+    ccCompiledScript *cctemp = NULL;
+    int first_header = 0;
+    ccCompileContext *context = ccGetCompileContext();
+    const int header_options = get_header_options();
 
-    sym.reset();
+    snapshotLock.lock();
+    const int snapshot = find_header_snapshot(header_options, header_count);
+    if (snapshot >= 0) {
+        // start with the headers compiled before
+        HeaderSnapshot *snap = headerSnapshots[snapshot];
+        headerSnapshots.erase(headerSnapshots.begin() + snapshot);
+        headerSnapshots.push_back(snap);
+        sym = snap->symbols;
+        cctemp = new ccCompiledScript(*snap->script);
+        first_header = snap->headers.size();
+    }
+    snapshotLock.unlock();
+    if (cctemp == NULL) {
+        cctemp = new ccCompiledScript();
+        cctemp->init();
+        sym.reset();
+    }
     preproc_startup(&predefinedMacros);
 
     if (scriptName == NULL)
         scriptName = "Main script";
 
-    ccError = 0;
-    ccErrorLine = 0;
+    context->error = 0;
+    context->errorLine = 0;
 
-    for (t=0;t<numheaders;t++) {
-        if (defaultHeaderNames[t] != NULL)
-            ccCurScriptName = defaultHeaderNames[t];
-        else
-            ccCurScriptName = "Internal header file";
+    for (t=first_header;t<header_count;t++) {
+        context->scriptName = get_header_name(t);
 
-        cctemp->start_new_section(ccCurScriptName);
+        cctemp->start_new_section(context->scriptName);
         cc_compile(defaultheaders[t],cctemp);
-        if (ccError) break;
+        if (context->error) break;
     }
 
-    if (!ccError) {
-        ccCurScriptName = scriptName;
-        cctemp->start_new_section(ccCurScriptName);
+    if (!context->error && (first_header < header_count))
+        add_header_snapshot(header_options, header_count, cctemp);
+
+    if (!context->error) {
+        context->scriptName = scriptName;
+        cctemp->start_new_section(context->scriptName);
         cc_compile(texo,cctemp);
     }
     preproc_shutdown();
 
-    if (ccError) {
+    if (context->error) {
         cctemp->shutdown();
         delete cctemp;
         return NULL;
@@ -117,13 +266,13 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
             (sym.get_type(t) != SYM_LOCALVAR)) continue;
 
         if (sym.entries[t].flags & SFLG_IMPORTED) continue;
-        if (ccGetOption(SCOPT_SHOWWARNINGS)==0) ;
+        if (context->getOption(SCOPT_SHOWWARNINGS)==0) ;
         else if ((sym.entries[t].flags & SFLG_ACCESSED)==0) {
             printf("warning: variable '%s' is never used\n",sym.get_friendly_name(t).c_str());
         }
     }
 
-    if (ccGetOption(SCOPT_EXPORTALL)) {
+    if (context->getOption(SCOPT_EXPORTALL)) {
         // export all functions
         for (t=0;t<cctemp->numfunctions;t++) {
             if (cctemp->add_new_export(cctemp->functions[t],EXPORT_FUNCTION,
@@ -135,6 +284,124 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
         }
     }
 
+    if (context->getOption(SCOPT_OPTIMIZE))
+        cc_optimize(cctemp);
+
     cctemp->free_extra();
     return cctemp;
 }
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    return compile_with_headers(texo, scriptName, numheaders);
+}
+
+#if defined(WINDOWS_VERSION)
+typedef HANDLE ccThreadHandle;
+#else
+typedef pthread_t ccThreadHandle;
+#endif
+
+struct CompileBatch {
+    ccCompileJob *jobs;
+    int count;
+    int next;   // first job not taken yet
+};
+
+static void run_compile_jobs(CompileBatch *batch) {
+    for (;;) {
+        snapshotLock.lock();
+        const int index = batch->next < batch->count ? batch->next++ : -1;
+        snapshotLock.unlock();
+        if (index < 0)
+            break;
+
+        ccCompileJob &job = batch->jobs[index];
+        ccCompileContext context(job.options);
+        ccSetCompileContext(&context);
+        int header_count = job.numHeaders;
+        if ((header_count < 0) || (header_count > numheaders))
+            header_count = numheaders;
+        job.result = compile_with_headers(job.script, job.scriptName, header_count);
+        if (job.result == NULL) {
+            strcpy(job.errorString, context.errorString);
+            strncpy(job.errorScriptName, context.scriptName, sizeof(job.errorScriptName) - 1);
+            job.errorScriptName[sizeof(job.errorScriptName) - 1] = 0;
+            job.errorLine = context.errorLine;
+        }
+        ccSetCompileContext(NULL);
+    }
+}
+
+#if defined(WINDOWS_VERSION)
+static DWORD WINAPI compile_thread(LPVOID batch) {
+    run_compile_jobs((CompileBatch*)batch);
+    return 0;
+}
+
+static int get_processor_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+#else
+static void *compile_thread(void *batch) {
+    run_compile_jobs((CompileBatch*)batch);
+    return NULL;
+}
+
+static int get_processor_count() {
+    return sysconf(_SC_NPROCESSORS_ONLN);
+}
+#endif
+
+int ccCompileBatch(ccCompileJob *jobs, int count, int threads) {
+    for (int i = 0; i < count; i++) {
+        jobs[i].result = NULL;
+        jobs[i].errorString[0] = 0;
+        jobs[i].errorScriptName[0] = 0;
+        jobs[i].errorLine = 0;
+    }
+
+    if (threads <= 0)
+        threads = get_processor_count();
+    if (threads > count)
+        threads = count;
+    if (threads < 1)
+        threads = 1;
+
+    CompileBatch batch;
+    batch.jobs = jobs;
+    batch.count = count;
+    batch.next = 0;
+
+    // the calling thread works on the jobs too
+    std::vector<ccThreadHandle> workers;
+    for (int i = 1; i < threads; i++) {
+#if defined(WINDOWS_VERSION)
+        HANDLE worker = CreateThread(NULL, 0, compile_thread, &batch, 0, NULL);
+        if (worker == NULL)
+            break;
+#else
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, compile_thread, &batch) != 0)
+            break;
+#endif
+        workers.push_back(worker);
+    }
+    run_compile_jobs(&batch);
+    for (size_t i = 0; i < workers.size(); i++) {
+#if defined(WINDOWS_VERSION)
+        WaitForSingleObject(workers[i], INFINITE);
+        CloseHandle(workers[i]);
+#else
+        pthread_join(workers[i], NULL);
+#endif
+    }
+
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].result == NULL)
+            failed++;
+    }
+    return failed;
+}
@@ -22,6 +22,8 @@
 extern int ccAddDefaultHeader(char *script, char *name);
 // don't compile any headers into the compilation
 extern void ccRemoveDefaultHeaders(void);
+// free the compiled states of the headers kept for the next compilations
+extern void ccClearHeaderSnapshots(void);
 
 // define a macro which will affect all compilations
 extern void ccDefineMacro(const char *macro, const char *definition);
@@ -34,6 +36,26 @@ extern void ccSetSoftwareVersion(const char *version);
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
+// one script of the batch compilation
+struct ccCompileJob {
+    // set by the caller
+    const char *script;
+    const char *scriptName;
+    int numHeaders;         // how many default headers to use, -1 for all
+    int options;            // SCOPT_* bits for this script
+    // set by the compiler
+    ccScript *result;       // NULL on failure
+    char errorString[400];
+    char errorScriptName[256];
+    int errorLine;
+};
+
+// compile the independent scripts on several threads at once, 0 threads
+// means one per processor; the default headers and macros must not be
+// changed meanwhile. The results do not depend on the number of threads.
+// Returns the number of the scripts that failed to compile.
+extern int ccCompileBatch(ccCompileJob *jobs, int count, int threads);
+
 extern const char *ccSoftwareVersion;
 
 #endif // __CS_COMPILER_H
\ No newline at end of file
@@ -0,0 +1,831 @@
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "cs_optimizer.h"
+#include "script/script_common.h"
+
+#define REGBIT(reg)     (1 << (reg))
+#define ALL_REGISTERS   ((1 << CC_NUM_REGISTERS) - 2)
+
+// what the instruction does besides the effects on the memory
+#define OPF_READ1   0x01    // reads the register of the first argument
+#define OPF_WRITE1  0x02    // writes the register of the first argument
+#define OPF_READ2   0x04
+#define OPF_WRITE2  0x08
+#define OPF_PURE    0x10    // has no effect besides writing the registers
+#define OPF_CALL    0x20    // calls a function, which uses all the registers
+#define OPF_JUMP    0x40    // the argument is a relative jump
+#define OPF_MEMORY  0x80    // reads or writes the memory at MAR
+
+#define OPF_BINARY  (OPF_READ1 | OPF_READ2 | OPF_WRITE1)
+
+struct OptCommandInfo {
+    int argc;
+    int flags;
+    int reads;      // registers read besides the arguments
+    int writes;     // registers written besides the arguments
+};
+
+static const OptCommandInfo cmdinfo[CC_NUM_SCCMDS] = {
+    { -1, 0, 0, 0 },                                                // not used
+    { 2, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_ADD
+    { 2, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_SUB
+    { 2, OPF_READ1 | OPF_WRITE2 | OPF_PURE, 0, 0 },                 // SCMD_REGTOREG
+    { 2, OPF_MEMORY, REGBIT(SREG_MAR), 0 },                         // SCMD_WRITELIT
+    { 0, 0, REGBIT(SREG_AX) | REGBIT(SREG_OP) | REGBIT(SREG_SP), REGBIT(SREG_SP) }, // SCMD_RET
+    { 2, OPF_WRITE1 | OPF_PURE, 0, 0 },                             // SCMD_LITTOREG
+    { 1, OPF_WRITE1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },            // SCMD_MEMREAD
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_MEMWRITE
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_MULREG
+    { 2, OPF_BINARY, 0, 0 },                                        // SCMD_DIVREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_ADDREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_SUBREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_BITAND
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_BITOR
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_ISEQUAL
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_NOTEQUAL
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_GREATER
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_LESSTHAN
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_GTE
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_LTE
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_AND
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_OR
+    { 1, OPF_READ1 | OPF_CALL, 0, 0 },                              // SCMD_CALL
+    { 1, OPF_WRITE1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },            // SCMD_MEMREADB
+    { 1, OPF_WRITE1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },            // SCMD_MEMREADW
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_MEMWRITEB
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_MEMWRITEW
+    { 1, OPF_JUMP, REGBIT(SREG_AX), 0 },                            // SCMD_JZ
+    { 1, OPF_READ1, REGBIT(SREG_SP), REGBIT(SREG_SP) },             // SCMD_PUSHREG
+    { 1, OPF_WRITE1, REGBIT(SREG_SP), REGBIT(SREG_SP) },            // SCMD_POPREG
+    { 1, OPF_JUMP, 0, 0 },                                          // SCMD_JMP
+    { 2, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_MUL
+    { 1, OPF_READ1 | OPF_CALL, 0, 0 },                              // SCMD_CALLEXT
+    { 1, OPF_READ1, 0, 0 },                                         // SCMD_PUSHREAL
+    { 1, 0, 0, 0 },                                                 // SCMD_SUBREALSTACK
+    { 1, 0, 0, 0 },                                                 // SCMD_LINENUM
+    { 1, OPF_READ1 | OPF_CALL, 0, 0 },                              // SCMD_CALLAS
+    { 1, 0, 0, 0 },                                                 // SCMD_THISBASE
+    { 1, 0, 0, 0 },                                                 // SCMD_NUMFUNCARGS
+    { 2, OPF_BINARY, 0, 0 },                                        // SCMD_MODREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_XORREG
+    { 1, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_NOTREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_SHIFTLEFT
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_SHIFTRIGHT
+    { 1, OPF_READ1, 0, REGBIT(SREG_OP) },                           // SCMD_CALLOBJ
+    { 2, OPF_READ1, 0, 0 },                                         // SCMD_CHECKBOUNDS
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_MEMWRITEPTR
+    { 1, OPF_WRITE1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },            // SCMD_MEMREADPTR
+    { 0, OPF_MEMORY, REGBIT(SREG_MAR), 0 },                         // SCMD_MEMZEROPTR
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_MEMINITPTR
+    { 1, OPF_PURE, REGBIT(SREG_SP), REGBIT(SREG_MAR) },             // SCMD_LOADSPOFFS
+    { 0, 0, REGBIT(SREG_MAR), 0 },                                  // SCMD_CHECKNULL
+    { 2, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_FADD
+    { 2, OPF_READ1 | OPF_WRITE1 | OPF_PURE, 0, 0 },                 // SCMD_FSUB
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FMULREG
+    { 2, OPF_BINARY, 0, 0 },                                        // SCMD_FDIVREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FADDREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FSUBREG
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FGREATER
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FLESSTHAN
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FGTE
+    { 2, OPF_BINARY | OPF_PURE, 0, 0 },                             // SCMD_FLTE
+    { 1, OPF_MEMORY, REGBIT(SREG_MAR), 0 },                         // SCMD_ZEROMEMORY
+    { 1, OPF_READ1 | OPF_WRITE1, 0, 0 },                            // SCMD_CREATESTRING
+    { 2, OPF_BINARY, 0, 0 },                                        // SCMD_STRINGSEQUAL
+    { 2, OPF_BINARY, 0, 0 },                                        // SCMD_STRINGSNOTEQ
+    { 1, OPF_READ1, 0, 0 },                                         // SCMD_CHECKNULLREG
+    { 0, 0, 0, 0 },                                                 // SCMD_LOOPCHECKOFF
+    { 0, OPF_MEMORY, REGBIT(SREG_MAR) | REGBIT(SREG_AX), 0 },       // SCMD_MEMZEROPTRND
+    { 1, OPF_JUMP, REGBIT(SREG_AX), 0 },                            // SCMD_JNZ
+    { 1, OPF_READ1 | OPF_MEMORY, REGBIT(SREG_MAR), 0 },             // SCMD_DYNAMICBOUNDS
+    { 3, OPF_READ1 | OPF_WRITE1, 0, 0 },                            // SCMD_NEWARRAY
+    { 2, OPF_WRITE1, 0, 0 },                                        // SCMD_NEWUSEROBJECT
+};
+
+// the number of times the optimizations are repeated at most; each round
+// usually makes room for a few more
+static const int MAX_PASSES = 8;
+// how far the register use is traced
+static const int MAX_LIVENESS_STEPS = 64;
+// how far apart a push and its pop may be
+static const int MAX_PUSH_WINDOW = 16;
+// how many jumps to jumps are followed
+static const int MAX_JUMP_CHAIN = 8;
+
+// Instruction, with the jumps and code addresses kept as the indexes of
+// the instructions they point to
+struct OptInstruction {
+    int op;
+    intptr_t args[MAX_SCMD_ARGS];
+    char fixups[MAX_SCMD_ARGS];     // fixup type of each argument, 0 if none
+    int fixupOrder[MAX_SCMD_ARGS];  // place of the fixup in the script's list
+    bool removed;
+};
+
+struct OptFixup {
+    int order;
+    int32_t location;
+    char type;
+
+    bool operator<(const OptFixup &other) const { return order < other.order; }
+};
+
+struct CodeOptimizer {
+    ccCompiledScript *scrip;
+    std::vector<OptInstruction> code;
+    std::vector<char> labels;       // can be reached other than from the previous instruction
+    std::vector<int> functions;
+    std::vector<int> exports;       // -1 for the data exports
+    std::vector<int> sections;
+    std::vector<OptFixup> dataFixups;
+    // work lists kept between the calls, so that they are allocated once
+    std::vector<int> paths;
+    std::vector<int> visited;
+    std::vector<int> stackLoads;
+
+    CodeOptimizer(ccCompiledScript *script) : scrip(script) {}
+
+    bool decode();
+    void encode();
+    void compact();
+    void find_labels();
+
+    bool propagate_constants();
+    bool remove_pushes();
+    bool remove_dead_stores();
+    bool thread_jumps();
+    bool remove_unreachable();
+
+    bool is_live_after(int index, int regmask);
+    int  next_instruction(int index);
+};
+
+static bool is_address_arg(const OptInstruction &ins, int arg) {
+    return (ins.fixups[arg] == FIXUP_FUNCTION) || (ins.op == SCMD_THISBASE);
+}
+
+static int reg_reads(const OptInstruction &ins) {
+    const OptCommandInfo &info = cmdinfo[ins.op];
+    if (info.flags & OPF_CALL)
+        return ALL_REGISTERS;
+    int regs = info.reads;
+    if (info.flags & OPF_READ1)
+        regs |= REGBIT(ins.args[0]);
+    if (info.flags & OPF_READ2)
+        regs |= REGBIT(ins.args[1]);
+    return regs;
+}
+
+static int reg_writes(const OptInstruction &ins) {
+    const OptCommandInfo &info = cmdinfo[ins.op];
+    if (info.flags & OPF_CALL)
+        return ALL_REGISTERS;
+    int regs = info.writes;
+    if (info.flags & OPF_WRITE1)
+        regs |= REGBIT(ins.args[0]);
+    if (info.flags & OPF_WRITE2)
+        regs |= REGBIT(ins.args[1]);
+    return regs;
+}
+
+// the instruction can be dropped if nothing reads what it writes
+static bool is_pure(const OptInstruction &ins) {
+    return ((cmdinfo[ins.op].flags & OPF_PURE) != 0) &&
+        ((reg_writes(ins) & REGBIT(SREG_SP)) == 0);
+}
+
+static bool is_jump(int op) {
+    return (cmdinfo[op].flags & OPF_JUMP) != 0;
+}
+
+// computes the integer operation as the engine does; returns false if it
+// cannot be done here (the engine would report an error, or the result is
+// not defined)
+static bool fold_constants(int op, int32_t a, int32_t b, int32_t &result) {
+    switch (op) {
+    case SCMD_ADD:
+    case SCMD_ADDREG:     result = (int32_t)((uint32_t)a + (uint32_t)b); return true;
+    case SCMD_SUB:
+    case SCMD_SUBREG:     result = (int32_t)((uint32_t)a - (uint32_t)b); return true;
+    case SCMD_MUL:
+    case SCMD_MULREG:     result = (int32_t)((uint32_t)a * (uint32_t)b); return true;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+        if ((b == 0) || ((a == INT_MIN) && (b == -1)))
+            return false;
+        result = (op == SCMD_DIVREG) ? a / b : a % b;
+        return true;
+    case SCMD_BITAND:     result = a & b; return true;
+    case SCMD_BITOR:      result = a | b; return true;
+    case SCMD_XORREG:     result = a ^ b; return true;
+    case SCMD_ISEQUAL:    result = (a == b); return true;
+    case SCMD_NOTEQUAL:   result = (a != b); return true;
+    case SCMD_GREATER:    result = (a > b); return true;
+    case SCMD_LESSTHAN:   result = (a < b); return true;
+    case SCMD_GTE:        result = (a >= b); return true;
+    case SCMD_LTE:        result = (a <= b); return true;
+    case SCMD_AND:        result = (a && b); return true;
+    case SCMD_OR:         result = (a || b); return true;
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+        if ((b < 0) || (b > 31))
+            return false;
+        result = (op == SCMD_SHIFTLEFT) ? (int32_t)((uint32_t)a << b) : (a >> b);
+        return true;
+    case SCMD_NOTREG:     result = !a; return true;
+    }
+    return false;
+}
+
+static void set_literal(OptInstruction &ins, int reg, int32_t value) {
+    ins.op = SCMD_LITTOREG;
+    ins.args[0] = reg;
+    ins.args[1] = value;
+    ins.fixups[0] = ins.fixups[1] = 0;
+}
+
+bool CodeOptimizer::decode() {
+    const int codesize = scrip->codesize;
+    // instruction that starts at each code position, or -1
+    std::vector<int> index_at(codesize + 1, -1);
+    std::vector<int> starts;
+    int pos = 0;
+    while (pos < codesize) {
+        const int op = scrip->code[pos];
+        if ((op <= 0) || (op >= CC_NUM_SCCMDS))
+            return false;
+        const int argc = cmdinfo[op].argc;
+        if (pos + argc >= codesize)
+            return false;
+        OptInstruction ins;
+        ins.op = op;
+        for (int aa = 0; aa < MAX_SCMD_ARGS; aa++) {
+            ins.args[aa] = (aa < argc) ? scrip->code[pos + 1 + aa] : 0;
+            ins.fixups[aa] = 0;
+            ins.fixupOrder[aa] = -1;
+        }
+        ins.removed = false;
+        index_at[pos] = code.size();
+        starts.push_back(pos);
+        code.push_back(ins);
+        pos += argc + 1;
+    }
+    index_at[codesize] = code.size();
+    starts.push_back(codesize);
+
+    for (int ff = 0; ff < scrip->numfixups; ff++) {
+        if (scrip->fixuptypes[ff] == FIXUP_DATADATA) {
+            OptFixup fixup = { ff, scrip->fixups[ff], FIXUP_DATADATA };
+            dataFixups.push_back(fixup);
+            continue;
+        }
+        const int32_t location = scrip->fixups[ff];
+        if ((location < 0) || (location >= codesize))
+            return false;
+        // find the instruction the fixed up argument belongs to
+        const int index = (std::upper_bound(starts.begin(), starts.end(), location) - starts.begin()) - 1;
+        const int arg = location - starts[index] - 1;
+        if ((arg < 0) || (arg >= cmdinfo[code[index].op].argc) || code[index].fixups[arg])
+            return false;
+        code[index].fixups[arg] = scrip->fixuptypes[ff];
+        code[index].fixupOrder[arg] = ff;
+    }
+
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &ins = code[ii];
+        if (is_jump(ins.op)) {
+            const intptr_t target = starts[ii] + 2 + ins.args[0];
+            if ((target < 0) || (target > codesize) || (index_at[target] < 0))
+                return false;
+            ins.args[0] = index_at[target];
+        }
+        for (int aa = 0; aa < cmdinfo[ins.op].argc; aa++) {
+            if (!is_address_arg(ins, aa))
+                continue;
+            if ((ins.args[aa] < 0) || (ins.args[aa] >= codesize) || (index_at[ins.args[aa]] < 0))
+                return false;
+            ins.args[aa] = index_at[ins.args[aa]];
+        }
+    }
+
+    for (int ff = 0; ff < scrip->numfunctions; ff++) {
+        const long offset = scrip->funccodeoffs[ff];
+        if ((offset < 0) || (offset > codesize) || (index_at[offset] < 0))
+            return false;
+        functions.push_back(index_at[offset]);
+    }
+    for (int ee = 0; ee < scrip->numexports; ee++) {
+        if ((scrip->export_addr[ee] >> 24) != EXPORT_FUNCTION) {
+            exports.push_back(-1);
+            continue;
+        }
+        const int offset = scrip->export_addr[ee] & 0x00ffffff;
+        if ((offset > codesize) || (index_at[offset] < 0))
+            return false;
+        exports.push_back(index_at[offset]);
+    }
+    for (int ss = 0; ss < scrip->numSections; ss++) {
+        const int offset = scrip->sectionOffsets[ss];
+        if ((offset < 0) || (offset > codesize) || (index_at[offset] < 0))
+            return false;
+        sections.push_back(index_at[offset]);
+    }
+    return true;
+}
+
+void CodeOptimizer::encode() {
+    std::vector<int> offsets(code.size() + 1);
+    int codesize = 0;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        offsets[ii] = codesize;
+        codesize += cmdinfo[code[ii].op].argc + 1;
+    }
+    offsets[code.size()] = codesize;
+
+    if (codesize > scrip->codeallocated) {
+        scrip->codeallocated = codesize;
+        scrip->code = (intptr_t*)realloc(scrip->code, codesize * sizeof(intptr_t));
+    }
+    std::vector<OptFixup> fixups(dataFixups);
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        const OptInstruction &ins = code[ii];
+        int pos = offsets[ii];
+        scrip->code[pos++] = ins.op;
+        for (int aa = 0; aa < cmdinfo[ins.op].argc; aa++, pos++) {
+            if (is_jump(ins.op))
+                scrip->code[pos] = offsets[ins.args[aa]] - (offsets[ii] + 2);
+            else if (is_address_arg(ins, aa))
+                scrip->code[pos] = offsets[ins.args[aa]];
+            else
+                scrip->code[pos] = ins.args[aa];
+            if (ins.fixups[aa]) {
+                OptFixup fixup = { ins.fixupOrder[aa], pos, ins.fixups[aa] };
+                fixups.push_back(fixup);
+            }
+        }
+    }
+    scrip->codesize = codesize;
+
+    // keep the fixups in their order, only without the removed ones
+    std::sort(fixups.begin(), fixups.end());
+    for (size_t ff = 0; ff < fixups.size(); ff++) {
+        scrip->fixups[ff] = fixups[ff].location;
+        scrip->fixuptypes[ff] = fixups[ff].type;
+    }
+    scrip->numfixups = fixups.size();
+
+    for (size_t ff = 0; ff < functions.size(); ff++)
+        scrip->funccodeoffs[ff] = offsets[functions[ff]];
+    for (size_t ee = 0; ee < exports.size(); ee++) {
+        if (exports[ee] >= 0)
+            scrip->export_addr[ee] = offsets[exports[ee]] | ((long)EXPORT_FUNCTION << 24L);
+    }
+    for (size_t ss = 0; ss < sections.size(); ss++)
+        scrip->sectionOffsets[ss] = offsets[sections[ss]];
+}
+
+// drops the removed instructions; whatever pointed to them points to the
+// instruction that followed
+void CodeOptimizer::compact() {
+    std::vector<int> new_index(code.size() + 1);
+    size_t kept = 0;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        new_index[ii] = kept;
+        if (!code[ii].removed)
+            code[kept++] = code[ii];
+    }
+    new_index[code.size()] = kept;
+    code.resize(kept);
+
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &ins = code[ii];
+        for (int aa = 0; aa < cmdinfo[ins.op].argc; aa++) {
+            if (is_jump(ins.op) || is_address_arg(ins, aa))
+                ins.args[aa] = new_index[ins.args[aa]];
+        }
+    }
+    for (size_t ff = 0; ff < functions.size(); ff++)
+        functions[ff] = new_index[functions[ff]];
+    for (size_t ee = 0; ee < exports.size(); ee++) {
+        if (exports[ee] >= 0)
+            exports[ee] = new_index[exports[ee]];
+    }
+    for (size_t ss = 0; ss < sections.size(); ss++)
+        sections[ss] = new_index[sections[ss]];
+}
+
+void CodeOptimizer::find_labels() {
+    labels.assign(code.size() + 1, 0);
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        const OptInstruction &ins = code[ii];
+        for (int aa = 0; aa < cmdinfo[ins.op].argc; aa++) {
+            if (is_jump(ins.op) || is_address_arg(ins, aa))
+                labels[ins.args[aa]] = 1;
+        }
+    }
+    for (size_t ff = 0; ff < functions.size(); ff++)
+        labels[functions[ff]] = 1;
+    for (size_t ee = 0; ee < exports.size(); ee++) {
+        if (exports[ee] >= 0)
+            labels[exports[ee]] = 1;
+    }
+    for (size_t ss = 0; ss < sections.size(); ss++)
+        labels[sections[ss]] = 1;
+}
+
+int CodeOptimizer::next_instruction(int index) {
+    for (index++; (index < (int)code.size()) && code[index].removed; index++);
+    return index;
+}
+
+// tells if any of the registers may be read after the instruction before
+// being written again
+bool CodeOptimizer::is_live_after(int index, int regmask) {
+    paths.clear();
+    visited.clear();
+    paths.push_back(index + 1);
+    int steps = 0;
+    while (!paths.empty()) {
+        int ii = paths.back();
+        paths.pop_back();
+        for (;;) {
+            if (ii >= (int)code.size() || ++steps > MAX_LIVENESS_STEPS)
+                return true;
+            const OptInstruction &ins = code[ii];
+            if (ins.removed) {
+                ii++;
+                continue;
+            }
+            if (std::find(visited.begin(), visited.end(), ii) != visited.end())
+                break;
+            visited.push_back(ii);
+            if (reg_reads(ins) & regmask)
+                return true;
+            if ((reg_writes(ins) & regmask) || (ins.op == SCMD_RET))
+                break;
+            if (ins.op == SCMD_JMP) {
+                ii = ins.args[0];
+                continue;
+            }
+            if (is_jump(ins.op))
+                paths.push_back(ins.args[0]);
+            ii++;
+        }
+    }
+    return false;
+}
+
+// Follows the known values of the registers, MAR and the line number
+// through each run of the code that has no labels; folds the operations
+// on constants and drops the instructions which set what is there already
+bool CodeOptimizer::propagate_constants() {
+    find_labels();
+    bool changed = false;
+    bool known[CC_NUM_REGISTERS];
+    int32_t values[CC_NUM_REGISTERS];
+    bool mar_known = false;
+    intptr_t mar_offset = 0;
+    bool line_known = false;
+    intptr_t line = 0;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &ins = code[ii];
+        if (labels[ii] || (ii == 0)) {
+            memset(known, 0, sizeof(known));
+            mar_known = false;
+            line_known = false;
+        }
+
+        switch (ins.op) {
+        case SCMD_LINENUM:
+            if (line_known && (line == ins.args[0])) {
+                ins.removed = true;
+                changed = true;
+                continue;
+            }
+            line_known = true;
+            line = ins.args[0];
+            continue;
+        case SCMD_LOADSPOFFS:
+            if (mar_known && (mar_offset == ins.args[0])) {
+                ins.removed = true;
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_LITTOREG:
+            if (!ins.fixups[1] && known[ins.args[0]] && (values[ins.args[0]] == (int32_t)ins.args[1])) {
+                ins.removed = true;
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_REGTOREG:
+            if (known[ins.args[0]] && (ins.args[1] != SREG_SP)) {
+                set_literal(ins, ins.args[1], values[ins.args[0]]);
+                changed = true;
+            }
+            break;
+        case SCMD_ADD:
+        case SCMD_SUB:
+        case SCMD_MUL:
+        case SCMD_NOTREG:
+            {
+                int32_t result;
+                if ((ins.args[0] != SREG_SP) && known[ins.args[0]] &&
+                    fold_constants(ins.op, values[ins.args[0]], (int32_t)ins.args[1], result)) {
+                    set_literal(ins, ins.args[0], result);
+                    changed = true;
+                }
+            }
+            break;
+        case SCMD_JZ:
+        case SCMD_JNZ:
+            if (known[SREG_AX]) {
+                const bool taken = (values[SREG_AX] == 0) == (ins.op == SCMD_JZ);
+                if (!taken) {
+                    ins.removed = true;
+                    changed = true;
+                    continue;
+                }
+                // only the backward JMP counts the loops, so this must not
+                // make one
+                if (ins.args[0] > (int)ii) {
+                    ins.op = SCMD_JMP;
+                    changed = true;
+                }
+            }
+            break;
+        default:
+            if ((cmdinfo[ins.op].flags & OPF_BINARY) == OPF_BINARY) {
+                int32_t result;
+                if (known[ins.args[0]] && known[ins.args[1]] && (ins.args[0] != SREG_SP) &&
+                    fold_constants(ins.op, values[ins.args[0]], values[ins.args[1]], result)) {
+                    set_literal(ins, ins.args[0], result);
+                    changed = true;
+                }
+            }
+            break;
+        }
+
+        const int writes = reg_writes(ins);
+        for (int reg = 0; reg < CC_NUM_REGISTERS; reg++) {
+            if (writes & REGBIT(reg))
+                known[reg] = false;
+        }
+        if (writes & (REGBIT(SREG_MAR) | REGBIT(SREG_SP)))
+            mar_known = false;
+        if (cmdinfo[ins.op].flags & OPF_CALL)
+            line_known = false;
+
+        if ((ins.op == SCMD_LITTOREG) && !ins.fixups[1]) {
+            known[ins.args[0]] = true;
+            values[ins.args[0]] = (int32_t)ins.args[1];
+        }
+        else if (ins.op == SCMD_LOADSPOFFS) {
+            mar_known = true;
+            mar_offset = ins.args[0];
+        }
+        else if ((ins.op == SCMD_JMP) || (ins.op == SCMD_RET)) {
+            // what follows is only reached from elsewhere
+            memset(known, 0, sizeof(known));
+            mar_known = false;
+            line_known = false;
+        }
+    }
+    return changed;
+}
+
+// Replaces a PUSHREG and the POPREG which follows it soon after with a
+// REGTOREG, if nothing between uses the pushed value on the stack. The
+// copy is done at the push or at the pop, whichever keeps the registers
+// used between intact.
+bool CodeOptimizer::remove_pushes() {
+    find_labels();
+    bool changed = false;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &push = code[ii];
+        if (push.removed)
+            continue;
+        if (push.op == SCMD_LINENUM) {
+            // the same line number repeated at once; a line without code
+            // keeps its number, so that the debugger may still stop there
+            const int next = next_instruction(ii);
+            if ((next < (int)code.size()) && (code[next].op == SCMD_LINENUM) &&
+                (code[next].args[0] == push.args[0])) {
+                push.removed = true;
+                changed = true;
+            }
+            continue;
+        }
+        if ((push.op != SCMD_PUSHREG) || (push.args[0] == SREG_SP))
+            continue;
+
+        const int pushed = push.args[0];
+        int reads = 0;
+        int writes = 0;
+        // the local variables read between, which are a slot nearer without the push
+        std::vector<int> &stack_loads = stackLoads;
+        stack_loads.clear();
+        // the memory at MAR is known not to be the pushed value
+        bool mar_safe = false;
+        int steps = 0;
+        for (int jj = next_instruction(ii); (jj < (int)code.size()) && (steps < MAX_PUSH_WINDOW);
+            jj = next_instruction(jj), steps++) {
+            OptInstruction &ins = code[jj];
+            if (labels[jj])
+                break;
+            if (ins.op == SCMD_POPREG) {
+                const int popped = ins.args[0];
+                if (popped == SREG_SP)
+                    break;
+                if ((writes & REGBIT(pushed)) == 0) {
+                    // copy at the pop
+                    push.removed = true;
+                    if (popped == pushed)
+                        ins.removed = true;
+                    else {
+                        ins.op = SCMD_REGTOREG;
+                        ins.args[0] = pushed;
+                        ins.args[1] = popped;
+                    }
+                }
+                else if ((popped != pushed) && (((reads | writes) & REGBIT(popped)) == 0)) {
+                    // copy at the push
+                    push.op = SCMD_REGTOREG;
+                    push.args[1] = popped;
+                    ins.removed = true;
+                }
+                else
+                    break;
+                for (size_t ll = 0; ll < stack_loads.size(); ll++)
+                    code[stack_loads[ll]].args[0] -= 4;
+                changed = true;
+                break;
+            }
+
+            if (ins.op == SCMD_LOADSPOFFS) {
+                if (ins.args[0] <= 4)
+                    break;
+                stack_loads.push_back(jj);
+                writes |= REGBIT(SREG_MAR);
+                mar_safe = true;
+                continue;
+            }
+            const int ins_reads = reg_reads(ins);
+            const int ins_writes = reg_writes(ins);
+            if ((ins_reads | ins_writes) & REGBIT(SREG_SP))
+                break;
+            const int flags = cmdinfo[ins.op].flags;
+            if (flags & OPF_MEMORY) {
+                if (!mar_safe || ((ins.op != SCMD_MEMREAD) && (ins.op != SCMD_MEMREADB) &&
+                    (ins.op != SCMD_MEMREADW) && (ins.op != SCMD_MEMWRITE) &&
+                    (ins.op != SCMD_MEMWRITEB) && (ins.op != SCMD_MEMWRITEW)))
+                    break;
+            }
+            else if (!(flags & OPF_PURE) && (ins.op != SCMD_LINENUM) &&
+                (ins.op != SCMD_CHECKBOUNDS) && (ins.op != SCMD_CHECKNULLREG))
+                break;
+
+            if (ins_writes & REGBIT(SREG_MAR)) {
+                // pointing into the same variable or object
+                if ((ins.op == SCMD_LITTOREG) && ((ins.fixups[1] == FIXUP_GLOBALDATA) ||
+                    (ins.fixups[1] == FIXUP_STRING) || (ins.fixups[1] == FIXUP_IMPORT)))
+                    mar_safe = true;
+                else if ((ins.op != SCMD_ADD) && (ins.op != SCMD_SUB) && (ins.op != SCMD_ADDREG))
+                    mar_safe = false;
+            }
+            reads |= ins_reads;
+            writes |= ins_writes;
+        }
+    }
+    return changed;
+}
+
+bool CodeOptimizer::remove_dead_stores() {
+    bool changed = false;
+    // from the end, so that what only fed the removed ones goes too
+    for (int ii = (int)code.size() - 1; ii >= 0; ii--) {
+        OptInstruction &ins = code[ii];
+        if (!is_pure(ins))
+            continue;
+        if (!is_live_after(ii, reg_writes(ins))) {
+            ins.removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool CodeOptimizer::thread_jumps() {
+    find_labels();
+    bool changed = false;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &ins = code[ii];
+        if (ins.removed || !is_jump(ins.op))
+            continue;
+
+        // follow the jumps to jumps; only the backward JMPs count the loops,
+        // so their number must stay the same
+        int target = ins.args[0];
+        int backward = ((ins.op == SCMD_JMP) && (target <= (int)ii)) ? 1 : 0;
+        for (int hops = 0; hops < MAX_JUMP_CHAIN && target < (int)code.size(); hops++) {
+            const OptInstruction &next = code[target];
+            if (next.op == SCMD_JMP) {
+                if (next.args[0] == target)
+                    break;
+                if (next.args[0] < target) {
+                    if (ins.op != SCMD_JMP)
+                        break;
+                    backward++;
+                }
+                target = next.args[0];
+            }
+            else if ((ins.op != SCMD_JMP) && (next.op == ins.op) && (next.args[0] != target))
+                target = next.args[0];
+            else if ((ins.op != SCMD_JMP) && is_jump(next.op) && (next.op != ins.op))
+                target = target + 1;    // the other condition is false
+            else
+                break;
+        }
+        const bool valid = (ins.op != SCMD_JMP) ||
+            ((backward <= 1) && ((backward == 1) == (target <= (int)ii)));
+        if (valid && (target != ins.args[0])) {
+            ins.args[0] = target;
+            labels[target] = 1;
+            changed = true;
+        }
+
+        if (ins.args[0] == next_instruction(ii)) {
+            // jumps to where it would go anyway
+            ins.removed = true;
+            changed = true;
+        }
+        else if ((ins.op == SCMD_JMP) && (ins.args[0] > (int)ii) &&
+            (ins.args[0] < (int)code.size()) && (code[ins.args[0]].op == SCMD_RET)) {
+            ins.op = SCMD_RET;
+            changed = true;
+        }
+        else if (ins.op != SCMD_JMP) {
+            // skips a forward JMP: jump there on the opposite condition
+            const int next = next_instruction(ii);
+            if ((next < (int)code.size()) && !labels[next] && (code[next].op == SCMD_JMP) &&
+                (code[next].args[0] > next) && (ins.args[0] == next_instruction(next))) {
+                ins.op = (ins.op == SCMD_JZ) ? SCMD_JNZ : SCMD_JZ;
+                ins.args[0] = code[next].args[0];
+                labels[ins.args[0]] = 1;
+                code[next].removed = true;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool CodeOptimizer::remove_unreachable() {
+    find_labels();
+    bool changed = false;
+    bool reachable = true;
+    for (size_t ii = 0; ii < code.size(); ii++) {
+        OptInstruction &ins = code[ii];
+        if (labels[ii])
+            reachable = true;
+        if (ins.removed)
+            continue;
+        if (!reachable) {
+            ins.removed = true;
+            changed = true;
+        }
+        else if ((ins.op == SCMD_JMP) || (ins.op == SCMD_RET))
+            reachable = false;
+    }
+    return changed;
+}
+
+int cc_optimize(ccCompiledScript *scrip) {
+    CodeOptimizer optimizer(scrip);
+    if (!optimizer.decode())
+        return -1;
+
+    for (int pass = 0; pass < MAX_PASSES; pass++) {
+        bool changed = false;
+        changed |= optimizer.propagate_constants();
+        optimizer.compact();
+        changed |= optimizer.remove_pushes();
+        optimizer.compact();
+        changed |= optimizer.remove_dead_stores();
+        optimizer.compact();
+        changed |= optimizer.thread_jumps();
+        optimizer.compact();
+        changed |= optimizer.remove_unreachable();
+        optimizer.compact();
+        if (!changed)
+            break;
+    }
+
+    optimizer.encode();
+    return 0;
+}
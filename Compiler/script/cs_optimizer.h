@@ -0,0 +1,19 @@
+//-----------------------------------------------------------------------------
+//  Should be used only internally by cs_compiler.cpp
+//-----------------------------------------------------------------------------
+
+#ifndef __CS_OPTIMIZER_H
+#define __CS_OPTIMIZER_H
+
+#include "cc_compiledscript.h"
+
+// Rewrites the compiled code so that it does the same with less work:
+// drops the redundant stack, register and line number instructions, folds
+// the constant expressions, threads the jumps and removes the code which
+// cannot be reached. The fixups, exports, functions and sections are moved
+// along with the code; only the standard instructions are used.
+// Returns 0 on success, or -1 if the code was not understood, in which case
+// the script is left as it was.
+extern int cc_optimize(ccCompiledScript *scrip);
+
+#endif // __CS_OPTIMIZER_H
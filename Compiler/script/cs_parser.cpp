@@ -7,6 +7,7 @@
 #include "cs_parser.h"
 #include "cc_internallist.h"    // ccInternalList
 #include "cs_parser_common.h"
+#include "cc_compilecontext.h"
 #include "cc_symboltable.h"
 #include "script/cc_options.h"
 #include "script/script_common.h"
@@ -15,10 +16,7 @@
 
 #include "fmem.h"
 
-extern int currentline;
-
 char ccCopyright[]="ScriptCompiler32 v" SCOM_VERSIONSTR " (c) 2000-2007 Chris Jones and 2011-2014 others";
-static char scriptNameBuffer[256];
 
 int  evaluate_expression(ccInternalList*,ccCompiledScript*,int,bool insideBracketedDeclaration);
 int  evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, long lilen, long *vnlist, bool insideBracketedDeclaration);
@@ -70,8 +68,8 @@ void clear_chunk_list(std::vector<ccChunk> *list) {
 
 int is_part_of_symbol(char thischar, char startchar) {
     // workaround for strings
-    static int sayno_next_char = 0;
-    static int next_is_escaped = 0;
+    int &sayno_next_char = ccGetCompileContext()->tokenSaynoNextChar;
+    int &next_is_escaped = ccGetCompileContext()->tokenNextIsEscaped;
     if (sayno_next_char) {
         sayno_next_char = 0;
         return 0;
@@ -128,32 +126,16 @@ int is_part_of_symbol(char thischar, char startchar) {
     return 0;
 }
 
-char constructedMemberName[MAX_SYM_LEN];
-const char *get_member_full_name(int structSym, int memberSym) {
-
-    const char* memberName = sym.get_name(memberSym);
-
-    // de-mangle name, if appropriate
-    if (memberName[0] == '.')
-        memberName = &memberName[1];
-
-    sprintf(constructedMemberName, "%s::%s", sym.get_name(structSym), memberName);
-
-    return constructedMemberName;
-}
-
-int sym_find_or_add(symbolTable &sym, const char *sname) {
-    int symdex = sym.find(sname);
-    if (symdex < 0) {
-        symdex = sym.add(sname);
-    }
-    return symdex;
+int sym_find_or_add(symbolTable &table, const char *sname) {
+    return table.find_or_add(sname);
 }
 
 int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
+    symbolTable &sym = ccGetSymbolTable();
     // *** create the symbol table and parse the text code into symbol code
     int linenum=1,in_struct_declr=-1,bracedepth = 0, last_time=0;
     int parenthesisdepth = 0;
+    int numtokens = 0;
     FMEM*iii=fmem_open(inpl);
     targ->write_meta(SMETA_LINENUM,1);
     while (!fmem_eof(iii)) {
@@ -173,7 +155,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
             linenum++;
             targ->write_meta(SMETA_LINENUM,linenum);
             if (fmem_peekc(iii) =='\n') fmem_getc(iii);
-            currentline=linenum;
+            ccGetCompileContext()->currentline=linenum;
             // go back and get the whitespace after the CRLF
             continue;
         }
@@ -269,9 +251,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
                     (sym.entries[last_time].stype != SYM_OPENBRACE) &&
                     (sym.entries[last_time].stype != SYM_OPENBRACKET) &&
                     (towrite != in_struct_declr)) {
-                        const char *new_name = get_member_full_name(in_struct_declr, towrite);
-                        //      printf("changed '%s' to '%s'\n",sym.get_friendly_name(towrite).c_str(),new_name);
-                        towrite = sym_find_or_add(sym, new_name);
+                        towrite = sym.find_or_add_member(in_struct_declr, towrite);
                         if (towrite < 0) {
                             cc_error("symbol table error - could not ensure new struct symbol.");
                             return -1;
@@ -295,9 +275,11 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
         }
         targ->write(towrite);
         last_time = towrite;
+        numtokens++;
     }
     fmem_close(iii);
     targ->write_meta(SMETA_END,0);
+    ccGetCompileContext()->numTokens += numtokens;
     // clear any temporary tpyes set
     for (int ii = 0; ii < sym.entries.size(); ii++) {
         if (sym.entries[ii].stype == SYM_TEMPORARYTYPE)
@@ -308,6 +290,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
 }
 
 void free_pointer(int spOffset, int zeroCmd, int arraySym, ccCompiledScript *scrip) {
+    symbolTable &sym = ccGetSymbolTable();
 
     scrip->write_cmd1(SCMD_LOADSPOFFS, spOffset);
     scrip->write_cmd(zeroCmd);
@@ -323,6 +306,7 @@ void free_pointer(int spOffset, int zeroCmd, int arraySym, ccCompiledScript *scr
 }
 
 void free_pointers_from_struct(int structVarSym, ccCompiledScript *scrip) {
+    symbolTable &sym = ccGetSymbolTable();
     int structType = sym.entries[structVarSym].vartype;
 
     for (int dd = 0; dd < sym.entries.size(); dd++) {
@@ -357,6 +341,7 @@ void free_pointers_from_struct(int structVarSym, ccCompiledScript *scrip) {
 // remove from stack
 // just_count: just returns number of bytes, doesn't actually remove any
 int remove_locals(int from_level, int just_count, ccCompiledScript *scrip) {
+    symbolTable &sym = ccGetSymbolTable();
     int cc, totalsub = 0;
     int zeroPtrCmd = SCMD_MEMZEROPTR;
     if (from_level == 0)
@@ -402,6 +387,7 @@ int remove_locals(int from_level, int just_count, ccCompiledScript *scrip) {
 
 int deal_with_end_of_ifelse (char*nested_type,long*nested_info,long*nested_start,
                              ccCompiledScript*scrip,ccInternalList*targ,int*nestlevel, std::vector<ccChunk> *nested_chunk) {
+    symbolTable &sym = ccGetSymbolTable();
      int nested_level = nestlevel[0];
      int is_else=0;
      if (nested_type[nested_level] == NEST_ELSESINGLE) ;
@@ -454,6 +440,7 @@ int deal_with_end_of_ifelse (char*nested_type,long*nested_info,long*nested_start
 }
 
 int deal_with_end_of_do (long *nested_info, long *nested_start, ccCompiledScript *scrip, ccInternalList *targ, int *nestlevel) {
+    symbolTable &sym = ccGetSymbolTable();
     int cursym;
     int nested_level;
 
@@ -523,10 +510,8 @@ int deal_with_end_of_switch (int32_t *nested_assign_addr, long *nested_start, st
 }
 
 int find_member_sym(int structSym, long *memSym, int allowProtected) {
-    int oriname = *memSym;
-    const char *possname = get_member_full_name(structSym, oriname);
-
-    oriname = sym.find(possname);
+    symbolTable &sym = ccGetSymbolTable();
+    int oriname = sym.find_member(structSym, *memSym);
     if (oriname < 0) {
         if (sym.entries[structSym].extends > 0) {
             // walk the inheritance tree to find the member
@@ -547,6 +532,7 @@ int find_member_sym(int structSym, long *memSym, int allowProtected) {
 }
 
 std::string friendly_int_symbol(int symidx, bool isNegative) {
+    symbolTable &sym = ccGetSymbolTable();
     if (isNegative) {
         return "-" + sym.get_friendly_name(symidx);
     } else {
@@ -555,6 +541,7 @@ std::string friendly_int_symbol(int symidx, bool isNegative) {
 }
 
 int accept_literal_or_constant_value(int fromSym, int &theValue, bool isNegative, const char *errorMsg) {
+    symbolTable &sym = ccGetSymbolTable();
   if (sym.get_type(fromSym) == SYM_LITERALVALUE) {
 
     // Prepend '-' so we can parse -2147483648
@@ -599,7 +586,7 @@ int check_not_eof(ccInternalList &targ) {
   if (targ.peeknext() == SCODE_INVALID) {
     // We are past the last symbol in the file
     targ.getnext();
-    currentline = targ.lineAtEnd;
+    ccGetCompileContext()->currentline = targ.lineAtEnd;
     cc_error("Unexpected end of file");
     return -1;
   }
@@ -607,6 +594,7 @@ int check_not_eof(ccInternalList &targ) {
 }
 
 int check_for_default_value(ccInternalList &targ, int funcsym, int numparams) {
+    symbolTable &sym = ccGetSymbolTable();
 
     if (sym.get_type(targ.peeknext()) == SYM_ASSIGN) {
         // parameter has default value
@@ -637,6 +625,7 @@ int check_for_default_value(ccInternalList &targ, int funcsym, int numparams) {
 
 int check_for_dynamic_array_declaration(ccInternalList &targ, int typeSym, bool isPointer)
 {
+    symbolTable &sym = ccGetSymbolTable();
   if (sym.get_type(targ.peeknext()) == SYM_OPENBRACKET)
   {
     // dynamic array
@@ -669,6 +658,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
                                  int returnsPointer, int func_is_static,
 								 int *isMemberFunctionPtr, SymbolDef *oldDefinition,
                  int returnsDynArray) {
+    symbolTable &sym = ccGetSymbolTable();
   int numparams = 1;
   int funcsym = *funcsymptr;
   int varsize = sym.entries[vtwas].ssize;
@@ -1021,6 +1011,7 @@ int float_to_int_raw(float toconv) {
 }
 
 int isPartOfExpression(ccInternalList *targ, int j) {
+    symbolTable &sym = ccGetSymbolTable();
   if (sym.get_type(targ->script[j]) == SYM_NEW)
     return 1;
   if (sym.get_type(targ->script[j]) < NOTEXPRESSION)
@@ -1037,6 +1028,7 @@ int isPartOfExpression(ccInternalList *targ, int j) {
 // so that either side of it can be evaluated first.
 // returns -1 if no operator was found
 int find_lowest_bonding_operator(long*slist,int listlen) {
+    symbolTable &sym = ccGetSymbolTable();
   int k,blevel=0,plevel=0;
   int lowestis = 0,lowestat = -1;
   for (k=0;k<listlen;k++) {
@@ -1054,7 +1046,7 @@ int find_lowest_bonding_operator(long*slist,int listlen) {
         (plevel == 0) && (blevel == 0)) {
       // .ssize stores the precedence
       int thisIsTheOperator = 0;
-      if (ccGetOption(SCOPT_LEFTTORIGHT)) {
+      if (ccGetCompileContext()->getOption(SCOPT_LEFTTORIGHT)) {
         // left-to-right; find the right-most operator, then
         // they will be recursively processed left
         if (sym.entries[slist[k]].ssize >= lowestis)
@@ -1076,6 +1068,7 @@ int find_lowest_bonding_operator(long*slist,int listlen) {
 }
 
 int is_any_type_of_string(int symtype) {
+    symbolTable &sym = ccGetSymbolTable();
     symtype &= ~(STYPE_CONST | STYPE_POINTER);
     if ((symtype == sym.normalStringSym) || (symtype == sym.stringStructSym))
         return 1;
@@ -1083,6 +1076,7 @@ int is_any_type_of_string(int symtype) {
 }
 
 int is_string(int valtype) {
+    symbolTable &sym = ccGetSymbolTable();
 
   if (strcmp(sym.get_name(valtype),"const string")==0)
     return 1;
@@ -1095,6 +1089,7 @@ int is_string(int valtype) {
 }
 
 int check_operator_valid_for_type(int *vcpuOpPtr, int type1, int type2) {
+    symbolTable &sym = ccGetSymbolTable();
   int NULL_TYPE = STYPE_POINTER | sym.nullSym;
   int vcpuOp = *vcpuOpPtr;
 
@@ -1177,6 +1172,7 @@ int check_operator_valid_for_type(int *vcpuOpPtr, int type1, int type2) {
 }
 
 int check_type_mismatch(int typeIs, int typeWantsToBe, int orderMatters) {
+    symbolTable &sym = ccGetSymbolTable();
   int isTypeMismatch = 0;
   int numstrings = 0;
 
@@ -1292,6 +1288,7 @@ int isVCPUOperatorBoolean(int scmdtype) {
 }
 
 long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAtOffs) {
+    symbolTable &sym = ccGetSymbolTable();
   *funcAtOffs = -1;
 
   int mustBeStaticMember = 0;
@@ -1423,7 +1420,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
         cc_error("%s is not an array",sym.get_friendly_name(slist[sslen-2]).c_str());
         return -1;
         }
-      int braclevel = 0, linenumWas = currentline;
+      int braclevel = 0, linenumWas = ccGetCompileContext()->currentline;
       // extract the contents of the brackets
       // comma is allowed because you can have like array[func(a,b)]
       // vartype is allowed to permit access to static members, e.g. array[Game.GetColorFromRGB(0, 0, 0)]
@@ -1433,7 +1430,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
         if (sym.get_type(slist[sslen - 1]) == SYM_VARTYPE && sym.get_type(slist[sslen]) != SYM_DOT)
           break;
         if (targ->getnext() == SCODE_INVALID) {
-          currentline = linenumWas;
+          ccGetCompileContext()->currentline = linenumWas;
           cc_error("missing ']'");
           return -1;
         }
@@ -1462,6 +1459,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
 }
 
 void DoNullCheckOnStringInAXIfNecessary(ccCompiledScript *scrip, int valTypeFrom, int valTypeTo) {
+    symbolTable &sym = ccGetSymbolTable();
 
   // Convert normal literal string into String object
   if (((valTypeFrom & (~STYPE_POINTER)) == sym.stringStructSym) &&
@@ -1473,6 +1471,7 @@ void DoNullCheckOnStringInAXIfNecessary(ccCompiledScript *scrip, int valTypeFrom
 }
 
 void PerformStringConversionInAX(ccCompiledScript *scrip, int *valTypeFrom, int valTypeTo) {
+    symbolTable &sym = ccGetSymbolTable();
 
   // Convert normal literal string into String object
   if (((*valTypeFrom & (~STYPE_CONST)) == sym.normalStringSym) &&
@@ -1485,6 +1484,7 @@ void PerformStringConversionInAX(ccCompiledScript *scrip, int *valTypeFrom, int
 }
 
 void set_ax_scope(ccCompiledScript *scrip, int syoffs) {
+    symbolTable &sym = ccGetSymbolTable();
   // "null" is a global var
   if (sym.get_type(syoffs) == SYM_NULL)
     scrip->ax_val_scope = SYM_GLOBALVAR;
@@ -1497,6 +1497,7 @@ void set_ax_scope(ccCompiledScript *scrip, int syoffs) {
 }
 
 int findClosingBracketOffs(int openBracketOffs, long *symlist, int slilen) {
+    symbolTable &sym = ccGetSymbolTable();
   int endof,braclevel=0;
   for (endof = openBracketOffs + 1; endof < slilen; endof++) {
     int symtype = sym.get_type(symlist[endof]);
@@ -1511,6 +1512,7 @@ int findClosingBracketOffs(int openBracketOffs, long *symlist, int slilen) {
 }
 
 int findOpeningBracketOffs(int closeBracketOffs, long *symlist) {
+    symbolTable &sym = ccGetSymbolTable();
   int endof,braclevel=0;
   for (endof = closeBracketOffs - 1; endof >= 0; endof--) {
     int symtype = sym.get_type(symlist[endof]);
@@ -1525,6 +1527,7 @@ int findOpeningBracketOffs(int closeBracketOffs, long *symlist) {
 }
 
 int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml) {
+    symbolTable &sym = ccGetSymbolTable();
   int variablePathSize = 0;
   int lastOffs = 0;
   int pp;
@@ -1568,7 +1571,6 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml)
   return variablePathSize;
 }
 
-int readcmd_lastcalledwith=0;
 int get_readcmd_for_size(int sizz, int writeinstead) {
   int readcmd = SCMD_MEMREAD;
   if (writeinstead) {
@@ -1584,12 +1586,13 @@ int get_readcmd_for_size(int sizz, int writeinstead) {
     readcmd = SCMD_MEMREADW;
 
   if (sizz!=0)
-    readcmd_lastcalledwith = sizz;
+    ccGetCompileContext()->readcmdLastCalledWith = sizz;
   return readcmd;
   }
 
 
 int get_array_index_into_ax(ccCompiledScript *scrip, long *symlist, int openBracketOffs, int closeBracketOffs, bool checkBounds, bool multiplySize) {
+    symbolTable &sym = ccGetSymbolTable();
 
   // "push" the ax val type (because this is just an array index,
   // we're actually interested in the type of the variable being read)
@@ -1597,11 +1600,11 @@ int get_array_index_into_ax(ccCompiledScript *scrip, long *symlist, int openBrac
 
   // save the size of the array element, so it doesn't get
   // overwritten by the size of the array index variable
-  int saveOldReadcmd = readcmd_lastcalledwith;
+  int saveOldReadcmd = ccGetCompileContext()->readcmdLastCalledWith;
   // parse expression inside brackets to return the array index in AX
   if (parse_sub_expr(&symlist[openBracketOffs + 1], closeBracketOffs - (openBracketOffs + 1), scrip))
     return -1;
-  readcmd_lastcalledwith = saveOldReadcmd;
+  ccGetCompileContext()->readcmdLastCalledWith = saveOldReadcmd;
 
   // array index must be an int
   if (check_type_mismatch(scrip->ax_val_type, sym.normalIntSym, 1))
@@ -1636,6 +1639,7 @@ int get_array_index_into_ax(ccCompiledScript *scrip, long *symlist, int openBrac
 }
 
 int parseArrayIndexOffsets(ccCompiledScript *scrip, VariableSymlist *thisClause, bool writingOperation, bool *isArrayOffset) {
+    symbolTable &sym = ccGetSymbolTable();
 
   if ((thisClause->len > 1) &&
       (sym.get_type(thisClause->syml[1]) == SYM_OPENBRACKET)) {
@@ -1756,7 +1760,7 @@ int process_arrays_and_members(int slilen,long*syml,int*soffset,int*extraoffset,
           // access shortcut won't work
           // Therefore, tell the caller to do it properly
           // and call us again to write the value
-          readonly_cannot_cause_error = 1;
+          ccGetCompileContext()->readonlyCannotCauseError = 1;
         }
         else if (iswrite) {
           if (sym.entries[syml[onoffs+1]].flags & SFLG_READONLY) {
@@ -1796,6 +1800,7 @@ int process_arrays_and_members(int slilen,long*syml,int*soffset,int*extraoffset,
 */
 
 int call_property_func(ccCompiledScript *scrip, int propSym, int isWrite) {
+    symbolTable &sym = ccGetSymbolTable();
   // a Property Get
   int numargs = 0;
 
@@ -1896,6 +1901,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
                               bool wholePointerAccess,
                               int mainVariableSym, int mainVariableType,
                               bool isDynamicArray, bool negateLiteral) {
+    symbolTable &sym = ccGetSymbolTable();
   int gotValType = 0;
   int readcmd = get_readcmd_for_size(sym.entries[variableSym].ssize, writing);
 
@@ -2050,9 +2056,9 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
 
 // If the variable being read is actually a property, not a
 // member variable, then read_variable_into_ax sets this
-int readonly_cannot_cause_error = 0;
 
 int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int mustBeWritable, bool negateLiteral = false) {
+    symbolTable &sym = ccGetSymbolTable();
   // read the various types of values into AX
   int ee;
 
@@ -2145,7 +2151,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
         // access shortcut won't work
         // Therefore, tell the caller to do it properly
         // and call us again to write the value
-        readonly_cannot_cause_error = 1;
+        ccGetCompileContext()->readonlyCannotCauseError = 1;
       }
       else if (writing) {
 
@@ -2281,7 +2287,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
     }
 
     // if one of the struct members in the path is read-only, don't allow it
-    if (((writing) || (mustBeWritable)) && (readonly_cannot_cause_error == 0)) {
+    if (((writing) || (mustBeWritable)) && (ccGetCompileContext()->readonlyCannotCauseError == 0)) {
       // allow writing to read-only pointers if it's actually
       // a property being accessed
       if ((sym.entries[variableSym].flags & SFLG_POINTER) && (!isLastClause)) { }
@@ -2421,6 +2427,7 @@ int write_ax_to_variable(int slilen,long*syml,ccCompiledScript*scrip) {
 
 
 int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
+    symbolTable &sym = ccGetSymbolTable();
 /*  printf("Parse expression: '");
   int j;
   for (j=0;j<listlen;j++)
@@ -2934,6 +2941,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 // to parse the expression in a slightly different way so that the final bracket is not
 // consumed as part of evaluating the expression.
 int evaluate_expression(ccInternalList*targ,ccCompiledScript*scrip,int countbrackets, bool insideBracketedDeclaration) {
+    symbolTable &sym = ccGetSymbolTable();
   ccInternalList ours;
   int j,ourlen=0,brackdepth=0;
   int hadMetaOnly = 1;
@@ -3005,6 +3013,7 @@ int evaluate_expression(ccInternalList*targ,ccCompiledScript*scrip,int countbrac
   }
 
 int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, long lilen, long *vnlist, bool insideBracketedDeclaration) {
+    symbolTable &sym = ccGetSymbolTable();
     if (!sym.entries[cursym].is_loadable_variable()) {
         // allow through static properties
         if ((sym.get_type(cursym) == SYM_VARTYPE) && (lilen > 2) &&
@@ -3046,7 +3055,7 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
     if (sym.get_type(asstype) == SYM_SASSIGN) {
 
         // ++ or --
-        readonly_cannot_cause_error = 0;
+        ccGetCompileContext()->readonlyCannotCauseError = 0;
 
         if (read_variable_into_ax(lilen,&vnlist[0],scrip, 1))
             return -1;
@@ -3058,11 +3067,11 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
 
         scrip->write_cmd2(cpuOp, SREG_AX, 1);
 
-        if (!readonly_cannot_cause_error) {
+        if (!ccGetCompileContext()->readonlyCannotCauseError) {
             MARIntactAssumption = 1;
             // since the MAR won't have changed, we can directly write
             // the value back to it without re-calculating the offset
-            scrip->write_cmd1(get_readcmd_for_size(readcmd_lastcalledwith,1),SREG_AX);
+            scrip->write_cmd1(get_readcmd_for_size(ccGetCompileContext()->readcmdLastCalledWith,1),SREG_AX);
         }
     }
     // not ++ or --, so we need to evaluate the RHS
@@ -3125,6 +3134,7 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
 int parse_variable_declaration(long cursym,int *next_type,int isglobal,
     int varsize,ccCompiledScript*scrip,ccInternalList*targ, int vtwas,
     int isPointer) {
+    symbolTable &sym = ccGetSymbolTable();
   long lbuffer = 0;
   long *getsvalue = &lbuffer;
   int need_fixup = 0;
@@ -3213,7 +3223,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
   if (strcmp(sym.get_name(vtwas),"string")==0) {
     sym.entries[cursym].flags |= SFLG_ISSTRING;
     // if it's a string, allocate it some space
-    if (ccGetOption(SCOPT_OLDSTRINGS) == 0) {
+    if (ccGetCompileContext()->getOption(SCOPT_OLDSTRINGS) == 0) {
       cc_error("type 'string' is no longer supported; use String instead");
       return -1;
     }
@@ -3389,6 +3399,8 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 // compile the code in the INPL parameter into code in the scrip structure,
 // but don't reset anything because more files could follow
 int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
+    symbolTable &sym = ccGetSymbolTable();
+    ccCompileContext *context = ccGetCompileContext();
     ccInternalList targ;
     if (cc_tokenize(inpl,&targ,scrip)) return -1;
 
@@ -3410,15 +3422,15 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
     // *** now we have the program as a list of symbols in targ
     // go through it one by one. We start off in the global data
     // part - no code is allowed until a function definition is started
-    currentline=1;
+    context->currentline=1;
     targ.startread();
     int currentlinewas=0;
     for (aa=0;aa<targ.length;aa++) {
         int cursym = targ.getnext();
-        if (currentline == -10) break; // end of stream was reached
-        if ((currentline != currentlinewas) && (ccGetOption(SCOPT_LINENUMBERS)!=0)) {
-            scrip->set_line_number(currentline);
-            currentlinewas = currentline;
+        if (context->currentline == -10) break; // end of stream was reached
+        if ((context->currentline != currentlinewas) && (context->getOption(SCOPT_LINENUMBERS)!=0)) {
+            scrip->set_line_number(context->currentline);
+            currentlinewas = context->currentline;
         }
 
         if (cursym == SCODE_INVALID) {
@@ -3440,12 +3452,12 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
         if (strncmp(sym.get_name(cursym), NEW_SCRIPT_TOKEN_PREFIX, 18) == 0)
         {
-            strcpy(scriptNameBuffer, &sym.get_name(cursym)[18]);
-            scriptNameBuffer[strlen(scriptNameBuffer) - 1] = 0;  // strip closing speech mark
-            ccCurScriptName = scriptNameBuffer;
+            strcpy(context->scriptNameBuffer, &sym.get_name(cursym)[18]);
+            context->scriptNameBuffer[strlen(context->scriptNameBuffer) - 1] = 0;  // strip closing speech mark
+            context->scriptName = context->scriptNameBuffer;
 
-            scrip->start_new_section(scriptNameBuffer);
-            currentline = 0;
+            scrip->start_new_section(context->scriptNameBuffer);
+            context->currentline = 0;
             continue;
         }
 
@@ -3800,8 +3812,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                     const char *memberExt = sym.get_name(vname);
                     memberExt = strstr(memberExt, "::");
                     if (!isFunction && sym.get_type(vname) == SYM_VARTYPE && vname > sym.normalFloatSym && memberExt == NULL) {
-                        const char *new_name = get_member_full_name(stname, vname);
-                        vname = sym_find_or_add(sym, new_name);
+                        vname = sym.find_or_add_member(stname, vname);
                     }
                     if (sym.get_type(vname) != 0 && (sym.get_type(vname) != SYM_VARTYPE || vname <= sym.normalFloatSym)) {
                         cc_error("'%s' is already defined",sym.get_friendly_name(vname).c_str());
@@ -3830,7 +3841,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         }
                         // not found -- a good thing, but find_member_sym will
                         // have errored. Clear the error
-                        ccError = 0;
+                        context->error = 0;
                     }
 
                     if (isFunction) {
@@ -4210,7 +4221,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                 }
                 // if all functions are being exported anyway, don't bother doing
                 // it now
-                if ((ccGetOption(SCOPT_EXPORTALL)!=0) && (nextype == SYM_FUNCTION));
+                if ((context->getOption(SCOPT_EXPORTALL)!=0) && (nextype == SYM_FUNCTION));
                 else if (scrip->add_new_export(sym.get_name(cursym),
                     (nextype == SYM_GLOBALVAR) ? EXPORT_DATA : EXPORT_FUNCTION,
                     sym.entries[cursym].soffs, sym.entries[cursym].sscope) == -1) {
@@ -4291,8 +4302,7 @@ startvarbit:
                 int whichmember = targ.getnext();
                 structSym = cursym;
                 // change cursym to be the full function name
-                const char *mfullname = get_member_full_name(cursym, whichmember);
-                cursym = sym.find(mfullname);
+                cursym = sym.find_member(cursym, whichmember);
                 if (cursym < 0) {
                     cc_error("'%s' does not contain a function '%s'", sym.get_friendly_name(structSym).c_str(), sym.get_friendly_name(whichmember).c_str());
                     return -1;
@@ -4385,7 +4395,7 @@ startvarbit:
             if (oldDefinition.stype) {
                 // there was a forward declaration -- check that
                 // the real declaration matches it
-                ccError = 0;
+                context->error = 0;
                 if (!isglobal)
                     cc_error("Local variable cannot have the same name as an import");
                 else if (oldDefinition.stype != sym.entries[cursym].stype)
@@ -4412,7 +4422,7 @@ startvarbit:
                         }
                     }
                 }
-                if (ccError)
+                if (context->error)
                     return -1;
             }
 
@@ -4620,7 +4630,7 @@ startvarbit:
                             cursym = targ.getnext();
                             if (cursym == SCODE_META) {
                                 // eg. "int" was the last word in the file
-                                currentline = targ.lineAtEnd;
+                                context->currentline = targ.lineAtEnd;
                                 cc_error("Unexpected end of file");
                                 return -1;
                             }
@@ -4730,7 +4740,7 @@ startvarbit:
                 nested_assign_addr[nested_level] = -1; // Location of default: label
                 targ.getnext();
                 if(targ.peeknext() == SCODE_META) {
-                    currentline = targ.lineAtEnd;
+                    context->currentline = targ.lineAtEnd;
                     cc_error("Unexpected end of file");
                     return -1;
                 }
@@ -4840,7 +4850,7 @@ startvarbit:
         }
     }
     if ((in_func >= 0) || (nested_level > 0)) {
-        currentline = targ.lineAtEnd;
+        context->currentline = targ.lineAtEnd;
         cc_error("Function still open, missing }");
         return -1;
     }
@@ -1,12 +1,14 @@
 
 #include "cs_prepro.h"
+#include "cc_compilecontext.h"
 
 void preproc_startup(MacroTable *preDefinedMacros) {
+    MacroTable &macros = ccGetCompileContext()->macros;
     macros.init();
     if (preDefinedMacros)
         macros.merge(preDefinedMacros);
 }
 
 void preproc_shutdown() {
-    macros.shutdown();
+    ccGetCompileContext()->macros.shutdown();
 }
@@ -137,6 +137,30 @@ TEST(SymbolTable, AddExAvailableAfterwards) {
 	ASSERT_TRUE(name != 0);
 }
 
+TEST(SymbolTable, FindMember) {
+	symbolTable testSym;
+	int struct_sym = testSym.add("Car");
+	int member_sym = testSym.add("speed");
+	int mangled_sym = testSym.add(".gear");
+
+	// not declared yet, so the later declaration is still found
+	ASSERT_TRUE(testSym.find_member(struct_sym, member_sym) == -1);
+	int full_sym = testSym.find_or_add_member(struct_sym, member_sym);
+	ASSERT_TRUE(full_sym >= 0);
+	ASSERT_STREQ("Car::speed", testSym.get_name(full_sym));
+	ASSERT_TRUE(testSym.find_member(struct_sym, member_sym) == full_sym);
+	ASSERT_TRUE(testSym.find_or_add_member(struct_sym, member_sym) == full_sym);
+
+	int gear_sym = testSym.add("Car::gear");
+	ASSERT_TRUE(testSym.find_member(struct_sym, mangled_sym) == gear_sym);
+
+	// the copy finds the members on its own
+	symbolTable copySym(testSym);
+	ASSERT_TRUE(copySym.find_member(struct_sym, member_sym) == full_sym);
+	testSym.reset();
+	ASSERT_TRUE(copySym.find_member(struct_sym, mangled_sym) == gear_sym);
+}
+
 TEST(SymbolTable, EntriesEnsureModifiable) {
 	symbolTable testSym;
 
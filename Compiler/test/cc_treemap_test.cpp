@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include "gtest/gtest.h"
 #include "script/cc_treemap.h"
 
@@ -55,3 +56,42 @@ TEST(TreeMap, Clear) {
 	symbolTree.clear();
 	ASSERT_TRUE (symbolTree.findValue("a") == -1);
 }
+
+TEST(TreeMap, ManyEntries) {
+	ccTreeMap symbolTree;
+	char key[20];
+	for (int i = 0; i < 5000; i++) {
+		sprintf(key, "sym%d", i);
+		symbolTree.addEntry(key, i);
+	}
+	for (int i = 0; i < 5000; i++) {
+		sprintf(key, "sym%d", i);
+		ASSERT_TRUE (symbolTree.findValue(key) == i);
+		ASSERT_TRUE (symbolTree.findValue(key, ccTreeMap::hashKey(key)) == i);
+	}
+	ASSERT_TRUE (symbolTree.findValue("sym5000") == -1);
+}
+
+TEST(TreeMap, KeysAreCopied) {
+	ccTreeMap symbolTree;
+	char key[] = "abc";
+	const char *kept = symbolTree.addEntry(key, 500);
+	ASSERT_TRUE (kept != key);
+	ASSERT_STREQ ("abc", kept);
+	ASSERT_TRUE (symbolTree.findKey("abc") == kept);
+	// replacing the value keeps the key
+	ASSERT_TRUE (symbolTree.addEntry("abc", 501) == kept);
+	ASSERT_TRUE (symbolTree.findKey("abd") == NULL);
+}
+
+TEST(TreeMap, Copy) {
+	ccTreeMap symbolTree;
+	symbolTree.addEntry("a", 600);
+	ccTreeMap copy(symbolTree);
+	copy.addEntry("b", 601);
+	symbolTree.clear();
+	ASSERT_TRUE (copy.findValue("a") == 600);
+	ASSERT_TRUE (copy.findValue("b") == 601);
+	ASSERT_TRUE (symbolTree.findValue("a") == -1);
+	ASSERT_TRUE (copy.findKey("a") != NULL);
+}
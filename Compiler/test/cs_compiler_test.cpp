@@ -0,0 +1,152 @@
+#include <string.h>
+#include "gtest/gtest.h"
+#include "script/cs_compiler.h"
+#include "script/cc_script.h"
+#include "script/cc_error.h"
+#include "script/cc_options.h"
+
+extern char *last_seen_cc_error;  // in cs_parser_test
+
+void expectSameScript(ccScript *expected, ccScript *actual) {
+    ASSERT_TRUE(expected != NULL);
+    ASSERT_TRUE(actual != NULL);
+    ASSERT_EQ(expected->codesize, actual->codesize);
+    EXPECT_EQ(0, memcmp(expected->code, actual->code, expected->codesize * sizeof(intptr_t)));
+    ASSERT_EQ(expected->globaldatasize, actual->globaldatasize);
+    ASSERT_EQ(expected->stringssize, actual->stringssize);
+    EXPECT_EQ(0, memcmp(expected->strings, actual->strings, expected->stringssize));
+    ASSERT_EQ(expected->numfixups, actual->numfixups);
+    ASSERT_EQ(expected->numimports, actual->numimports);
+    for (int i = 0; i < expected->numimports; i++)
+        EXPECT_STREQ(expected->imports[i], actual->imports[i]);
+    ASSERT_EQ(expected->numexports, actual->numexports);
+    for (int i = 0; i < expected->numexports; i++)
+        EXPECT_STREQ(expected->exports[i], actual->exports[i]);
+    ASSERT_EQ(expected->numSections, actual->numSections);
+    for (int i = 0; i < expected->numSections; i++)
+        EXPECT_STREQ(expected->sectionNames[i], actual->sectionNames[i]);
+}
+
+TEST(Compile, HeaderSnapshots) {
+    char *header1 = "\
+        import int Foo(int a);\
+        struct Bar {\
+          int x;\
+          import int Get(int b);\
+        };\
+        ";
+    char *header2 = "\
+        import int Baz();\
+        ";
+    char *script1 = "\
+        int Test() {\
+          return Foo(1);\
+        }\
+        ";
+    char *script2 = "\
+        int Test() {\
+          Bar b;\
+          return b.Get(Baz());\
+        }\
+        ";
+
+    ccClearHeaderSnapshots();
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(header1, "Header1");
+    ccScript *first = ccCompileText(script1, "Script1");
+    ASSERT_TRUE(first != NULL);
+
+    // extends the snapshot of the first header
+    ccAddDefaultHeader(header2, "Header2");
+    ccScript *extended = ccCompileText(script2, "Script2");
+    // uses the snapshot of both headers
+    ccScript *reused = ccCompileText(script2, "Script2");
+
+    ccClearHeaderSnapshots();
+    ccScript *fresh = ccCompileText(script2, "Script2");
+
+    expectSameScript(fresh, extended);
+    expectSameScript(fresh, reused);
+
+    // an error in the main script does not spoil the snapshot
+    EXPECT_EQ(NULL, ccCompileText("int Test() { return Unknown(); }", "Broken"));
+    ccScript *after_error = ccCompileText(script2, "Script2");
+    expectSameScript(fresh, after_error);
+
+    ccClearHeaderSnapshots();
+    ccRemoveDefaultHeaders();
+    delete first;
+    delete extended;
+    delete reused;
+    delete fresh;
+    delete after_error;
+}
+
+TEST(Compile, Batch) {
+    char *header = "\
+        import int Foo(int a);\
+        struct Bar {\
+          int x;\
+          import int Get(int b);\
+        };\
+        ";
+    const char *scripts[] = {
+        "int Test() { return Foo(1); }",
+        "int Test() { Bar b; return b.Get(2); }",
+        "int Test() { return Unknown(); }",
+        "int a; int Test() { a = Foo(a); return a; }",
+        "int Test() {\n  int x = 1;\n  return x + Foo(x);\n}",
+    };
+    const int count = sizeof(scripts) / sizeof(scripts[0]);
+
+    ccClearHeaderSnapshots();
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(header, "Header");
+    const int options = SCOPT_LINENUMBERS | SCOPT_LEFTTORIGHT;
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOption(SCOPT_LEFTTORIGHT, 1);
+    ccScript *expected[count];
+    char expected_error[400];
+    int expected_line = 0;
+    for (int i = 0; i < count; i++) {
+        expected[i] = ccCompileText(scripts[i], "Script");
+        if (expected[i] == NULL) {
+            // formatted as by the editor
+            sprintf(expected_error, "Error (line %d): %s", ccErrorLine, last_seen_cc_error);
+            expected_line = ccErrorLine;
+        }
+    }
+    ASSERT_TRUE(expected[2] == NULL);
+
+    for (int threads = 1; threads <= 4; threads++) {
+        ccClearHeaderSnapshots();
+        ccCompileJob jobs[count];
+        for (int i = 0; i < count; i++) {
+            jobs[i].script = scripts[i];
+            jobs[i].scriptName = "Script";
+            jobs[i].numHeaders = -1;
+            jobs[i].options = options;
+        }
+        EXPECT_EQ(1, ccCompileBatch(jobs, count, threads));
+        for (int i = 0; i < count; i++) {
+            if (expected[i] == NULL) {
+                EXPECT_TRUE(jobs[i].result == NULL);
+                EXPECT_STREQ(expected_error, jobs[i].errorString);
+                EXPECT_STREQ("Script", jobs[i].errorScriptName);
+                EXPECT_EQ(expected_line, jobs[i].errorLine);
+                continue;
+            }
+            expectSameScript(expected[i], jobs[i].result);
+            delete jobs[i].result;
+        }
+    }
+    // the errors in the batch are not reported as usual
+    EXPECT_EQ(0, ccError);
+
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ccSetOption(SCOPT_LEFTTORIGHT, 0);
+    ccClearHeaderSnapshots();
+    ccRemoveDefaultHeaders();
+    for (int i = 0; i < count; i++)
+        delete expected[i];
+}
@@ -0,0 +1,411 @@
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cs_compiler.h"
+#include "script/cc_script.h"
+#include "script/cc_options.h"
+#include "script/script_common.h"
+
+// Runs the script functions on a small interpreter of the integer subset
+// of the instructions, so that the plain and the optimized code may be
+// compared by what they do.
+
+static const int OPT_ARGC[] = {
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 2, 2, 1, 2, 1, 1, 0, 1, 1,
+    0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2
+};
+
+static const int VM_GLOBAL_BASE = 16;
+static const int VM_STACK_BASE  = 4096;
+static const int VM_MEMORY_SIZE = 8192;
+static const int VM_MAX_STEPS   = 100000;
+
+enum VMStatus {
+    kVMOk,
+    kVMError,       // the engine would abort the script
+    kVMUnsupported,
+    kVMTooLong
+};
+
+struct VMResult {
+    int status;
+    int value;
+    std::vector<char> globals;
+};
+
+static bool vm_address(int address, int size) {
+    return address >= 0 && address + size <= VM_MEMORY_SIZE;
+}
+
+static int vm_read(const std::vector<char> &memory, int address, int size) {
+    if (size == 1)
+        return (unsigned char)memory[address];
+    if (size == 2) {
+        short value;
+        memcpy(&value, &memory[address], 2);
+        return value;
+    }
+    int value;
+    memcpy(&value, &memory[address], 4);
+    return value;
+}
+
+static void vm_write(std::vector<char> &memory, int address, int size, int value) {
+    if (size == 1)
+        memory[address] = (char)value;
+    else if (size == 2) {
+        short half = (short)value;
+        memcpy(&memory[address], &half, 2);
+    }
+    else
+        memcpy(&memory[address], &value, 4);
+}
+
+static int vm_memory_size(int op) {
+    if (op == SCMD_MEMREADB || op == SCMD_MEMWRITEB)
+        return 1;
+    if (op == SCMD_MEMREADW || op == SCMD_MEMWRITEW)
+        return 2;
+    return 4;
+}
+
+static VMResult run_function(ccScript *scrip, const char *name, int arg) {
+    VMResult result;
+    result.status = kVMUnsupported;
+    result.value = 0;
+
+    int start = -1;
+    for (int i = 0; i < scrip->numexports; i++) {
+        if (strncmp(scrip->exports[i], name, strlen(name)) == 0 &&
+            scrip->exports[i][strlen(name)] == '$')
+            start = scrip->export_addr[i] & 0xFFFFFF;
+    }
+    if (start < 0)
+        return result;
+
+    std::vector<char> fixups(scrip->codesize, 0);
+    for (int i = 0; i < scrip->numfixups; i++)
+        fixups[scrip->fixups[i]] = scrip->fixuptypes[i];
+
+    std::vector<char> memory(VM_MEMORY_SIZE, 0);
+    memcpy(&memory[VM_GLOBAL_BASE], scrip->globaldata, scrip->globaldatasize);
+    int reg[8] = { 0 };
+    reg[SREG_SP] = VM_STACK_BASE;
+    vm_write(memory, reg[SREG_SP], 4, arg);
+    vm_write(memory, reg[SREG_SP] + 4, 4, -1);
+    reg[SREG_SP] += 8;
+
+    int pc = start;
+    result.status = kVMTooLong;
+    for (int steps = 0; steps < VM_MAX_STEPS; steps++) {
+        if (pc < 0 || pc >= scrip->codesize) {
+            result.status = kVMError;
+            break;
+        }
+        int op = scrip->code[pc];
+        if (op <= 0 || op >= (int)(sizeof(OPT_ARGC) / sizeof(OPT_ARGC[0]))) {
+            result.status = kVMUnsupported;
+            break;
+        }
+        int argc = OPT_ARGC[op];
+        int args[3] = { 0, 0, 0 };
+        for (int i = 0; i < argc; i++) {
+            args[i] = scrip->code[pc + 1 + i];
+            if (fixups[pc + 1 + i] == FIXUP_GLOBALDATA)
+                args[i] += VM_GLOBAL_BASE;
+            else if (fixups[pc + 1 + i] != 0 && fixups[pc + 1 + i] != FIXUP_FUNCTION) {
+                result.status = kVMUnsupported;
+                return result;
+            }
+        }
+        int next = pc + argc + 1;
+        int &r1 = reg[args[0] & 7];
+        int &r2 = reg[args[1] & 7];
+        int size = vm_memory_size(op);
+        bool failed = false;
+        bool unsupported = false;
+
+        switch (op) {
+        case SCMD_LINENUM:
+        case SCMD_THISBASE:
+        case SCMD_LOOPCHECKOFF:
+        case SCMD_NUMFUNCARGS:
+            break;
+        case SCMD_ADD:      r1 += args[1]; break;
+        case SCMD_SUB:      r1 -= args[1]; break;
+        case SCMD_MUL:      r1 *= args[1]; break;
+        case SCMD_REGTOREG: r2 = r1; break;
+        case SCMD_LITTOREG: r1 = args[1]; break;
+        case SCMD_MULREG:   r1 *= r2; break;
+        case SCMD_ADDREG:   r1 += r2; break;
+        case SCMD_SUBREG:   r1 -= r2; break;
+        case SCMD_BITAND:   r1 &= r2; break;
+        case SCMD_BITOR:    r1 |= r2; break;
+        case SCMD_XORREG:   r1 ^= r2; break;
+        case SCMD_ISEQUAL:  r1 = (r1 == r2); break;
+        case SCMD_NOTEQUAL: r1 = (r1 != r2); break;
+        case SCMD_GREATER:  r1 = (r1 > r2); break;
+        case SCMD_LESSTHAN: r1 = (r1 < r2); break;
+        case SCMD_GTE:      r1 = (r1 >= r2); break;
+        case SCMD_LTE:      r1 = (r1 <= r2); break;
+        case SCMD_AND:      r1 = (r1 && r2); break;
+        case SCMD_OR:       r1 = (r1 || r2); break;
+        case SCMD_NOTREG:   r1 = !r1; break;
+        case SCMD_SHIFTLEFT:  r1 = r1 << r2; break;
+        case SCMD_SHIFTRIGHT: r1 = r1 >> r2; break;
+        case SCMD_DIVREG:
+        case SCMD_MODREG:
+            if (r2 == 0)
+                failed = true;
+            else
+                r1 = (op == SCMD_DIVREG) ? r1 / r2 : r1 % r2;
+            break;
+        case SCMD_CHECKBOUNDS:
+            failed = r1 < 0 || r1 >= args[1];
+            break;
+        case SCMD_LOADSPOFFS:
+            reg[SREG_MAR] = reg[SREG_SP] - args[0];
+            break;
+        case SCMD_MEMREAD:
+        case SCMD_MEMREADB:
+        case SCMD_MEMREADW:
+            if (!vm_address(reg[SREG_MAR], size))
+                failed = true;
+            else
+                r1 = vm_read(memory, reg[SREG_MAR], size);
+            break;
+        case SCMD_MEMWRITE:
+        case SCMD_MEMWRITEB:
+        case SCMD_MEMWRITEW:
+            if (!vm_address(reg[SREG_MAR], size))
+                failed = true;
+            else
+                vm_write(memory, reg[SREG_MAR], size, r1);
+            break;
+        case SCMD_WRITELIT:
+            if (!vm_address(reg[SREG_MAR], args[0]))
+                failed = true;
+            else
+                vm_write(memory, reg[SREG_MAR], args[0], args[1]);
+            break;
+        case SCMD_ZEROMEMORY:
+            if (!vm_address(reg[SREG_MAR], args[0]))
+                failed = true;
+            else
+                memset(&memory[reg[SREG_MAR]], 0, args[0]);
+            break;
+        case SCMD_PUSHREG:
+            if (!vm_address(reg[SREG_SP], 4))
+                failed = true;
+            else {
+                vm_write(memory, reg[SREG_SP], 4, r1);
+                reg[SREG_SP] += 4;
+            }
+            break;
+        case SCMD_POPREG:
+            reg[SREG_SP] -= 4;
+            if (!vm_address(reg[SREG_SP], 4))
+                failed = true;
+            else
+                r1 = vm_read(memory, reg[SREG_SP], 4);
+            break;
+        case SCMD_JMP:
+            next += args[0];
+            break;
+        case SCMD_JZ:
+            if (reg[SREG_AX] == 0)
+                next += args[0];
+            break;
+        case SCMD_JNZ:
+            if (reg[SREG_AX] != 0)
+                next += args[0];
+            break;
+        case SCMD_CALL:
+            if (!vm_address(reg[SREG_SP], 4))
+                failed = true;
+            else {
+                vm_write(memory, reg[SREG_SP], 4, next);
+                reg[SREG_SP] += 4;
+                next = r1;
+            }
+            break;
+        case SCMD_RET:
+            reg[SREG_SP] -= 4;
+            if (!vm_address(reg[SREG_SP], 4))
+                failed = true;
+            else
+                next = vm_read(memory, reg[SREG_SP], 4);
+            break;
+        default:
+            unsupported = true;
+            break;
+        }
+
+        if (unsupported) {
+            result.status = kVMUnsupported;
+            break;
+        }
+        if (failed) {
+            result.status = kVMError;
+            break;
+        }
+        if (next == -1) {
+            result.status = kVMOk;
+            result.value = reg[SREG_AX];
+            break;
+        }
+        pc = next;
+    }
+    result.globals.assign(memory.begin() + VM_GLOBAL_BASE,
+        memory.begin() + VM_GLOBAL_BASE + scrip->globaldatasize);
+    return result;
+}
+
+static void expectSameRuns(ccScript *plain, ccScript *optimized, const char *name, int from, int to) {
+    for (int arg = from; arg <= to; arg++) {
+        VMResult expected = run_function(plain, name, arg);
+        VMResult actual = run_function(optimized, name, arg);
+        ASSERT_NE(kVMUnsupported, expected.status);
+        EXPECT_EQ(expected.status, actual.status) << name << "(" << arg << ")";
+        if (expected.status == kVMOk)
+            EXPECT_EQ(expected.value, actual.value) << name << "(" << arg << ")";
+        EXPECT_TRUE(expected.globals == actual.globals) << name << "(" << arg << ")";
+    }
+}
+
+static ccScript *compile_with_optimize(const char *script, int optimize) {
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_OPTIMIZE, optimize);
+    ccScript *scrip = ccCompileText(script, "Optimizer");
+    ccSetOption(SCOPT_OPTIMIZE, 0);
+    ccSetOption(SCOPT_EXPORTALL, 0);
+    return scrip;
+}
+
+TEST(Optimize, ConstantExpression) {
+    char *inpl = "int Test() { return 2 + 3 * 4; }";
+
+    ccRemoveDefaultHeaders();
+    ccScript *plain = compile_with_optimize(inpl, 0);
+    ccScript *optimized = compile_with_optimize(inpl, 1);
+    ASSERT_TRUE(plain != NULL);
+    ASSERT_TRUE(optimized != NULL);
+
+    EXPECT_LT(optimized->codesize, plain->codesize);
+    bool folded = false;
+    for (int pc = 0; pc < optimized->codesize; pc += OPT_ARGC[optimized->code[pc]] + 1) {
+        if (optimized->code[pc] == SCMD_LITTOREG && optimized->code[pc + 1] == SREG_AX &&
+            optimized->code[pc + 2] == 14)
+            folded = true;
+    }
+    EXPECT_TRUE(folded);
+    // the function still starts where it is exported
+    ASSERT_EQ(1, optimized->numexports);
+    EXPECT_EQ(SCMD_THISBASE, optimized->code[optimized->export_addr[0] & 0xFFFFFF]);
+
+    VMResult result = run_function(optimized, "Test", 0);
+    EXPECT_EQ(kVMOk, result.status);
+    EXPECT_EQ(14, result.value);
+
+    delete plain;
+    delete optimized;
+}
+
+TEST(Optimize, SameBehaviour) {
+    char *inpl = "\
+        int arr[10];\n\
+        int g = 3;\n\
+        short h;\n\
+        int Fib(int n) {\n\
+          if (n < 2) return n;\n\
+          return Fib(n - 1) + Fib(n - 2);\n\
+        }\n\
+        int Loops(int n) {\n\
+          int sum = 0;\n\
+          for (int i = 0; i < n; i++) {\n\
+            if (i % 3 == 0) continue;\n\
+            if (i > 20) break;\n\
+            sum += i * 2 - (4 / 2);\n\
+          }\n\
+          int j = n;\n\
+          while (j > 0 && sum < 1000 || j == 7) {\n\
+            j--;\n\
+            arr[j % 10] = arr[j % 10] + j;\n\
+          }\n\
+          switch (n) {\n\
+            case 1: sum += 100; break;\n\
+            case 5: sum += 500;\n\
+            case 6: sum += 600; break;\n\
+            default: sum -= 1;\n\
+          }\n\
+          int loc[4];\n\
+          loc[n % 4] = sum;\n\
+          h = sum;\n\
+          return loc[n % 4] + g * (1 << 3) + (!n) + (n != 5);\n\
+        }\n\
+        int Divide(int n) {\n\
+          int zero = 0;\n\
+          if (n > 3) return n / zero;\n\
+          return 12 / n + 7 % (n + 5);\n\
+        }\n\
+        ";
+
+    ccRemoveDefaultHeaders();
+    for (int linenumbers = 0; linenumbers <= 1; linenumbers++) {
+        ccSetOption(SCOPT_LINENUMBERS, linenumbers);
+        ccScript *plain = compile_with_optimize(inpl, 0);
+        ccScript *optimized = compile_with_optimize(inpl, 1);
+        ASSERT_TRUE(plain != NULL);
+        ASSERT_TRUE(optimized != NULL);
+        EXPECT_LT(optimized->codesize, plain->codesize);
+
+        expectSameRuns(plain, optimized, "Fib", -1, 12);
+        expectSameRuns(plain, optimized, "Loops", -5, 30);
+        expectSameRuns(plain, optimized, "Divide", -6, 5);
+
+        delete plain;
+        delete optimized;
+    }
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+}
+
+static std::vector<int> line_numbers(ccScript *scrip) {
+    std::vector<int> lines;
+    for (int pc = 0; pc < scrip->codesize; pc += OPT_ARGC[scrip->code[pc]] + 1) {
+        if (scrip->code[pc] == SCMD_LINENUM)
+            lines.push_back(scrip->code[pc + 1]);
+    }
+    return lines;
+}
+
+TEST(Optimize, KeepsLineNumbers) {
+    // the condition is known, so the line of the "if" is left without code
+    char *inpl = "\
+        int g;\n\
+        void Lines(int n) {\n\
+          int a = n;\n\
+          if (1)\n\
+          {\n\
+            g = a;\n\
+          }\n\
+        }\n\
+        ";
+
+    ccRemoveDefaultHeaders();
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccScript *plain = compile_with_optimize(inpl, 0);
+    ccScript *optimized = compile_with_optimize(inpl, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ASSERT_TRUE(plain != NULL);
+    ASSERT_TRUE(optimized != NULL);
+
+    // every line the debugger may stop on is kept, in the same order
+    std::vector<int> expected = line_numbers(plain);
+    std::vector<int> actual = line_numbers(optimized);
+    EXPECT_TRUE(expected == actual);
+    expectSameRuns(plain, optimized, "Lines", -2, 2);
+
+    delete plain;
+    delete optimized;
+}
@@ -19,6 +19,7 @@ void cc_error_without_line(char *buffer, const char *error_msg)
 }
 
 ccCompiledScript *newScriptFixture() {
+    symbolTable &sym = ccGetSymbolTable();
     // TODO: investigate proper google test fixtures.
     ccCompiledScript *scrip = new ccCompiledScript();
     scrip->init();
@@ -201,6 +202,7 @@ TEST(Compile, ParsingNegIntOverflow) {
 
 
 TEST(Compile, EnumNegative) {
+    symbolTable &sym = ccGetSymbolTable();
     ccCompiledScript *scrip = newScriptFixture();
 
     char *inpl = "\
@@ -244,6 +246,7 @@ TEST(Compile, EnumNegative) {
 
 
 TEST(Compile, DefaultParametersLargeInts) {
+    symbolTable &sym = ccGetSymbolTable();
     ccCompiledScript *scrip = newScriptFixture();
 
     char *inpl = "\
@@ -296,6 +299,7 @@ TEST(Compile, DefaultParametersLargeInts) {
 }
 
 TEST(Compile, ImportFunctionReturningDynamicArray) {
+    symbolTable &sym = ccGetSymbolTable();
     ccCompiledScript *scrip = newScriptFixture();
 
     char *inpl = "\
@@ -624,6 +624,8 @@ import void DisplayMessageBar(int y, int textColor, int backColor, const string
 import void ResetRoom(int roomNumber);
 /// Checks whether the player has been in the specified room yet.
 import int  HasPlayerBeenInRoom(int roomNumber);
+/// Starts reading the specified room in the background, so that changing to it later is faster.
+import void PreloadRoom(int roomNumber);
 #ifndef STRICT_IN_v340
 /// Performs default processing of a mouse click at the specified co-ordinates.
 import void ProcessClick(int x, int y, CursorMode);
@@ -662,6 +664,10 @@ import void SaveGameSlot(int slot, const string description);
 import void RestoreGameSlot(int slot);
 /// Deletes the specified save game.
 import void DeleteSaveSlot(int slot);
+/// Saves the current game position into memory, to the specified quick slot.
+import void QuickSaveSlot(int slot);
+/// Restores the game saved into memory to the specified quick slot.
+import void QuickRestoreSlot(int slot);
 /// Sets this as the point at which the game will be restarted.
 import void SetRestartPoint();
 /// Gets what type of thing is in the room at the specified co-ordinates.
@@ -7,6 +7,8 @@ extern bool Scintilla_RegisterClasses(void *hInstance);
 extern int Scintilla_LinkLexers();
 
 int antiAliasFonts = 0;
+// Save room images in the LZ format rather than the legacy one
+bool fastLoadingRoomImages = false;
 bool ShouldAntiAliasText() { return (antiAliasFonts != 0); }
 
 int mousex, mousey;
@@ -1905,15 +1907,29 @@ void save_room(const char *files, roomstruct rstruc) {
     opty->WriteArrayOfInt32(&rstruc.regionTintLevel[0], MAX_REGIONS);
   }
 
-  xoff = opty->GetPosition();
-  delete opty;
+  const RoomImageFormat image_format = fastLoadingRoomImages ? kRoomImage_LZ : kRoomImage_Legacy;
+  if (rfh.version >= 31)
+    opty->WriteByte(image_format);
 
-  tesl = save_lzw((char*)files, rstruc.ebscene[0], rstruc.pal, xoff);
+  if (image_format == kRoomImage_LZ) {
+    save_lz_image(opty, rstruc.ebscene[0], rstruc.pal);
+    save_lz_image(opty, rstruc.regions, NULL);
+    save_lz_image(opty, rstruc.walls, NULL);
+    save_lz_image(opty, rstruc.object, NULL);
+    save_lz_image(opty, rstruc.lookat, NULL);
+    delete opty;
+  }
+  else {
+    xoff = opty->GetPosition();
+    delete opty;
 
-  tesl = savecompressed_allegro((char*)files, rstruc.regions, rstruc.pal, tesl);
-  tesl = savecompressed_allegro((char*)files, rstruc.walls, rstruc.pal, tesl);
-  tesl = savecompressed_allegro((char*)files, rstruc.object, rstruc.pal, tesl);
-  tesl = savecompressed_allegro((char*)files, rstruc.lookat, rstruc.pal, tesl);
+    tesl = save_lzw((char*)files, rstruc.ebscene[0], rstruc.pal, xoff);
+
+    tesl = savecompressed_allegro((char*)files, rstruc.regions, rstruc.pal, tesl);
+    tesl = savecompressed_allegro((char*)files, rstruc.walls, rstruc.pal, tesl);
+    tesl = savecompressed_allegro((char*)files, rstruc.object, rstruc.pal, tesl);
+    tesl = savecompressed_allegro((char*)files, rstruc.lookat, rstruc.pal, tesl);
+  }
 
   if (rfh.version >= 5) {
     long  lee;
@@ -1988,14 +2004,23 @@ void save_room(const char *files, roomstruct rstruc) {
       opty->WriteByte(rstruc.bscene_anim_speed);
       
       opty->WriteArrayOfInt8 ((int8_t*)&rstruc.ebpalShared[0], rstruc.num_bscenes);
+      if (rfh.version >= 31)
+        opty->WriteByte(image_format);
 
-      delete opty;
+      if (image_format == kRoomImage_LZ) {
+        for (gg = 1; gg < rstruc.num_bscenes; gg++)
+          save_lz_image(opty, rstruc.ebscene[gg], rstruc.bpalettes[gg]);
+        curoffs = opty->GetPosition();
+      }
+      else {
+        curoffs = opty->GetPosition();
+        delete opty;
 
-      curoffs = lenpos + 6 + rstruc.num_bscenes;
-      for (gg = 1; gg < rstruc.num_bscenes; gg++)
-        curoffs = save_lzw((char*)files, rstruc.ebscene[gg], rstruc.bpalettes[gg], curoffs);
+        for (gg = 1; gg < rstruc.num_bscenes; gg++)
+          curoffs = save_lzw((char*)files, rstruc.ebscene[gg], rstruc.bpalettes[gg], curoffs);
 
-      opty = ci_fopen(const_cast<char*>(files), Common::kFile_Open, Common::kFile_ReadWrite);
+        opty = ci_fopen(const_cast<char*>(files), Common::kFile_Open, Common::kFile_ReadWrite);
+      }
       lenis = (curoffs - lenpos) - 4;
       opty->Seek(lenpos, Common::kSeekBegin);
       opty->WriteInt32(lenis);
@@ -2552,6 +2577,7 @@ void GameUpdated(Game ^game) {
   thisgame.options[OPT_ANTIALIASFONTS] = game->Settings->AntiAliasFonts;
   antiAliasFonts = thisgame.options[OPT_ANTIALIASFONTS];
   update_font_sizes();
+  fastLoadingRoomImages = game->Settings->FastLoadingRoomImages;
 
   //delete abuf;
   //abuf = Common::BitmapHelper::CreateBitmap(32, 32, thisgame.color_depth * 8);
@@ -49,6 +49,7 @@ namespace AGS.Types
         private RoomTransitionStyle _roomTransition = RoomTransitionStyle.FadeOutAndIn;
         private bool _saveScreenshots = false;
         private bool _compressSprites = false;
+        private bool _fastLoadingRoomImages = false;
         private bool _inventoryCursors = true;
         private bool _handleInvInScript = false;
         private bool _displayMultipleInv = false;
@@ -284,6 +285,16 @@ namespace AGS.Types
             set { _compressSprites = value; }
         }
 
+        [DisplayName("Store room images for fast loading")]
+        [Description("Room backgrounds and masks are saved in a format which loads several times faster, at the expense of larger room files. Applies to the rooms saved afterwards")]
+        [DefaultValue(false)]
+        [Category("Compiler")]
+        public bool FastLoadingRoomImages
+        {
+            get { return _fastLoadingRoomImages; }
+            set { _fastLoadingRoomImages = value; }
+        }
+
         [DisplayName("Save screenshots in save games")]
         [Description("A screenshot of the player's current position will be saved into the save games")]
         [DefaultValue(false)]
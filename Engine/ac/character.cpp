@@ -32,6 +32,7 @@
 #include "ac/global_region.h"
 #include "ac/global_room.h"
 #include "ac/global_translation.h"
+#include "ac/hittestindex.h"
 #include "ac/gui.h"
 #include "ac/lipsync.h"
 #include "ac/mouse.h"
@@ -52,6 +53,7 @@
 #include "ac/spritecache.h"
 #include "util/string_utils.h"
 #include <math.h>
+#include <vector>
 #include "gfx/graphicsdriver.h"
 #include "platform/base/override_defines.h"
 #include "script/runtimescriptvalue.h"
@@ -113,6 +115,8 @@ int char_thinking = -1;
 const char *text_lips_text = NULL;
 SpeechLipSyncLine *splipsync = NULL;
 int numLipLines = 0, curLipLine = -1, curLipLinePhoneme = 0;
+// Lip sync data was found in the speech file but not read yet
+bool speech_lipsync_pending = false;
 
 // **** CHARACTER: FUNCTIONS ****
 
@@ -1647,6 +1651,14 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
+void walk_character_to_leader(int chac, int tox, int toy, int share_radius) {
+    // followers of the same leader walk one after another within the
+    // update, so that the later ones may share the route found for the first
+    set_route_share_radius(share_radius);
+    walk_character(chac, tox, toy, 0, true);
+    set_route_share_radius(0);
+}
+
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
@@ -2184,36 +2196,57 @@ CharacterInfo *GetCharacterAtLocation(int xx, int yy) {
 
 extern int char_lowest_yp, obj_lowest_yp;
 
-int is_pos_on_character(int xx,int yy) {
-    int cc,sppic,lowestyp=0,lowestwas=-1;
-    for (cc=0;cc<game.numcharacters;cc++) {
-        if (game.chars[cc].room!=displayed_room) continue;
-        if (game.chars[cc].on==0) continue;
-        if (game.chars[cc].flags & CHF_NOINTERACT) continue;
-        if (game.chars[cc].view < 0) continue;
-        CharacterInfo*chin=&game.chars[cc];
+bool get_character_hit_rect(int cc, int *x, int *y, int *width, int *height) {
+    if (game.chars[cc].room!=displayed_room) return false;
+    if (game.chars[cc].on==0) return false;
+    if (game.chars[cc].flags & CHF_NOINTERACT) return false;
+    if (game.chars[cc].view < 0) return false;
+    CharacterInfo*chin=&game.chars[cc];
 
-        if ((chin->view < 0) || 
-            (chin->loop >= views[chin->view].numLoops) ||
-            (chin->frame >= views[chin->view].loops[chin->loop].numFrames))
-        {
-            continue;
-        }
+    if ((chin->view < 0) || 
+        (chin->loop >= views[chin->view].numLoops) ||
+        (chin->frame >= views[chin->view].loops[chin->loop].numFrames))
+    {
+        return false;
+    }
+
+    int sppic=views[chin->view].loops[chin->loop].frames[chin->frame].pic;
+    int usewid = charextra[cc].width;
+    int usehit = charextra[cc].height;
+    if (usewid==0) usewid=spritewidth[sppic];
+    if (usehit==0) usehit=spriteheight[sppic];
+    *x = chin->x - divide_down_coordinate(usewid) / 2;
+    *y = chin->get_effective_y() - divide_down_coordinate(usehit);
+    *width = divide_down_coordinate(usewid);
+    *height = divide_down_coordinate(usehit);
+    // is_pos_in_sprite takes the size of the image in this case
+    if ((*width == 0) || (*height == 0)) {
+        Bitmap *theImage = GetCharacterImage(cc, NULL);
+        if (*width == 0) *width = divide_down_coordinate(theImage->GetWidth()) - 1;
+        if (*height == 0) *height = divide_down_coordinate(theImage->GetHeight()) - 1;
+    }
+    return true;
+}
 
-        sppic=views[chin->view].loops[chin->loop].frames[chin->frame].pic;
-        int usewid = charextra[cc].width;
-        int usehit = charextra[cc].height;
-        if (usewid==0) usewid=spritewidth[sppic];
-        if (usehit==0) usehit=spriteheight[sppic];
-        int xxx = chin->x - divide_down_coordinate(usewid) / 2;
-        int yyy = chin->get_effective_y() - divide_down_coordinate(usehit);
+int is_pos_on_character(int xx,int yy) {
+    int cc,lowestyp=0,lowestwas=-1;
+    static std::vector<int> candidates;
+    const bool use_candidates = get_hit_test_candidates(kHitTest_Character, xx, yy, candidates);
+    const int count = use_candidates ? (int)candidates.size() : game.numcharacters;
+    for (int i = 0; i < count; i++) {
+        cc = use_candidates ? candidates[i] : i;
+        int xxx, yyy, wid, hit;
+        if (!get_character_hit_rect(cc, &xxx, &yyy, &wid, &hit))
+            continue;
+        // get the image only if the point is within the character's bounds
+        if (isposinbox(xx, yy, xxx, yyy, xxx + wid, yyy + hit) == FALSE)
+            continue;
 
+        CharacterInfo*chin=&game.chars[cc];
         int mirrored = views[chin->view].loops[chin->loop].frames[chin->frame].flags & VFLG_FLIPSPRITE;
         Bitmap *theImage = GetCharacterImage(cc, &mirrored);
 
-        if (is_pos_in_sprite(xx,yy,xxx,yyy, theImage,
-            divide_down_coordinate(usewid),
-            divide_down_coordinate(usehit), mirrored) == FALSE)
+        if (is_pos_in_sprite(xx,yy,xxx,yyy, theImage, wid, hit, mirrored) == FALSE)
             continue;
 
         int use_base = chin->get_baseline();
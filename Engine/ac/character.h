@@ -161,6 +161,9 @@ using namespace AGS; // FIXME later
 
 void animate_character(CharacterInfo *chap, int loopn,int sppd,int rept, int noidleoverride, int direction);
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
+// Walks the follower towards its leader, reusing a route found nearby
+// within the given distance if there's one
+void walk_character_to_leader(int chac, int tox, int toy, int share_radius);
 int  find_looporder_index (int curloop);
 // returns 0 to use diagonal, 1 to not
 int  useDiagonal (CharacterInfo *char1);
@@ -183,6 +186,9 @@ void animate_character(CharacterInfo *chap, int loopn,int sppd,int rept, int noi
 void CheckViewFrameForCharacter(CharacterInfo *chi);
 Common::Bitmap *GetCharacterImage(int charid, int *isFlipped);
 CharacterInfo *GetCharacterAtLocation(int xx, int yy);
+// Gets the rectangle in the room where the character may be clicked on;
+// returns false if it may not be clicked on at all
+bool get_character_hit_rect(int charid, int *x, int *y, int *width, int *height);
 int is_pos_on_character(int xx,int yy);
 void get_char_blocking_rect(int charid, int *x1, int *y1, int *width, int *y2);
 // Check whether the source char has walked onto character ww
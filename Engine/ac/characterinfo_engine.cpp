@@ -19,6 +19,7 @@
 #include "media/audio/audiodefines.h"
 #include "ac/character.h"
 #include "ac/characterextras.h"
+#include "ac/draw.h"
 #include "ac/gamestate.h"
 #include "ac/global_character.h"
 #include "ac/math.h"
@@ -453,8 +454,9 @@ void CharacterInfo::update_character_follower(int &aa, int &numSheep, int *follo
         // make sure he's not standing on top of the other man
         if (goxoffs < 0) goxoffs-=distaway;
         else goxoffs+=distaway;
-        walk_character(aa,game.chars[following].x + goxoffs,
-          game.chars[following].y + (Random(50)-25),0, true);
+        // the leader has likely come here by the route the follower needs
+        walk_character_to_leader(aa,game.chars[following].x + goxoffs,
+          game.chars[following].y + (Random(50)-25), convert_to_low_res(distaway + 50));
         doing_nothing = 0;
       }
     }
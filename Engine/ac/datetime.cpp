@@ -14,11 +14,30 @@
 
 #include <time.h>
 #include "ac/datetime.h"
+#include "ac/record.h"
+#include "ac/timer.h"
 #include "platform/base/agsplatformdriver.h"
 #include "script/runtimescriptvalue.h"
 
 ScriptDateTime* DateTime_Now_Core() {
     ScriptDateTime *sdt = new ScriptDateTime();
+
+    if (is_timer_unthrottled() || is_replay_active())
+    {
+        // the game's clock is running faster than the real one, or has
+        // to be the same as during the replay recording
+        time_t game_time = rec_get_time();
+        sdt->rawUnixTime = game_time;
+        struct tm *newtime = localtime(&game_time);
+        sdt->hour = newtime->tm_hour;
+        sdt->minute = newtime->tm_min;
+        sdt->second = newtime->tm_sec;
+        sdt->day = newtime->tm_mday;
+        sdt->month = newtime->tm_mon + 1;
+        sdt->year = newtime->tm_year + 1900;
+        return sdt;
+    }
+
     sdt->rawUnixTime = time(NULL);
 
     platform->GetSystemTime(sdt);
@@ -39,6 +39,7 @@
 #include "ac/screenoverlay.h"
 #include "ac/spritelistentry.h"
 #include "ac/string.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/viewport.h"
 #include "ac/walkablearea.h"
@@ -57,7 +58,11 @@
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "gfx/blender_simd.h"
+#include "gfx/spritetinter.h"
+#include "gfx/spritetransformcache.h"
 #include "main/graphics_mode.h"
+#include "util/math.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -82,6 +87,7 @@ extern AGSPlatformDriver *platform;
 extern roomstruct thisroom;
 extern char noWalkBehindsAtAll;
 extern unsigned int loopcounter;
+extern volatile unsigned long globalTimerCounter;
 extern char *walkBehindExists;  // whether a WB area is in this column
 extern int *walkBehindStartY, *walkBehindEndY;
 extern int walkBehindLeft[MAX_OBJ], walkBehindTop[MAX_OBJ];
@@ -90,6 +96,8 @@ extern IDriverDependantBitmap *walkBehindBitmap[MAX_OBJ];
 extern int walkBehindsCachedForBgNum;
 extern WalkBehindMethodEnum walkBehindMethod;
 extern int walk_behind_baselines_changed;
+extern std::vector<WalkBehindSpan> walkBehindSpans;
+extern std::vector<int> walkBehindRowSpans;
 extern int spritewidth[MAX_SPRITES],spriteheight[MAX_SPRITES];
 extern SpriteCache spriteset;
 extern RoomStatus*croom;
@@ -177,6 +185,10 @@ Bitmap *debugConsoleBuffer = NULL;
 int screen_is_dirty = 0;
 
 Bitmap *raw_saved_screen = NULL;
+// Shared scaled/flipped/tinted variants of character and object sprites
+SpriteTransformCache spriteTransformCache;
+// Tint and light level processing for character and object sprites
+SpriteTinter spriteTinter;
 Bitmap *dynamicallyCreatedSurfaces[MAX_DYNAMIC_SURFACES];
 
 
@@ -565,6 +577,12 @@ int combine_new_rect(InvalidRect *r1, InvalidRect *r2) {
 }
 
 void invalidate_rect(int x1, int y1, int x2, int y2) {
+    if (gfxDriver->UsesDamageTracking()) {
+        // renderer reconstructs changed regions itself
+        gfxDriver->InvalidateRect(Rect(x1, y1, x2, y2));
+        return;
+    }
+
     if (numDirtyRegions >= MAXDIRTYREGIONS) {
         // too many invalid rectangles, just mark the whole thing dirty
         numDirtyRegions = WHOLESCREENDIRTY;
@@ -664,6 +682,9 @@ void invalidate_rect(int x1, int y1, int x2, int y2) {
 
 
 void invalidate_sprite(int x1, int y1, IDriverDependantBitmap *pic) {
+    // renderer with damage tracking already knows where sprites are
+    if (gfxDriver->UsesDamageTracking())
+        return;
     invalidate_rect(x1, y1, x1 + pic->GetWidth(), y1 + pic->GetHeight());
 }
 
@@ -675,6 +696,7 @@ void draw_and_invalidate_text(Bitmap *ds, int x1, int y1, int font, color_t text
 void invalidate_screen() {
     // mark the whole screen dirty
     numDirtyRegions = WHOLESCREENDIRTY;
+    gfxDriver->InvalidateScreen();
 }
 
 // ** dirty rectangle system end **
@@ -763,11 +785,23 @@ void clear_letterbox_borders() {
 
 }
 
+// Tells if the frame needs not be drawn, because nobody is going to see it
+static bool is_frame_skipped()
+{
+    if (play.fast_forward || gfxDriver->SkipsRendering())
+        return true;
+    // unthrottled game only draws every Nth tick
+    if (is_timer_unthrottled())
+        return usetup.unthrottled_render_interval <= 0 ||
+            (globalTimerCounter % usetup.unthrottled_render_interval) != 0;
+    return false;
+}
+
 // writes the virtual screen to the screen, converting colours if
 // necessary
 void write_screen() {
 
-    if (play.fast_forward)
+    if (is_frame_skipped())
         return;
 
     static int wasShakingScreen = 0;
@@ -789,6 +823,12 @@ void write_screen() {
         }
     }
 
+    // plugins may draw anything right on the screen, so the renderer can't
+    // tell which parts have changed
+    if (gfxDriver->UsesDamageTracking() &&
+        pl_any_want_hook(AGSE_PRESCREENDRAW | AGSE_PREGUIDRAW | AGSE_POSTSCREENDRAW | AGSE_FINALSCREENDRAW))
+        invalidate_screen();
+
     if (play.screen_tint < 1)
         gfxDriver->SetScreenTint(0, 0, 0);
     else
@@ -871,6 +911,57 @@ void invalidate_cached_walkbehinds()
     memset(&actspswbcache[0], 0, sizeof(CachedActSpsData) * actSpsCount);
 }
 
+void invalidate_sprite_transforms(int sppic)
+{
+    spriteTransformCache.InvalidateSprite(sppic);
+}
+
+// Applies walk-behind mask to the sprite, within the room area [x1, x2) x [y1, y2)
+// which is already clipped to both sprite and room bounds. The per-row
+// walk-behind runs are intersected with that range and each run is applied
+// as a contiguous row operation.
+template <int BPP>
+static int apply_walk_behind_spans(Bitmap *sprit, int xx, int yy, int x1, int x2, int y1, int y2,
+                                   const bool *inFront, uint32_t maskcol,
+                                   Bitmap *copyPixelsFrom, Bitmap *checkPixelsFrom, int zoom, const int *zoomX)
+{
+    typedef WalkBehindPixel<BPP> Px;
+    const WalkBehindSpan *spans = &walkBehindSpans[0];
+    int pixelsChanged = 0;
+    for (int y = y1; y < y2; ++y)
+    {
+        const int span_end = walkBehindRowSpans[y + 1];
+        int i = walkBehindRowSpans[y];
+        if (i == span_end)
+            continue;
+        uint8_t *dst = sprit->GetScanLineForWriting(y - yy);
+        const uint8_t *bg = copyPixelsFrom ? copyPixelsFrom->GetScanLine(y) : NULL;
+        const uint8_t *check = copyPixelsFrom ? checkPixelsFrom->GetScanLine(((y - yy) * 100) / zoom) : NULL;
+
+        for (; i < span_end; ++i)
+        {
+            const WalkBehindSpan &span = spans[i];
+            if (span.X1 >= x2)
+                break;
+            if (span.X2 <= x1 || !inFront[span.Area])
+                continue;
+            const int sx1 = Math::Max(span.X1, x1) - xx;
+            const int sx2 = Math::Min(span.X2, x2) - xx;
+
+            if (!copyPixelsFrom)
+            {
+                Px::Fill(dst, sx1, sx2, maskcol);
+                pixelsChanged = 1;
+            }
+            else
+            {
+                pixelsChanged |= copy_walk_behind_run<BPP>(dst, bg, check, sx1, sx2, xx, maskcol, zoomX);
+            }
+        }
+    }
+    return pixelsChanged;
+}
+
 // sort_out_walk_behinds: modifies the supplied sprite by overwriting parts
 // of it with transparent pixels where there are walk-behind areas
 // Returns whether any pixels were updated
@@ -882,114 +973,55 @@ int sort_out_walk_behinds(Bitmap *sprit,int xx,int yy,int basel, Bitmap *copyPix
         (!sprit->IsMemoryBitmap()))
         quit("!sort_out_walk_behinds: wb bitmap not linear");
 
-    int rr,tmm, toheight;//,tcol;
-    // precalculate this to try and shave some time off
-    int maskcol = sprit->GetMaskColor();
     int spcoldep = sprit->GetColorDepth();
-    int screenhit = thisroom.object->GetHeight();
-    short *shptr, *shptr2;
-    int *loptr, *loptr2;
-    int pixelsChanged = 0;
-    int ee = 0;
-    if (xx < 0)
-        ee = 0 - xx;
-
     if ((checkPixelsFrom != NULL) && (checkPixelsFrom->GetColorDepth() != spcoldep))
         quit("sprite colour depth does not match background colour depth");
 
-    for ( ; ee < sprit->GetWidth(); ee++) {
-        if (ee + xx >= thisroom.object->GetWidth())
-            break;
+    // Find out which areas are in front of this baseline first, so that
+    // the per-pixel work does not have to look them up
+    bool inFront[MAX_OBJ];
+    bool anyInFront = false;
+    inFront[0] = false;
+    for (int area = 1; area < MAX_OBJ; ++area)
+    {
+        inFront[area] = croom->walkbehind_base[area] > basel;
+        anyInFront |= inFront[area];
+    }
+    if (!anyInFront)
+        return 0;
 
-        if ((!walkBehindExists[ee+xx]) ||
-            (walkBehindEndY[ee+xx] <= yy) ||
-            (walkBehindStartY[ee+xx] > yy+sprit->GetHeight()))
-            continue;
+    const int x1 = Math::Max(xx, 0);
+    const int x2 = Math::Min(xx + sprit->GetWidth(), thisroom.object->GetWidth());
+    const int y1 = Math::Max(yy, 0);
+    const int y2 = Math::Min(yy + sprit->GetHeight(), thisroom.object->GetHeight());
+    if (x1 >= x2 || y1 >= y2)
+        return 0;
 
-        toheight = sprit->GetHeight();
+    // Column lookup for the scaled check sprite, to avoid divisions per pixel
+    std::vector<int> zoomX;
+    if (copyPixelsFrom != NULL && zoom != 100)
+    {
+        zoomX.resize(sprit->GetWidth());
+        for (int x = 0; x < sprit->GetWidth(); ++x)
+            zoomX[x] = (x * 100) / zoom;
+    }
+    const int *zoomXPtr = zoomX.empty() ? NULL : &zoomX[0];
 
-        if (walkBehindStartY[ee+xx] < yy)
-            rr = 0;
-        else
-            rr = (walkBehindStartY[ee+xx] - yy);
-
-        // Since we will use _getpixel, ensure we only check within the screen
-        if (rr + yy < 0)
-            rr = 0 - yy;
-        if (toheight + yy > screenhit)
-            toheight = screenhit - yy;
-        if (toheight + yy > walkBehindEndY[ee+xx])
-            toheight = walkBehindEndY[ee+xx] - yy;
-        if (rr < 0)
-            rr = 0;
-
-        for ( ; rr < toheight;rr++) {
-
-            // we're ok with _getpixel because we've checked the screen edges
-            //tmm = _getpixel(thisroom.object,ee+xx,rr+yy);
-            // actually, _getpixel is well inefficient, do it ourselves
-            // since we know it's 8-bit bitmap
-            tmm = thisroom.object->GetScanLine(rr+yy)[ee+xx];
-            if (tmm<1) continue;
-            if (croom->walkbehind_base[tmm] <= basel) continue;
-
-            if (copyPixelsFrom != NULL)
-            {
-                if (spcoldep <= 8)
-                {
-                    if (checkPixelsFrom->GetScanLine((rr * 100) / zoom)[(ee * 100) / zoom] != maskcol) {
-                        sprit->GetScanLineForWriting(rr)[ee] = copyPixelsFrom->GetScanLine(rr + yy)[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr2 = (short*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (shptr2[(ee * 100) / zoom] != maskcol) {
-                        shptr[ee] = ((short*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    char *chptr2 = (char*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (memcmp(&chptr2[((ee * 100) / zoom) * 3], &maskcol, 3) != 0) {
-                        memcpy(&chptr[ee * 3], &copyPixelsFrom->GetScanLine(rr + yy)[(ee + xx) * 3], 3);
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr2 = (int*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (loptr2[(ee * 100) / zoom] != maskcol) {
-                        loptr[ee] = ((int*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-            }
-            else
-            {
-                pixelsChanged = 1;
-                if (spcoldep <= 8)
-                    sprit->GetScanLineForWriting(rr)[ee] = maskcol;
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr[ee] = maskcol;
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    memcpy(&chptr[ee * 3], &maskcol, 3);
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr[ee] = maskcol;
-                }
-                else
-                    quit("!Sprite colour depth >32 ??");
-            }
-        }
+    const uint32_t maskcol = sprit->GetMaskColor();
+    switch ((spcoldep + 7) / 8)
+    {
+    case 1:
+        return apply_walk_behind_spans<1>(sprit, xx, yy, x1, x2, y1, y2, inFront, maskcol, copyPixelsFrom, checkPixelsFrom, zoom, zoomXPtr);
+    case 2:
+        return apply_walk_behind_spans<2>(sprit, xx, yy, x1, x2, y1, y2, inFront, maskcol, copyPixelsFrom, checkPixelsFrom, zoom, zoomXPtr);
+    case 3:
+        return apply_walk_behind_spans<3>(sprit, xx, yy, x1, x2, y1, y2, inFront, maskcol, copyPixelsFrom, checkPixelsFrom, zoom, zoomXPtr);
+    case 4:
+        return apply_walk_behind_spans<4>(sprit, xx, yy, x1, x2, y1, y2, inFront, maskcol, copyPixelsFrom, checkPixelsFrom, zoom, zoomXPtr);
+    default:
+        quit("!Sprite colour depth >32 ??");
     }
-    return pixelsChanged;
+    return 0;
 }
 
 void sort_out_char_sprite_walk_behind(int actspsIndex, int xx, int yy, int basel, int zoom, int width, int height)
@@ -1114,11 +1146,14 @@ void draw_gui_sprite(Bitmap *ds, int pic, int x, int y, bool use_alpha, BlendMod
     // Backwards-compatible drawing
     else if (use_alpha && ds_has_alpha && game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_AdditiveAlpha)
     {
-        if (src_has_alpha)
-            set_additive_alpha_blender();
-        else
-            set_opaque_alpha_blender();
-        ds->TransBlendBlt(sprite, x, y);
+        if (!src_has_alpha || !RowBlend::DrawBlended(ds, sprite, x, y, RowBlend::kBlendRow_Additive))
+        {
+            if (src_has_alpha)
+                set_additive_alpha_blender();
+            else
+                set_opaque_alpha_blender();
+            ds->TransBlendBlt(sprite, x, y);
+        }
     }
     else
     {
@@ -1315,17 +1350,28 @@ void apply_tint_or_light(int actspsindex, int light_level,
 
  // we can only do tint/light if the colour depths match
  if (ScreenResolution.ColorDepth == actsps[actspsindex]->GetColorDepth()) {
+     Bitmap *active_spr = actsps[actspsindex];
      Bitmap *oldwas;
      // if the caller supplied a source bitmap, ->Blit from it
      // (used as a speed optimisation where possible)
-     if (blitFrom) 
+     if (blitFrom) {
          oldwas = blitFrom;
+         // batched tinting is done later, when the sprite cache might have
+         // already freed the source sprite; so tint a copy of it in place
+         if (spriteTinter.IsBatching() && SpriteTinter::IsSupported(active_spr, blitFrom)) {
+             active_spr->Blit(blitFrom, 0, 0, 0, 0, active_spr->GetWidth(), active_spr->GetHeight());
+             oldwas = active_spr;
+         }
+     }
+     // the tinter does not need a separate target
+     else if (SpriteTinter::IsSupported(active_spr, active_spr))
+         oldwas = active_spr;
      // otherwise, make a new target bmp
      else {
-         oldwas = actsps[actspsindex];
+         oldwas = active_spr;
          actsps[actspsindex] = BitmapHelper::CreateBitmap(oldwas->GetWidth(), oldwas->GetHeight(), coldept);
+         active_spr = actsps[actspsindex];
      }
-     Bitmap *active_spr = actsps[actspsindex];
 
      if (tint_amount) {
          // It is an RGB tint
@@ -1337,7 +1383,6 @@ void apply_tint_or_light(int actspsindex, int light_level,
          // to LitBlendBlt defines how much it will be darkened/lightened by.
          
          int lit_amnt;
-         active_spr->FillTransparent();
          // It's a light level, not a tint
          if (game.color_depth == 1) {
              // 256-col
@@ -1352,10 +1397,17 @@ void apply_tint_or_light(int actspsindex, int light_level,
              lit_amnt = abs(light_level) * 2;
          }
 
-         active_spr->LitBlendBlt(oldwas, 0, 0, lit_amnt);
+         if (SpriteTinter::IsSupported(active_spr, oldwas)) {
+             const int lit_col = (light_level < 0) ? 8 : 248;
+             spriteTinter.Light(active_spr, oldwas, makecol32(lit_col, lit_col, lit_col), lit_amnt);
+         }
+         else {
+             active_spr->FillTransparent();
+             active_spr->LitBlendBlt(oldwas, 0, 0, lit_amnt);
+         }
      }
 
-     if (oldwas != blitFrom)
+     if (oldwas != blitFrom && oldwas != active_spr)
          delete oldwas;
 
  }
@@ -1368,6 +1420,12 @@ void apply_tint_or_light(int actspsindex, int light_level,
 
 }
 
+// Tells if the sprite will be anti-aliased when scaled
+bool is_sprite_antialiased(int sppic)
+{
+    return (IS_ANTIALIAS_SPRITES) && ((game.spriteflags[sppic] & SPF_ALPHACHANNEL) == 0);
+}
+
 // Draws the specified 'sppic' sprite onto actsps[useindx] at the
 // specified width and height, and flips the sprite if necessary.
 // Returns 1 if something was drawn to actsps; returns 0 if no
@@ -1393,20 +1451,19 @@ int scale_and_flip_sprite(int useindx, int coldept, int zoom_level,
           select_palette (palette);
 
 
-      if (isMirrored) {
+      if (!is_sprite_antialiased(sppic)) {
+          // stretch and flip in one pass, without a temporary bitmap
+          SpriteTransformCache::StretchAndFlip(active_spr, spriteset[sppic], isMirrored != 0);
+      }
+      else if (isMirrored) {
           Bitmap *tempspr = BitmapHelper::CreateBitmap(newwidth, newheight,coldept);
           tempspr->Fill (actsps[useindx]->GetMaskColor());
-          if ((IS_ANTIALIAS_SPRITES) && ((game.spriteflags[sppic] & SPF_ALPHACHANNEL) == 0))
-              tempspr->AAStretchBlt (spriteset[sppic], RectWH(0, 0, newwidth, newheight), Common::kBitmap_Transparency);
-          else
-              tempspr->StretchBlt (spriteset[sppic], RectWH(0, 0, newwidth, newheight), Common::kBitmap_Transparency);
+          tempspr->AAStretchBlt (spriteset[sppic], RectWH(0, 0, newwidth, newheight), Common::kBitmap_Transparency);
           active_spr->FlipBlt(tempspr, 0, 0, Common::kBitmap_HFlip);
           delete tempspr;
       }
-      else if ((IS_ANTIALIAS_SPRITES) && ((game.spriteflags[sppic] & SPF_ALPHACHANNEL) == 0))
-          active_spr->AAStretchBlt(spriteset[sppic],RectWH(0,0,newwidth,newheight), Common::kBitmap_Transparency);
       else
-          active_spr->StretchBlt(spriteset[sppic],RectWH(0,0,newwidth,newheight), Common::kBitmap_Transparency);
+          active_spr->AAStretchBlt(spriteset[sppic],RectWH(0,0,newwidth,newheight), Common::kBitmap_Transparency);
 
       /*  AASTR2 version of code (doesn't work properly, gives black borders)
       if (IS_ANTIALIAS_SPRITES) {
@@ -1450,6 +1507,159 @@ int scale_and_flip_sprite(int useindx, int coldept, int zoom_level,
 
 
 
+// Character images tinted during the batch; when the batch ends they are
+// put into the transform cache, or copied from the character which had the
+// same image tinted
+struct PendingTint
+{
+    SpriteTransformKey Key;
+    int Index;
+    int CopyFrom;
+};
+static std::vector<PendingTint> pendingTints;
+
+// Starts batching the tinting of character sprites, so that they are
+// tinted all at once, possibly in parallel
+static void begin_tint_batch()
+{
+    pendingTints.clear();
+    spriteTinter.BeginBatch();
+}
+
+// Finishes the tinting started by begin_tint_batch, and stores the results
+static void end_tint_batch()
+{
+    spriteTinter.EndBatch();
+    for (size_t i = 0; i < pendingTints.size(); ++i)
+    {
+        const PendingTint &pending = pendingTints[i];
+        Bitmap *image = actsps[pending.Index];
+        if (pending.CopyFrom >= 0)
+            image->Blit(actsps[pending.CopyFrom], 0, 0, 0, 0, image->GetWidth(), image->GetHeight());
+        else if (spriteTransformCache.IsEnabled())
+            spriteTransformCache.Put(pending.Key, BitmapHelper::CreateBitmapCopy(image));
+    }
+    pendingTints.clear();
+}
+
+// Draws the specified 'sppic' sprite onto actsps[useindx] scaled, flipped,
+// tinted or lit as requested. The results are kept in the shared transform
+// cache, so that other characters and objects using the same frame at the
+// same size and tint do not have to redo the transformation.
+void draw_transformed_sprite(int useindx, int coldept, int zoom_level,
+                             int sppic, int newwidth, int newheight, int isMirrored,
+                             int light_level, int tint_amount, int tint_red,
+                             int tint_green, int tint_blue, int tint_light)
+{
+    const bool tinted = (light_level != 0) || (tint_amount != 0);
+    const bool scaled_or_flipped = (zoom_level != 100) || (isMirrored != 0);
+    // 8-bit results depend on the palette, which may change at any time
+    const bool use_cache = spriteTransformCache.IsEnabled() && (coldept > 8);
+    const bool batched = tinted && spriteTinter.IsBatching() && (coldept > 8);
+
+    SpriteTransformKey key(sppic, newwidth, newheight, isMirrored != 0,
+        (zoom_level != 100) && is_sprite_antialiased(sppic));
+    SpriteTransformKey tint_key = key;
+    tint_key.TintAmount = tint_amount;
+    tint_key.TintRed = tint_red;
+    tint_key.TintGreen = tint_green;
+    tint_key.TintBlue = tint_blue;
+    tint_key.TintLight = tint_light;
+    tint_key.LightLevel = light_level;
+
+    Bitmap *cached = NULL;
+    bool tint_cached = false;
+    if (use_cache && tinted)
+    {
+        cached = spriteTransformCache.Get(tint_key);
+        tint_cached = (cached != NULL);
+    }
+    if (batched && !cached)
+    {
+        // if the same image is being tinted for another character, then
+        // simply copy it when the batch is done
+        for (size_t i = 0; i < pendingTints.size(); ++i)
+        {
+            const PendingTint &pending = pendingTints[i];
+            if ((pending.CopyFrom >= 0) || (pending.Key < tint_key) || (tint_key < pending.Key))
+                continue;
+            actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, newwidth, newheight);
+            PendingTint copy = { tint_key, useindx, pending.Index };
+            pendingTints.push_back(copy);
+            return;
+        }
+    }
+    if (use_cache && !cached && scaled_or_flipped)
+        cached = spriteTransformCache.Get(key);
+
+    int actspsUsed;
+    if (cached)
+    {
+        actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, newwidth, newheight);
+        actsps[useindx]->Blit(cached, 0, 0, 0, 0, newwidth, newheight);
+        if (tint_cached)
+            return;
+        actspsUsed = 1;
+    }
+    else
+    {
+        actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
+            sppic, newwidth, newheight, isMirrored);
+        if (use_cache && actspsUsed)
+            spriteTransformCache.Put(key, BitmapHelper::CreateBitmapCopy(actsps[useindx]));
+    }
+
+    if (tinted)
+    {
+        // if possible, direct read from the source image
+        apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
+            tint_green, tint_blue, tint_light, coldept,
+            actspsUsed ? NULL : spriteset[sppic]);
+        if (batched)
+        {
+            PendingTint pending = { tint_key, useindx, -1 };
+            pendingTints.push_back(pending);
+        }
+        else if (use_cache)
+            spriteTransformCache.Put(tint_key, BitmapHelper::CreateBitmapCopy(actsps[useindx]));
+    }
+    else if (!actspsUsed)
+    {
+        // no scaling, flipping or tinting was done, so just blit it normally
+        actsps[useindx]->Blit(spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
+    }
+}
+
+// Lets the prefilter threads scale the next frame of the animation in
+// advance, while the current one is displayed
+void prefilter_next_frame(int view, int loop, int frame, int zoom_level)
+{
+    if (!spriteTransformCache.IsPrefiltering() || (gfxDriver->HasAcceleratedStretchAndFlip()))
+        return;
+    if ((view < 0) || (views[view].loops[loop].numFrames <= 0))
+        return;
+
+    ViewLoopNew &vloop = views[view].loops[loop];
+    const ViewFrame &vframe = vloop.frames[(frame + 1) % vloop.numFrames];
+    const int sppic = vframe.pic;
+    const bool isMirrored = (vframe.flags & VFLG_FLIPSPRITE) != 0;
+    if ((zoom_level == 100) && (!isMirrored))
+        return;
+    if ((zoom_level != 100) && is_sprite_antialiased(sppic))
+        return; // anti-aliasing is done by Allegro, which is not thread-safe
+
+    Bitmap *sprite = spriteset[sppic];
+    if ((sprite == NULL) || (sprite->GetColorDepth() <= 8))
+        return;
+    int newwidth = spritewidth[sppic];
+    int newheight = spriteheight[sppic];
+    if (zoom_level != 100)
+        scale_sprite_size(sppic, zoom_level, &newwidth, &newheight);
+    spriteTransformCache.Prefilter(SpriteTransformKey(sppic, newwidth, newheight, isMirrored, false), sprite);
+}
+
+
+
 // create the actsps[aa] image with the object drawn correctly
 // returns 1 if nothing at all has changed and actsps is still
 // intact from last time; 0 otherwise
@@ -1588,34 +1798,17 @@ int construct_object_gfx(int aa, int *drawnWidth, int *drawnHeight, bool alwaysU
 
     // Not cached, so draw the image
 
-    int actspsUsed = 0;
     if (!hardwareAccelerated)
     {
-        // draw the base sprite, scaled and flipped as appropriate
-        actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
-            objs[aa].num, sprwidth, sprheight, isMirrored);
+        // draw the base sprite, scaled, flipped and tinted as appropriate
+        draw_transformed_sprite(useindx, coldept, zoom_level,
+            objs[aa].num, sprwidth, sprheight, isMirrored,
+            light_level, tint_level, tint_red, tint_green, tint_blue, tint_light);
     }
     else
     {
-        // ensure actsps exists
+        // ensure actsps exists, and copy the source bitmap
         actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, spritewidth[objs[aa].num], spriteheight[objs[aa].num]);
-    }
-
-    // direct read from source bitmap, where possible
-    Bitmap *comeFrom = NULL;
-    if (!actspsUsed)
-        comeFrom = spriteset[objs[aa].num];
-
-    // apply tints or lightenings where appropriate, else just copy
-    // the source bitmap
-    if (((tint_level > 0) || (light_level != 0)) &&
-        (!hardwareAccelerated))
-    {
-        apply_tint_or_light(useindx, light_level, tint_level, tint_red,
-            tint_green, tint_blue, tint_light, coldept,
-            comeFrom);
-    }
-    else if (!actspsUsed) {
         actsps[useindx]->Blit(spriteset[objs[aa].num],0,0,0,0,spritewidth[objs[aa].num],spriteheight[objs[aa].num]);
     }
 
@@ -1661,6 +1854,9 @@ void prepare_objects_for_drawing() {
         objcache[aa].xwas = objs[aa].x;
         objcache[aa].ywas = objs[aa].y;
 
+        if (objs[aa].cycling)
+            prefilter_next_frame(objs[aa].view, objs[aa].loop, objs[aa].frame, objs[aa].last_zoom);
+
         atxp = multiply_up_coordinate(objs[aa].x) - offsetx;
         atyp = (multiply_up_coordinate(objs[aa].y) - tehHeight) - offsety;
 
@@ -1731,6 +1927,18 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
             return;
     }
 
+    if (SpriteTinter::IsSupported(ds, srcimg)) {
+        // the colourising blender only depends on the pixel's value, so
+        // make a table of its results and tint whole rows at once
+        uint32_t tint_table[256];
+        make_tint_table32(tint_table, red, grn, blu, luminance);
+        int amount = -1; // fully colourised
+        if (light_level < 100)
+            amount = Math::Max(0, (light_level * 25) / 10);
+        spriteTinter.Tint(ds, srcimg, tint_table, amount);
+        return;
+    }
+
     // For performance reasons, we have a seperate blender for
     // when light is being adjusted and when it is not.
     // If luminance >= 250, then normal brightness, otherwise darken
@@ -1766,13 +1974,32 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
 
 
 
+// Character drawing parameters, gathered by the first pass of
+// prepare_characters_for_drawing for use in the second one
+struct CharDrawInfo
+{
+    int  Index;
+    int  SpriteNum;
+    int  X, Y;
+    int  Width, Height;
+    int  ColorDepth;
+    int  Mirrored;
+    bool Redrawn;
+    bool UsingCachedImage;
+    int  TintRed, TintGreen, TintBlue, TintAmount, TintLight, LightLevel;
+};
+static std::vector<CharDrawInfo> charsToDraw;
+
 void prepare_characters_for_drawing() {
     int zoom_level,newwidth,newheight,onarea,sppic,atxp,atyp,useindx;
     int light_level,coldept,aa;
     int tint_red, tint_green, tint_blue, tint_amount, tint_light = 255;
 
     our_eip=33;
-    // draw characters
+    // First pass sorts out the images of all characters; tinting is batched
+    // so that several characters may be tinted at the same time
+    charsToDraw.clear();
+    begin_tint_batch();
     for (aa=0;aa<game.numcharacters;aa++) {
         if (game.chars[aa].on==0) continue;
         if (game.chars[aa].room!=displayed_room) continue;
@@ -1909,6 +2136,9 @@ void prepare_characters_for_drawing() {
 
         our_eip = 3336;
 
+        if ((chin->walking) || (chin->animating))
+            prefilter_next_frame(chin->view, chin->loop, chin->frame, zoom_level);
+
         // Calculate the X & Y co-ordinates of where the sprite will be
         atxp=(multiply_up_coordinate(chin->x) - offsetx) - newwidth/2;
         atyp=(multiply_up_coordinate(chin->y) - newheight) - offsety;
@@ -1926,46 +2156,74 @@ void prepare_characters_for_drawing() {
         if (!charcache[aa].inUse) {
 
             // create the base sprite in actsps[useindx], which will
-            // be scaled and/or flipped, as appropriate
-            int actspsUsed = 0;
+            // be scaled, flipped and tinted as appropriate
             if (!gfxDriver->HasAcceleratedStretchAndFlip())
             {
-                actspsUsed = scale_and_flip_sprite(
-                    useindx, coldept, zoom_level, sppic,
-                    newwidth, newheight, isMirrored);
+                draw_transformed_sprite(useindx, coldept, zoom_level, sppic,
+                    newwidth, newheight, isMirrored, light_level, tint_amount,
+                    tint_red, tint_green, tint_blue, tint_light);
             }
             else 
             {
-                // ensure actsps exists
+                // ensure actsps exists, and blit the sprite normally
                 actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, spritewidth[sppic], spriteheight[sppic]);
+                actsps[useindx]->Blit (spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
             }
+        } // end if !cache.inUse
 
+        CharDrawInfo info;
+        info.Index = aa;
+        info.SpriteNum = sppic;
+        info.X = atxp;
+        info.Y = atyp;
+        info.Width = newwidth;
+        info.Height = newheight;
+        info.ColorDepth = coldept;
+        info.Mirrored = isMirrored;
+        info.Redrawn = !charcache[aa].inUse;
+        info.UsingCachedImage = usingCachedImage;
+        info.TintRed = tint_red;
+        info.TintGreen = tint_green;
+        info.TintBlue = tint_blue;
+        info.TintAmount = tint_amount;
+        info.TintLight = tint_light;
+        info.LightLevel = light_level;
+        charsToDraw.push_back(info);
+    }
+
+    end_tint_batch();
+
+    // Second pass finishes the characters with their final images
+    for (size_t i = 0; i < charsToDraw.size(); ++i) {
+        const CharDrawInfo &info = charsToDraw[i];
+        aa = info.Index;
+        eip_guinum = aa;
+        useindx = aa + MAX_INIT_SPR;
+        CharacterInfo*chin=&game.chars[aa];
+        sppic = info.SpriteNum;
+        atxp = info.X;
+        atyp = info.Y;
+        newwidth = info.Width;
+        newheight = info.Height;
+        coldept = info.ColorDepth;
+        const int isMirrored = info.Mirrored;
+        const bool usingCachedImage = info.UsingCachedImage;
+        tint_red = info.TintRed;
+        tint_green = info.TintGreen;
+        tint_blue = info.TintBlue;
+        tint_amount = info.TintAmount;
+        tint_light = info.TintLight;
+        light_level = info.LightLevel;
+
+        if (info.Redrawn) {
             our_eip = 335;
 
-            if (((light_level != 0) || (tint_amount != 0)) &&
-                (!gfxDriver->HasAcceleratedStretchAndFlip())) {
-                    // apply the lightening or tinting
-                    Bitmap *comeFrom = NULL;
-                    // if possible, direct read from the source image
-                    if (!actspsUsed)
-                        comeFrom = spriteset[sppic];
-
-                    apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
-                        tint_green, tint_blue, tint_light, coldept,
-                        comeFrom);
-            }
-            else if (!actspsUsed) {
-                // no scaling, flipping or tinting was done, so just blit it normally
-                actsps[useindx]->Blit (spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
-            }
-
             // update the character cache with the new image
             charcache[aa].inUse = 1;
             //charcache[aa].image = BitmapHelper::CreateBitmap_ (coldept, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
             charcache[aa].image = recycle_bitmap(charcache[aa].image, coldept, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
             charcache[aa].image->Blit (actsps[useindx], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
-
-        } // end if !cache.inUse
+        }
 
         int usebasel = chin->get_baseline();
 
@@ -2071,7 +2329,9 @@ void draw_screen_background(Bitmap *ds) {
     if (play.screen_tint >= 0)
         invalidate_screen();
 
-    if (gfxDriver->RequiresFullRedrawEachFrame())
+    // with damage tracking the renderer restores background itself,
+    // so it has to be passed as a sprite
+    if (gfxDriver->RequiresFullRedrawEachFrame() || gfxDriver->UsesDamageTracking())
     {
         if (roomBackgroundBmp == NULL) 
         {
@@ -2129,7 +2389,8 @@ void draw_fps()
 
     if (fpsDisplay == NULL)
     {
-        fpsDisplay = BitmapHelper::CreateBitmap(get_fixed_pixel_size(100), (wgetfontheight(FONT_SPEECH) + get_fixed_pixel_size(5)), ScreenResolution.ColorDepth);
+        // the line also holds loop counter, which is drawn further to the right
+        fpsDisplay = BitmapHelper::CreateBitmap(play.viewport.GetWidth() - 1, (wgetfontheight(FONT_SPEECH) + get_fixed_pixel_size(5)), ScreenResolution.ColorDepth);
         fpsDisplay = ReplaceBitmapWithSupportedFormat(fpsDisplay);
     }
     fpsDisplay->ClearTransparent();
@@ -2139,10 +2400,10 @@ void draw_fps()
     sprintf(tbuffer,"FPS: %d",fps);
     color_t text_color = fpsDisplay->GetCompatibleColor(14);
     wouttext_outline(fpsDisplay, 1, 1, FONT_SPEECH, text_color, tbuffer);
+    sprintf(tbuffer,"Loop %u", loopcounter);
+    wouttext_outline(fpsDisplay, get_fixed_pixel_size(250) - 1, 0, FONT_SPEECH, text_color, tbuffer);
     //ds = oldAbuf;
 
-    Bitmap *ds = GetVirtualScreen();
-
     if (ddb == NULL)
         ddb = gfxDriver->CreateDDBFromBitmap(fpsDisplay, false);
     else
@@ -2152,9 +2413,29 @@ void draw_fps()
 
     gfxDriver->DrawSprite(1, yp, ddb);
     invalidate_sprite(1, yp, ddb);
+}
 
-    sprintf(tbuffer,"Loop %u", loopcounter);
-    draw_and_invalidate_text(ds, get_fixed_pixel_size(250), yp, FONT_SPEECH, text_color, tbuffer);
+// Draws "REC" or "PLAY" line with the replay time
+void draw_replay_status(const char *text, int color)
+{
+    static IDriverDependantBitmap* ddb = NULL;
+    static Bitmap *replayDisplay = NULL;
+
+    if (replayDisplay == NULL)
+    {
+        replayDisplay = BitmapHelper::CreateBitmap(play.viewport.GetWidth() - get_fixed_pixel_size(5), (wgetfontheight(FONT_SPEECH) + get_fixed_pixel_size(1)), ScreenResolution.ColorDepth);
+        replayDisplay = ReplaceBitmapWithSupportedFormat(replayDisplay);
+    }
+    replayDisplay->ClearTransparent();
+    wouttext_outline(replayDisplay, 0, 0, FONT_SPEECH, replayDisplay->GetCompatibleColor(color), (char*)text);
+
+    if (ddb == NULL)
+        ddb = gfxDriver->CreateDDBFromBitmap(replayDisplay, false);
+    else
+        gfxDriver->UpdateDDBFromBitmap(ddb, replayDisplay, false);
+
+    gfxDriver->DrawSprite(get_fixed_pixel_size(5), get_fixed_pixel_size(10), ddb);
+    invalidate_sprite(get_fixed_pixel_size(5), get_fixed_pixel_size(10), ddb);
 }
 
 // draw_screen_overlay: draws any stuff currently on top of the background,
@@ -2321,24 +2602,19 @@ void draw_misc_info()
         draw_fps();
     }
 
-    Bitmap *ds = GetVirtualScreen();
-
-    color_t text_color;
     if (play.recording) {
         // Flash "REC" while recording
-        text_color = ds->GetCompatibleColor (12);
         //if ((loopcounter % (frames_per_second * 2)) > frames_per_second/2) {
         char tformat[30];
         sprintf (tformat, "REC %02d:%02d:%02d", replay_time / 3600, (replay_time % 3600) / 60, replay_time % 60);
-        draw_and_invalidate_text(ds, get_fixed_pixel_size(5), get_fixed_pixel_size(10), FONT_SPEECH, text_color, tformat);
+        draw_replay_status(tformat, 12);
         //}
     }
     else if (play.playback) {
-        text_color = ds->GetCompatibleColor (10);
         char tformat[30];
         sprintf (tformat, "PLAY %02d:%02d:%02d", replay_time / 3600, (replay_time % 3600) / 60, replay_time % 60);
 
-        draw_and_invalidate_text(ds, get_fixed_pixel_size(5), get_fixed_pixel_size(10), FONT_SPEECH, text_color, tformat);
+        draw_replay_status(tformat, 10);
     }
 
     our_eip = 1101;
@@ -2506,7 +2782,7 @@ void construct_virtual_screen(bool fullRedraw)
 {
     gfxDriver->ClearDrawList();
 
-    if (play.fast_forward)
+    if (is_frame_skipped())
         return;
 
     our_eip=3;
@@ -72,6 +72,7 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         if (sds->modified)
         {
             int tt;
+            invalidate_sprite_transforms(sds->dynamicSpriteNumber);
             // force a refresh of any cached object or character images
             if (croom != NULL) 
             {
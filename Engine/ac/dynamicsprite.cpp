@@ -13,10 +13,13 @@
 //=============================================================================
 
 #include <math.h>
+#include <map>
+#include <vector>
 #include "ac/dynamicsprite.h"
 #include "ac/common.h"
 #include "ac/charactercache.h"
 #include "ac/draw.h"
+#include "ac/game.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/global_dynamicsprite.h"
 #include "ac/global_game.h"
@@ -33,6 +36,7 @@
 #include "gfx/graphicsdriver.h"
 #include "script/runtimescriptvalue.h"
 #include "main/graphics_mode.h"
+#include "util/memorystream.h"
 
 using namespace Common;
 using namespace Engine;
@@ -51,6 +55,8 @@ extern Bitmap *virtual_screen;
 extern AGS::Engine::IGraphicsDriver *gfxDriver;
 
 char check_dynamic_sprites_at_exit = 1;
+// Serialized images of the restored dynamic sprites that were not used yet
+std::map<int, std::vector<uint8_t> > deferredSprites;
 
 // ** SCRIPT DYNAMIC SPRITE
 
@@ -169,6 +175,7 @@ void DynamicSprite_CopyTransparencyMask(ScriptDynamicSprite *sds, int sourceSpri
     }
 
     BitmapHelper::CopyTransparency(target, source, dst_has_alpha, src_has_alpha);
+    invalidate_sprite_transforms(sds->slot);
 }
 
 void DynamicSprite_ChangeCanvasSize(ScriptDynamicSprite *sds, int width, int height, int x, int y) 
@@ -474,6 +481,7 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
 void add_dynamic_sprite(int gotSlot, Bitmap *redin, bool hasAlpha) {
 
   spriteset.set(gotSlot, redin);
+  invalidate_sprite_transforms(gotSlot);
 
   game.spriteflags[gotSlot] = SPF_DYNAMICALLOC;
 
@@ -497,8 +505,13 @@ void free_dynamic_sprite (int gotSlot) {
   if ((game.spriteflags[gotSlot] & SPF_DYNAMICALLOC) == 0)
     quitprintf("!DeleteSprite: Attempted to free static sprite %d that was not loaded by the script", gotSlot);
 
-  delete spriteset[gotSlot];
+  // deferred sprite has no image to delete
+  if (spriteset.flags[gotSlot] & SPRCACHEFLAG_DEFERRED)
+    deferredSprites.erase(gotSlot);
+  else
+    delete spriteset[gotSlot];
   spriteset.set(gotSlot, NULL);
+  invalidate_sprite_transforms(gotSlot);
 
   game.spriteflags[gotSlot] = 0;
   spritewidth[gotSlot] = 0;
@@ -534,6 +547,60 @@ void free_dynamic_sprite (int gotSlot) {
   }
 }
 
+void add_deferred_dynamic_sprite(int gotSlot, int spriteflags, Stream *in) {
+  const int width = in->ReadInt32();
+  const int height = in->ReadInt32();
+  const int color_depth = in->ReadInt32();
+  // same amount of data as read_serialized_bitmap reads
+  int pixel_size = 0;
+  switch (color_depth) {
+    case 8:
+    case 15: pixel_size = 1; break;
+    case 16: pixel_size = 2; break;
+    case 32: pixel_size = 4; break;
+  }
+
+  // the data is kept in the same form, to be read as serialized bitmap
+  MemoryStream head;
+  head.WriteInt32(width);
+  head.WriteInt32(height);
+  head.WriteInt32(color_depth);
+  const size_t head_size = head.GetLength();
+  std::vector<uint8_t> &data = deferredSprites[gotSlot];
+  head.Swap(data);
+  data.resize(head_size + width * height * pixel_size);
+  if (data.size() > head_size)
+    in->Read(&data[head_size], data.size() - head_size);
+
+  spriteset.setDeferred(gotSlot);
+  invalidate_sprite_transforms(gotSlot);
+  game.spriteflags[gotSlot] = spriteflags;
+  spritewidth[gotSlot] = width;
+  spriteheight[gotSlot] = height;
+}
+
+Bitmap *load_deferred_dynamic_sprite(int gotSlot) {
+  std::map<int, std::vector<uint8_t> >::iterator it = deferredSprites.find(gotSlot);
+  if (it == deferredSprites.end())
+    return NULL;
+  MemoryStream in;
+  in.Swap(it->second);
+  deferredSprites.erase(it);
+  return read_serialized_bitmap(&in);
+}
+
+bool write_deferred_dynamic_sprite(int gotSlot, Stream *out) {
+  std::map<int, std::vector<uint8_t> >::const_iterator it = deferredSprites.find(gotSlot);
+  if (it == deferredSprites.end())
+    return false;
+  out->Write(&it->second[0], it->second.size());
+  return true;
+}
+
+void free_deferred_dynamic_sprites() {
+  deferredSprites.clear();
+}
+
 //=============================================================================
 //
 // Script API Functions
@@ -21,6 +21,8 @@
 #include "ac/dynobj/scriptdynamicsprite.h"
 #include "ac/dynobj/scriptdrawingsurface.h"
 
+namespace AGS { namespace Common { class Bitmap; class Stream; } }
+
 void	DynamicSprite_Delete(ScriptDynamicSprite *sds);
 ScriptDrawingSurface* DynamicSprite_GetDrawingSurface(ScriptDynamicSprite *dss);
 int		DynamicSprite_GetGraphic(ScriptDynamicSprite *sds);
@@ -47,5 +49,14 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
 
 void	add_dynamic_sprite(int gotSlot, Common::Bitmap *redin, bool hasAlpha = false);
 void	free_dynamic_sprite (int gotSlot);
+// Reads the serialized image of the restored dynamic sprite, which is only
+// turned into bitmap when the sprite is first used
+void	add_deferred_dynamic_sprite(int gotSlot, int spriteflags, Common::Stream *in);
+// Makes the image of the deferred dynamic sprite
+Common::Bitmap *load_deferred_dynamic_sprite(int gotSlot);
+// Writes the serialized image of the sprite if it was never used since the
+// restore; returns false if it has to be serialized from the bitmap
+bool	write_deferred_dynamic_sprite(int gotSlot, Common::Stream *out);
+void	free_deferred_dynamic_sprites();
 
 #endif // __AGS_EE_AC__DYNAMICSPRITE_H
@@ -25,6 +25,7 @@
 #include "ac/roomstatus.h"
 #include "ac/roomstruct.h"
 #include "ac/screen.h"
+#include "ac/timer.h"
 #include "script/cc_error.h"
 #include "media/audio/audio.h"
 #include "media/audio/soundclip.h"
@@ -285,7 +286,7 @@ void process_event(EventHappened*evp) {
                         boxwid, boxhit);
                     render_to_screen(screen_bmp, 0, 0);
                     update_mp3();
-                        while (timerloop == 0) ;
+                        wait_for_timer_tick();
                 }
                 gfxDriver->SetMemoryBackBuffer(virtual_screen);
             }
@@ -315,7 +316,7 @@ void process_event(EventHappened*evp) {
                 }
 				render_to_screen(screen_bmp, 0, 0);
                 update_polled_stuff_if_runtime();
-                while (timerloop == 0) ;
+                wait_for_timer_tick();
                 transparency -= 16;
             }
             temp_virtual->Release();
@@ -353,7 +354,7 @@ void process_event(EventHappened*evp) {
                 gfxDriver->DrawSprite(0, -(temp_virtual->GetHeight() - virtual_screen->GetHeight()), ddb);
 				render_to_screen(screen_bmp, 0, 0);
                 update_polled_stuff_if_runtime();
-                while (timerloop == 0) ;
+                wait_for_timer_tick();
             }
             temp_virtual->Release();
 
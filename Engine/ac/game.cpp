@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <map>
 #include "ac/common.h"
 #include "ac/view.h"
 #include "ac/audiochannel.h"
@@ -65,9 +66,12 @@
 #include "font/fonts.h"
 #include "game/savegame.h"
 #include "game/savegame_internal.h"
+#include "game/savegamesnapshot.h"
+#include "game/savegamewriter.h"
 #include "gui/animatingguibutton.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/gfxfilter.h"
+#include "gfx/spritetransformcache.h"
 #include "gui/guidialog.h"
 #include "main/graphics_mode.h"
 #include "main/main.h"
@@ -81,6 +85,7 @@
 #include "util/alignedstream.h"
 #include "util/directory.h"
 #include "util/filestream.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/string_utils.h"
 
@@ -93,6 +98,7 @@ extern Bitmap *virtual_screen;
 extern int cur_mode,cur_cursor;
 extern SpeechLipSyncLine *splipsync;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
+extern bool speech_lipsync_pending;
 
 extern CharacterExtras *charextra;
 extern DialogTopic *dialog;
@@ -133,6 +139,7 @@ extern unsigned int loopcounter;
 extern Bitmap *raw_saved_screen;
 extern Bitmap *dynamicallyCreatedSurfaces[MAX_DYNAMIC_SURFACES];
 extern IGraphicsDriver *gfxDriver;
+extern SpriteTransformCache spriteTransformCache;
 
 //=============================================================================
 GameState play;
@@ -196,6 +203,13 @@ String saveGameParent;
 
 const char* sgnametemplate = "agssave.%03d";
 String saveGameSuffix;
+// Writes the saved games to disk, in the background if possible
+SavegameWriter savegameWriter;
+// Game states kept in memory by the quick saves
+std::map<int, SavegameSnapshot> quickSaveSlots;
+// The game state written as the base of the checkpoints, and its slot
+SavegameSnapshot checkpointBase;
+int checkpointBaseSlot = 0;
 
 int game_paused=0;
 char pexbuf[STD_BUFFER_SIZE];
@@ -347,6 +361,20 @@ String get_save_game_path(int slotNum) {
     return path;
 }
 
+int get_save_slot_from_file_name(const char *filename) {
+    // only games .000 to .099 are listed (to allow higher slots for other purposes)
+    const char *numberExtension = strstr(filename, ".0");
+    if (numberExtension == NULL)
+        return -1;
+    const int slotNum = atoi(numberExtension + 1);
+    // the name must match exactly, which also leaves out the temporary
+    // files of the saves being written
+    String name;
+    name.Format(sgnametemplate, slotNum);
+    name.Append(saveGameSuffix);
+    return name.CompareNoCase(filename) == 0 ? slotNum : -1;
+}
+
 // Convert a path possibly containing path tags into acceptable save path
 String MakeSaveGameDir(const char *newFolder)
 {
@@ -547,6 +575,9 @@ void unload_game_file() {
     free(actspswb);
     free(actspswbbmp);
     free(actspswbcache);
+    // transformed images are keyed by sprite number, which will refer
+    // to different sprites once another game is loaded
+    spriteTransformCache.Clear();
     game.charProps.clear();
 
     for (bb = 1; bb < game.numinvitems; bb++) {
@@ -642,6 +673,7 @@ void unload_game_file() {
         numLipLines = 0;
         curLipLine = -1;
     }
+    speech_lipsync_pending = false;
 
     for (ee=0;ee < MAXGLOBALMES;ee++) {
         if (game.messages[ee]==NULL) continue;
@@ -690,7 +722,11 @@ void unload_game_file() {
     free(play.gui_draw_order);
 
     resetRoomStatuses();
+    free_deferred_dynamic_sprites();
 
+    // the states saved in memory belong to this game
+    quickSaveSlots.clear();
+    checkpointBase.Clear();
 }
 
 
@@ -1111,7 +1147,11 @@ void save_game_spriteset(Stream *out)
         if (game.spriteflags[bb] & SPF_DYNAMICALLOC) {
             out->WriteInt32(bb);
             out->WriteInt8(game.spriteflags[bb]);
-            serialize_bitmap(spriteset[bb], out);
+            // the sprite which was not used since the restore is written
+            // from its saved data, without making the image
+            if (!(spriteset.flags[bb] & SPRCACHEFLAG_DEFERRED) ||
+                !write_deferred_dynamic_sprite(bb, out))
+                serialize_bitmap(spriteset[bb], out);
         }
     }
     // end of dynamic sprite list
@@ -1146,20 +1186,24 @@ void save_game_room_state(Stream *out)
 {
     out->WriteInt32(displayed_room);
 
-    // write the room state for all the rooms the player has been in
-    RoomStatus* roomstat;
+    // write the room state for all the rooms the player has been in;
+    // each state is preceded by its size, so that it may be kept unread
+    // on restore until the room is needed
+    MemoryStream room_data;
     for (int bb = 0; bb < MAX_ROOMS; bb++) {
-        if (isRoomStatusValid(bb))
+        room_data.Clear();
+        // the room which was not entered since the restore keeps its saved state
+        if (!writeDeferredRoomStatus(bb, &room_data) && isRoomStatusValid(bb))
         {
-            roomstat = getRoomStatus(bb);
-            if (roomstat->beenhere) {
-                out->WriteInt8 (1);
-                WriteRoomStatus_Aligned(roomstat, out);
-                if (roomstat->tsdatasize>0)
-                    out->Write(&roomstat->tsdata[0], roomstat->tsdatasize);
-            }
-            else
-                out->WriteInt8(0);
+            RoomStatus *roomstat = getRoomStatus(bb);
+            if (roomstat->beenhere)
+                roomstat->WriteToSavegame(&room_data);
+        }
+        if (room_data.GetLength() > 0)
+        {
+            out->WriteInt8(1);
+            out->WriteInt32(room_data.GetLength());
+            out->Write(room_data.GetData(), room_data.GetLength());
         }
         else
             out->WriteInt8(0);
@@ -1432,7 +1476,9 @@ void save_game_data(Stream *out)
     save_game_audioclips_and_crossfade(out);
 
     // [IKM] Plugins expect FILE pointer! // TODO something with this later...
-    pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)out)->GetHandle());
+    // the game is never saved into memory if any plugin wants this hook
+    if (pl_any_want_hook(AGSE_SAVEGAME))
+        pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)out)->GetHandle());
     out->WriteInt32 (MAGICNUMBER);  // to verify the plugins
 
     // save the room music volume
@@ -1511,6 +1557,28 @@ void save_game(int slotn, const char*descript) {
     // Screenshot
     create_savegame_screenshot(screenShot);
 
+    // Plugins write their data straight into the save file, otherwise
+    // the game is saved into memory, and written to disk by the writer
+    if (!pl_any_want_hook(AGSE_SAVEGAME))
+    {
+        const int svg_flags = usetup.compress_saves ? kSvgFlag_Compressed : kSvgFlag_None;
+        MemoryStream *head = new MemoryStream();
+        WriteSavegameHeader(head, descript, screenShot, svg_flags);
+        MemoryStream *data = new MemoryStream();
+        SaveGameState(data);
+        MemoryStream *thumbnail = NULL;
+        if (screenShot != NULL)
+        {
+            thumbnail = new MemoryStream();
+            write_screen_shot_for_vista(thumbnail, screenShot);
+            delete screenShot;
+        }
+        savegameWriter.Write(nametouse, head, data, (svg_flags & kSvgFlag_Compressed) != 0, thumbnail);
+        return;
+    }
+
+    // don't let the queued save of this slot overwrite this one
+    savegameWriter.Wait();
     Stream *out = StartSavegame(nametouse, descript, screenShot);
     if (out == NULL)
         quit("save_game: unable to open savegame file for writing");
@@ -1564,8 +1632,8 @@ void restore_game_spriteset(Stream *in)
     int sprnum = in->ReadInt32();
     while (sprnum) {
         unsigned char spriteflag = in->ReadByte();
-        add_dynamic_sprite(sprnum, read_serialized_bitmap(in));
-        game.spriteflags[sprnum] = spriteflag;
+        // the image is made when the sprite is first used
+        add_deferred_dynamic_sprite(sprnum, spriteflag, in);
         sprnum = in->ReadInt32();
     }
 }
@@ -1610,7 +1678,7 @@ void ReadRoomStatus_Aligned(RoomStatus *roomstat, Stream *in)
     roomstat->ReadFromFile_v321(&align_s);
 }
 
-void restore_game_room_state(Stream *in)
+void restore_game_room_state(Stream *in, SavegameVersion svg_version)
 {
     int vv;
 
@@ -1624,18 +1692,19 @@ void restore_game_room_state(Stream *in)
         beenhere = in->ReadByte();
         if (beenhere)
         {
-            roomstat = getRoomStatus(vv);
-            roomstat->beenhere = beenhere;
-
-            if (roomstat->beenhere)
+            if (svg_version >= kSvgVersion_RoomSizes)
             {
-                ReadRoomStatus_Aligned(roomstat, in);
-                if (roomstat->tsdatasize > 0)
-                {
-                    roomstat->tsdata=(char*)malloc(roomstat->tsdatasize + 8);  // JJS: Why allocate 8 additional bytes?
-                    in->Read(&roomstat->tsdata[0], roomstat->tsdatasize);
-                }
+                // the state is read when the room is first accessed
+                std::vector<uint8_t> data((uint32_t)in->ReadInt32());
+                if (!data.empty())
+                    in->Read(&data[0], data.size());
+                setDeferredRoomStatus(vv, data);
+                continue;
             }
+
+            roomstat = getRoomStatus(vv);
+            roomstat->beenhere = beenhere;
+            roomstat->ReadFromSavegame(in);
         }
     }
 }
@@ -1943,7 +2012,7 @@ SavegameError restore_game_audioclips_and_crossfade(Stream *in, RestoredData &r_
     return kSvgErr_NoError;
 }
 
-SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data)
+SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, int svg_flags, const PreservedParams &pp, RestoredData &r_data)
 {
     int vv;
 
@@ -1957,7 +2026,7 @@ SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, const P
     err = restore_game_scripts(in, pp, r_data);
     if (err != kSvgErr_NoError)
         return err;
-    restore_game_room_state(in);
+    restore_game_room_state(in, svg_version);
     restore_game_play(in);
     ReadMoveList_Aligned(in);
 
@@ -2046,7 +2115,9 @@ SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, const P
         return err;
 
     // [IKM] Plugins expect FILE pointer! // TODO something with this later
-    pl_run_plugin_hooks(AGSE_RESTOREGAME, (long)((Common::FileStream*)in)->GetHandle());
+    // saves are only made in memory when no plugin has data to save
+    if ((svg_flags & (kSvgFlag_Compressed | kSvgFlag_InMemory)) == 0)
+        pl_run_plugin_hooks(AGSE_RESTOREGAME, (long)((Common::FileStream*)in)->GetHandle());
     if (in->ReadInt32() != (unsigned)MAGICNUMBER)
         return kSvgErr_InconsistentPlugin;
 
@@ -2144,7 +2215,7 @@ SavegameError load_game(const String &path, int slotNumber, bool &data_overwritt
     }
 
     // do the actual restore
-    err = RestoreGameState(src.InputStream.get(), src.Version);
+    err = RestoreGameState(src.InputStream.get(), src.Version, src.Flags);
     data_overwritten = true;
     if (err != kSvgErr_NoError)
         return err;
@@ -2184,6 +2255,109 @@ bool try_restore_save(const Common::String &path, int slot)
     return true;
 }
 
+void quick_save_game(int slotn)
+{
+    // the state of blocked scripts is not saved, same as with the usual saves
+    can_run_delayed_command();
+
+    if (inside_script) {
+        curscript->queue_action(ePSAQuickSave, slotn, "QuickSaveSlot");
+        return;
+    }
+
+    // plugins can only save their data into the file
+    if (pl_any_want_hook(AGSE_SAVEGAME))
+    {
+        Common::Debug::Printf(kDbgMsg_Warn, "QuickSaveSlot: not supported when plugins save the game data, slot %d was not saved", slotn);
+        return;
+    }
+
+    MemoryStream state;
+    SaveGameState(&state);
+    quickSaveSlots[slotn].Swap(state);
+}
+
+bool quick_restore_game(int slotn)
+{
+    std::map<int, SavegameSnapshot>::iterator it = quickSaveSlots.find(slotn);
+    if (it == quickSaveSlots.end())
+    {
+        Common::Debug::Printf(kDbgMsg_Warn, "QuickRestoreSlot: slot %d was not saved", slotn);
+        return false;
+    }
+
+    gameHasBeenRestored++;
+    oldeip = our_eip;
+    our_eip = 2050;
+
+    // the state is given to the stream for reading and taken back after
+    MemoryStream state;
+    it->second.Swap(state);
+    SavegameError err = RestoreGameState(&state, kSvgVersion_Current, kSvgFlag_InMemory);
+    it->second.Swap(state);
+    // the game data is already overwritten, there's no way back
+    if (err != kSvgErr_NoError)
+        quitprintf("Unable to restore game:\n%s", GetSavegameErrorText(err).GetCStr());
+    our_eip = oldeip;
+
+    while (keypressed()) readkey();
+    run_on_event(GE_RESTORE_GAME, RuntimeScriptValue().SetInt32(slotn));
+    return true;
+}
+
+void save_game_checkpoint()
+{
+    if (pl_any_want_hook(AGSE_SAVEGAME))
+        return;
+
+    MemoryStream state_data;
+    SaveGameState(&state_data);
+    SavegameSnapshot state;
+    state.Swap(state_data);
+
+    const int svg_flags = usetup.compress_saves ? kSvgFlag_Compressed : kSvgFlag_None;
+    MemoryStream *delta = new MemoryStream();
+    if (!checkpointBase.IsEmpty())
+    {
+        const size_t changed = WriteDeltaSavegameData(delta, get_save_game_path(checkpointBaseSlot),
+                                                      checkpointBase, state);
+        // when too much has changed, the new base is written instead
+        if (changed > state.GetSize() / 4)
+        {
+            delta->Clear();
+            checkpointBase.Clear();
+        }
+    }
+
+    if (checkpointBase.IsEmpty())
+    {
+        // the two base slots are used in turns, so that the last checkpoint
+        // stays valid until the new one replaces it; the first time since
+        // the start, the slot in use is found from the last checkpoint file
+        if (checkpointBaseSlot == 0)
+        {
+            const String last_base = GetDeltaSavegameBase(get_save_game_path(CHECKPOINT_SAVE_GAME_NUMBER));
+            if (!last_base.IsEmpty() &&
+                Path::ComparePaths(last_base, get_save_game_path(CHECKPOINT_BASE_SAVE_GAME_NUMBER)) == 0)
+                checkpointBaseSlot = CHECKPOINT_BASE_SAVE_GAME_NUMBER;
+        }
+        checkpointBaseSlot = checkpointBaseSlot == CHECKPOINT_BASE_SAVE_GAME_NUMBER ?
+            CHECKPOINT_BASE_SAVE_GAME_NUMBER + 1 : CHECKPOINT_BASE_SAVE_GAME_NUMBER;
+        const String base_path = get_save_game_path(checkpointBaseSlot);
+        MemoryStream *head = new MemoryStream();
+        WriteSavegameHeader(head, "Checkpoint", NULL, svg_flags);
+        MemoryStream *data = new MemoryStream();
+        data->Write(state.GetData(), state.GetSize());
+        savegameWriter.Write(base_path, head, data, usetup.compress_saves, NULL);
+        checkpointBase.Swap(state);
+        WriteDeltaSavegameData(delta, base_path, checkpointBase, checkpointBase);
+    }
+
+    MemoryStream *head = new MemoryStream();
+    WriteSavegameHeader(head, "Checkpoint", NULL, svg_flags | kSvgFlag_Delta);
+    savegameWriter.Write(get_save_game_path(CHECKPOINT_SAVE_GAME_NUMBER), head, delta, usetup.compress_saves, NULL);
+}
+
 void start_skipping_cutscene () {
     play.fast_forward = 1;
     // if a drop-down icon bar is up, remove it as it will pause the game
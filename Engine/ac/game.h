@@ -121,6 +121,9 @@ void set_game_speed(int fps);
 void setup_for_dialog();
 void restore_after_dialog();
 Common::String get_save_game_path(int slotNum);
+// Gets the slot of the listed savegame file name, or -1 if it's not a save
+// of the listed slots
+int get_save_slot_from_file_name(const char *filename);
 void restore_game_dialog();
 void save_game_dialog();
 void setup_sierra_interface();
@@ -134,6 +137,13 @@ bool read_savedgame_screenshot(const Common::String &savedgame, int &want_shot);
 // too late, when the game data was already overwritten, shuts engine down.
 bool try_restore_save(int slot);
 bool try_restore_save(const Common::String &path, int slot);
+// Saves the game state into memory
+void quick_save_game(int slotn);
+// Restores the game state saved into memory; returns false if there is none
+bool quick_restore_game(int slotn);
+// Writes the changes of the game state since the last checkpoint base,
+// or the new base when there are too many of them
+void save_game_checkpoint();
 void serialize_bitmap(const Common::Bitmap *thispic, Common::Stream *out);
 // On Windows we could just use IIDFromString but this is platform-independant
 void convert_guid_from_text_to_binary(const char *guidText, unsigned char *buffer);
@@ -14,6 +14,7 @@
 
 #include "util/wgt2allg.h" // DIGI_AUTODETECT & MIDI_AUTODETECT
 #include "ac/gamesetup.h"
+#include "gfx/spritetransformcache.h"
 
 GameSetup::GameSetup()
 {
@@ -32,6 +33,16 @@ GameSetup::GameSetup()
     mouse_speed = 1.f;
     mouse_control = kMouseCtrl_Fullscreen;
     mouse_speed_def = kMouseSpeed_CurrentDisplay;
+    transform_cache_size = DEFAULTTRANSFORMCACHESIZE;
+    sprite_prefilter_threads = 0;
+    sprite_tint_threads = 0;
+    unthrottled = false;
+    unthrottled_render_interval = 1;
+    replay_verify_interval = 0;
+    compress_saves = true;
+    save_in_background = true;
+    checkpoint_interval = 0;
+    preload_rooms = true;
 
     Screen.DisplayMode.MatchDeviceRatio = false;
     Screen.DisplayMode.SizeDef = kScreenDef_MaxDisplay;
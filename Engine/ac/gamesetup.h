@@ -58,6 +58,16 @@ struct GameSetup {
     float mouse_speed;
     MouseControl mouse_control;
     MouseSpeedDef mouse_speed_def;
+    size_t transform_cache_size; // max size of the scaled sprites cache, in bytes
+    int   sprite_prefilter_threads;
+    int   sprite_tint_threads;
+    bool  unthrottled; // run game ticks as fast as possible, counting the game time by ticks
+    int   unthrottled_render_interval; // only draw every Nth tick when unthrottled
+    int   replay_verify_interval; // record game state checksum every Nth game loop
+    bool  compress_saves;  // write the game data compressed
+    bool  save_in_background; // write saves to disk on the separate thread
+    int   checkpoint_interval; // save the checkpoint every N seconds of game time
+    bool  preload_rooms; // read the room files ahead on the separate thread
 
     ScreenSetup Screen;
 
@@ -1217,6 +1217,24 @@ RuntimeScriptValue Sc_scrPlayVideo(const RuntimeScriptValue *params, int32_t par
     API_SCALL_VOID_POBJ_PINT2(scrPlayVideo, const char);
 }
 
+// void (int nrnum)
+RuntimeScriptValue Sc_PreloadRoom(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(PreloadRoom);
+}
+
+// void (int slnum)
+RuntimeScriptValue Sc_QuickRestoreSlot(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(QuickRestoreSlot);
+}
+
+// void (int slotn)
+RuntimeScriptValue Sc_quick_save_game(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(quick_save_game);
+}
+
 // void (int dialog)
 RuntimeScriptValue Sc_QuitGame(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -2458,6 +2476,9 @@ void RegisterGlobalAPI()
 	ccAddExternalStaticFunction("PlaySoundEx",              Sc_PlaySoundEx);
 	ccAddExternalStaticFunction("PlaySpeech",               Sc_scr_play_speech);
 	ccAddExternalStaticFunction("PlayVideo",                Sc_scrPlayVideo);
+	ccAddExternalStaticFunction("PreloadRoom",              Sc_PreloadRoom);
+	ccAddExternalStaticFunction("QuickRestoreSlot",         Sc_QuickRestoreSlot);
+	ccAddExternalStaticFunction("QuickSaveSlot",            Sc_quick_save_game);
 	ccAddExternalStaticFunction("QuitGame",                 Sc_QuitGame);
 	ccAddExternalStaticFunction("Random",                   Sc_Rand);
 	ccAddExternalStaticFunction("RawClearScreen",           Sc_RawClear);
@@ -2825,7 +2846,10 @@ void RegisterGlobalAPI()
     ccAddExternalFunctionForPlugin("PlaySoundEx",              (void*)PlaySoundEx);
     ccAddExternalFunctionForPlugin("PlaySpeech",               (void*)__scr_play_speech);
     ccAddExternalFunctionForPlugin("PlayVideo",                (void*)scrPlayVideo);
+    ccAddExternalFunctionForPlugin("PreloadRoom",              (void*)PreloadRoom);
     ccAddExternalFunctionForPlugin("ProcessClick",             (void*)ProcessClick);
+    ccAddExternalFunctionForPlugin("QuickRestoreSlot",         (void*)QuickRestoreSlot);
+    ccAddExternalFunctionForPlugin("QuickSaveSlot",            (void*)quick_save_game);
     ccAddExternalFunctionForPlugin("QuitGame",                 (void*)QuitGame);
     ccAddExternalFunctionForPlugin("Random",                   (void*)__Rand);
     ccAddExternalFunctionForPlugin("RawClearScreen",           (void*)RawClear);
@@ -22,11 +22,16 @@
 #include "ac/lipsync.h"
 #include "ac/path_helper.h"
 #include "ac/roomstruct.h"
+#include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "main/engine.h"
+#include "main/game_file.h"
 #include "media/audio/audio.h"
 #include "media/audio/sound.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
 
 extern GameSetup usetup;
 extern GameState play;
@@ -34,6 +39,7 @@ extern GameSetupStruct game;
 extern roomstruct thisroom;
 extern SpeechLipSyncLine *splipsync;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
+extern bool speech_lipsync_pending;
 
 void StopAmbientSound (int channel) {
     if ((channel < 0) || (channel >= MAX_SOUND_CHANNELS))
@@ -451,6 +457,41 @@ int IsMusicVoxAvailable () {
     return play.separate_music_lib;
 }
 
+// Reads the voice lip sync data from the speech file, this is postponed
+// until the first speech is played to let the game start sooner
+static void load_speech_lipsync() {
+    if (!speech_lipsync_pending)
+        return;
+    speech_lipsync_pending = false;
+
+    if (AssetManager::SetDataFile(speech_file) != kAssetNoError)
+        return;
+    Stream *speechsync = AssetManager::OpenAsset("syncdata.dat");
+    if (speechsync != NULL) {
+        // this game has voice lip sync
+        if (speechsync->ReadInt32() != 4)
+        { 
+            // Don't display this warning.
+            // platform->DisplayAlert("Unknown speech lip sync format (might be from older or newer version); lip sync disabled");
+        }
+        else {
+            numLipLines = speechsync->ReadInt32();
+            splipsync = (SpeechLipSyncLine*)malloc (sizeof(SpeechLipSyncLine) * numLipLines);
+            for (int ee = 0; ee < numLipLines; ee++)
+            {
+                splipsync[ee].numPhonemes = speechsync->ReadInt16();
+                speechsync->Read(splipsync[ee].filename, 14);
+                splipsync[ee].endtimeoffs = (int*)malloc(splipsync[ee].numPhonemes * sizeof(int));
+                speechsync->ReadArrayOfInt32(splipsync[ee].endtimeoffs, splipsync[ee].numPhonemes);
+                splipsync[ee].frame = (short*)malloc(splipsync[ee].numPhonemes * sizeof(short));
+                speechsync->ReadArrayOfInt16(splipsync[ee].frame, splipsync[ee].numPhonemes);
+            }
+        }
+        delete speechsync;
+    }
+    AssetManager::SetDataFile(game_file_name);
+}
+
 int play_speech(int charid,int sndid) {
     stop_and_destroy_channel (SCHAN_SPEECH);
 
@@ -476,6 +517,8 @@ int play_speech(int charid,int sndid) {
     // append the speech number and create voice file name
     String voice_file = String::FromFormat("%s%d", script_name.GetCStr(), sndid);
 
+    load_speech_lipsync();
+
     int ii;  // Compare the base file name to the .pam file name
     curLipLine = -1;  // See if we have voice lip sync for this line
     curLipLinePhoneme = -1;
@@ -16,6 +16,8 @@
 #include "ac/global_datetime.h"
 #include "ac/datetime.h"
 #include "ac/common.h"
+#include "ac/record.h"
+#include "ac/timer.h"
 
 int sc_GetTime(int whatti) {
     ScriptDateTime *sdt = DateTime_Now_Core();
@@ -35,5 +37,5 @@ int sc_GetTime(int whatti) {
 }
 
 int GetRawTime () {
-    return time(NULL);
+    return rec_get_time();
 }
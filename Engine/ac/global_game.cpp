@@ -43,6 +43,7 @@
 #include "ac/string.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "game/savegamewriter.h"
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_start.h"
@@ -53,11 +54,13 @@
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/spritetransformcache.h"
 #include "core/assetmanager.h"
 #include "main/game_file.h"
 #include "util/string_utils.h"
 
 using namespace AGS::Common;
+using AGS::Engine::SpriteTransformCache;
 
 #define ALLEGRO_KEYBOARD_HANDLER
 
@@ -67,6 +70,7 @@ extern int displayed_room;
 extern int game_paused;
 extern int spritewidth[MAX_SPRITES],spriteheight[MAX_SPRITES];
 extern SpriteCache spriteset;
+extern SpriteTransformCache spriteTransformCache;
 extern int frames_per_second;
 extern int time_between_timers;
 extern char gamefilenamebuf[200];
@@ -85,6 +89,7 @@ extern IGraphicsDriver *gfxDriver;
 extern color palette[256];
 extern Bitmap *virtual_screen;
 extern int psp_gfx_renderer;
+extern AGS::Engine::SavegameWriter savegameWriter;
 
 void GiveScore(int amnt) 
 {
@@ -118,7 +123,21 @@ void RestoreGameSlot(int slnum) {
     try_restore_save(slnum);
 }
 
+void QuickRestoreSlot(int slnum) {
+    if (displayed_room < 0)
+        quit("!QuickRestoreSlot: a game cannot be restored from within game_start");
+
+    can_run_delayed_command();
+    if (inside_script) {
+        curscript->queue_action(ePSAQuickRestore, slnum, "QuickRestoreSlot");
+        return;
+    }
+    quick_restore_game(slnum);
+}
+
 void DeleteSaveSlot (int slnum) {
+    // the slot may be still waiting to be written
+    savegameWriter.Wait();
     String nametouse;
     nametouse = get_save_game_path(slnum);
     unlink (nametouse);
@@ -276,6 +295,7 @@ int RunAGSGame (const char *newgame, unsigned int mode, int data) {
         quitprintf("!RunAGSGame: error loading new game file:\n%s", err_str.GetCStr());
 
     spriteset.reset();
+    spriteTransformCache.Clear();
     if (spriteset.initFile ("acsprset.spr"))
         quit("!RunAGSGame: error loading new sprites");
 
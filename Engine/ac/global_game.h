@@ -24,6 +24,7 @@ using namespace AGS; // FIXME later
 void GiveScore(int amnt);
 void restart_game();
 void RestoreGameSlot(int slnum);
+void QuickRestoreSlot(int slnum);
 void DeleteSaveSlot (int slnum);
 int  GetSaveSlotDescription(int slnum,char*desbuf);
 int  LoadSaveSlotScreenshot(int slnum, int width, int height);
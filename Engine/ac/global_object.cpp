@@ -23,6 +23,7 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/global_character.h"
 #include "ac/global_translation.h"
+#include "ac/hittestindex.h"
 #include "ac/object.h"
 #include "ac/objectcache.h"
 #include "ac/properties.h"
@@ -61,26 +62,48 @@ extern IGraphicsDriver *gfxDriver;
 // Used for deciding whether a char or obj was closer
 int obj_lowest_yp;
 
+bool get_object_hit_rect(int aa, int *x, int *y, int *width, int *height) {
+    if (objs[aa].on != 1) return false;
+    if (objs[aa].flags & OBJF_NOINTERACT)
+        return false;
+    *width = divide_down_coordinate(objs[aa].get_width());
+    *height = divide_down_coordinate(objs[aa].get_height());
+    *x = objs[aa].x;
+    *y = objs[aa].y - *height;
+    // is_pos_in_sprite takes the size of the image in this case
+    if ((*width == 0) || (*height == 0)) {
+        Bitmap *theImage = GetObjectImage(aa, NULL);
+        if (*width == 0) *width = divide_down_coordinate(theImage->GetWidth()) - 1;
+        if (*height == 0) *height = divide_down_coordinate(theImage->GetHeight()) - 1;
+    }
+    return true;
+}
+
 int GetObjectAt(int xx,int yy) {
     int aa,bestshotyp=-1,bestshotwas=-1;
     // translate screen co-ordinates to room co-ordinates
     xx += divide_down_coordinate(offsetx);
     yy += divide_down_coordinate(offsety);
-    // Iterate through all objects in the room
-    for (aa=0;aa<croom->numobj;aa++) {
-        if (objs[aa].on != 1) continue;
-        if (objs[aa].flags & OBJF_NOINTERACT)
+    // Iterate through the objects in the room that may be there
+    static std::vector<int> candidates;
+    const bool use_candidates = get_hit_test_candidates(kHitTest_Object, xx, yy, candidates);
+    const int count = use_candidates ? (int)candidates.size() : croom->numobj;
+    for (int i = 0; i < count; i++) {
+        aa = use_candidates ? candidates[i] : i;
+        int xxx, yyy, spWidth, spHeight;
+        if (!get_object_hit_rect(aa, &xxx, &yyy, &spWidth, &spHeight))
             continue;
-        int xxx=objs[aa].x,yyy=objs[aa].y;
+        // get the image only if the point is within the object's bounds
+        if (isposinbox(xx, yy, xxx, yyy, xxx + spWidth, yyy + spHeight) == FALSE)
+            continue;
+
         int isflipped = 0;
-        int spWidth = divide_down_coordinate(objs[aa].get_width());
-        int spHeight = divide_down_coordinate(objs[aa].get_height());
         if (objs[aa].view >= 0)
             isflipped = views[objs[aa].view].loops[objs[aa].loop].frames[objs[aa].frame].flags & VFLG_FLIPSPRITE;
 
         Bitmap *theImage = GetObjectImage(aa, &isflipped);
 
-        if (is_pos_in_sprite(xx, yy, xxx, yyy - spHeight, theImage,
+        if (is_pos_in_sprite(xx, yy, xxx, yyy, theImage,
             spWidth, spHeight, isflipped) == FALSE)
             continue;
 
@@ -63,5 +63,8 @@ int  GetObjectProperty (int hss, const char *property);
 void GetObjectPropertyText (int item, const char *property, char *bufer);
 
 Common::Bitmap *GetObjectImage(int obj, int *isFlipped);
+// Gets the rectangle in the room where the object may be clicked on;
+// returns false if it may not be clicked on at all
+bool get_object_hit_rect(int obj, int *x, int *y, int *width, int *height);
 
 #endif // __AGS_EE_AC__GLOBALOBJECT_H
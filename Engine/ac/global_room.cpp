@@ -172,6 +172,16 @@ int HasPlayerBeenInRoom(int roomnum) {
         return 0;
 }
 
+void PreloadRoom(int nrnum) {
+    if (nrnum < 0)
+        quitprintf("!PreloadRoom: invalid room number %d.", nrnum);
+    if (nrnum == displayed_room)
+        return;
+
+    debug_script_log("Room %d is going to be preloaded", nrnum);
+    preload_room(nrnum);
+}
+
 void CallRoomScript (int value) {
     can_run_delayed_command();
 
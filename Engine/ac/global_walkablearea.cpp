@@ -60,7 +60,7 @@ void RemoveWalkableArea(int areanum) {
   if ((areanum<1) | (areanum>15))
     quit("!RemoveWalkableArea: invalid area number specified (1-15).");
   play.walkable_areas_on[areanum]=0;
-  redo_walkable_areas();
+  redo_walkable_area(areanum);
   debug_script_log("Walkable area %d removed", areanum);
 }
 
@@ -68,7 +68,7 @@ void RestoreWalkableArea(int areanum) {
   if ((areanum<1) | (areanum>15))
     quit("!RestoreWalkableArea: invalid area number specified (1-15).");
   play.walkable_areas_on[areanum]=1;
-  redo_walkable_areas();
+  redo_walkable_area(areanum);
   debug_script_log("Walkable area %d restored", areanum);
 }
 
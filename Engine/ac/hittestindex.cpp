@@ -0,0 +1,129 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include "ac/hittestindex.h"
+#include "ac/character.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/global_object.h"
+#include "ac/roomstatus.h"
+#include "ac/roomstruct.h"
+
+extern GameSetupStruct game;
+extern roomstruct thisroom;
+extern RoomStatus *croom;
+
+HitTestIndex::HitTestIndex()
+    : _width(0)
+    , _height(0)
+    , _cellsX(0)
+    , _cellsY(0)
+{
+}
+
+void HitTestIndex::Reset(int width, int height)
+{
+    _width = width;
+    _height = height;
+    _cellsX = (width + CellSize - 1) / CellSize;
+    _cellsY = (height + CellSize - 1) / CellSize;
+    _items.clear();
+    // keep the cell lists' memory for the next time
+    if (_cells.size() < (size_t)(_cellsX * _cellsY))
+        _cells.resize(_cellsX * _cellsY);
+    for (size_t i = 0; i < _cells.size(); ++i)
+        _cells[i].clear();
+}
+
+void HitTestIndex::Add(HitTestItemType type, int index, const Rect &bounds)
+{
+    const Rect area = IntersectRects(bounds, Rect(0, 0, _width - 1, _height - 1));
+    if (area.IsEmpty())
+        return;
+
+    Item item;
+    item.Type = type;
+    item.Index = index;
+    item.Bounds = bounds;
+    const int number = (int)_items.size();
+    _items.push_back(item);
+    for (int cy = area.Top / CellSize; cy <= area.Bottom / CellSize; ++cy)
+    {
+        for (int cx = area.Left / CellSize; cx <= area.Right / CellSize; ++cx)
+            _cells[cy * _cellsX + cx].push_back(number);
+    }
+}
+
+bool HitTestIndex::GetAt(HitTestItemType type, int x, int y, std::vector<int> &items) const
+{
+    items.clear();
+    if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height))
+        return false;
+
+    const std::vector<int> &cell = _cells[(y / CellSize) * _cellsX + (x / CellSize)];
+    for (size_t i = 0; i < cell.size(); ++i)
+    {
+        const Item &item = _items[cell[i]];
+        if ((item.Type == type) && item.Bounds.IsInside(x, y))
+            items.push_back(item.Index);
+    }
+    return true;
+}
+
+
+HitTestIndex hitTestIndex;
+int  hit_test_scope_level = 0;
+bool hit_test_index_built = false;
+
+void begin_hit_test_scope()
+{
+    hit_test_scope_level++;
+}
+
+void end_hit_test_scope()
+{
+    if (--hit_test_scope_level == 0)
+        hit_test_index_built = false;
+}
+
+void invalidate_hit_test_index()
+{
+    hit_test_index_built = false;
+}
+
+static void build_hit_test_index()
+{
+    hitTestIndex.Reset(thisroom.width, thisroom.height);
+    int x, y, width, height;
+    for (int cc = 0; cc < game.numcharacters; cc++)
+    {
+        if (get_character_hit_rect(cc, &x, &y, &width, &height))
+            hitTestIndex.Add(kHitTest_Character, cc, Rect(x, y, x + width, y + height));
+    }
+    for (int aa = 0; aa < croom->numobj; aa++)
+    {
+        if (get_object_hit_rect(aa, &x, &y, &width, &height))
+            hitTestIndex.Add(kHitTest_Object, aa, Rect(x, y, x + width, y + height));
+    }
+    hit_test_index_built = true;
+}
+
+bool get_hit_test_candidates(HitTestItemType type, int x, int y, std::vector<int> &items)
+{
+    if (hit_test_scope_level == 0)
+        return false;
+    if (!hit_test_index_built)
+        build_hit_test_index();
+    return hitTestIndex.GetAt(type, x, y, items);
+}
@@ -0,0 +1,81 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// HitTestIndex is a uniform grid of the rectangles covered by characters and
+// objects in the room, which gives the few items that may be found at the
+// point instead of checking every one of them.
+//
+// The index for the current room is only used inside the hit test scope,
+// where the game state is known not to change, such as during the render.
+// It is built by the first hit test in the scope, and dropped whenever the
+// plugins get control, because they may move things around.
+//
+//=============================================================================
+#ifndef __AC_HITTESTINDEX_H
+#define __AC_HITTESTINDEX_H
+
+#include <vector>
+#include "util/geometry.h"
+
+enum HitTestItemType
+{
+    kHitTest_Character,
+    kHitTest_Object,
+    kNumHitTestTypes
+};
+
+class HitTestIndex
+{
+public:
+    // Size of the grid cell
+    static const int CellSize = 32;
+
+    HitTestIndex();
+
+    // Removes all items, and sets the size of the indexed area
+    void Reset(int width, int height);
+    // Adds the item; items of each type must be added in the order they
+    // are checked by the hit test
+    void Add(HitTestItemType type, int index, const Rect &bounds);
+    // Gets the items of given type whose bounds contain the point, in the
+    // order they were added. Returns false if the point is outside of the
+    // indexed area, in which case every item must be checked.
+    bool GetAt(HitTestItemType type, int x, int y, std::vector<int> &items) const;
+
+private:
+    struct Item
+    {
+        HitTestItemType Type;
+        int  Index;
+        Rect Bounds;
+    };
+
+    int _width;
+    int _height;
+    int _cellsX;
+    int _cellsY;
+    std::vector<Item> _items;
+    std::vector< std::vector<int> > _cells; // numbers of items in each cell
+};
+
+// Starts and ends the period in which the game state does not change
+void begin_hit_test_scope();
+void end_hit_test_scope();
+// Drops the index built for the current scope
+void invalidate_hit_test_index();
+// Gets the indexes of characters or objects that may be at the room
+// position; returns false if all of them have to be checked
+bool get_hit_test_candidates(HitTestItemType type, int x, int y, std::vector<int> &items);
+
+#endif // __AC_HITTESTINDEX_H
@@ -16,11 +16,13 @@
 #include <stdio.h>
 #include "ac/listbox.h"
 #include "ac/common.h"
+#include "ac/game.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_game.h"
 #include "ac/path_helper.h"
 #include "ac/string.h"
+#include "game/savegamewriter.h"
 #include "gui/guimain.h"
 
 using namespace AGS::Common;
@@ -28,6 +30,7 @@ using namespace AGS::Common;
 extern char saveGameDirectory[260];
 extern GameState play;
 extern GameSetupStruct game;
+extern AGS::Engine::SavegameWriter savegameWriter;
 
 // *** LIST BOX FUNCTIONS
 
@@ -98,6 +101,9 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
   long filedates[MAXSAVEGAMES];
   char buff[200];
 
+  // the saves still being written must be complete before they are listed
+  savegameWriter.Wait();
+
   char searchPath[260];
   sprintf(searchPath, "%s""agssave.*", saveGameDirectory);
 
@@ -106,13 +112,11 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
     bufix=0;
     if (numsaves >= MAXSAVEGAMES)
       break;
-    // only list games .000 to .099 (to allow higher slots for other perposes)
-    if (strstr(ffb.name,".0")==NULL) {
+    int saveGameSlot = get_save_slot_from_file_name(ffb.name);
+    if (saveGameSlot < 0) {
       don = al_findnext(&ffb);
       continue;
     }
-    const char *numberExtension = strstr(ffb.name, ".0") + 1;
-    int saveGameSlot = atoi(numberExtension);
     GetSaveSlotDescription(saveGameSlot, buff);
     listbox->AddItem(buff);
     listbox->saveGameIndex[numsaves] = saveGameSlot;
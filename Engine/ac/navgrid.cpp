@@ -0,0 +1,243 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include "ac/navgrid.h"
+#include "gfx/bitmap.h"
+
+using AGS::Common::Bitmap;
+
+// Cost of the straight and diagonal moves; their ratio approximates sqrt(2)
+const int COST_STRAIGHT = 10;
+const int COST_DIAGONAL = 14;
+// Node was already expanded by the current search
+const uint8_t NODE_CLOSED = 0x80;
+
+// Moves in 8 directions; straight ones go first, so that the first four
+// also describe how pixels are connected into components
+const int NUM_DIRS = 8;
+const int DIR_DX[NUM_DIRS] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+const int DIR_DY[NUM_DIRS] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+
+NavGrid::NavGrid()
+    : _width(0)
+    , _height(0)
+    , _maxValue(0)
+    , _version(0)
+    , _searchStamp(0)
+{
+}
+
+bool NavGrid::Update(const Bitmap *mask, uint32_t version)
+{
+    const int width = mask->GetWidth();
+    const int height = mask->GetHeight();
+    bool changed = (width != _width) || (height != _height);
+    if (!changed && (version != 0) && (version == _version))
+        return false;
+    for (int y = 0; y < height && !changed; ++y)
+        changed = memcmp(&_mask[y * width], mask->GetScanLine(y), width) != 0;
+    _version = version;
+    if (!changed)
+        return false;
+
+    _width = width;
+    _height = height;
+    _mask.resize(width * height);
+    for (int y = 0; y < height; ++y)
+        memcpy(&_mask[y * width], mask->GetScanLine(y), width);
+    Rebuild();
+    return true;
+}
+
+bool NavGrid::Update(const uint8_t *mask, int width, int height)
+{
+    if ((width == _width) && (height == _height) && !_mask.empty() &&
+        (memcmp(&_mask[0], mask, width * height) == 0))
+        return false;
+
+    _width = width;
+    _height = height;
+    _version = 0;
+    _mask.assign(mask, mask + width * height);
+    Rebuild();
+    return true;
+}
+
+void NavGrid::Rebuild()
+{
+    const int size = _width * _height;
+    _labels.assign(size, 0);
+    _compBounds.resize(1);
+    _maxValue = 0;
+    for (int i = 0; i < size; ++i)
+        _maxValue = std::max<int>(_maxValue, _mask[i]);
+
+    // Label walkable pixels connected by their sides, filling one component
+    // at a time; 'fill' is reused as a stack of pixels to check
+    std::vector<int> fill;
+    for (int start = 0; start < size; ++start)
+    {
+        if ((_mask[start] == 0) || (_labels[start] != 0))
+            continue;
+
+        const int component = (int)_compBounds.size();
+        Rect bounds(start % _width, start / _width, start % _width, start / _width);
+        _labels[start] = component;
+        fill.push_back(start);
+        while (!fill.empty())
+        {
+            const int index = fill.back();
+            fill.pop_back();
+            const int x = index % _width;
+            const int y = index / _width;
+            bounds.Left = std::min(bounds.Left, x);
+            bounds.Right = std::max(bounds.Right, x);
+            bounds.Top = std::min(bounds.Top, y);
+            bounds.Bottom = std::max(bounds.Bottom, y);
+
+            for (int dir = 0; dir < 4; ++dir)
+            {
+                const int nx = x + DIR_DX[dir];
+                const int ny = y + DIR_DY[dir];
+                if ((nx < 0) || (nx >= _width) || (ny < 0) || (ny >= _height))
+                    continue;
+                const int next = ny * _width + nx;
+                if ((_mask[next] != 0) && (_labels[next] == 0))
+                {
+                    _labels[next] = component;
+                    fill.push_back(next);
+                }
+            }
+        }
+        _compBounds.push_back(bounds);
+    }
+
+    _stamp.assign(size, 0);
+    _cost.resize(size);
+    _dir.resize(size);
+    _searchStamp = 0;
+}
+
+int NavGrid::GetComponent(int x, int y) const
+{
+    if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height))
+        return 0;
+    return _labels[y * _width + x];
+}
+
+bool NavGrid::AreConnected(int x1, int y1, int x2, int y2) const
+{
+    const int component = GetComponent(x1, y1);
+    return (component != 0) && (component == GetComponent(x2, y2));
+}
+
+// Octile distance, which never overestimates the cost of 8-way moves
+int NavGrid::Heuristic(int index, int tox, int toy) const
+{
+    const int dx = abs(index % _width - tox);
+    const int dy = abs(index / _width - toy);
+    return COST_STRAIGHT * std::max(dx, dy) + (COST_DIAGONAL - COST_STRAIGHT) * std::min(dx, dy);
+}
+
+bool NavGrid::FindPath(int fromx, int fromy, int tox, int toy, std::vector<Point> &path)
+{
+    path.clear();
+    if (!AreConnected(fromx, fromy, tox, toy))
+        return false;
+
+    // Start new search; on the stamp overflow reset all the nodes
+    if (++_searchStamp == 0)
+    {
+        std::fill(_stamp.begin(), _stamp.end(), 0);
+        _searchStamp = 1;
+    }
+
+    const int src = fromy * _width + fromx;
+    const int dest = toy * _width + tox;
+    _stamp[src] = _searchStamp;
+    _cost[src] = 0;
+    _dir[src] = 0;
+    _open.clear();
+    HeapNode start = { Heuristic(src, tox, toy), Heuristic(src, tox, toy), src };
+    _open.push_back(start);
+
+    bool found = false;
+    while (!_open.empty())
+    {
+        std::pop_heap(_open.begin(), _open.end());
+        const HeapNode node = _open.back();
+        _open.pop_back();
+        const int index = node.Index;
+        // nodes may be queued more than once, only the cheapest one counts
+        if ((_dir[index] & NODE_CLOSED) != 0)
+            continue;
+        _dir[index] |= NODE_CLOSED;
+        if (index == dest)
+        {
+            found = true;
+            break;
+        }
+
+        const int x = index % _width;
+        const int y = index / _width;
+        for (int dir = 0; dir < NUM_DIRS; ++dir)
+        {
+            const int nx = x + DIR_DX[dir];
+            const int ny = y + DIR_DY[dir];
+            if ((nx < 0) || (nx >= _width) || (ny < 0) || (ny >= _height))
+                continue;
+            const int next = ny * _width + nx;
+            if (_mask[next] == 0)
+                continue;
+            int cost = COST_STRAIGHT;
+            if ((DIR_DX[dir] != 0) && (DIR_DY[dir] != 0))
+            {
+                // do not squeeze between the diagonal walls
+                if ((_mask[y * _width + nx] == 0) || (_mask[ny * _width + x] == 0))
+                    continue;
+                cost = COST_DIAGONAL;
+            }
+            cost += _cost[index];
+
+            if (_stamp[next] == _searchStamp)
+            {
+                if (((_dir[next] & NODE_CLOSED) != 0) || (_cost[next] <= cost))
+                    continue;
+            }
+            _stamp[next] = _searchStamp;
+            _cost[next] = cost;
+            _dir[next] = (uint8_t)dir;
+            const int h = Heuristic(next, tox, toy);
+            HeapNode open_node = { cost + h, h, next };
+            _open.push_back(open_node);
+            std::push_heap(_open.begin(), _open.end());
+        }
+    }
+    if (!found)
+        return false;
+
+    // Go back from the destination, remembering where the direction changes
+    path.push_back(Point(tox, toy));
+    for (int index = dest; index != src;)
+    {
+        const int dir = _dir[index] & ~NODE_CLOSED;
+        index -= DIR_DY[dir] * _width + DIR_DX[dir];
+        if ((index != src) && ((_dir[index] & ~NODE_CLOSED) != dir))
+            path.push_back(Point(index % _width, index / _width));
+    }
+    return true;
+}
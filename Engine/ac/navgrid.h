@@ -0,0 +1,102 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// NavGrid keeps navigation data for the walkable areas mask used by the
+// pathfinder: connected components of walkable pixels (connected the same
+// way as flood fill connects them), which tell at once whether one point
+// may be reached from another, and an A* search over the mask.
+//
+// The data is rebuilt only when the mask changes. Search buffers are kept
+// between searches and are never cleared: every search marks the nodes it
+// touches with its own stamp instead.
+//
+//=============================================================================
+#ifndef __AC_NAVGRID_H
+#define __AC_NAVGRID_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+// Forward declaration
+namespace AGS { namespace Common { class Bitmap; } }
+
+class NavGrid
+{
+public:
+    NavGrid();
+
+    // Updates navigation data for the 8-bit walkable areas mask, where
+    // non-zero pixels are walkable; the data is only rebuilt if the mask's
+    // size or contents differ from the last time. Returns true if rebuilt.
+    // If non-zero version is given, the mask with the same version as the
+    // last one is considered unchanged without comparing the contents.
+    bool Update(const AGS::Common::Bitmap *mask, uint32_t version = 0);
+    // Same as above, for the mask given as a packed array of pixels
+    bool Update(const uint8_t *mask, int width, int height);
+
+    int  GetWidth() const { return _width; }
+    int  GetHeight() const { return _height; }
+    // Returns the biggest pixel value found in the mask
+    int  GetMaxValue() const { return _maxValue; }
+    // Returns number of the walkable component the pixel belongs to,
+    // or 0 if it is not walkable or lies outside of the mask
+    int  GetComponent(int x, int y) const;
+    // Returns bounding rectangle of the component
+    const Rect &GetComponentBounds(int component) const { return _compBounds[component]; }
+    // Tells if there is a walkable path between the two points
+    bool AreConnected(int x1, int y1, int x2, int y2) const;
+
+    // Finds the shortest path between two walkable points, moving in 8
+    // directions but never cutting corners of the non-walkable pixels.
+    // The path is returned backwards, from the destination to the source,
+    // and only has the points where direction changes; source point is not
+    // included. Returns false if there's no path.
+    bool FindPath(int fromx, int fromy, int tox, int toy, std::vector<Point> &path);
+
+private:
+    struct HeapNode
+    {
+        int F; // estimated total path cost
+        int H; // estimated remaining cost
+        int Index;
+
+        // std heap functions keep the "greatest" node on top, so the node
+        // with lower cost should compare as greater
+        bool operator <(const HeapNode &other) const
+        {
+            return F > other.F || (F == other.F && H > other.H);
+        }
+    };
+
+    void Rebuild();
+    int  Heuristic(int index, int tox, int toy) const;
+
+    int _width;
+    int _height;
+    int _maxValue;
+    std::vector<uint8_t> _mask;
+    std::vector<int>  _labels;
+    std::vector<Rect> _compBounds; // index 0 is unused
+    uint32_t _version;
+
+    // Search buffers; node data is valid only if its stamp is current
+    std::vector<uint32_t> _stamp;
+    std::vector<int>      _cost;
+    std::vector<uint8_t>  _dir; // move that led to the node, and closed flag
+    std::vector<HeapNode> _open;
+    uint32_t _searchStamp;
+};
+
+#endif // __AC_NAVGRID_H
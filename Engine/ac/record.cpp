@@ -15,7 +15,9 @@
 #define IS_RECORD_UNIT
 #include "ac/common.h"
 #include "media/audio/audiodefines.h"
+#include "ac/characterinfo.h"
 #include "ac/game.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_display.h"
@@ -23,9 +25,14 @@
 #include "ac/keycode.h"
 #include "ac/mouse.h"
 #include "ac/record.h"
+#include "ac/replaystream.h"
+#include "ac/roomstatus.h"
+#include "ac/timer.h"
+#include "debug/out.h"
 #include "game/savegame.h"
 #include "main/main.h"
 #include "media/audio/soundclip.h"
+#include "script/cc_instance.h"
 #include "util/string_utils.h"
 #include "gfx/gfxfilter.h"
 #include "device/mousew32.h"
@@ -35,7 +42,10 @@ using namespace AGS::Common;
 using namespace AGS::Engine;
 
 extern GameSetupStruct game;
+extern GameSetup usetup;
 extern GameState play;
+extern RoomStatus *croom;
+extern ccInstance *gameinst;
 extern int disable_mgetgraphpos;
 extern int mousex,mousey;
 extern unsigned int loopcounter,lastcounter;
@@ -45,54 +55,79 @@ extern int pluginSimulatedClick;
 extern int displayed_room;
 extern char check_dynamic_sprites_at_exit;
 
+// Replay file versions:
+// 1, 2, 3 - array of 16-bit numbers: step, event type, fixed number of data
+// 4       - packed ReplayStream; recorded time reads and state checksums
+#define REPLAY_VERSION_STREAM   4
+#define REPLAY_VERSION_CURRENT  REPLAY_VERSION_STREAM
+
 char replayfile[MAX_PATH] = "record.dat";
 int replay_time = 0;
 unsigned long replay_last_second = 0;
 int replay_start_this_time = 0;
 
-short *recordbuffer = NULL;
-int  recbuffersize = 0, recsize = 0;
+ReplayStream replay_stream;
+// The next event to play back, read ahead from the stream
+ReplayEvent  replay_next;
+// Real time at the start of the recording; the time reads are stored relative to it
+time_t replay_clock_base = 0;
+// Number of game loops between the game state checksums, 0 for none
+int replay_verify_interval = 0;
+unsigned int replay_loops = 0;
+// Whether the playback has warned about a clock read with no recorded time
+bool replay_time_warned = false;
 
 const char *replayTempFile = "~replay.tmp";
 
 int mouse_z_was = 0;
 
-void write_record_event (int evnt, int dlen, short *dbuf) {
-
-    recordbuffer[recsize] = play.gamestep;
-    recordbuffer[recsize+1] = evnt;
-
+void write_record_event (int evnt, int dlen, const int *dbuf) {
+    ReplayEvent evt;
+    evt.Step = play.gamestep;
+    evt.Type = evnt;
+    evt.DataCount = dlen;
     for (int i = 0; i < dlen; i++)
-        recordbuffer[recsize + i + 2] = dbuf[i];
-    recsize += dlen + 2;
-
-    if (recsize >= recbuffersize - 100) {
-        recbuffersize += 10000;
-        recordbuffer = (short*)realloc (recordbuffer, recbuffersize * sizeof(short));
-    }
+        evt.Data[i] = dbuf[i];
+    replay_stream.Write(evt);
 
     play.gamestep++;
 }
 void disable_replay_playback () {
     play.playback = 0;
-    if (recordbuffer)
-        free (recordbuffer);
-    recordbuffer = NULL;
+    replay_stream.Clear();
     disable_mgetgraphpos = 0;
 }
 
-void done_playback_event (int size) {
-    recsize += size;
-    play.gamestep++;
-    if ((recsize >= recbuffersize) || (recordbuffer[recsize+1] == REC_ENDOFFILE))
+// Reads ahead the next event to play back, ends the playback if there are none
+static void read_playback_event () {
+    if (!replay_stream.Read(replay_next) || (replay_next.Type == REC_ENDOFFILE))
         disable_replay_playback();
 }
 
+void done_playback_event () {
+    play.gamestep++;
+    read_playback_event();
+}
+
+// Tells if the replay data is loaded and being played back
+static bool is_playback_loaded () {
+    return play.playback && (replay_stream.GetSize() > 0);
+}
+
+// Tells if the next recorded event is of the given type, and is due on this step
+static bool is_playback_event (int type) {
+    return is_playback_loaded() && (replay_next.Step == play.gamestep) && (replay_next.Type == type);
+}
+
+bool is_replay_active () {
+    return play.recording || is_playback_loaded();
+}
+
 int rec_getch () {
     if (play.playback) {
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_GETCH)) {
-            int toret = recordbuffer[recsize + 2];
-            done_playback_event (3);
+        if (is_playback_event(REC_GETCH)) {
+            int toret = replay_next.Data[0];
+            done_playback_event ();
             return toret;
         }
         // Since getch() waits for a key to be pressed, if we have no
@@ -101,15 +136,15 @@ int rec_getch () {
     }
     int result = my_readkey();
     if (play.recording) {
-        short buff[1] = {static_cast<short>(result)};
+        int buff[1] = {result};
         write_record_event (REC_GETCH, 1, buff);
     }
 
-    return result;  
+    return result;
 }
 
 int rec_kbhit () {
-    if ((play.playback) && (recordbuffer != NULL)) {
+    if (is_playback_loaded()) {
         // check for real keypresses to abort the replay
         if (keypressed()) {
             if (my_readkey() == 27) {
@@ -118,8 +153,8 @@ int rec_kbhit () {
             }
         }
         // now simulate the keypresses
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_KBHIT)) {
-            done_playback_event (2);
+        if (is_playback_event(REC_KBHIT)) {
+            done_playback_event ();
             return 1;
         }
         return 0;
@@ -134,7 +169,7 @@ int rec_kbhit () {
     if ((result) && (play.recording)) {
         write_record_event (REC_KBHIT, 0, NULL);
     }
-    return result;  
+    return result;
 }
 
 char playback_keystate[KEY_MAX];
@@ -142,11 +177,9 @@ char playback_keystate[KEY_MAX];
 int rec_iskeypressed (int keycode) {
 
     if (play.playback) {
-        if ((recordbuffer[recsize] == play.gamestep)
-            && (recordbuffer[recsize + 1] == REC_KEYDOWN)
-            && (recordbuffer[recsize + 2] == keycode)) {
-                playback_keystate[keycode] = recordbuffer[recsize + 3];
-                done_playback_event (4);
+        if (is_playback_event(REC_KEYDOWN) && (replay_next.Data[0] == keycode)) {
+                playback_keystate[keycode] = replay_next.Data[1];
+                done_playback_event ();
         }
         return playback_keystate[keycode];
     }
@@ -155,7 +188,7 @@ int rec_iskeypressed (int keycode) {
 
     if (play.recording) {
         if (toret != playback_keystate[keycode]) {
-            short buff[2] = {static_cast<short>(keycode), static_cast<short>(toret)};
+            int buff[2] = {keycode, toret};
             write_record_event (REC_KEYDOWN, 2, buff);
             playback_keystate[keycode] = toret;
         }
@@ -166,8 +199,8 @@ int rec_iskeypressed (int keycode) {
 
 int rec_isSpeechFinished () {
     if (play.playback) {
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_SPEECHFINISHED)) {
-            done_playback_event (2);
+        if (is_playback_event(REC_SPEECHFINISHED)) {
+            done_playback_event ();
             return 1;
         }
         return 0;
@@ -184,18 +217,16 @@ int rec_isSpeechFinished () {
 int recbutstate[4] = {-1, -1, -1, -1};
 int rec_misbuttondown (int but) {
     if (play.playback) {
-        if ((recordbuffer[recsize] == play.gamestep)
-            && (recordbuffer[recsize + 1] == REC_MOUSEDOWN)
-            && (recordbuffer[recsize + 2] == but)) {
-                recbutstate[but] = recordbuffer[recsize + 3];
-                done_playback_event (4);
+        if (is_playback_event(REC_MOUSEDOWN) && (replay_next.Data[0] == but)) {
+                recbutstate[but] = replay_next.Data[1];
+                done_playback_event ();
         }
         return recbutstate[but];
     }
     int result = misbuttondown (but);
     if (play.recording) {
         if (result != recbutstate[but]) {
-            short buff[2] = {static_cast<short>(but), static_cast<short>(result)};
+            int buff[2] = {but, result};
             write_record_event (REC_MOUSEDOWN, 2, buff);
             recbutstate[but] = result;
         }
@@ -205,20 +236,21 @@ int rec_misbuttondown (int but) {
 
 int rec_mgetbutton() {
 
-    if ((play.playback) && (recordbuffer != NULL)) {
-        if ((recordbuffer[recsize] < play.gamestep) && (play.gamestep < 32766))
+    if (is_playback_loaded()) {
+        // steps are compared modulo 2^16, because the step counter wraps around
+        if ((short)(replay_next.Step - play.gamestep) < 0)
             quit("Playback error: out of sync");
         if (loopcounter >= replay_last_second + 40) {
             replay_time ++;
             replay_last_second += 40;
         }
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_MOUSECLICK)) {
-            Mouse::SetPosition(Point(recordbuffer[recsize+3], recordbuffer[recsize+4]));
+        if (is_playback_event(REC_MOUSECLICK)) {
+            Mouse::SetPosition(Point(replay_next.Data[1], replay_next.Data[2]));
             disable_mgetgraphpos = 0;
             mgetgraphpos ();
             disable_mgetgraphpos = 1;
-            int toret = recordbuffer[recsize + 2];
-            done_playback_event (5);
+            int toret = replay_next.Data[0];
+            done_playback_event ();
             return toret;
         }
         return NONE;
@@ -242,7 +274,7 @@ int rec_mgetbutton() {
 
     if (play.recording) {
         if (result >= 0) {
-            short buff[3] = {static_cast<short>(result), static_cast<short>(mousex), static_cast<short>(mousey)};
+            int buff[3] = {result, mousex, mousey};
             write_record_event (REC_MOUSECLICK, 3, buff);
         }
         if (loopcounter >= replay_last_second + 40) {
@@ -266,23 +298,21 @@ void rec_domouse (int what) {
             // don't divide down the co-ordinates, because we lose
             // the precision, and it might click the wrong thing
             // if eg. hi-res 71 -> 35 in record file -> 70 in playback
-            short buff[2] = {static_cast<short>(mousex), static_cast<short>(mousey)};
+            int buff[2] = {mousex, mousey};
             write_record_event (REC_MOUSEMOVE, 2, buff);
         }
         return;
     }
-    else if ((play.playback) && (recordbuffer != NULL)) {
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_MOUSEMOVE)) {
-            Mouse::SetPosition(Point(recordbuffer[recsize+2], recordbuffer[recsize+3]));
-            disable_mgetgraphpos = 0;
-            if (what == DOMOUSE_NOCURSOR)
-                mgetgraphpos();
-            else
-                domouse(what);
-            disable_mgetgraphpos = 1;
-            done_playback_event (4);
-            return;
-        }
+    else if (is_playback_event(REC_MOUSEMOVE)) {
+        Mouse::SetPosition(Point(replay_next.Data[0], replay_next.Data[1]));
+        disable_mgetgraphpos = 0;
+        if (what == DOMOUSE_NOCURSOR)
+            mgetgraphpos();
+        else
+            domouse(what);
+        disable_mgetgraphpos = 1;
+        done_playback_event ();
+        return;
     }
     if (what == DOMOUSE_NOCURSOR)
         mgetgraphpos();
@@ -291,10 +321,10 @@ void rec_domouse (int what) {
 }
 
 int check_mouse_wheel () {
-    if ((play.playback) && (recordbuffer != NULL)) {
-        if ((recordbuffer[recsize] == play.gamestep) && (recordbuffer[recsize + 1] == REC_MOUSEWHEEL)) {
-            int toret = recordbuffer[recsize+2];
-            done_playback_event (3);
+    if (is_playback_loaded()) {
+        if (is_playback_event(REC_MOUSEWHEEL)) {
+            int toret = replay_next.Data[0];
+            done_playback_event ();
             return toret;
         }
         return 0;
@@ -310,13 +340,103 @@ int check_mouse_wheel () {
     }
 
     if ((play.recording) && (result)) {
-        short buff[1] = {static_cast<short>(result)};
+        int buff[1] = {result};
         write_record_event (REC_MOUSEWHEEL, 1, buff);
     }
 
     return result;
 }
 
+time_t rec_get_time () {
+    if (is_playback_loaded()) {
+        if (is_playback_event(REC_TIME)) {
+            time_t toret = replay_clock_base + replay_next.Data[0];
+            done_playback_event ();
+            return toret;
+        }
+        // the game is reading the clock at a moment it did not during the
+        // recording, or the replay has no time reads at all; tell only once
+        if (!replay_time_warned) {
+            Debug::Printf(kDbgMsg_Warn, "Playback: no recorded time on step %d, using the current one", play.gamestep);
+            replay_time_warned = true;
+        }
+        return get_game_time();
+    }
+
+    time_t result = get_game_time();
+    if (play.recording) {
+        int buff[1] = {(int)(result - replay_clock_base)};
+        write_record_event (REC_TIME, 1, buff);
+    }
+    return result;
+}
+
+// FNV-1a hash of the given bytes
+static void hash_bytes (uint32_t &hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+}
+
+static void hash_int (uint32_t &hash, int value) {
+    hash_bytes (hash, &value, sizeof(value));
+}
+
+// Calculates the checksum of the game state which the replay has to reproduce:
+// the room, the characters, the room objects and the script variables
+static int calc_game_state_checksum () {
+    uint32_t hash = 2166136261u;
+    hash_int (hash, displayed_room);
+    hash_int (hash, play.score);
+    hash_bytes (hash, play.globalvars, sizeof(play.globalvars));
+    for (int i = 0; i < game.numcharacters; i++) {
+        const CharacterInfo &chinfo = game.chars[i];
+        hash_int (hash, chinfo.room);
+        hash_int (hash, chinfo.x);
+        hash_int (hash, chinfo.y);
+        hash_int (hash, chinfo.loop);
+        hash_int (hash, chinfo.frame);
+    }
+    if ((displayed_room >= 0) && (croom != NULL)) {
+        for (int i = 0; i < croom->numobj; i++) {
+            const RoomObject &obj = croom->obj[i];
+            hash_int (hash, obj.on);
+            hash_int (hash, obj.x);
+            hash_int (hash, obj.y);
+            hash_int (hash, obj.num);
+        }
+    }
+    if ((gameinst != NULL) && (gameinst->globaldata != NULL))
+        hash_bytes (hash, gameinst->globaldata, gameinst->globaldatasize);
+    return (int)hash;
+}
+
+void rec_verify_state () {
+    if ((replay_verify_interval <= 0) || !is_replay_active())
+        return;
+    if (++replay_loops % replay_verify_interval != 0)
+        return;
+
+    const int checksum = calc_game_state_checksum();
+    if (play.recording) {
+        int buff[1] = {checksum};
+        write_record_event (REC_CHECKSUM, 1, buff);
+        return;
+    }
+
+    if (is_playback_event(REC_CHECKSUM)) {
+        const int recorded = replay_next.Data[0];
+        done_playback_event ();
+        if (recorded == checksum)
+            return;
+    }
+    Debug::Printf(kDbgMsg_Error, "Playback: game state diverged from the recording on game loop %u (step %d)",
+        replay_loops, play.gamestep);
+    quit("!Playback error: game state diverged from the recording");
+}
+
 void start_recording() {
     if (play.playback) {
         play.recording = 0;  // stop quit() crashing
@@ -327,9 +447,10 @@ void start_recording() {
     srand (play.randseed);
     play.gamestep = 0;
 
-    recbuffersize = 10000;
-    recordbuffer = (short*)malloc (recbuffersize * sizeof(short));
-    recsize = 0;
+    replay_stream.Clear();
+    replay_clock_base = get_game_time();
+    replay_verify_interval = usetup.replay_verify_interval;
+    replay_loops = 0;
     memset (playback_keystate, -1, KEY_MAX);
     replay_last_second = loopcounter;
     replay_time = 0;
@@ -363,22 +484,17 @@ void stop_recording() {
     Stream *replay_out = Common::File::CreateFile(replayfile);
     replay_out->Write ("AGSRecording", 12);
     fputstring (EngineVersion.LongString, replay_out);
-    int write_version = 2;
-    Stream *replay_temp_in = Common::File::OpenFileRead(replayTempFile);
-    if (replay_temp_in) {
-        // There was a save file created
-        write_version = 3;
-    }
-    replay_out->WriteInt32 (write_version);
+    replay_out->WriteInt32 (REPLAY_VERSION_CURRENT);
 
     fputstring (game.gamename, replay_out);
     replay_out->WriteInt32 (game.uniqueid);
     replay_out->WriteInt32 (replay_time);
     fputstring (replaydesc, replay_out);  // replay description, maybe we'll use this later
     replay_out->WriteInt32 (play.randseed);
-    if (write_version >= 3)
-        replay_out->WriteInt32 (recsize);
-    replay_out->WriteArrayOfInt16 (recordbuffer, recsize);
+    replay_out->WriteInt64 (replay_clock_base);
+    replay_out->WriteInt32 (replay_verify_interval);
+    replay_stream.WriteToFile (replay_out);
+    Stream *replay_temp_in = Common::File::OpenFileRead(replayTempFile);
     if (replay_temp_in) {
         replay_out->WriteInt32 (1);  // yes there is a save present
         int lenno = replay_temp_in->GetLength();
@@ -389,13 +505,49 @@ void stop_recording() {
         delete replay_temp_in;
         unlink (replayTempFile);
     }
-    else if (write_version >= 3) {
+    else {
         replay_out->WriteInt32 (0);
     }
     delete replay_out;
 
-    free (recordbuffer);
-    recordbuffer = NULL;
+    replay_stream.Clear();
+}
+
+// Gets the number of data values following the event in the old replay
+// formats, or -1 if the event type is unknown
+static int get_legacy_event_data_count (int type) {
+    switch (type) {
+    case REC_MOUSECLICK: return 3;
+    case REC_MOUSEMOVE:  return 2;
+    case REC_MOUSEDOWN:  return 2;
+    case REC_KBHIT:      return 0;
+    case REC_GETCH:      return 1;
+    case REC_KEYDOWN:    return 2;
+    case REC_MOUSEWHEEL: return 1;
+    case REC_SPEECHFINISHED: return 0;
+    case REC_ENDOFFILE:  return 0;
+    }
+    return -1;
+}
+
+// Converts the events recorded in the old replay formats into the stream
+static void convert_legacy_events (const short *buf, size_t count) {
+    replay_stream.Clear();
+    for (size_t i = 0; i + 1 < count;) {
+        ReplayEvent evt;
+        evt.Step = buf[i];
+        evt.Type = buf[i + 1];
+        evt.DataCount = get_legacy_event_data_count(evt.Type);
+        if ((evt.DataCount < 0) || (i + 2 + evt.DataCount > count))
+            break;
+        for (int d = 0; d < evt.DataCount; d++)
+            evt.Data[d] = buf[i + 2 + d];
+        replay_stream.Write(evt);
+        i += 2 + evt.DataCount;
+        if (evt.Type == REC_ENDOFFILE)
+            break;
+    }
+    replay_stream.Rewind();
 }
 
 void start_playback()
@@ -412,7 +564,7 @@ void start_playback()
         else {
             String version_string = String::FromStream(in, 12);
             AGS::Engine::Version requested_engine_version(version_string);
-            if (requested_engine_version.Major != '2') 
+            if (requested_engine_version.Major != '2')
                 quit("!Replay file is from an old version of AGS");
             if (requested_engine_version < AGS::Engine::Version(2, 55, 553))
                 quit("!Replay file was recorded with an older incompatible version");
@@ -432,7 +584,7 @@ void start_playback()
 
             int replayver = in->ReadInt32();
 
-            if ((replayver < 1) || (replayver > 3))
+            if ((replayver < 1) || (replayver > REPLAY_VERSION_CURRENT))
                 quit("!Unsupported Replay file version");
 
             if (replayver >= 2) {
@@ -451,15 +603,29 @@ void start_playback()
             }
 
             play.randseed = in->ReadInt32();
-            int flen = in->GetLength() - in->GetPosition ();
-            if (replayver >= 3) {
-                flen = in->ReadInt32() * sizeof(short);
+            if (replayver >= REPLAY_VERSION_STREAM) {
+                replay_clock_base = in->ReadInt64();
+                replay_verify_interval = in->ReadInt32();
+                if (!replay_stream.ReadFromFile(in)) {
+                    delete in;
+                    quit("!Replay file is corrupt");
+                }
+            }
+            else {
+                replay_clock_base = 0;
+                replay_verify_interval = 0;
+                int flen = in->GetLength() - in->GetPosition ();
+                if (replayver >= 3) {
+                    flen = in->ReadInt32() * sizeof(short);
+                }
+                std::vector<short> legacy_buf(flen / sizeof(short));
+                if (!legacy_buf.empty())
+                    in->ReadArrayOfInt16(&legacy_buf[0], legacy_buf.size());
+                convert_legacy_events(legacy_buf.empty() ? NULL : &legacy_buf[0], legacy_buf.size());
             }
-            recordbuffer = (short*)malloc (flen);
-            in->Read(recordbuffer, flen);
             srand (play.randseed);
-            recbuffersize = flen / sizeof(short);
-            recsize = 0;
+            replay_loops = 0;
+            replay_time_warned = false;
             disable_mgetgraphpos = 1;
             replay_time = 0;
             replay_last_second = loopcounter;
@@ -472,6 +638,7 @@ void start_playback()
                 }
             }
             delete in;
+            read_playback_event();
         }
     }
     else // file not found
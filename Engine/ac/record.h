@@ -18,6 +18,8 @@
 #ifndef __AGS_EE_AC__RECORD_H
 #define __AGS_EE_AC__RECORD_H
 
+#include <time.h>
+
 #define REC_MOUSECLICK 1
 #define REC_MOUSEMOVE  2
 #define REC_MOUSEDOWN  3
@@ -26,6 +28,8 @@
 #define REC_KEYDOWN    6
 #define REC_MOUSEWHEEL 7
 #define REC_SPEECHFINISHED 8
+#define REC_TIME       9
+#define REC_CHECKSUM   10
 #define REC_ENDOFFILE  0x6f
 
 // If this is defined for record unit it will cause endless recursion!
@@ -38,9 +42,11 @@
 #define getch rec_getch
 #endif
 
-void write_record_event (int evnt, int dlen, short *dbuf);
+void write_record_event (int evnt, int dlen, const int *dbuf);
 void disable_replay_playback ();
-void done_playback_event (int size);
+void done_playback_event ();
+// Tells if the replay is being recorded or played back
+bool is_replay_active ();
 int  rec_getch ();
 int  rec_kbhit ();
 int  rec_iskeypressed (int keycode);
@@ -49,6 +55,11 @@ int  rec_misbuttondown (int but);
 int  rec_mgetbutton();
 void rec_domouse (int what);
 int  check_mouse_wheel ();
+// Gets the game time, recording it, or taking the recorded one on playback
+time_t rec_get_time ();
+// Records the game state checksum every few game loops, or compares it with
+// the recorded one on playback, and quits if the game state has diverged
+void rec_verify_state ();
 void start_recording();
 void start_replay_record ();
 void stop_recording();
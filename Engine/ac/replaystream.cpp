@@ -0,0 +1,169 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "ac/replaystream.h"
+#include "util/stream.h"
+
+using AGS::Common::Stream;
+
+// Data count is packed into the lowest bits of the event type
+static const int DataCountBits = 3;
+
+// Zigzag encoding maps the small signed numbers to the small unsigned ones
+inline uint32_t ZigZagEncode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t ZigZagDecode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+ReplayEvent::ReplayEvent()
+    : Step(0)
+    , Type(0)
+    , DataCount(0)
+{
+    memset(Data, 0, sizeof(Data));
+}
+
+void ReplayStream::CodecState::Reset()
+{
+    LastStep = 0;
+    memset(LastData, 0, sizeof(LastData));
+}
+
+ReplayStream::ReplayStream()
+    : _readPos(0)
+{
+    _writer.Reset();
+    _reader.Reset();
+}
+
+void ReplayStream::Clear()
+{
+    _data.clear();
+    _writer.Reset();
+    Rewind();
+}
+
+void ReplayStream::Rewind()
+{
+    _readPos = 0;
+    _reader.Reset();
+}
+
+void ReplayStream::Write(const ReplayEvent &evt)
+{
+    // the step is a 16-bit counter, and may wrap around; the difference
+    // is still correct when taken modulo 2^16
+    WriteVarUInt((uint16_t)(evt.Step - _writer.LastStep));
+    _writer.LastStep = evt.Step;
+    WriteVarUInt(((uint32_t)evt.Type << DataCountBits) | evt.DataCount);
+    int *last = _writer.LastData[evt.Type];
+    for (int i = 0; i < evt.DataCount; ++i)
+    {
+        WriteVarUInt(ZigZagEncode((int32_t)((uint32_t)evt.Data[i] - (uint32_t)last[i])));
+        last[i] = evt.Data[i];
+    }
+}
+
+bool ReplayStream::Read(ReplayEvent &evt)
+{
+    uint32_t step, type;
+    if (!ReadVarUInt(step) || !ReadVarUInt(type))
+        return false;
+    evt.Step = (short)(_reader.LastStep + step);
+    evt.Type = type >> DataCountBits;
+    evt.DataCount = type & ((1 << DataCountBits) - 1);
+    if (evt.Type > MaxEventType || evt.DataCount > ReplayEvent::MaxData)
+        return false;
+    _reader.LastStep = evt.Step;
+    int *last = _reader.LastData[evt.Type];
+    for (int i = 0; i < evt.DataCount; ++i)
+    {
+        uint32_t value;
+        if (!ReadVarUInt(value))
+            return false;
+        evt.Data[i] = (int)((uint32_t)last[i] + (uint32_t)ZigZagDecode(value));
+        last[i] = evt.Data[i];
+    }
+    return true;
+}
+
+const uint8_t *ReplayStream::GetData() const
+{
+    return _data.empty() ? NULL : &_data[0];
+}
+
+size_t ReplayStream::GetSize() const
+{
+    return _data.size();
+}
+
+void ReplayStream::SetData(const uint8_t *data, size_t size)
+{
+    _data.assign(data, data + size);
+    _writer.Reset();
+    Rewind();
+}
+
+void ReplayStream::WriteToFile(Stream *out) const
+{
+    out->WriteInt32(_data.size());
+    if (!_data.empty())
+        out->Write(&_data[0], _data.size());
+}
+
+bool ReplayStream::ReadFromFile(Stream *in)
+{
+    Clear();
+    const int32_t size = in->ReadInt32();
+    if (size < 0 || (size_t)size > in->GetLength() - in->GetPosition())
+        return false;
+    _data.resize(size);
+    if (size > 0 && in->Read(&_data[0], size) != (size_t)size)
+    {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+void ReplayStream::WriteVarUInt(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        _data.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    _data.push_back((uint8_t)value);
+}
+
+bool ReplayStream::ReadVarUInt(uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (_readPos >= _data.size())
+            return false;
+        const uint8_t b = _data[_readPos++];
+        value |= (uint32_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,92 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// ReplayStream is the packed sequence of the recorded replay events.
+//
+// Every event is stored as the number of game steps passed since the previous
+// event, followed by the event type packed together with the data count, and
+// then the data values, each one as the difference from the same value of the
+// previous event of that type. All numbers are written as varints (7 bits per
+// byte), the differences being zigzag-encoded, so that the usual events, like
+// a small mouse move on the next step, take only a few bytes.
+//
+//=============================================================================
+#ifndef __AC_REPLAYSTREAM_H
+#define __AC_REPLAYSTREAM_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS { namespace Common { class Stream; } }
+
+struct ReplayEvent
+{
+    static const int MaxData = 7;
+
+    short Step;  // game step the event happened on
+    int   Type;  // one of the REC_* codes
+    int   DataCount;
+    int   Data[MaxData];
+
+    ReplayEvent();
+};
+
+class ReplayStream
+{
+public:
+    // Event types must be in range 0..MaxEventType
+    static const int MaxEventType = 0x7f;
+
+    ReplayStream();
+
+    // Removes all events
+    void Clear();
+    // Makes the next Read start from the first event
+    void Rewind();
+    // Appends the event to the end of the stream
+    void Write(const ReplayEvent &evt);
+    // Reads the next event; returns false if there are no more events,
+    // or the stream data is broken
+    bool Read(ReplayEvent &evt);
+
+    const uint8_t *GetData() const;
+    size_t         GetSize() const;
+    // Assigns the packed data, and rewinds the stream
+    void           SetData(const uint8_t *data, size_t size);
+    // Writes the packed data to the file, preceded by its size
+    void           WriteToFile(AGS::Common::Stream *out) const;
+    // Reads the packed data written by WriteToFile, and rewinds the stream;
+    // returns false if the size is not valid for the rest of the file
+    bool           ReadFromFile(AGS::Common::Stream *in);
+
+private:
+    // The values that the next event is encoded relative to
+    struct CodecState
+    {
+        short LastStep;
+        int   LastData[MaxEventType + 1][ReplayEvent::MaxData];
+
+        void Reset();
+    };
+
+    void WriteVarUInt(uint32_t value);
+    bool ReadVarUInt(uint32_t &value);
+
+    std::vector<uint8_t> _data;
+    size_t               _readPos;
+    CodecState           _writer;
+    CodecState           _reader;
+};
+
+#endif // __AC_REPLAYSTREAM_H
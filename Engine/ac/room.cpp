@@ -51,6 +51,7 @@
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "device/mousew32.h"
+#include "game/roompreloader.h"
 #include "media/audio/audio.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin.h"
@@ -127,6 +128,7 @@ extern CCObject ccDynamicObject;
 RGB_MAP rgb_table;  // for 256-col antialiasing
 int new_room_flags=0;
 int gs_to_newroom=-1;
+RoomPreloader roomPreloader;
 
 ScriptDrawingSurface* Room_GetDrawingSurfaceForBackground(int backgroundNumber)
 {
@@ -402,6 +404,26 @@ void convert_room_coordinates_to_low_res(roomstruct *rstruc)
 
 extern int convert_16bit_bgr;
 
+String get_room_filename(int room)
+{
+    String room_filename = String::FromFormat("room%d.crm", room);
+    if (room == 0) {
+        // support both room0.crm and intro.crm
+        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
+        if (loaded_game_file_version < kGameVersion_270 && Common::AssetManager::DoesAssetExist("intro.crm") ||
+            loaded_game_file_version >= kGameVersion_270 && !Common::AssetManager::DoesAssetExist(room_filename))
+        {
+            room_filename = "intro.crm";
+        }
+    }
+    return room_filename;
+}
+
+void preload_room(int room)
+{
+    roomPreloader.Preload(get_room_filename(room));
+}
+
 #define NO_GAME_ID_IN_ROOM_FILE 16325
 // forchar = playerchar on NewRoom, or NULL if restore saved game
 void load_new_room(int newnum, CharacterInfo*forchar) {
@@ -415,16 +437,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     set_color_depth(8);
     displayed_room=newnum;
 
-    room_filename.Format("room%d.crm", newnum);
-    if (newnum == 0) {
-        // support both room0.crm and intro.crm
-        // 2.70: Renamed intro.crm to room0.crm, to stop it causing confusion
-        if (loaded_game_file_version < kGameVersion_270 && Common::AssetManager::DoesAssetExist("intro.crm") ||
-            loaded_game_file_version >= kGameVersion_270 && !Common::AssetManager::DoesAssetExist(room_filename))
-        {
-            room_filename = "intro.crm";
-        }
-    }
+    room_filename = get_room_filename(newnum);
     // reset these back, because they might have been changed.
     delete thisroom.object;
     thisroom.object=BitmapHelper::CreateBitmap(320,200);
@@ -437,7 +450,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     // load the room from disk
     our_eip=200;
     thisroom.gameId = NO_GAME_ID_IN_ROOM_FILE;
-    load_room(room_filename, &thisroom, game.IsHiRes());
+    load_room(room_filename, &thisroom, game.IsHiRes(), roomPreloader.Open(room_filename));
 
     if ((thisroom.gameId != NO_GAME_ID_IN_ROOM_FILE) &&
         (thisroom.gameId != game.uniqueid)) {
@@ -1008,6 +1021,9 @@ void new_room(int newnum,CharacterInfo*forchar) {
     newnum = in_leaves_screen;
     in_leaves_screen = -1;
 
+    // start reading the new room while the old one fades out and unloads
+    preload_room(newnum);
+
     if ((playerchar->following >= 0) &&
         (game.chars[playerchar->following].room != newnum)) {
             // the player character is following another character,
@@ -21,6 +21,7 @@
 #include "ac/dynobj/scriptdrawingsurface.h"
 #include "ac/characterinfo.h"
 #include "ac/roomstruct.h"
+#include "util/string.h"
 
 ScriptDrawingSurface* Room_GetDrawingSurfaceForBackground(int backgroundNumber);
 int Room_GetObjectCount();
@@ -43,6 +44,10 @@ Common::Bitmap *fix_bitmap_size(Common::Bitmap *todubl);
 void  save_room_data_segment ();
 void  unload_old_room();
 void  convert_room_coordinates_to_low_res(roomstruct *rstruc);
+// Returns the name of the file which the room is loaded from
+Common::String get_room_filename(int room);
+// Starts reading the room file in the background, if the room preloader is on
+void  preload_room(int room);
 void  load_new_room(int newnum,CharacterInfo*forchar);
 void  new_room(int newnum,CharacterInfo*forchar);
 int   find_highest_room_entered();
@@ -14,10 +14,12 @@
 
 #include <string.h> // memset
 #include <stdlib.h> // free
+#include <map>
 #include "ac/common.h"
 #include "ac/roomstatus.h"
 #include "game/customproperties.h"
 #include "util/alignedstream.h"
+#include "util/memorystream.h"
 
 using namespace AGS::Common;
 
@@ -162,9 +164,35 @@ void RoomStatus::WriteRoomObjects_Aligned(Common::Stream *out)
     }
 }
 
+void RoomStatus::ReadFromSavegame(Common::Stream *in)
+{
+    {
+        AlignedStream align_s(in, Common::kAligned_Read);
+        ReadFromFile_v321(&align_s);
+    }
+    if (tsdatasize > 0)
+    {
+        tsdata = (char*)malloc(tsdatasize + 8);  // JJS: Why allocate 8 additional bytes?
+        in->Read(&tsdata[0], tsdatasize);
+    }
+}
+
+void RoomStatus::WriteToSavegame(Common::Stream *out)
+{
+    {
+        AlignedStream align_s(out, Common::kAligned_Write);
+        WriteToFile_v321(&align_s);
+    }
+    if (tsdatasize > 0)
+        out->Write(&tsdata[0], tsdatasize);
+}
+
 // JJS: Replacement for the global roomstats array in the original engine.
 
 RoomStatus* room_statuses[MAX_ROOMS];
+// Saved states of the restored rooms that were not accessed yet; most of
+// them are usually not needed until the player goes there
+std::map<int, std::vector<uint8_t> > deferred_room_statuses;
 
 // Replaces all accesses to the roomstats array
 RoomStatus* getRoomStatus(int room)
@@ -173,6 +201,16 @@ RoomStatus* getRoomStatus(int room)
     {
         // First access, allocate and initialise the status
         room_statuses[room] = new RoomStatus();
+
+        std::map<int, std::vector<uint8_t> >::iterator it = deferred_room_statuses.find(room);
+        if (it != deferred_room_statuses.end())
+        {
+            MemoryStream in;
+            in.Swap(it->second);
+            deferred_room_statuses.erase(it);
+            room_statuses[room]->beenhere = 1;
+            room_statuses[room]->ReadFromSavegame(&in);
+        }
     }
     return room_statuses[room];
 }
@@ -183,7 +221,8 @@ RoomStatus* getRoomStatus(int room)
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room)
 {
-    return (room_statuses[room] != NULL);
+    return (room_statuses[room] != NULL) ||
+        deferred_room_statuses.find(room) != deferred_room_statuses.end();
 }
 
 void resetRoomStatuses()
@@ -196,4 +235,25 @@ void resetRoomStatuses()
             room_statuses[i] = NULL;
         }
     }
+    deferred_room_statuses.clear();
+}
+
+void setDeferredRoomStatus(int room, std::vector<uint8_t> &data)
+{
+    if (room_statuses[room] != NULL)
+    {
+        delete room_statuses[room];
+        room_statuses[room] = NULL;
+    }
+    deferred_room_statuses[room].swap(data);
+}
+
+bool writeDeferredRoomStatus(int room, Common::Stream *out)
+{
+    std::map<int, std::vector<uint8_t> >::const_iterator it = deferred_room_statuses.find(room);
+    if (it == deferred_room_statuses.end())
+        return false;
+    if (!it->second.empty())
+        out->Write(&it->second[0], it->second.size());
+    return true;
 }
@@ -18,6 +18,7 @@
 #ifndef __AGS_EE_AC__ROOMSTATUS_H
 #define __AGS_EE_AC__ROOMSTATUS_H
 
+#include <vector>
 #include "ac/roomobject.h"
 #include "game/interactions.h"
 #include "util/string_types.h"
@@ -65,6 +66,9 @@ struct RoomStatus {
     void WriteToFile_v321(Common::Stream *out);
     void ReadRoomObjects_Aligned(Common::Stream *in);
     void WriteRoomObjects_Aligned(Common::Stream *out);
+    // Reads and writes the state along with the room script data
+    void ReadFromSavegame(Common::Stream *in);
+    void WriteToSavegame(Common::Stream *out);
 };
 
 // Replaces all accesses to the roomstats array
@@ -75,5 +79,11 @@ RoomStatus* getRoomStatus(int room);
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room);
 void resetRoomStatuses();
+// Keeps the saved state of the room, which is only read when the room
+// status is first accessed; takes the contents of the buffer
+void setDeferredRoomStatus(int room, std::vector<uint8_t> &data);
+// Writes the saved state of the room, if it was not read since the
+// restore; returns false otherwise
+bool writeDeferredRoomStatus(int room, Common::Stream *out);
 
 #endif // __AGS_EE_AC__ROOMSTATUS_H
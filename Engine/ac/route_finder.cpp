@@ -20,15 +20,22 @@
 #include "ac/route_finder.h"
 #include "ac/common.h"   // quit()
 #include "ac/movelist.h"     // MoveList
+#include "ac/navgrid.h"
 #include "ac/point.h"
+#include "ac/routecache.h"
 #include "ac/common_defines.h"
 #include <string.h>
 #include <math.h>
+#include <vector>
 #include "gfx/bitmap.h"
 
 using AGS::Common::Bitmap;
 namespace BitmapHelper = AGS::Common::BitmapHelper;
 
+extern Bitmap *walkable_areas_temp;
+extern unsigned walkable_areas_temp_version;
+extern int displayed_room;
+
 #define MANOBJNUM 99
 
 #define MAXPATHBACK 1000
@@ -92,19 +99,39 @@ int can_see_from(int x1, int y1, int x2, int y2)
   return 0;
 }
 
-int find_nearest_walkable_area(Bitmap *tempw, int fromX, int fromY, int toX, int toY, int destX, int destY, int granularity)
+// Navigation data for the last used walkable areas mask
+NavGrid navgrid;
+// A* path, from destination to source
+std::vector<Point> navpath;
+
+// Skips the grid lines which lie before the component's bounds
+static int align_to_bounds(int from, int bound, int granularity)
+{
+  if (from >= bound)
+    return from;
+  return from + ((bound - from + granularity - 1) / granularity) * granularity;
+}
+
+int find_nearest_walkable_area(int component, int fromX, int fromY, int toX, int toY, int destX, int destY, int granularity)
 {
   int ex, ey, nearest = 99999, thisis, nearx, neary;
   if (fromX < 0) fromX = 0;
   if (fromY < 0) fromY = 0;
-  if (toX >= tempw->GetWidth()) toX = tempw->GetWidth() - 1;
-  if (toY >= tempw->GetHeight()) toY = tempw->GetHeight() - 1;
+  if (toX >= navgrid.GetWidth()) toX = navgrid.GetWidth() - 1;
+  if (toY >= navgrid.GetHeight()) toY = navgrid.GetHeight() - 1;
+
+  // only look inside the component's bounds, keeping the same grid
+  const Rect &bounds = navgrid.GetComponentBounds(component);
+  fromX = align_to_bounds(fromX, bounds.Left, granularity);
+  fromY = align_to_bounds(fromY, bounds.Top, granularity);
+  if (toX > bounds.Right + 1) toX = bounds.Right + 1;
+  if (toY > bounds.Bottom + 1) toY = bounds.Bottom + 1;
 
   for (ex = fromX; ex < toX; ex += granularity) 
   {
     for (ey = fromY; ey < toY; ey += granularity) 
     {
-      if (tempw->GetScanLine(ey)[ex] != 232)
+      if (navgrid.GetComponent(ex, ey) != component)
         continue;
 
       thisis = (int)::sqrt((double)((ex - destX) * (ex - destX) + (ey - destY) * (ey - destY)));
@@ -126,8 +153,6 @@ int find_nearest_walkable_area(Bitmap *tempw, int fromX, int fromY, int toX, int
   return 0;
 }
 
-#define MAX_GRANULARITY 3
-int walk_area_granularity[MAX_WALK_AREAS + 1];
 int is_route_possible(int fromx, int fromy, int tox, int toy, Bitmap *wss)
 {
   wallscreen = wss;
@@ -140,97 +165,26 @@ int is_route_possible(int fromx, int fromy, int tox, int toy, Bitmap *wss)
   if (wallscreen->GetPixel(fromx, fromy) < 1)
     return 0;
 
-  Bitmap *tempw = BitmapHelper::CreateBitmapCopy(wallscreen, 8);
+  // the temp walkable areas mask tells when it changes, others have to be compared
+  const uint32_t version = (wallscreen == walkable_areas_temp) ? walkable_areas_temp_version : 0;
+  if (navgrid.Update(wallscreen, version) && (navgrid.GetMaxValue() > MAX_WALK_AREAS))
+    quit("!Calculate_Route: invalid colours in walkable area mask");
 
-  if (tempw == NULL)
-    quit("no memory for route calculation");
-  if (!tempw->IsMemoryBitmap())
-    quit("tempw is not memory bitmap");
-
-  int dd, ff;
-  // initialize array for finding widths of walkable areas
-  int thisar, inarow = 0, lastarea = 0;
-  int walk_area_times[MAX_WALK_AREAS + 1];
-  for (dd = 0; dd <= MAX_WALK_AREAS; dd++) {
-    walk_area_times[dd] = 0;
-    walk_area_granularity[dd] = 0;
-  }
-
-  for (ff = 0; ff < tempw->GetHeight(); ff++) {
-    const uint8_t *tempw_scanline = tempw->GetScanLine(ff);
-    for (dd = 0; dd < tempw->GetWidth(); dd++) {
-      thisar = tempw_scanline[dd];
-      // count how high the area is at this point
-      if ((thisar == lastarea) && (thisar > 0))
-        inarow++;
-      else if (lastarea > MAX_WALK_AREAS)
-        quit("!Calculate_Route: invalid colours in walkable area mask");
-      else if (lastarea != 0) {
-        walk_area_granularity[lastarea] += inarow;
-        walk_area_times[lastarea]++;
-        inarow = 0;
-      }
-      lastarea = thisar;
-    }
-  }
-
-  for (dd = 0; dd < tempw->GetWidth(); dd++) {
-    for (ff = 0; ff < tempw->GetHeight(); ff++) {
-      uint8_t *tempw_scanline = tempw->GetScanLineForWriting(ff);
-      thisar = tempw_scanline[dd];
-      if (thisar > 0)
-        tempw_scanline[dd] = 1;
-      // count how high the area is at this point
-      if ((thisar == lastarea) && (thisar > 0))
-        inarow++;
-      else if (lastarea != 0) {
-        walk_area_granularity[lastarea] += inarow;
-        walk_area_times[lastarea]++;
-        inarow = 0;
-      }
-      lastarea = thisar;
-    }
-  }
-
-  // find the average "width" of a path in this walkable area
-  for (dd = 1; dd <= MAX_WALK_AREAS; dd++) {
-    if (walk_area_times[dd] == 0) {
-      walk_area_granularity[dd] = MAX_GRANULARITY;
-      continue;
-    }
-
-    walk_area_granularity[dd] /= walk_area_times[dd];
-    if (walk_area_granularity[dd] <= 4)
-      walk_area_granularity[dd] = 2;
-    else if (walk_area_granularity[dd] <= 15)
-      walk_area_granularity[dd] = 3;
-    else
-      walk_area_granularity[dd] = MAX_GRANULARITY;
-
-    /*char toprnt[200];
-       sprintf(toprnt,"area %d: Gran %d", dd, walk_area_granularity[dd]);
-       winalert(toprnt); */
-  }
-  walk_area_granularity[0] = MAX_GRANULARITY;
-
-  tempw->FloodFill(fromx, fromy, 232);
-  if (tempw->GetPixel(tox, toy) != 232) 
+  const int component = navgrid.GetComponent(fromx, fromy);
+  if (navgrid.GetComponent(tox, toy) != component) 
   {
     // Destination pixel is not walkable
     // Try the 100x100 square around the target first at 3-pixel granularity
     int tryFirstX = tox - 50, tryToX = tox + 50;
     int tryFirstY = toy - 50, tryToY = toy + 50;
 
-    if (!find_nearest_walkable_area(tempw, tryFirstX, tryFirstY, tryToX, tryToY, tox, toy, 3))
+    if (!find_nearest_walkable_area(component, tryFirstX, tryFirstY, tryToX, tryToY, tox, toy, 3))
     {
       // Nothing found, sweep the whole room at 5 pixel granularity
-      find_nearest_walkable_area(tempw, 0, 0, tempw->GetWidth(), tempw->GetHeight(), tox, toy, 5);
+      find_nearest_walkable_area(component, 0, 0, navgrid.GetWidth(), navgrid.GetHeight(), tox, toy, 5);
     }
-
-    delete tempw;
     return 0;
   }
-  delete tempw;
 
   return 1;
 }
@@ -242,6 +196,7 @@ int pathbackstage = 0;
 int finalpartx = 0, finalparty = 0;
 short **beenhere = NULL;     //[200][320];
 int beenhere_array_size = 0;
+std::vector<short> beenhere_buffer;
 const int BEENHERE_SIZE = 2;
 
 #define DIR_LEFT  0
@@ -340,225 +295,44 @@ try_again:
 }
 
 
-#define CHECK_MIN(cellx, celly) { \
-  if (beenhere[celly][cellx] == -1) {\
-    adjcount = 0; \
-    if ((wallscreen->GetScanLine(celly)[cellx] != 0) && (beenhere[j][i]+modifier <= min)) {\
-      if (beenhere[j][i]+modifier < min) { \
-        min = beenhere[j][i]+modifier; \
-        numfound = 0; } \
-      if (numfound < 40) { \
-        newcell[numfound] = (celly) * wallscreen->GetWidth() + (cellx);\
-        cheapest[numfound] = j * wallscreen->GetWidth() + i;\
-        numfound++; \
-      }\
-    } \
-  }}
-
-#define MAX_TRAIL_LENGTH 5000
-
-// Round down the supplied co-ordinates to the area granularity,
-// and move a bit if this causes them to become non-walkable
-void round_down_coords(int &tmpx, int &tmpy)
+// Prepares the cleared beenhere buffer for the old pathfinder; the memory is
+// kept between calls
+void init_beenhere()
 {
-  int startgran = walk_area_granularity[wallscreen->GetPixel(tmpx, tmpy)];
-  tmpy = tmpy - tmpy % startgran;
-
-  if (tmpy < 0)
-    tmpy = 0;
-
-  tmpx = tmpx - tmpx % startgran;
-  if (tmpx < 0)
-    tmpx = 0;
-
-  if (wallscreen->GetPixel(tmpx, tmpy) == 0) {
-    tmpx += startgran;
-    if ((wallscreen->GetPixel(tmpx, tmpy) == 0) && (tmpy < wallscreen->GetHeight() - startgran)) {
-      tmpy += startgran;
+  if (wallscreen->GetHeight() > beenhere_array_size)
+  {
+    beenhere = (short**)realloc(beenhere, sizeof(short*) * wallscreen->GetHeight());
+    beenhere_array_size = wallscreen->GetHeight();
 
-      if (wallscreen->GetPixel(tmpx, tmpy) == 0)
-        tmpx -= startgran;
-    }
+    if (beenhere == NULL)
+      quit("insufficient memory to allocate pathfinder beenhere buffer");
   }
+
+  const size_t size = wallscreen->GetWidth() * wallscreen->GetHeight();
+  if (beenhere_buffer.size() < size)
+    beenhere_buffer.resize(size);
+  memset(&beenhere_buffer[0], 0, size * BEENHERE_SIZE);
+  for (int aaa = 0; aaa < wallscreen->GetHeight(); aaa++)
+    beenhere[aaa] = &beenhere_buffer[aaa * wallscreen->GetWidth()];
 }
 
-int find_route_dijkstra(int fromx, int fromy, int destx, int desty)
+// Finds the route with A*; navigation data must have been updated for the
+// current wallscreen by is_route_possible
+int find_route_astar(int fromx, int fromy, int destx, int desty)
 {
-  int i, j;
-
   // This algorithm doesn't behave differently the second time, so ignore
   if (leftorright == 1)
     return 0;
 
-  for (i = 0; i < wallscreen->GetHeight(); i++)
-    memset(&beenhere[i][0], 0xff, wallscreen->GetWidth() * BEENHERE_SIZE);
-
-  round_down_coords(fromx, fromy);
-  beenhere[fromy][fromx] = 0;
-
-  int temprd = destx, tempry = desty;
-  round_down_coords(temprd, tempry);
-  if ((temprd == fromx) && (tempry == fromy)) {
-    // already at destination
-    pathbackstage = 0;
-    return 1;
-  }
-
-  int allocsize = int (wallscreen->GetWidth()) * int (wallscreen->GetHeight()) * sizeof(int);
-  int *parent = (int *)malloc(allocsize);
-  int min = 999999, cheapest[40], newcell[40], replace[40];
-  int *visited = (int *)malloc(MAX_TRAIL_LENGTH * sizeof(int));
-  int iteration = 1;
-  visited[0] = fromy * wallscreen->GetWidth() + fromx;
-  parent[visited[0]] = -1;
-
-  int granularity = 3, newx = -1, newy, foundAnswer = -1, numreplace;
-  int changeiter, numfound, adjcount;
-  int destxlow = destx - MAX_GRANULARITY;
-  int destylow = desty - MAX_GRANULARITY;
-  int destxhi = destxlow + MAX_GRANULARITY * 2;
-  int destyhi = destylow + MAX_GRANULARITY * 2;
-  int modifier = 0;
-  int totalfound = 0;
-  int DIRECTION_BONUS = 0;
-
-  update_polled_stuff_if_runtime();
-
-  while (foundAnswer < 0) {
-    min = 29999;
-    changeiter = iteration;
-    numfound = 0;
-    numreplace = 0;
-
-    for (int n = 0; n < iteration; n++) {
-      if (visited[n] == -1)
-        continue;
-
-      i = visited[n] % wallscreen->GetWidth();
-      j = visited[n] / wallscreen->GetWidth();
-      granularity = walk_area_granularity[wallscreen->GetScanLine(j)[i]];
-      adjcount = 1;
-
-      if (i >= granularity) {
-        modifier = (destx < i) ? DIRECTION_BONUS : 0;
-        CHECK_MIN(i - granularity, j)
-      }
-
-      if (j >= granularity) {
-        modifier = (desty < j) ? DIRECTION_BONUS : 0;
-        CHECK_MIN(i, j - granularity)
-      }
-
-      if (i < wallscreen->GetWidth() - granularity) {
-        modifier = (destx > i) ? DIRECTION_BONUS : 0;
-        CHECK_MIN(i + granularity, j)
-      }
-
-      if (j < wallscreen->GetHeight() - granularity) {
-        modifier = (desty > j) ? DIRECTION_BONUS : 0;
-        CHECK_MIN(i, j + granularity)
-      }
-
-      // If all the adjacent cells have been done, stop checking this one
-      if (adjcount) {
-        if (numreplace < 40) {
-          visited[numreplace] = -1;
-          replace[numreplace] = n;
-          numreplace++;
-        }
-      }
-    }
-
-    if (numfound == 0) {
-      free(visited);
-      free(parent);
-      return 0;
-    }
-
-    totalfound += numfound;
-    for (int p = 0; p < numfound; p++) {
-      newx = newcell[p] % wallscreen->GetWidth();
-      newy = newcell[p] / wallscreen->GetWidth();
-      beenhere[newy][newx] = beenhere[cheapest[p] / wallscreen->GetWidth()][cheapest[p] % wallscreen->GetWidth()] + 1;
-//      int wal = walk_area_granularity[->GetPixel(wallscreen, newx, newy)];
-//      beenhere[newy - newy%wal][newx - newx%wal] = beenhere[newy][newx];
-      parent[newcell[p]] = cheapest[p];
-
-      // edges of screen pose a problem, so if current and dest are within
-      // certain distance of the edge, say we've got it
-      if ((newx >= wallscreen->GetWidth() - MAX_GRANULARITY) && (destx >= wallscreen->GetWidth() - MAX_GRANULARITY))
-        newx = destx;
-
-      if ((newy >= wallscreen->GetHeight() - MAX_GRANULARITY) && (desty >= wallscreen->GetHeight() - MAX_GRANULARITY))
-        newy = desty;
-
-      // Found the desination, abort loop
-      if ((newx >= destxlow) && (newx <= destxhi) && (newy >= destylow)
-          && (newy <= destyhi)) {
-        foundAnswer = newcell[p];
-        break;
-      }
-
-      if (totalfound >= 1000) {
-        //Doesn't work cos it can see the destination from the point that's
-        //not nearest
-        // every so often, check if we can see the destination
-        if (can_see_from(newx, newy, destx, desty)) {
-          DIRECTION_BONUS -= 50;
-          totalfound = 0;
-        }
-
-      }
+  if (!navgrid.FindPath(fromx, fromy, destx, desty, navpath))
+    return 0;
+  if (navpath.size() >= MAXPATHBACK)
+    return 0;
 
-      if (numreplace > 0) {
-        numreplace--;
-        changeiter = replace[numreplace];
-      } else
-        changeiter = iteration;
-
-      visited[changeiter] = newcell[p];
-      if (changeiter == iteration)
-        iteration++;
-
-      changeiter = iteration;
-      if (iteration >= MAX_TRAIL_LENGTH) {
-        free(visited);
-        free(parent);
-        return 0;
-      }
-    }
-    if (totalfound >= 1000) {
-      update_polled_stuff_if_runtime();
-      totalfound = 0;
-    }
+  for (pathbackstage = 0; pathbackstage < (int)navpath.size(); pathbackstage++) {
+    pathbackx[pathbackstage] = navpath[pathbackstage].X;
+    pathbacky[pathbackstage] = navpath[pathbackstage].Y;
   }
-  free(visited);
-
-  int on;
-  pathbackstage = 0;
-  pathbackx[pathbackstage] = destx;
-  pathbacky[pathbackstage] = desty;
-  pathbackstage++;
-
-  for (on = parent[foundAnswer];; on = parent[on]) {
-    if (on == -1)
-      break;
-
-    newx = on % wallscreen->GetWidth();
-    newy = on / wallscreen->GetWidth();
-    if ((newx >= destxlow) && (newx <= destxhi) && (newy >= destylow)
-        && (newy <= destyhi))
-      break;
-
-    pathbackx[pathbackstage] = on % wallscreen->GetWidth();
-    pathbacky[pathbackstage] = on / wallscreen->GetWidth();
-    pathbackstage++;
-    if (pathbackstage >= MAXPATHBACK) {
-      free(parent);
-      return 0;
-    }
-  }
-  free(parent);
   return 1;
 }
 
@@ -594,13 +368,13 @@ findroutebk:
   }
 
   // Try the new pathfinding algorithm
-  if (find_route_dijkstra(srcx, srcy, tox[0], toy[0])) {
+  if (find_route_astar(srcx, srcy, tox[0], toy[0])) {
     return 1;
   }
 
   // if the new pathfinder failed, try the old one
   pathbackstage = 0;
-  memset(&beenhere[0][0], 0, wallscreen->GetWidth() * wallscreen->GetHeight() * BEENHERE_SIZE);
+  init_beenhere();
   if (try_this_square(srcx, srcy, tox[0], toy[0]) == 0)
     return 0;
 
@@ -711,6 +485,76 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 
 #define MAKE_INTCOORD(x,y) (((unsigned short)x << 16) | ((unsigned short)y))
 
+RouteCache routecache;
+// Distance within which the remembered routes are shared
+int route_share_radius = 0;
+
+void set_route_share_radius(int radius)
+{
+  route_share_radius = radius;
+}
+
+// Builds the stages from the remembered route, going from the exact source
+// to the exact destination instead of its own end points; the parts that
+// were not checked on this walkable mask are tested for walls
+int make_cached_route(const RouteCache::Stages &route, int srcx, int srcy, int xx, int yy, bool check_all, int *stages)
+{
+  const int numstages = (int)route.size();
+  if ((numstages < 3) || (numstages >= MAXNEEDSTAGES))
+    return 0;
+
+  memcpy(stages, &route[0], sizeof(int) * numstages);
+  stages[0] = MAKE_INTCOORD(srcx, srcy);
+  stages[numstages - 1] = MAKE_INTCOORD(xx, yy);
+  for (int aaa = 0; aaa < numstages - 1; aaa++) {
+    if (!check_all && (aaa > 0) && (aaa < numstages - 2))
+      continue;
+    if (!can_see_from((stages[aaa] >> 16) & 0x000ffff, stages[aaa] & 0x000ffff,
+                      (stages[aaa + 1] >> 16) & 0x000ffff, stages[aaa + 1] & 0x000ffff))
+      return 0;
+  }
+  return numstages;
+}
+
+int find_cached_route(int srcx, int srcy, int xx, int yy, int nocross, int *stages)
+{
+  const RouteCache::Stages *route = routecache.Get(displayed_room, srcx, srcy, xx, yy, walkable_areas_temp_version, nocross);
+  int numstages;
+  if ((route != NULL) && ((numstages = make_cached_route(*route, srcx, srcy, xx, yy, false, stages)) > 0))
+    return numstages;
+  if (route_share_radius <= 0)
+    return 0;
+
+  static std::vector<const RouteCache::Stages*> nearby;
+  routecache.GetNearby(displayed_room, srcx, srcy, xx, yy, route_share_radius, nocross, nearby);
+  for (size_t i = 0; i < nearby.size(); ++i) {
+    if ((numstages = make_cached_route(*nearby[i], srcx, srcy, xx, yy, true, stages)) > 0)
+      return numstages;
+  }
+  return 0;
+}
+
+int make_move_list(int mlist, int orisrcx, int orisrcy, const int *stages, int numstages)
+{
+  int aaa;
+  mls[mlist].numstage = numstages;
+  memcpy(&mls[mlist].pos[0], &stages[0], sizeof(int) * numstages);
+//    fprintf(stderr,"stages: %d\n",numstages);
+
+  for (aaa = 0; aaa < numstages - 1; aaa++) {
+    calculate_move_stage(&mls[mlist], aaa);
+  }
+
+  mls[mlist].fromx = orisrcx;
+  mls[mlist].fromy = orisrcy;
+  mls[mlist].onstage = 0;
+  mls[mlist].onpart = 0;
+  mls[mlist].doneflag = 0;
+  mls[mlist].lastx = -1;
+  mls[mlist].lasty = -1;
+  return mlist;
+}
+
 int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
 {
 #ifdef DEBUG_PATHFINDER
@@ -720,17 +564,13 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   leftorright = 0;
   int aaa;
 
-  if (wallscreen->GetHeight() > beenhere_array_size)
-  {
-    beenhere = (short**)realloc(beenhere, sizeof(short*) * wallscreen->GetHeight());
-    beenhere_array_size = wallscreen->GetHeight();
-
-    if (beenhere == NULL)
-      quit("insufficient memory to allocate pathfinder beenhere buffer");
-  }
-
   int orisrcx = srcx, orisrcy = srcy;
+  int reqx = xx, reqy = yy;
   finalpartx = -1;
+  // only the routes over the temp mask may be remembered, because
+  // its version tells when it changes
+  const bool use_cache = (onscreen == walkable_areas_temp) && (walkable_areas_temp_version != 0);
+  bool searched = false;
 
   if (ignore_walls) {
     pathbackstage = 0;
@@ -739,17 +579,17 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
     pathbackstage = 0;
   }
   else {
-    beenhere[0] = (short *)malloc((wallscreen->GetWidth()) * (wallscreen->GetHeight()) * BEENHERE_SIZE);
-
-    for (aaa = 1; aaa < wallscreen->GetHeight(); aaa++)
-      beenhere[aaa] = beenhere[0] + aaa * (wallscreen->GetWidth());
+    int cached[MAXNEEDSTAGES];
+    int numcached = use_cache ? find_cached_route(srcx, srcy, xx, yy, nocross, cached) : 0;
+    if (numcached > 0)
+      return make_move_list(movlst, orisrcx, orisrcy, cached, numcached);
 
+    searched = true;
     if (__find_route(srcx, srcy, &xx, &yy, nocross) == 0) {
       leftorright = 1;
       if (__find_route(srcx, srcy, &xx, &yy, nocross) == 0)
         pathbackstage = -1;
     }
-    free(beenhere[0]);
   }
 
   if (pathbackstage >= 0) {
@@ -810,22 +650,11 @@ stage_again:
     }
     //Display("Route from %d,%d to %d,%d - %d stage, %d stages", orisrcx,orisrcy,xx,yy,pathbackstage,numstages);
 
-    int mlist = movlst;
-    mls[mlist].numstage = numstages;
-    memcpy(&mls[mlist].pos[0], &reallyneed[0], sizeof(int) * numstages);
-//    fprintf(stderr,"stages: %d\n",numstages);
-
-    for (aaa = 0; aaa < numstages - 1; aaa++) {
-      calculate_move_stage(&mls[mlist], aaa);
-    }
+    // remember the route, unless it had to end somewhere else
+    if (use_cache && searched && (xx == reqx) && (yy == reqy) && (numstages > 2))
+      routecache.Put(displayed_room, orisrcx, orisrcy, reqx, reqy, walkable_areas_temp_version, nocross, reallyneed, numstages);
 
-    mls[mlist].fromx = orisrcx;
-    mls[mlist].fromy = orisrcy;
-    mls[mlist].onstage = 0;
-    mls[mlist].onpart = 0;
-    mls[mlist].doneflag = 0;
-    mls[mlist].lastx = -1;
-    mls[mlist].lasty = -1;
+    int mlist = make_move_list(movlst, orisrcx, orisrcy, reallyneed, numstages);
 #ifdef DEBUG_PATHFINDER
     getch();
 #endif
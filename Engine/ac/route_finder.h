@@ -22,6 +22,9 @@ int can_see_from(int x1, int y1, int x2, int y2);
 
 void init_pathfinder();
 void set_route_move_speed(int speed_x, int speed_y);
+// Sets the distance within which the routes found before for other
+// characters may be reused; 0 only reuses the routes between the same points
+void set_route_share_radius(int radius);
 int find_route(short srcx, short srcy, short xx, short yy, Common::Bitmap *onscreen, int movlst, int nocross =
                0, int ignore_walls = 0);
 
@@ -0,0 +1,107 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <stdlib.h>
+#include "ac/routecache.h"
+
+// Packs the cell of the point into one number; coordinates are limited to
+// 16 bits the same way as in the move lists
+static int make_cell(int x, int y)
+{
+    return ((x / RouteCache::CellSize) << 16) | ((y / RouteCache::CellSize) & 0xFFFF);
+}
+
+RouteCache::RouteKey::RouteKey(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags)
+    : Room(room)
+    , SrcCell(make_cell(srcx, srcy))
+    , DstCell(make_cell(dstx, dsty))
+    , Version(version)
+    , Flags(flags)
+{
+}
+
+bool RouteCache::RouteKey::operator <(const RouteKey &other) const
+{
+    if (Room != other.Room)
+        return Room < other.Room;
+    if (SrcCell != other.SrcCell)
+        return SrcCell < other.SrcCell;
+    if (DstCell != other.DstCell)
+        return DstCell < other.DstCell;
+    if (Version != other.Version)
+        return Version < other.Version;
+    return Flags < other.Flags;
+}
+
+const RouteCache::Stages *RouteCache::Get(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags)
+{
+    RouteMap::iterator it = _routes.find(RouteKey(room, srcx, srcy, dstx, dsty, version, flags));
+    if (it == _routes.end())
+        return NULL;
+    _lru.splice(_lru.begin(), _lru, it->second.LruPos);
+    return &it->second.Route;
+}
+
+void RouteCache::GetNearby(int room, int srcx, int srcy, int dstx, int dsty, int radius, int flags,
+                           std::vector<const Stages*> &routes)
+{
+    routes.clear();
+    for (std::list<RouteKey>::const_iterator it = _lru.begin(); it != _lru.end(); ++it)
+    {
+        const RouteEntry &entry = _routes.find(*it)->second;
+        if ((entry.Room != room) || (entry.Flags != flags))
+            continue;
+        if ((abs(entry.SrcX - srcx) > radius) || (abs(entry.SrcY - srcy) > radius) ||
+            (abs(entry.DstX - dstx) > radius) || (abs(entry.DstY - dsty) > radius))
+            continue;
+        routes.push_back(&entry.Route);
+    }
+}
+
+void RouteCache::Put(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags,
+                     const int *stages, int count)
+{
+    const RouteKey key(room, srcx, srcy, dstx, dsty, version, flags);
+    RouteMap::iterator it = _routes.find(key);
+    if (it == _routes.end())
+    {
+        if (_routes.size() >= MaxRoutes)
+        {
+            _routes.erase(_lru.back());
+            _lru.pop_back();
+        }
+        _lru.push_front(key);
+        it = _routes.insert(std::make_pair(key, RouteEntry())).first;
+        it->second.LruPos = _lru.begin();
+    }
+    else
+    {
+        _lru.splice(_lru.begin(), _lru, it->second.LruPos);
+    }
+
+    RouteEntry &entry = it->second;
+    entry.Room = room;
+    entry.SrcX = srcx;
+    entry.SrcY = srcy;
+    entry.DstX = dstx;
+    entry.DstY = dsty;
+    entry.Flags = flags;
+    entry.Route.assign(stages, stages + count);
+}
+
+void RouteCache::Clear()
+{
+    _routes.clear();
+    _lru.clear();
+}
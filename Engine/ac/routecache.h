@@ -0,0 +1,84 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// RouteCache remembers the routes found by the pathfinder, as lists of move
+// stages. Routes are keyed by the room, source and destination rounded to
+// the cell size, and the version of the walkable mask they were found on,
+// so a route is only given out for the same mask.
+//
+// Routes may also be looked up by the distance from their real end points,
+// for any mask version; such routes must be checked against the current
+// mask by the caller. This lets followers walk along the route their leader
+// has just taken.
+//
+//=============================================================================
+#ifndef __AC_ROUTECACHE_H
+#define __AC_ROUTECACHE_H
+
+#include <list>
+#include <map>
+#include <vector>
+
+class RouteCache
+{
+public:
+    // Max number of remembered routes; the least recently used are dropped
+    static const size_t MaxRoutes = 64;
+    // Size of the cell route end points are rounded to
+    static const int    CellSize = 8;
+
+    typedef std::vector<int> Stages;
+
+    // Returns the route found on the same mask between the same cells,
+    // or NULL if there's none
+    const Stages *Get(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags);
+    // Gets the routes in the room which start and end within the given
+    // distance from the points, most recently used first
+    void GetNearby(int room, int srcx, int srcy, int dstx, int dsty, int radius, int flags,
+                   std::vector<const Stages*> &routes);
+    // Remembers the route; stages include the source and destination
+    void Put(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags,
+             const int *stages, int count);
+    void Clear();
+
+private:
+    struct RouteKey
+    {
+        int Room;
+        int SrcCell;
+        int DstCell;
+        unsigned Version;
+        int Flags;
+
+        RouteKey(int room, int srcx, int srcy, int dstx, int dsty, unsigned version, int flags);
+        bool operator <(const RouteKey &other) const;
+    };
+
+    struct RouteEntry
+    {
+        int Room;
+        int SrcX, SrcY;
+        int DstX, DstY;
+        int Flags;
+        Stages Route;
+        std::list<RouteKey>::iterator LruPos;
+    };
+
+    typedef std::map<RouteKey, RouteEntry> RouteMap;
+
+    RouteMap _routes;
+    std::list<RouteKey> _lru; // most recently used at front
+};
+
+#endif // __AC_ROUTECACHE_H
@@ -150,6 +150,9 @@ const int LegacyRoomVolumeFactor            = 30;
 
 #define MAX_ANIMATING_BUTTONS 15
 #define RESTART_POINT_SAVE_GAME_NUMBER 999
+// The checkpoint is saved as the difference from one of the two bases
+#define CHECKPOINT_SAVE_GAME_NUMBER 998
+#define CHECKPOINT_BASE_SAVE_GAME_NUMBER 996
 
 #define MAX_OPEN_SCRIPT_FILES 10
 
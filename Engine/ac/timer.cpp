@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <time.h>
 #include "ac/timer.h"
 #include "util/wgt2allg.h" // END_OF_FUNCTION macro
 
@@ -22,6 +23,11 @@ volatile unsigned long globalTimerCounter = 0;
 
 volatile int timerloop=0;
 int time_between_timers=25;  // in milliseconds
+// In the unthrottled mode the game does not wait for the timer, and the
+// game time is counted by the game ticks instead
+bool timer_unthrottled = false;
+time_t virtual_clock_start = 0;
+int64_t virtual_clock_ms = 0;
 // our timer, used to keep game running at same speed on all systems
 #if defined(WINDOWS_VERSION)
 void __cdecl dj_timer_handler() {
@@ -29,7 +35,41 @@ void __cdecl dj_timer_handler() {
 extern "C" void dj_timer_handler() {
 #endif
     timerloop++;
-    globalTimerCounter++;
+    if (!timer_unthrottled)
+        globalTimerCounter++;
     if (mvolcounter > 0) mvolcounter++;
 }
 END_OF_FUNCTION(dj_timer_handler);
+
+void set_timer_unthrottled(bool on)
+{
+    if (on && !timer_unthrottled)
+    {
+        virtual_clock_start = time(NULL);
+        virtual_clock_ms = 0;
+    }
+    timer_unthrottled = on;
+}
+
+bool is_timer_unthrottled()
+{
+    return timer_unthrottled;
+}
+
+void tick_virtual_clock()
+{
+    globalTimerCounter++;
+    virtual_clock_ms += time_between_timers;
+}
+
+time_t get_game_time()
+{
+    if (timer_unthrottled)
+        return virtual_clock_start + (time_t)(virtual_clock_ms / 1000);
+    return time(NULL);
+}
+
+void wait_for_timer_tick()
+{
+    while (timerloop == 0 && !timer_unthrottled) ;
+}
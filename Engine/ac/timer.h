@@ -18,10 +18,24 @@
 #ifndef __AGS_EE_AC__TIMER_H
 #define __AGS_EE_AC__TIMER_H
 
+#include <time.h>
+#include "core/types.h"
+
 #if defined(WINDOWS_VERSION)
 void __cdecl dj_timer_handler();
 #else
 extern "C" void dj_timer_handler();
 #endif
 
+// Makes the game ticks run as fast as possible, not waiting for the timer;
+// the time seen by the game is then counted by the ticks
+void set_timer_unthrottled(bool on);
+bool is_timer_unthrottled();
+// Counts one game tick in the unthrottled mode
+void tick_virtual_clock();
+// Gets the current time as seen by the game
+time_t get_game_time();
+// Waits until the timer ticks; does not wait in the unthrottled mode
+void wait_for_timer_tick();
+
 #endif // __AGS_EE_AC__TIMER_H
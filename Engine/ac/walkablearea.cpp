@@ -12,6 +12,8 @@
 //
 //=============================================================================
 
+#include <algorithm>
+#include <vector>
 #include "ac/common.h"
 #include "ac/object.h"
 #include "ac/roomstruct.h"
@@ -24,6 +26,7 @@
 #include "ac/roomstatus.h"
 #include "ac/walkablearea.h"
 #include "gfx/bitmap.h"
+#include "util/geometry.h"
 
 using AGS::Common::Bitmap;
 
@@ -36,6 +39,29 @@ extern RoomStatus*croom;
 extern RoomObject*objs;
 
 Bitmap *walkareabackup=NULL, *walkable_areas_temp = NULL;
+// Identifies walkable_areas_temp contents: the same version always means
+// the same contents, and the recently used contents get their old version
+// back when they are made again
+unsigned walkable_areas_temp_version = 0;
+static unsigned last_walkable_areas_version = 0;
+
+// walkable_areas_temp keeps the walkable areas with the blocking rectangles
+// cut out between the pathfinder calls, so that only the blockers that have
+// moved since the last call have to be redrawn
+static bool walkable_areas_temp_copied = false;
+static std::vector<Rect> temp_blockers;
+static std::vector<Rect> new_blockers;
+
+// Recently used sets of blockers and the versions given to them
+struct BlockerSet
+{
+    std::vector<Rect> Rects;
+    unsigned Version;
+};
+#define MAX_RECENT_BLOCKER_SETS 8
+static std::vector<BlockerSet> recent_blocker_sets;
+// Bounds of every walkable area in walkareabackup, in low-res coordinates
+static Rect walk_area_bounds[MAX_WALK_AREAS + 1];
 
 void redo_walkable_areas() {
 
@@ -47,15 +73,51 @@ void redo_walkable_areas() {
     thisroom.walls->Blit(walkareabackup, 0, 0, 0, 0, thisroom.walls->GetWidth(), thisroom.walls->GetHeight());
 
     int hh,ww;
+    for (hh = 0; hh <= MAX_WALK_AREAS; hh++)
+        walk_area_bounds[hh] = Rect();
     for (hh=0;hh<walkareabackup->GetHeight();hh++) {
         uint8_t *walls_scanline = thisroom.walls->GetScanLineForWriting(hh);
         for (ww=0;ww<walkareabackup->GetWidth();ww++) {
+            const int area = walls_scanline[ww];
+            if (area <= MAX_WALK_AREAS) {
+                Rect &bounds = walk_area_bounds[area];
+                if (bounds.IsEmpty())
+                    bounds = Rect(ww, hh, ww, hh);
+                else {
+                    bounds.Left = std::min(bounds.Left, ww);
+                    bounds.Right = std::max(bounds.Right, ww);
+                    bounds.Bottom = hh;
+                }
+            }
             //      if (play.walkable_areas_on[_getpixel(thisroom.walls,ww,hh)]==0)
             if (play.walkable_areas_on[walls_scanline[ww]]==0)
                 walls_scanline[ww] = 0;
         }
     }
 
+    invalidate_walkable_areas_temp();
+}
+
+void redo_walkable_area(int areanum) {
+
+    // only the pixels of this area may change, so don't look outside of it
+    const Rect &bounds = walk_area_bounds[areanum];
+    const uint8_t value = play.walkable_areas_on[areanum] ? areanum : 0;
+    for (int hh = bounds.Top; hh <= bounds.Bottom; hh++) {
+        const uint8_t *backup_scanline = walkareabackup->GetScanLine(hh);
+        uint8_t *walls_scanline = thisroom.walls->GetScanLineForWriting(hh);
+        for (int ww = bounds.Left; ww <= bounds.Right; ww++) {
+            if (backup_scanline[ww] == areanum)
+                walls_scanline[ww] = value;
+        }
+    }
+
+    invalidate_walkable_areas_temp();
+}
+
+void invalidate_walkable_areas_temp() {
+    walkable_areas_temp_copied = false;
+    recent_blocker_sets.clear();
 }
 
 int get_walkable_area_pixel(int x, int y)
@@ -120,18 +182,60 @@ void remove_walkable_areas_from_temp(int fromx, int cwidth, int starty, int endy
     starty = convert_to_low_res(starty);
     endy = convert_to_low_res(endy);
 
-    int yyy;
-    if (endy >= walkable_areas_temp->GetHeight())
-        endy = walkable_areas_temp->GetHeight() - 1;
-    if (starty < 0)
-        starty = 0;
+    // the rectangle is only remembered here, and cut out of the
+    // walkable areas by update_walkable_areas_temp
+    Rect blocker = IntersectRects(Rect(fromx, starty, fromx + cwidth - 1, endy),
+        RectWH(0, 0, walkable_areas_temp->GetWidth(), walkable_areas_temp->GetHeight()));
+    if (!blocker.IsEmpty())
+        new_blockers.push_back(blocker);
+}
 
-    for (; cwidth > 0; cwidth --) {
-        for (yyy = starty; yyy <= endy; yyy++)
-            walkable_areas_temp->PutPixel (fromx, yyy, 0);
-        fromx ++;
+static bool are_same_blockers(const std::vector<Rect> &b1, const std::vector<Rect> &b2) {
+    if (b1.size() != b2.size())
+        return false;
+    for (size_t i = 0; i < b1.size(); i++) {
+        if ((b1[i].Left != b2[i].Left) || (b1[i].Top != b2[i].Top) ||
+            (b1[i].Right != b2[i].Right) || (b1[i].Bottom != b2[i].Bottom))
+            return false;
     }
+    return true;
+}
+
+// Makes walkable_areas_temp match the walkable areas with the new blockers
+// cut out, only redrawing the rectangles that were blocked before
+static void update_walkable_areas_temp() {
 
+    size_t i;
+    if (!walkable_areas_temp_copied) {
+        walkable_areas_temp->Blit (thisroom.walls, 0,0,0,0,thisroom.walls->GetWidth(),thisroom.walls->GetHeight());
+        walkable_areas_temp_copied = true;
+    }
+    else if (are_same_blockers(temp_blockers, new_blockers))
+        return;
+    else {
+        for (i = 0; i < temp_blockers.size(); i++) {
+            const Rect &r = temp_blockers[i];
+            walkable_areas_temp->Blit (thisroom.walls, r.Left, r.Top, r.Left, r.Top, r.GetWidth(), r.GetHeight());
+        }
+    }
+
+    for (i = 0; i < new_blockers.size(); i++)
+        walkable_areas_temp->FillRect(new_blockers[i], 0);
+    temp_blockers.swap(new_blockers);
+
+    for (i = 0; i < recent_blocker_sets.size(); i++) {
+        if (are_same_blockers(recent_blocker_sets[i].Rects, temp_blockers)) {
+            walkable_areas_temp_version = recent_blocker_sets[i].Version;
+            return;
+        }
+    }
+    if (recent_blocker_sets.size() >= MAX_RECENT_BLOCKER_SETS)
+        recent_blocker_sets.erase(recent_blocker_sets.begin());
+    BlockerSet set;
+    set.Rects = temp_blockers;
+    set.Version = ++last_walkable_areas_version;
+    recent_blocker_sets.push_back(set);
+    walkable_areas_temp_version = set.Version;
 }
 
 int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
@@ -141,12 +245,13 @@ int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
 }
 
 Bitmap *prepare_walkable_areas (int sourceChar) {
-    // copy the walkable areas to the temp bitmap
-    walkable_areas_temp->Blit (thisroom.walls, 0,0,0,0,thisroom.walls->GetWidth(),thisroom.walls->GetHeight());
+    new_blockers.clear();
     // if the character who's moving doesn't Bitmap *, don't bother checking
     if (sourceChar < 0) ;
-    else if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
+    else if (game.chars[sourceChar].flags & CHF_NOBLOCKING) {
+        update_walkable_areas_temp();
         return walkable_areas_temp;
+    }
 
     int ww;
     // for each character in the current room, make the area under
@@ -194,6 +299,7 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
         remove_walkable_areas_from_temp(x1, width, y1, y2);
     }
 
+    update_walkable_areas_temp();
     return walkable_areas_temp;
 }
 
@@ -18,7 +18,12 @@
 #ifndef __AGS_EE_AC__WALKABLEAREA_H
 #define __AGS_EE_AC__WALKABLEAREA_H
 
+// Applies walkable areas' on/off state to the room's walkable mask
 void  redo_walkable_areas();
+// Same as above, when only the given area was turned on or off
+void  redo_walkable_area(int areanum);
+// Must be called whenever the room's walkable mask changes
+void  invalidate_walkable_areas_temp();
 int   get_walkable_area_pixel(int x, int y);
 int   get_area_scaling (int onarea, int xx, int yy);
 void  scale_sprite_size(int sppic, int zoom_level, int *newwidth, int *newheight);
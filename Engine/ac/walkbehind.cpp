@@ -12,6 +12,8 @@
 //
 //=============================================================================
 
+#include <string.h>
+#include <vector>
 #include "ac/walkbehind.h"
 #include "ac/common.h"
 #include "ac/common_defines.h"
@@ -38,6 +40,10 @@ IDriverDependantBitmap *walkBehindBitmap[MAX_OBJ];
 int walkBehindsCachedForBgNum = 0;
 WalkBehindMethodEnum walkBehindMethod = DrawOverCharSprite;
 int walk_behind_baselines_changed = 0;
+// Walk-behind runs for the whole room mask, and the index of the first run
+// of each row; runs of row Y are [walkBehindRowSpans[Y], walkBehindRowSpans[Y + 1])
+std::vector<WalkBehindSpan> walkBehindSpans;
+std::vector<int> walkBehindRowSpans;
 
 void update_walk_behind_images()
 {
@@ -117,26 +123,44 @@ void recache_walk_behinds () {
   if ((!thisroom.object->IsLinearBitmap()) || (thisroom.object->GetColorDepth() != 8))
     quit("Walk behinds bitmap not linear");
 
-  for (ee=0;ee<thisroom.object->GetWidth();ee++) {
-    walkBehindExists[ee] = 0;
-    for (rr=0;rr<thisroom.object->GetHeight();rr++) {
-      tmm = thisroom.object->GetScanLine(rr)[ee];
-      //tmm = _getpixel(thisroom.object,ee,rr);
-      if ((tmm >= 1) && (tmm < MAX_OBJ)) {
+  // Scan the mask row by row; this is cache friendly and lets us gather the
+  // horizontal runs at the same time as the per-column bounds
+  const int width = thisroom.object->GetWidth();
+  const int height = thisroom.object->GetHeight();
+  memset(walkBehindExists, 0, width);
+  walkBehindSpans.clear();
+  walkBehindRowSpans.resize(height + 1);
+  for (rr=0;rr<height;rr++) {
+    walkBehindRowSpans[rr] = walkBehindSpans.size();
+    const unsigned char *row = thisroom.object->GetScanLine(rr);
+    for (ee=0;ee<width;) {
+      tmm = row[ee];
+      if ((tmm < 1) || (tmm >= MAX_OBJ)) {
+        ee++;
+        continue;
+      }
+
+      WalkBehindSpan span;
+      span.X1 = ee;
+      span.Area = tmm;
+      for (; (ee < width) && (row[ee] == tmm); ee++) {
         if (!walkBehindExists[ee]) {
           walkBehindStartY[ee] = rr;
           walkBehindExists[ee] = tmm;
-          noWalkBehindsAtAll = 0;
         }
         walkBehindEndY[ee] = rr + 1;  // +1 to allow bottom line of screen to work
-
-        if (ee < walkBehindLeft[tmm]) walkBehindLeft[tmm] = ee;
-        if (rr < walkBehindTop[tmm]) walkBehindTop[tmm] = rr;
-        if (ee > walkBehindRight[tmm]) walkBehindRight[tmm] = ee;
-        if (rr > walkBehindBottom[tmm]) walkBehindBottom[tmm] = rr;
       }
+      span.X2 = ee;
+      walkBehindSpans.push_back(span);
+      noWalkBehindsAtAll = 0;
+
+      if (span.X1 < walkBehindLeft[tmm]) walkBehindLeft[tmm] = span.X1;
+      if (rr < walkBehindTop[tmm]) walkBehindTop[tmm] = rr;
+      if (span.X2 - 1 > walkBehindRight[tmm]) walkBehindRight[tmm] = span.X2 - 1;
+      if (rr > walkBehindBottom[tmm]) walkBehindBottom[tmm] = rr;
     }
   }
+  walkBehindRowSpans[height] = walkBehindSpans.size();
 
   if (walkBehindMethod == DrawAsSeparateSprite)
   {
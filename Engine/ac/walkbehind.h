@@ -18,6 +18,9 @@
 #ifndef __AGS_EE_AC__WALKBEHIND_H
 #define __AGS_EE_AC__WALKBEHIND_H
 
+#include <string.h>
+#include "core/types.h"
+
 enum WalkBehindMethodEnum
 {
     DrawOverCharSprite,
@@ -25,6 +28,109 @@ enum WalkBehindMethodEnum
     DrawAsSeparateCharSprite
 };
 
+// Horizontal run of walk-behind mask pixels belonging to the same area;
+// X2 is exclusive. Runs are stored row by row, so that a mask row may be
+// applied to a sprite row with contiguous memory operations.
+struct WalkBehindSpan
+{
+    int X1;
+    int X2;
+    int Area;
+};
+
+// Pixel accessors for the walk-behind kernels, specialized per bytes per
+// pixel so that the row loops are compiled without colour depth branches
+template <int BPP> struct WalkBehindPixel;
+
+template <> struct WalkBehindPixel<1>
+{
+    static inline uint32_t Get(const uint8_t *row, int x) { return row[x]; }
+    static inline void Put(uint8_t *row, int x, uint32_t c) { row[x] = (uint8_t)c; }
+    static inline void Fill(uint8_t *row, int x1, int x2, uint32_t c) { memset(row + x1, c, x2 - x1); }
+};
+
+template <> struct WalkBehindPixel<2>
+{
+    static inline uint32_t Get(const uint8_t *row, int x) { return ((const uint16_t*)row)[x]; }
+    static inline void Put(uint8_t *row, int x, uint32_t c) { ((uint16_t*)row)[x] = (uint16_t)c; }
+    static inline void Fill(uint8_t *row, int x1, int x2, uint32_t c)
+    {
+        uint16_t *p = (uint16_t*)row;
+        for (int x = x1; x < x2; ++x)
+            p[x] = (uint16_t)c;
+    }
+};
+
+template <> struct WalkBehindPixel<3>
+{
+    static inline uint32_t Get(const uint8_t *row, int x)
+    {
+        const uint8_t *p = row + x * 3;
+        return p[0] | (p[1] << 8) | (p[2] << 16);
+    }
+    static inline void Put(uint8_t *row, int x, uint32_t c)
+    {
+        uint8_t *p = row + x * 3;
+        p[0] = (uint8_t)c;
+        p[1] = (uint8_t)(c >> 8);
+        p[2] = (uint8_t)(c >> 16);
+    }
+    static inline void Fill(uint8_t *row, int x1, int x2, uint32_t c)
+    {
+        for (int x = x1; x < x2; ++x)
+            Put(row, x, c);
+    }
+};
+
+template <> struct WalkBehindPixel<4>
+{
+    static inline uint32_t Get(const uint8_t *row, int x) { return ((const uint32_t*)row)[x]; }
+    static inline void Put(uint8_t *row, int x, uint32_t c) { ((uint32_t*)row)[x] = c; }
+    static inline void Fill(uint8_t *row, int x1, int x2, uint32_t c)
+    {
+        uint32_t *p = (uint32_t*)row;
+        for (int x = x1; x < x2; ++x)
+            p[x] = c;
+    }
+};
+
+// Copies background pixels over the sprite row range [sx1, sx2) wherever the
+// character's own pixel is not transparent; bg is indexed by the sprite x
+// plus bg_offset, and zoomX (if set) maps sprite x to the check row x.
+// Pixels are compared as unsigned values of their own size, which is what
+// lets 16-bit mask colours at or above 0x8000 (e.g. magenta) be recognized.
+// Returns whether any pixels were copied.
+template <int BPP>
+inline int copy_walk_behind_run(uint8_t *dst, const uint8_t *bg, const uint8_t *check,
+                                int sx1, int sx2, int bg_offset, uint32_t maskcol, const int *zoomX)
+{
+    typedef WalkBehindPixel<BPP> Px;
+    if (!zoomX)
+    {
+        // Unscaled: sprite, check and background rows are all read
+        // sequentially, so keep the loop free of branches
+        uint32_t changed = 0;
+        for (int sx = sx1; sx < sx2; ++sx)
+        {
+            const uint32_t opaque = Px::Get(check, sx) != maskcol;
+            Px::Put(dst, sx, opaque ? Px::Get(bg, sx + bg_offset) : Px::Get(dst, sx));
+            changed |= opaque;
+        }
+        return changed;
+    }
+
+    int changed = 0;
+    for (int sx = sx1; sx < sx2; ++sx)
+    {
+        if (Px::Get(check, zoomX[sx]) != maskcol)
+        {
+            Px::Put(dst, sx, Px::Get(bg, sx + bg_offset));
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
 void update_walk_behind_images();
 void recache_walk_behinds ();
 
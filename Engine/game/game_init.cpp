@@ -326,7 +326,11 @@ void LoadFonts()
         FontRenderParams params;
         params.YOffset = game.fontvoffset[i];
 
-        if (!wloadfont_size(i, fontsize, &params))
+        // The first font is required to start the game, the rest are only
+        // loaded when something is printed with them
+        if (i > 0)
+            wloadfont_lazy(i, fontsize, &params);
+        else if (!wloadfont_size(i, fontsize, &params))
             quitprintf("Unable to load font %d, no renderer could load a matching file", i);
     }
 }
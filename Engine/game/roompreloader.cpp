@@ -0,0 +1,227 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "game/roompreloader.h"
+#include "debug/out.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/filestream.h"
+#include "util/memorystream.h"
+#include "util/mutex_lock.h"
+
+using namespace AGS::Common;
+
+extern AGSPlatformDriver *platform;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// How many read room files are kept waiting to be loaded
+const size_t MaxPreloadedRooms = 3;
+
+RoomPreloader *RoomPreloader::_workerPreloader = NULL;
+
+RoomPreloader::RoomPreloader()
+    : _threadRunning(false)
+{
+}
+
+RoomPreloader::~RoomPreloader()
+{
+    StopThread();
+}
+
+bool RoomPreloader::StartThread()
+{
+    if (_threadRunning || _workerPreloader != NULL)
+        return false;
+    _workerPreloader = this;
+    _threadRunning = _thread.CreateAndStart(WorkerThread, true);
+    if (!_threadRunning)
+    {
+        _workerPreloader = NULL;
+        Debug::Printf(kDbgMsg_Error, "Failed to start room preloader thread");
+        return false;
+    }
+    Debug::Printf("Started room preloader thread");
+    return true;
+}
+
+void RoomPreloader::StopThread()
+{
+    if (!_threadRunning)
+        return;
+    _thread.Stop();
+    _threadRunning = false;
+    _workerPreloader = NULL;
+    Clear();
+}
+
+void RoomPreloader::Preload(const String &room_file)
+{
+    if (!_threadRunning)
+        return;
+    AssetLocation loc;
+    if (!AssetManager::GetAssetLocation(room_file, loc))
+        return;
+
+    MutexLock lock(_mutex);
+    if (FindJob(room_file, loc) != _jobs.end())
+        return;
+    TrimJobs(MaxPreloadedRooms - 1);
+    // the strings are copied, so that their buffers are not shared with
+    // the caller's strings
+    Job job;
+    job.Filename = String(room_file.GetCStr());
+    job.Location.FileName = String(loc.FileName.GetCStr());
+    job.Location.Offset = loc.Offset;
+    job.Location.Size = loc.Size;
+    job.State = kJob_Queued;
+    _jobs.push_back(job);
+    Debug::Printf("Preloading room file %s", room_file.GetCStr());
+}
+
+Stream *RoomPreloader::Open(const String &room_file)
+{
+    if (!_threadRunning)
+        return NULL;
+    AssetLocation loc;
+    if (!AssetManager::GetAssetLocation(room_file, loc))
+        return NULL;
+
+    for (;;)
+    {
+        MutexLock lock(_mutex);
+        JobList::iterator it = FindJob(room_file, loc);
+        if (it == _jobs.end())
+            return NULL;
+        if (it->State == kJob_Done)
+        {
+            MemoryStream *in = NULL;
+            if (!it->Data.empty())
+            {
+                in = new MemoryStream();
+                in->Swap(it->Data);
+            }
+            _jobs.erase(it);
+            return in;
+        }
+        // the file is still to be read, the thread may be busy with another
+        // one, so read it here if it was not started yet
+        if (it->State == kJob_Queued)
+        {
+            it->State = kJob_Reading;
+            const String filename(it->Location.FileName.GetCStr());
+            lock.Release();
+            std::vector<uint8_t> data;
+            ReadFile(filename, loc.Offset, loc.Size, data);
+            lock.Acquire(_mutex);
+            it->Data.swap(data);
+            it->State = kJob_Done;
+            continue;
+        }
+        lock.Release();
+        platform->YieldCPU();
+    }
+}
+
+void RoomPreloader::Clear()
+{
+    for (;;)
+    {
+        MutexLock lock(_mutex);
+        TrimJobs(0);
+        if (_jobs.empty())
+            break;
+        lock.Release();
+        platform->YieldCPU();
+    }
+}
+
+RoomPreloader::JobList::iterator RoomPreloader::FindJob(const String &room_file, const AssetLocation &loc)
+{
+    for (JobList::iterator it = _jobs.begin(); it != _jobs.end(); ++it)
+    {
+        if (it->Filename.CompareNoCase(room_file) == 0 &&
+            it->Location.FileName.Compare(loc.FileName) == 0 &&
+            it->Location.Offset == loc.Offset && it->Location.Size == loc.Size)
+            return it;
+    }
+    return _jobs.end();
+}
+
+void RoomPreloader::TrimJobs(size_t keep_count)
+{
+    size_t count = _jobs.size();
+    for (JobList::iterator it = _jobs.begin(); it != _jobs.end() && count > keep_count;)
+    {
+        if (it->State == kJob_Reading)
+        {
+            ++it;
+            continue;
+        }
+        it = _jobs.erase(it);
+        count--;
+    }
+}
+
+bool RoomPreloader::ReadFile(const String &filename, int offset, int size, std::vector<uint8_t> &data)
+{
+    data.clear();
+    if (size <= 0)
+        return false;
+    FileStream in(filename, kFile_Open, kFile_Read);
+    if (!in.IsValid() || in.Seek(offset, kSeekBegin) != (size_t)offset)
+        return false;
+    data.resize(size);
+    if (in.Read(&data[0], size) != (size_t)size)
+    {
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+void RoomPreloader::WorkerThread()
+{
+    RoomPreloader *preloader = _workerPreloader;
+    MutexLock lock(preloader->_mutex);
+    JobList::iterator it = preloader->_jobs.begin();
+    for (; it != preloader->_jobs.end() && it->State != kJob_Queued; ++it);
+    if (it == preloader->_jobs.end())
+    {
+        lock.Release();
+        platform->Delay(5);
+        return;
+    }
+    // the game thread keeps the job in the list while it is being read
+    it->State = kJob_Reading;
+    const String filename(it->Location.FileName.GetCStr());
+    const int offset = it->Location.Offset;
+    const int size = it->Location.Size;
+    lock.Release();
+
+    // if the file could not be read, the room will be loaded as usual, and
+    // the error is reported then
+    std::vector<uint8_t> data;
+    ReadFile(filename, offset, size, data);
+
+    lock.Acquire(preloader->_mutex);
+    it->Data.swap(data);
+    it->State = kJob_Done;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,103 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// RoomPreloader reads the room files, which are likely to be loaded soon,
+// into memory on the separate thread. When the room is loaded afterwards, it
+// is read from the memory instead of the disk.
+//
+// Only the raw file data is read in the background: decoding the room needs
+// the asset manager and Allegro, which may only be used on the game thread.
+//
+//=============================================================================
+#ifndef __AGS_EE_GAME__ROOMPRELOADER_H
+#define __AGS_EE_GAME__ROOMPRELOADER_H
+
+#include <list>
+#include <vector>
+#include "core/assetmanager.h"
+#include "util/mutex.h"
+#include "util/string.h"
+#include "util/thread.h"
+
+namespace AGS
+{
+namespace Common { class Stream; }
+
+namespace Engine
+{
+
+using Common::AssetLocation;
+using Common::Stream;
+using Common::String;
+
+class RoomPreloader
+{
+public:
+    RoomPreloader();
+    ~RoomPreloader();
+
+    // Starts the thread which reads the room files
+    bool StartThread();
+    // Stops the thread and forgets the preloaded rooms
+    void StopThread();
+
+    // Queues the room file for reading; does nothing without the thread
+    void Preload(const String &room_file);
+    // Returns the stream over the preloaded room file, or NULL if this file
+    // was not preloaded. Waits if the file is still being read. The data is
+    // given to the stream and is not kept by the preloader anymore.
+    Stream *Open(const String &room_file);
+    // Forgets all the preloaded rooms
+    void Clear();
+
+private:
+    enum JobState
+    {
+        kJob_Queued,
+        kJob_Reading,
+        kJob_Done
+    };
+
+    struct Job
+    {
+        String               Filename;
+        AssetLocation        Location;
+        JobState             State;
+        std::vector<uint8_t> Data;  // empty if the file could not be read
+    };
+    typedef std::list<Job> JobList;
+
+    // Finds the job for the given file at the given location
+    JobList::iterator FindJob(const String &room_file, const AssetLocation &loc);
+    // Removes the finished jobs, leaving the given number of newest ones
+    void TrimJobs(size_t keep_count);
+
+    static bool ReadFile(const String &filename, int offset, int size, std::vector<uint8_t> &data);
+    static void WorkerThread();
+
+    Thread   _thread;
+    bool     _threadRunning;
+    // The jobs are guarded by _mutex; the game thread does not remove the
+    // job while it is being read
+    Mutex    _mutex;
+    JobList  _jobs;
+
+    // The preloader that the thread works for
+    static RoomPreloader *_workerPreloader;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GAME__ROOMPRELOADER_H
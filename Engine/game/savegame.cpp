@@ -39,6 +39,8 @@
 #include "gfx/graphicsdriver.h"
 #include "game/savegame.h"
 #include "game/savegame_internal.h"
+#include "game/savegamesnapshot.h"
+#include "game/savegamewriter.h"
 #include "main/main.h"
 #include "media/audio/audio.h"
 #include "media/audio/soundclip.h"
@@ -48,6 +50,8 @@
 #include "script/cc_error.h"
 #include "util/alignedstream.h"
 #include "util/file.h"
+#include "util/lzstream.h"
+#include "util/memorystream.h"
 #include "util/stream.h"
 #include "util/string_utils.h"
 #include "util/version.h"
@@ -56,7 +60,7 @@ using namespace Common;
 using namespace Engine;
 
 // function is currently implemented in game.cpp
-SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data);
+SavegameError restore_game_data(Stream *in, SavegameVersion svg_version, int svg_flags, const PreservedParams &pp, RestoredData &r_data);
 void save_game_data(Stream *out);
 
 extern GameSetupStruct game;
@@ -67,6 +71,7 @@ extern Bitmap *dynamicallyCreatedSurfaces[MAX_DYNAMIC_SURFACES];
 extern Bitmap *raw_saved_screen;
 extern RoomStatus troom;
 extern RoomStatus *croom;
+extern SavegameWriter savegameWriter;
 
 
 namespace AGS
@@ -79,6 +84,7 @@ const String SavegameSource::Signature = "Adventure Game Studio saved game";
 
 SavegameSource::SavegameSource()
     : Version(kSvgVersion_Undefined)
+    , Flags(kSvgFlag_None)
 {
 }
 
@@ -155,8 +161,54 @@ void SkipSaveImage(Stream *in)
         skip_serialized_bitmap(in);
 }
 
-SavegameError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems)
+// Gets the position of the file name in the path
+size_t FindFilename(const String &path)
 {
+    size_t slash_at = path.FindCharReverse('/');
+    const size_t bslash_at = path.FindCharReverse('\\');
+    if (slash_at == (size_t)-1 || (bslash_at != (size_t)-1 && bslash_at > slash_at))
+        slash_at = bslash_at;
+    return slash_at == (size_t)-1 ? 0 : slash_at + 1;
+}
+
+SavegameError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems,
+                               bool apply_delta = true);
+
+// Gets the path of the base savegame of the delta one, in the same directory
+String MakeDeltaBasePath(const String &filename, const String &base_name)
+{
+    return String::FromFormat("%s%s", filename.Left(FindFilename(filename)).GetCStr(), base_name.GetCStr());
+}
+
+// Makes the full game data of the delta savegame out of its base savegame
+SavegameError ApplyDeltaSavegame(const String &filename, AStream &in)
+{
+    const String base_name = StrUtil::ReadString(in.get());
+    SavegameSource base_src;
+    SavegameError err = OpenSavegameBase(MakeDeltaBasePath(filename, base_name), &base_src, NULL, kSvgDesc_None);
+    if (err != kSvgErr_NoError)
+        return err;
+    if (base_src.Flags & kSvgFlag_Delta)
+        return kSvgErr_InconsistentFormat;
+
+    std::vector<uint8_t> data;
+    if (!SavegameSnapshot::ReadDelta(in.get(), base_src.InputStream.get(), data))
+    {
+        Debug::Printf(kDbgMsg_Error, "Restore game error: delta savegame does not match its base %s", base_name.GetCStr());
+        return kSvgErr_InconsistentFormat;
+    }
+    MemoryStream *state = new MemoryStream();
+    state->Swap(data);
+    in.reset(state);
+    return kSvgErr_NoError;
+}
+
+SavegameError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems,
+                               bool apply_delta)
+{
+    // the file may be still waiting to be written
+    savegameWriter.Wait();
+
     AStream in(File::OpenFileRead(filename));
     if (!in.get())
         return kSvgErr_FileNotFound;
@@ -212,12 +264,28 @@ SavegameError OpenSavegameBase(const String &filename, SavegameSource *src, Save
         in->ReadInt32(); // unscaled game height with borders, now obsolete
         in->ReadInt32(); // color depth
     }
+    int svg_flags = kSvgFlag_None;
+    if (svg_ver >= kSvgVersion_Flags)
+        svg_flags = in->ReadInt32();
+    if (svg_flags & ~kSvgFlag_All)
+        return kSvgErr_FormatVersionNotSupported;
 
     if (src)
     {
         src->Filename = filename;
         src->Version = svg_ver;
-        src->InputStream.reset(in.release());
+        src->Flags = svg_flags;
+        if (svg_flags & kSvgFlag_Compressed)
+            src->InputStream.reset(new LzReadStream(in.release(), kDisposeAfterUse));
+        else
+            src->InputStream.reset(in.release());
+        if ((svg_flags & kSvgFlag_Delta) && apply_delta)
+        {
+            SavegameError err = ApplyDeltaSavegame(filename, src->InputStream);
+            if (err != kSvgErr_NoError)
+                return err;
+            src->Flags |= kSvgFlag_InMemory;
+        }
     }
     if (desc)
     {
@@ -544,12 +612,12 @@ SavegameError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_da
     return kSvgErr_NoError;
 }
 
-SavegameError RestoreGameState(Stream *in, SavegameVersion svg_version)
+SavegameError RestoreGameState(Stream *in, SavegameVersion svg_version, int svg_flags)
 {
     PreservedParams pp;
     RestoredData r_data;
     DoBeforeRestore(pp);
-    SavegameError err = restore_game_data(in, svg_version, pp, r_data);
+    SavegameError err = restore_game_data(in, svg_version, svg_flags, pp, r_data);
     if (err != kSvgErr_NoError)
         return err;
     return DoAfterRestore(pp, r_data);
@@ -564,12 +632,8 @@ void WriteSaveImage(Stream *out, const Bitmap *screenshot)
         serialize_bitmap(screenshot, out);
 }
 
-Stream *StartSavegame(const String &filename, const String &desc, const Bitmap *image)
+void WriteSavegameHeader(Stream *out, const String &desc, const Bitmap *image, int svg_flags)
 {
-    Stream *out = Common::File::CreateFile(filename);
-    if (!out)
-        return NULL;
-
     // Initialize and write Vista header
     RICH_GAME_MEDIA_HEADER vistaHeader;
     memset(&vistaHeader, 0, sizeof(RICH_GAME_MEDIA_HEADER));
@@ -610,6 +674,32 @@ Stream *StartSavegame(const String &filename, const String &desc, const Bitmap *
     // Write current display mode parameters
     out->WriteInt32(play.viewport.GetHeight()); // for compatibility with old engines
     out->WriteInt32(ScreenResolution.ColorDepth);
+    out->WriteInt32(svg_flags);
+}
+
+size_t WriteDeltaSavegameData(Stream *out, const String &base_filename,
+                              const SavegameSnapshot &base, const SavegameSnapshot &state)
+{
+    // only the name is written, the base is looked for next to the delta
+    StrUtil::WriteString(base_filename.Mid(FindFilename(base_filename)), out);
+    return state.WriteDelta(base, out);
+}
+
+String GetDeltaSavegameBase(const String &filename)
+{
+    SavegameSource src;
+    if (OpenSavegameBase(filename, &src, NULL, kSvgDesc_None, false) != kSvgErr_NoError ||
+        (src.Flags & kSvgFlag_Delta) == 0)
+        return "";
+    return MakeDeltaBasePath(filename, StrUtil::ReadString(src.InputStream.get()));
+}
+
+Stream *StartSavegame(const String &filename, const String &desc, const Bitmap *image)
+{
+    Stream *out = Common::File::CreateFile(filename);
+    if (!out)
+        return NULL;
+    WriteSavegameHeader(out, desc, image, kSvgFlag_None);
     return out;
 }
 
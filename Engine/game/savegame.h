@@ -31,19 +31,41 @@ using Common::Stream;
 using Common::String;
 using Common::Version;
 
+class SavegameSnapshot;
+
 //-----------------------------------------------------------------------------
 // Savegame version history
 //
 // 8      last old style saved game format (of AGS 3.2.1)
+// 9      format flags after the description; game data may be compressed,
+//        or be the difference from another savegame
+// 10     room states are preceded by their sizes
 //-----------------------------------------------------------------------------
 enum SavegameVersion
 {
     kSvgVersion_Undefined = 0,
     kSvgVersion_321       = 8,
-    kSvgVersion_Current   = kSvgVersion_321,
+    kSvgVersion_Flags     = 9,
+    kSvgVersion_RoomSizes = 10,
+    kSvgVersion_Current   = kSvgVersion_RoomSizes,
     kSvgVersion_LowestSupported = kSvgVersion_321
 };
 
+// Savegame format flags
+enum SavegameFlags
+{
+    kSvgFlag_None       = 0,
+    // game data is written as the LZ compressed stream
+    kSvgFlag_Compressed = 0x0001,
+    // game data is the difference from the base savegame, which is
+    // named at the start of the data
+    kSvgFlag_Delta      = 0x0002,
+    kSvgFlag_All        = kSvgFlag_Compressed | kSvgFlag_Delta,
+    // not written in files: the game data is restored from memory,
+    // and so has no data of the plugins
+    kSvgFlag_InMemory   = 0x8000
+};
+
 // Error codes for save restoration routine
 enum SavegameError
 {
@@ -74,7 +96,10 @@ struct SavegameSource
     String              Filename;
     // Savegame format version
     SavegameVersion     Version;
-    // A ponter to the opened stream
+    // Savegame format flags
+    int                 Flags;
+    // A ponter to the opened stream; compressed game data is
+    // unpacked by this stream as it is read
     AStream             InputStream;
 
     SavegameSource();
@@ -119,8 +144,17 @@ SavegameError  OpenSavegame(const String &filename, SavegameSource &src,
 SavegameError  OpenSavegame(const String &filename, SavegameDescription &desc, SavegameDescElem elems = kSvgDesc_All);
 
 // Reads the game data from the save stream and reinitializes game state
-SavegameError  RestoreGameState(Stream *in, SavegameVersion svg_version);
-
+SavegameError  RestoreGameState(Stream *in, SavegameVersion svg_version, int svg_flags = kSvgFlag_None);
+
+// Writes the game data of the delta savegame, which refers to the base
+// savegame file in the same directory; returns the amount of changed data
+size_t         WriteDeltaSavegameData(Stream *out, const String &base_filename,
+                                      const SavegameSnapshot &base, const SavegameSnapshot &state);
+// Gets the path of the base savegame which the delta savegame refers to;
+// returns empty string if there's no such delta savegame
+String         GetDeltaSavegameBase(const String &filename);
+// Writes savegame description, which the game data must follow
+void           WriteSavegameHeader(Stream *out, const String &desc, const Bitmap *image, int svg_flags);
 // Opens savegame for writing and puts in savegame description
 Stream        *StartSavegame(const String &filename, const String &desc, const Bitmap *image);
 
@@ -0,0 +1,290 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <map>
+#include <string.h>
+#include "game/savegamesnapshot.h"
+#include "util/math.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+// Chunk sizes; the border is put where the low bits of the rolling hash
+// are zero, which makes chunks of about 1 KB on average
+const size_t   MinChunk  = 256;
+const size_t   MaxChunk  = 8192;
+const uint32_t ChunkMask = 0x3FF;
+// Max size of the game state read from the delta; anything larger is taken
+// for a broken file rather than allocated
+const size_t   MaxStateSize = 256 * 1024 * 1024;
+// The data is read by blocks of this size, so that the short stream fails
+// before the whole size written in the file is allocated
+const size_t   ReadBlock = 64 * 1024;
+
+// Delta operations
+enum DeltaOp
+{
+    kDeltaOp_Copy,      // copy the data from the base
+    kDeltaOp_Data       // take the data from the delta
+};
+
+struct DeltaBlock
+{
+    DeltaOp Type;
+    size_t  Offset; // in the base for copy, in the new data otherwise
+    size_t  Length;
+};
+
+// Random values for each byte, which the rolling hash is made of
+static uint32_t GearTable[256];
+static bool     GearTableReady = false;
+
+static void MakeGearTable()
+{
+    uint32_t v = 0x9E3779B9;
+    for (int i = 0; i < 256; ++i)
+    {
+        // xorshift generator
+        v ^= v << 13;
+        v ^= v >> 17;
+        v ^= v << 5;
+        GearTable[i] = v;
+    }
+    GearTableReady = true;
+}
+
+SavegameSnapshot::SavegameSnapshot()
+    : _hasChunks(false)
+    , _hash(0)
+    , _hasHash(false)
+{
+}
+
+void SavegameSnapshot::Swap(MemoryStream &state)
+{
+    state.Swap(_data);
+    _chunks.clear();
+    _hasChunks = false;
+    _hasHash = false;
+}
+
+void SavegameSnapshot::Swap(SavegameSnapshot &other)
+{
+    _data.swap(other._data);
+    _chunks.swap(other._chunks);
+    std::swap(_hasChunks, other._hasChunks);
+    std::swap(_hash, other._hash);
+    std::swap(_hasHash, other._hasHash);
+}
+
+void SavegameSnapshot::Clear()
+{
+    _data.clear();
+    _chunks.clear();
+    _hasChunks = false;
+    _hasHash = false;
+}
+
+uint32_t SavegameSnapshot::GetHash() const
+{
+    if (!_hasHash)
+    {
+        _hash = Hash(GetData(), _data.size());
+        _hasHash = true;
+    }
+    return _hash;
+}
+
+uint32_t SavegameSnapshot::Hash(const uint8_t *data, size_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void SavegameSnapshot::MakeChunks() const
+{
+    if (_hasChunks)
+        return;
+    if (!GearTableReady)
+        MakeGearTable();
+
+    _chunks.clear();
+    const uint8_t *data = GetData();
+    const size_t size = _data.size();
+    size_t start = 0;
+    uint32_t roll = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        // every byte is shifted out of the hash after 32 steps, so the
+        // hash only depends on the last bytes
+        roll = (roll << 1) + GearTable[data[i]];
+        const size_t len = i + 1 - start;
+        if ((len >= MinChunk && (roll & ChunkMask) == 0) || len >= MaxChunk)
+        {
+            Chunk chunk = { start, len, Hash(data + start, len) };
+            _chunks.push_back(chunk);
+            start = i + 1;
+        }
+    }
+    if (start < size)
+    {
+        Chunk chunk = { start, size - start, Hash(data + start, size - start) };
+        _chunks.push_back(chunk);
+    }
+    _hasChunks = true;
+}
+
+size_t SavegameSnapshot::WriteDelta(const SavegameSnapshot &base, Stream *out) const
+{
+    MakeChunks();
+    base.MakeChunks();
+    std::map<uint32_t, size_t> base_index;
+    for (size_t i = 0; i < base._chunks.size(); ++i)
+        base_index.insert(std::make_pair(base._chunks[i].Hash, i));
+
+    // Neighbour chunks that are also neighbours in the base make one copy,
+    // neighbour changed chunks make one data block
+    std::vector<DeltaBlock> ops;
+    size_t changed = 0;
+    for (size_t i = 0; i < _chunks.size(); ++i)
+    {
+        const Chunk &chunk = _chunks[i];
+        DeltaBlock op = { kDeltaOp_Data, chunk.Offset, chunk.Length };
+        std::map<uint32_t, size_t>::const_iterator it = base_index.find(chunk.Hash);
+        if (it != base_index.end())
+        {
+            const Chunk &base_chunk = base._chunks[it->second];
+            if (base_chunk.Length == chunk.Length &&
+                memcmp(base.GetData() + base_chunk.Offset, GetData() + chunk.Offset, chunk.Length) == 0)
+            {
+                op.Type = kDeltaOp_Copy;
+                op.Offset = base_chunk.Offset;
+            }
+        }
+        if (op.Type == kDeltaOp_Data)
+            changed += op.Length;
+
+        if (!ops.empty() && ops.back().Type == op.Type &&
+            ops.back().Offset + ops.back().Length == op.Offset)
+            ops.back().Length += op.Length;
+        else
+            ops.push_back(op);
+    }
+
+    out->WriteInt32(base.GetSize());
+    out->WriteInt32(base.GetHash());
+    out->WriteInt32(GetSize());
+    out->WriteInt32(GetHash());
+    out->WriteInt32(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        out->WriteInt8(ops[i].Type);
+        if (ops[i].Type == kDeltaOp_Copy)
+        {
+            out->WriteInt32(ops[i].Offset);
+            out->WriteInt32(ops[i].Length);
+        }
+        else
+        {
+            out->WriteInt32(ops[i].Length);
+            out->Write(GetData() + ops[i].Offset, ops[i].Length);
+        }
+    }
+    return changed;
+}
+
+// Returns number of bytes left in the stream, or (size_t)-1 if the stream
+// does not know its length, as the compressed one
+static size_t GetRemainingLength(Stream *in)
+{
+    const size_t len = in->GetLength();
+    return len > 0 ? len - Math::Min(len, in->GetPosition()) : (size_t)-1;
+}
+
+// Reads the data by blocks, appending it to the buffer
+static bool ReadAppend(Stream *in, std::vector<uint8_t> &buf, size_t len)
+{
+    while (len > 0)
+    {
+        const size_t block = Math::Min(len, ReadBlock);
+        const size_t at = buf.size();
+        buf.resize(at + block);
+        if (in->Read(&buf[at], block) != block)
+            return false;
+        len -= block;
+    }
+    return true;
+}
+
+bool SavegameSnapshot::ReadDelta(Stream *in, Stream *base_in, std::vector<uint8_t> &data)
+{
+    const size_t base_size = (uint32_t)in->ReadInt32();
+    const uint32_t base_hash = in->ReadInt32();
+    const size_t size = (uint32_t)in->ReadInt32();
+    const uint32_t hash = in->ReadInt32();
+    const size_t op_count = (uint32_t)in->ReadInt32();
+
+    // Every operation takes at least 5 bytes of the delta, and makes at
+    // least one byte of the state
+    if (base_size > MaxStateSize || size > MaxStateSize || op_count > size ||
+        base_size > GetRemainingLength(base_in) || op_count > GetRemainingLength(in) / 5)
+        return false;
+
+    std::vector<uint8_t> base;
+    if (!ReadAppend(base_in, base, base_size))
+        return false;
+    if (Hash(base.empty() ? NULL : &base[0], base_size) != base_hash)
+        return false;
+
+    data.clear();
+    for (size_t i = 0; i < op_count; ++i)
+    {
+        const size_t pos = data.size();
+        const int type = in->ReadInt8();
+        if (type == kDeltaOp_Copy)
+        {
+            const size_t offset = (uint32_t)in->ReadInt32();
+            const size_t len = (uint32_t)in->ReadInt32();
+            if (len == 0 || offset > base_size || len > base_size - offset || len > size - pos)
+                return false;
+            data.insert(data.end(), base.begin() + offset, base.begin() + offset + len);
+        }
+        else if (type == kDeltaOp_Data)
+        {
+            const size_t len = (uint32_t)in->ReadInt32();
+            if (len == 0 || len > size - pos || !ReadAppend(in, data, len))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return data.size() == size && Hash(data.empty() ? NULL : &data[0], size) == hash;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,89 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// SavegameSnapshot keeps the serialized game state in memory, for the quick
+// restoration, or as the base which the later states are compared to.
+//
+// The state is split into chunks at the positions defined by its content
+// (where the rolling hash of the last bytes has certain value), so that the
+// data inserted or removed in one place does not move the chunk borders
+// anywhere else. The delta to the base snapshot refers to the chunks which
+// are found in the base, and only carries the data of the changed ones.
+//
+//=============================================================================
+#ifndef __AGS_EE_GAME__SAVEGAMESNAPSHOT_H
+#define __AGS_EE_GAME__SAVEGAMESNAPSHOT_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+
+namespace Common { class MemoryStream; class Stream; }
+
+namespace Engine
+{
+
+using Common::MemoryStream;
+using Common::Stream;
+
+class SavegameSnapshot
+{
+public:
+    SavegameSnapshot();
+
+    // Exchanges the data with the stream; this is how the snapshot is made
+    // from the written game state, and how it is given back for reading
+    void            Swap(MemoryStream &state);
+    void            Swap(SavegameSnapshot &other);
+    void            Clear();
+
+    bool            IsEmpty() const { return _data.empty(); }
+    const uint8_t  *GetData() const { return _data.empty() ? NULL : &_data[0]; }
+    size_t          GetSize() const { return _data.size(); }
+    uint32_t        GetHash() const;
+
+    // Writes the delta which makes this snapshot out of the base one;
+    // returns the amount of data that was not found in the base
+    size_t          WriteDelta(const SavegameSnapshot &base, Stream *out) const;
+    // Reads the delta, takes the base data from the base stream and
+    // puts the resulting data into the buffer; returns false if the
+    // delta is broken or was made for another base
+    static bool     ReadDelta(Stream *in, Stream *base_in, std::vector<uint8_t> &data);
+
+private:
+    struct Chunk
+    {
+        size_t   Offset;
+        size_t   Length;
+        uint32_t Hash;
+    };
+
+    static uint32_t Hash(const uint8_t *data, size_t len);
+    // Splits the data into chunks, unless it was done already
+    void            MakeChunks() const;
+
+    std::vector<uint8_t>        _data;
+    // Chunks and hash are made when they are first needed
+    mutable std::vector<Chunk>  _chunks;
+    mutable bool                _hasChunks;
+    mutable uint32_t            _hash;
+    mutable bool                _hasHash;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GAME__SAVEGAMESNAPSHOT_H
@@ -0,0 +1,219 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <stddef.h>
+#include <stdio.h>
+#if defined(WINDOWS_VERSION)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "game/savegamewriter.h"
+#include "ac/richgamemedia.h"
+#include "debug/out.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/filestream.h"
+#include "util/lzstream.h"
+#include "util/mutex_lock.h"
+
+using namespace AGS::Common;
+
+extern AGSPlatformDriver *platform;
+
+namespace AGS
+{
+namespace Engine
+{
+
+SavegameWriter *SavegameWriter::_workerWriter = NULL;
+
+// Makes sure that the written data is on disk, before the file replaces the old save
+static bool SyncFile(FileStream &out)
+{
+    if (!out.Flush())
+        return false;
+#if defined(WINDOWS_VERSION)
+    return _commit(_fileno(out.GetHandle())) == 0;
+#elif defined(LINUX_VERSION) || defined(MAC_VERSION) || defined(IOS_VERSION) || defined(ANDROID_VERSION)
+    return fsync(fileno(out.GetHandle())) == 0;
+#else
+    return true;
+#endif
+}
+
+SavegameWriter::SavegameWriter()
+    : _threadRunning(false)
+{
+}
+
+SavegameWriter::~SavegameWriter()
+{
+    StopThread();
+}
+
+bool SavegameWriter::StartThread()
+{
+    if (_threadRunning || _workerWriter != NULL)
+        return false;
+    _workerWriter = this;
+    _threadRunning = _thread.CreateAndStart(WorkerThread, true);
+    if (!_threadRunning)
+    {
+        _workerWriter = NULL;
+        Debug::Printf(kDbgMsg_Error, "Failed to start savegame writer thread");
+        return false;
+    }
+    Debug::Printf("Started savegame writer thread");
+    return true;
+}
+
+void SavegameWriter::StopThread()
+{
+    if (!_threadRunning)
+        return;
+    Wait();
+    _thread.Stop();
+    _threadRunning = false;
+    _workerWriter = NULL;
+}
+
+void SavegameWriter::Write(const String &filename, MemoryStream *head, MemoryStream *data,
+                           bool compress, MemoryStream *thumbnail)
+{
+    // the job is destroyed after the lock is taken, because its string
+    // buffer is shared with the queued copy, and must not be shared with
+    // the caller's string
+    MutexLock lock;
+    Job job;
+    job.Filename = String(filename.GetCStr());
+    job.Head = head;
+    job.Data = data;
+    job.Compress = compress;
+    job.Thumbnail = thumbnail;
+    if (!_threadRunning)
+    {
+        if (!DoJob(job))
+            _failed.push_back(job.Filename);
+        FreeJob(job);
+        return;
+    }
+
+    lock.Acquire(_mutex);
+    _jobs.push_back(job);
+}
+
+void SavegameWriter::Wait()
+{
+    for (;;)
+    {
+        MutexLock lock(_mutex);
+        if (_jobs.empty())
+            break;
+        lock.Release();
+        platform->YieldCPU();
+    }
+}
+
+String SavegameWriter::GetFailedSave()
+{
+    MutexLock lock(_mutex);
+    if (_failed.empty())
+        return "";
+    // the name is copied, so that its buffer is not shared with the thread
+    const String filename = String(_failed.front().GetCStr());
+    _failed.erase(_failed.begin());
+    return filename;
+}
+
+bool SavegameWriter::DoJob(const Job &job)
+{
+    // The game data is packed first, because the thumbnail offset depends on its size
+    MemoryStream packed;
+    const MemoryStream *data = job.Data;
+    if (job.Compress)
+    {
+        LZ::WriteStream(&packed, job.Data->GetData(), job.Data->GetLength());
+        data = &packed;
+    }
+    if (job.Thumbnail && job.Thumbnail->GetLength() > 0)
+    {
+        job.Head->Seek(offsetof(RICH_GAME_MEDIA_HEADER, dwThumbnailOffsetLowerDword), kSeekBegin);
+        job.Head->WriteInt32(job.Head->GetLength() + data->GetLength() - sizeof(RICH_GAME_MEDIA_HEADER));
+        job.Head->Seek(offsetof(RICH_GAME_MEDIA_HEADER, dwThumbnailSize), kSeekBegin);
+        job.Head->WriteInt32(job.Thumbnail->GetLength());
+    }
+
+    const String temp_filename = String::FromFormat("%s.tmp", job.Filename.GetCStr());
+    bool result;
+    {
+        FileStream out(temp_filename, kFile_CreateAlways, kFile_Write);
+        if (!out.IsValid())
+            return false;
+        result = out.Write(job.Head->GetData(), job.Head->GetLength()) == job.Head->GetLength() &&
+            out.Write(data->GetData(), data->GetLength()) == data->GetLength();
+        if (result && job.Thumbnail)
+            result = out.Write(job.Thumbnail->GetData(), job.Thumbnail->GetLength()) == job.Thumbnail->GetLength();
+        result = result && SyncFile(out);
+    }
+
+    if (result)
+    {
+#if defined(WINDOWS_VERSION)
+        // rename does not replace existing files on Windows, and removing the
+        // old save first would leave no save at all if the rename then fails
+        result = MoveFileExA(temp_filename, job.Filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        result = rename(temp_filename, job.Filename) == 0;
+#endif
+    }
+    if (!result)
+        unlink(temp_filename);
+    return result;
+}
+
+void SavegameWriter::FreeJob(Job &job)
+{
+    delete job.Head;
+    delete job.Data;
+    delete job.Thumbnail;
+    job.Head = NULL;
+    job.Data = NULL;
+    job.Thumbnail = NULL;
+}
+
+void SavegameWriter::WorkerThread()
+{
+    SavegameWriter *writer = _workerWriter;
+    MutexLock lock(writer->_mutex);
+    if (writer->_jobs.empty())
+    {
+        lock.Release();
+        platform->Delay(5);
+        return;
+    }
+    // the game thread only appends to the queue, which keeps this job in place
+    Job &job = writer->_jobs.front();
+    lock.Release();
+
+    const bool result = DoJob(job);
+
+    lock.Acquire(writer->_mutex);
+    if (!result)
+        writer->_failed.push_back(job.Filename);
+    FreeJob(job);
+    writer->_jobs.pop_front();
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,99 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// SavegameWriter writes the savegames which were made in memory by the game
+// thread. The game data is compressed, if required, and the save is written
+// into the temporary file, which is flushed to disk and then renamed over
+// the old save, so that the save file is never left half-written.
+//
+// With the writer thread started this is done in the background, while the
+// game goes on. Anything that reads or removes save files has to Wait for
+// the queued writes first.
+//
+//=============================================================================
+#ifndef __AGS_EE_GAME__SAVEGAMEWRITER_H
+#define __AGS_EE_GAME__SAVEGAMEWRITER_H
+
+#include <deque>
+#include <vector>
+#include "util/memorystream.h"
+#include "util/mutex.h"
+#include "util/string.h"
+#include "util/thread.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::MemoryStream;
+using Common::String;
+
+class SavegameWriter
+{
+public:
+    SavegameWriter();
+    ~SavegameWriter();
+
+    // Starts the thread which writes the queued savegames
+    bool StartThread();
+    // Writes the queued savegames and stops the thread
+    void StopThread();
+
+    // Queues the savegame for writing, taking ownership of the streams.
+    // 'head' is the savegame description, written as is; 'data' is the game
+    // data, which is compressed if 'compress' is set; optional 'thumbnail'
+    // is the Vista rich media image put at the end of the file.
+    // Without the thread the savegame is written right away.
+    void Write(const String &filename, MemoryStream *head, MemoryStream *data,
+               bool compress, MemoryStream *thumbnail);
+    // Waits until all the queued savegames are written
+    void Wait();
+    // Returns the name of a savegame which could not be written, and forgets
+    // about it; returns empty string if there's no failed save left.
+    // The game thread polls this to tell the player.
+    String GetFailedSave();
+
+private:
+    struct Job
+    {
+        String        Filename;
+        MemoryStream *Head;
+        MemoryStream *Data;
+        bool          Compress;
+        MemoryStream *Thumbnail;
+    };
+
+    // Writes the savegame file, returns false on failure
+    static bool DoJob(const Job &job);
+    static void FreeJob(Job &job);
+
+    static void WorkerThread();
+
+    Thread   _thread;
+    bool     _threadRunning;
+    // The job is kept in the queue until it is written; the queue and the
+    // failed save names are guarded by _mutex
+    Mutex              _mutex;
+    std::deque<Job>    _jobs;
+    std::vector<String> _failed;
+
+    // The writer that the thread works for
+    static SavegameWriter *_workerWriter;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GAME__SAVEGAMEWRITER_H
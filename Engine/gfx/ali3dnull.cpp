@@ -0,0 +1,244 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Null graphics driver, drawing to memory
+//
+//=============================================================================
+
+#include "gfx/ali3dnull.h"
+#include "debug/out.h"
+#include "main/main_allegro.h"
+#include "util/directory.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Null
+{
+
+using namespace Common;
+
+NullGraphicsDriver::NullGraphicsDriver()
+    : _skipRender(false)
+    , _captureInterval(0)
+    , _captureFormat(kNullFrame_Bmp)
+    , _frameCount(0)
+{
+}
+
+NullGraphicsDriver::~NullGraphicsDriver()
+{
+    // base class destructor can't call our override anymore
+    UnInit();
+}
+
+void NullGraphicsDriver::SetRenderOptions(bool skip_render, int capture_interval, const String &capture_dir, NullFrameFormat capture_format)
+{
+    _skipRender = skip_render;
+    _captureInterval = skip_render ? 0 : capture_interval;
+    _captureDir = capture_dir;
+    _captureFormat = capture_format;
+    if (_captureInterval > 0)
+    {
+        if (_captureDir.IsEmpty())
+            _captureDir = ".";
+        Directory::CreateDirectory(_captureDir);
+        Debug::Printf("Null renderer: saving every %d frame(s) to %s", _captureInterval, _captureDir.GetCStr());
+    }
+}
+
+bool NullGraphicsDriver::IsModeSupported(const DisplayMode &mode)
+{
+    if (mode.Width <= 0 || mode.Height <= 0 || mode.ColorDepth <= 0)
+    {
+        set_allegro_error("Invalid resolution parameters: %d x %d x %d", mode.Width, mode.Height, mode.ColorDepth);
+        return false;
+    }
+    // Any size fits in memory
+    return true;
+}
+
+bool NullGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile int *loopTimer)
+{
+    ReleaseDisplayMode();
+
+    if (!IsModeSupported(mode))
+        return false;
+
+    set_color_depth(mode.ColorDepth);
+
+    if (_initGfxCallback != NULL)
+        _initGfxCallback(NULL);
+
+    OnInit(loopTimer);
+    OnModeSet(mode);
+    // The screen is an ordinary memory bitmap, owned by the driver; it is
+    // destroyed along with the display mode, same as the screen wrapper
+    _allegroScreenWrapper = BitmapHelper::CreateBitmap(mode.Width, mode.Height, mode.ColorDepth);
+    if (!_allegroScreenWrapper)
+    {
+        set_allegro_error("Failed to allocate screen bitmap %d x %d x %d", mode.Width, mode.Height, mode.ColorDepth);
+        OnModeReleased();
+        return false;
+    }
+    BitmapHelper::SetScreenBitmap(_allegroScreenWrapper);
+    BitmapHelper::GetScreenBitmap()->Clear();
+
+    // If we already have a gfx filter, then use it to update virtual screen immediately
+    CreateVirtualScreen();
+    return true;
+}
+
+void NullGraphicsDriver::ReleaseDisplayMode()
+{
+    const bool had_screen = _allegroScreenWrapper != NULL;
+    ALSoftwareGraphicsDriver::ReleaseDisplayMode();
+    // Allegro's screen was pointing to our bitmap, which is deleted now
+    if (had_screen)
+        screen = NULL;
+}
+
+void NullGraphicsDriver::RenderToBackBuffer()
+{
+    if (_skipRender)
+    {
+        ClearDrawList();
+        return;
+    }
+    ALSoftwareGraphicsDriver::RenderToBackBuffer();
+}
+
+void NullGraphicsDriver::Render(GlobalFlipType flip)
+{
+    _frameCount++;
+    if (_skipRender)
+    {
+        ClearDrawList();
+        return;
+    }
+
+    ALSoftwareGraphicsDriver::Render(flip);
+
+    if (_captureInterval > 0 && (_frameCount % _captureInterval) == 0)
+        CaptureFrame();
+}
+
+void NullGraphicsDriver::CaptureFrame()
+{
+    const Bitmap *frame = _allegroScreenWrapper;
+    if (!frame)
+        return;
+
+    String filename = String::FromFormat("%s/frame%06u.%s", _captureDir.GetCStr(), _frameCount,
+        _captureFormat == kNullFrame_Raw ? "raw" : "bmp");
+    bool result;
+    if (_captureFormat == kNullFrame_Raw)
+    {
+        Stream *out = File::CreateFile(filename);
+        result = out != NULL;
+        if (out)
+        {
+            for (int y = 0; y < frame->GetHeight(); ++y)
+                out->Write(frame->GetScanLine(y), frame->GetLineLength());
+            delete out;
+        }
+    }
+    else
+    {
+        PALETTE pal;
+        get_palette(pal);
+        result = const_cast<Bitmap*>(frame)->SaveToFile(filename, pal);
+    }
+
+    if (!result)
+    {
+        Debug::Printf(kDbgMsg_Error, "Null renderer: failed to save frame to %s; stopped capturing", filename.GetCStr());
+        _captureInterval = 0;
+    }
+}
+
+// The fades take no time without a display; only their end result is drawn
+void NullGraphicsDriver::FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue)
+{
+    if (_allegroScreenWrapper)
+        _allegroScreenWrapper->Clear(makecol_depth(_mode.ColorDepth, targetColourRed, targetColourGreen, targetColourBlue));
+    InvalidateScreen();
+}
+
+void NullGraphicsDriver::FadeIn(int speed, PALETTE pal, int targetColourRed, int targetColourGreen, int targetColourBlue)
+{
+    if (_mode.ColorDepth == 8)
+        set_palette(pal);
+    if (virtualScreen && _filter)
+        _filter->RenderScreen(virtualScreen, _global_x_offset, _global_y_offset);
+    InvalidateScreen();
+}
+
+void NullGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int delay)
+{
+    if (blackingOut)
+        ClearRectangle(0, 0, _srcRect.GetWidth() - 1, _srcRect.GetHeight() - 1, NULL);
+    InvalidateScreen();
+}
+
+
+NullGraphicsFactory *NullGraphicsFactory::_factory = NULL;
+
+NullGraphicsFactory::~NullGraphicsFactory()
+{
+    _factory = NULL;
+}
+
+size_t NullGraphicsFactory::GetFilterCount() const
+{
+    return 1;
+}
+
+const GfxFilterInfo *NullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    return index == 0 ? &AllegroGfxFilter::FilterInfo : NULL;
+}
+
+String NullGraphicsFactory::GetDefaultFilterID() const
+{
+    return AllegroGfxFilter::FilterInfo.Id;
+}
+
+/* static */ NullGraphicsFactory *NullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new NullGraphicsFactory();
+    return _factory;
+}
+
+NullGraphicsDriver *NullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new NullGraphicsDriver();
+    return _driver;
+}
+
+AllegroGfxFilter *NullGraphicsFactory::CreateFilter(const String &id)
+{
+    if (AllegroGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new AllegroGfxFilter();
+    return NULL;
+}
+
+} // namespace Null
+} // namespace Engine
+} // namespace AGS
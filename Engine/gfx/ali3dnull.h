@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Null graphics factory, for running the game without a display
+//
+// Null driver is the software renderer which draws frames into the memory
+// bitmap in place of the real screen, and never opens a window. It may also
+// save every Nth frame to file, or skip rendering altogether.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_GFX__ALI3DNULL_H
+#define __AGS_EE_GFX__ALI3DNULL_H
+
+#include "gfx/ali3dsw.h"
+#include "gfx/gfxfilter_allegro.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Null
+{
+
+using AGS::Common::String;
+using ALSW::AllegroGfxFilter;
+
+// Formats of the captured frames
+enum NullFrameFormat
+{
+    kNullFrame_Bmp, // image file
+    kNullFrame_Raw  // pixel rows only, as they are in memory
+};
+
+class NullGraphicsDriver : public ALSW::ALSoftwareGraphicsDriver
+{
+public:
+    NullGraphicsDriver();
+    virtual ~NullGraphicsDriver();
+
+    virtual const char*GetDriverName() { return "Null"; }
+    virtual const char*GetDriverID() { return "NULL"; }
+    virtual bool SetDisplayMode(const DisplayMode &mode, volatile int *loopTimer);
+    virtual bool IsModeSupported(const DisplayMode &mode);
+    virtual IGfxModeList *GetSupportedModeList(int color_depth) { return NULL; }
+    virtual void RenderToBackBuffer();
+    using ALSoftwareGraphicsDriver::Render;
+    virtual void Render(GlobalFlipType flip);
+    virtual void Vsync() { }
+    virtual void FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
+    virtual void FadeIn(int speed, PALETTE pal, int targetColourRed, int targetColourGreen, int targetColourBlue);
+    virtual void BoxOutEffect(bool blackingOut, int speed, int delay);
+    virtual bool PlayVideo(const char *filename, bool useAVISound, VideoSkipType skipType, bool stretchToFullScreen) { return false; }
+    virtual bool SupportsGammaControl() { return false; }
+    virtual void SetGamma(int newGamma) { }
+    virtual bool SkipsRendering() { return _skipRender; }
+
+    // Sets whether the frames are drawn, and how often they are saved;
+    // frames are numbered from the driver creation
+    void SetRenderOptions(bool skip_render, int capture_interval, const String &capture_dir, NullFrameFormat capture_format);
+
+protected:
+    virtual void ReleaseDisplayMode();
+
+private:
+    // Saves the current memory screen to the capture directory
+    void CaptureFrame();
+
+    bool            _skipRender;
+    int             _captureInterval;
+    String          _captureDir;
+    NullFrameFormat _captureFormat;
+    unsigned int    _frameCount;
+};
+
+
+class NullGraphicsFactory : public GfxDriverFactoryBase<NullGraphicsDriver, AllegroGfxFilter>
+{
+public:
+    virtual ~NullGraphicsFactory();
+
+    virtual size_t               GetFilterCount() const;
+    virtual const GfxFilterInfo *GetFilterInfo(size_t index) const;
+    virtual String               GetDefaultFilterID() const;
+
+    static  NullGraphicsFactory *GetFactory();
+
+private:
+    virtual NullGraphicsDriver *EnsureDriverCreated();
+    virtual AllegroGfxFilter   *CreateFilter(const String &id);
+
+    static NullGraphicsFactory *_factory;
+};
+
+} // namespace Null
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__ALI3DNULL_H
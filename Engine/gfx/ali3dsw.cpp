@@ -18,6 +18,7 @@
 
 #include "gfx/ali3dexception.h"
 #include "gfx/ali3dsw.h"
+#include "gfx/blender_simd.h"
 #include "gfx/gfxfilter_allegro.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/gfx_util.h"
@@ -85,6 +86,12 @@ ALSoftwareGraphicsDriver::ALSoftwareGraphicsDriver()
   _spareTintingScreen = NULL;
   numToDraw = 0;
   _gfxModeList = NULL;
+  _ddbVersion = 0;
+  _damageTracking = false;
+  _lastDrawListValid = false;
+  _wasTinted = false;
+  _lastRenderX = 0;
+  _lastRenderY = 0;
 #ifdef _WIN32
   dxGammaControl = NULL;
 #endif
@@ -240,6 +247,8 @@ void ALSoftwareGraphicsDriver::ReleaseDisplayMode()
 {
   OnModeReleased();
   numToDraw = 0;
+  _lastDrawList.clear();
+  _lastDrawListValid = false;
 
 #ifdef _WIN32
   if (dxGammaControl != NULL) 
@@ -285,6 +294,8 @@ void ALSoftwareGraphicsDriver::ClearRectangle(int x1, int y1, int x2, int y2, RG
   if (colorToUse != NULL) 
     color = makecol_depth(_mode.ColorDepth, colorToUse->r, colorToUse->g, colorToUse->b);
   _filter->ClearRect(x1, y1, x2, y2, color);
+  // the screen now differs from the back buffer
+  InvalidateScreen();
 }
 
 ALSoftwareGraphicsDriver::~ALSoftwareGraphicsDriver()
@@ -341,7 +352,7 @@ Bitmap *ALSoftwareGraphicsDriver::ConvertBitmapToSupportedColourDepth(Bitmap *bi
 
 IDriverDependantBitmap* ALSoftwareGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque)
 {
-  ALSoftwareBitmap* newBitmap = new ALSoftwareBitmap(bitmap, opaque, hasAlpha);
+  ALSoftwareBitmap* newBitmap = new ALSoftwareBitmap(bitmap, opaque, hasAlpha, ++_ddbVersion);
   return newBitmap;
 }
 
@@ -350,6 +361,7 @@ void ALSoftwareGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitma
   ALSoftwareBitmap* alSwBmp = (ALSoftwareBitmap*)bitmapToUpdate;
   alSwBmp->_bmp = bitmap;
   alSwBmp->_hasAlpha = hasAlpha;
+  alSwBmp->_version = ++_ddbVersion;
 }
 
 void ALSoftwareGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
@@ -375,7 +387,116 @@ void ALSoftwareGraphicsDriver::ClearDrawList()
   numToDraw = 0;
 }
 
-void ALSoftwareGraphicsDriver::RenderToBackBuffer()
+void ALSoftwareGraphicsDriver::SetMemoryBackBuffer(Bitmap *backBuffer)
+{
+  virtualScreen = backBuffer;
+  _damage.SetBounds(backBuffer ? RectWH(0, 0, backBuffer->GetWidth(), backBuffer->GetHeight()) : Rect());
+  _unpresented.SetBounds(_damage.GetBounds());
+  _presented.SetBounds(_damage.GetBounds());
+  _lastDrawListValid = false;
+}
+
+void ALSoftwareGraphicsDriver::EnableDamageTracking(bool enabled)
+{
+  _damageTracking = enabled;
+  _lastDrawListValid = false;
+  InvalidateScreen();
+}
+
+void ALSoftwareGraphicsDriver::InvalidateRect(const Rect &rc)
+{
+  _damage.Add(rc);
+}
+
+void ALSoftwareGraphicsDriver::InvalidateScreen()
+{
+  _damage.MarkWhole();
+}
+
+bool ALSoftwareGraphicsDriver::GetDamagedRegions(std::vector<Rect> &rects)
+{
+  rects = _presented.GetRects();
+  return true;
+}
+
+bool ALSoftwareGraphicsDriver::IsDrawListSelfContained() const
+{
+  if (numToDraw == 0 || drawlist[0] == NULL || !drawlist[0]->_opaque)
+    return false;
+  const Bitmap *bg = drawlist[0]->_bmp;
+  if (drawx[0] > 0 || drawy[0] > 0 ||
+      drawx[0] + bg->GetWidth() < virtualScreen->GetWidth() ||
+      drawy[0] + bg->GetHeight() < virtualScreen->GetHeight())
+    return false;
+  for (int i = 0; i < numToDraw; ++i)
+  {
+    // back buffer drawn over itself means "keep what is already there"
+    if (drawlist[i] && drawlist[i]->_bmp == virtualScreen)
+      return false;
+  }
+  return true;
+}
+
+void ALSoftwareGraphicsDriver::UpdateDamageFromDrawList()
+{
+  _curDrawList.resize(numToDraw);
+  for (int i = 0; i < numToDraw; ++i)
+  {
+    DrawListState &state = _curDrawList[i];
+    const ALSoftwareBitmap *bitmap = drawlist[i];
+    state.Ddb = bitmap;
+    if (bitmap)
+    {
+      state.Version = bitmap->_version;
+      state.Area = RectWH(drawx[i], drawy[i], bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+      state.Transparency = bitmap->_transparency;
+    }
+    else
+    {
+      // null sprites are plugin callbacks; it is up to the client to
+      // invalidate the screen if any plugin is going to draw on it
+      state.Version = 0;
+      state.Area = Rect();
+      state.Transparency = 0;
+    }
+  }
+
+  if (!_lastDrawListValid)
+    _damage.MarkWhole();
+
+  // Entries are compared by their position in the list, because changing
+  // sprites order alters the image wherever they overlap
+  const size_t last_count = _lastDrawList.size();
+  const size_t cur_count = _curDrawList.size();
+  for (size_t i = 0; (i < last_count || i < cur_count) && !_damage.IsWhole(); ++i)
+  {
+    if (i >= cur_count)
+    {
+      _damage.Add(_lastDrawList[i].Area);
+      continue;
+    }
+    if (i >= last_count)
+    {
+      _damage.Add(_curDrawList[i].Area);
+      continue;
+    }
+    const DrawListState &was = _lastDrawList[i];
+    const DrawListState &now = _curDrawList[i];
+    if (was.Ddb != now.Ddb || was.Version != now.Version ||
+        was.Transparency != now.Transparency ||
+        was.Area.Left != now.Area.Left || was.Area.Top != now.Area.Top ||
+        was.Area.Right != now.Area.Right || was.Area.Bottom != now.Area.Bottom)
+    {
+      _damage.Add(was.Area);
+      _damage.Add(now.Area);
+    }
+  }
+
+  _lastDrawList.swap(_curDrawList);
+  _lastDrawListValid = true;
+}
+
+void ALSoftwareGraphicsDriver::DrawAllEntries()
 {
   for (int i = 0; i < numToDraw; i++)
   {
@@ -389,21 +510,49 @@ void ALSoftwareGraphicsDriver::RenderToBackBuffer()
       continue;
     }
 
-    ALSoftwareBitmap* bitmap = drawlist[i];
-    int drawAtX = drawx[i];
-    int drawAtY = drawy[i];
+    DrawEntry(drawlist[i], drawx[i], drawy[i]);
+  }
+}
 
-    if ((bitmap->_opaque) && (bitmap->_bmp == virtualScreen))
-    { }
-    else if (bitmap->_opaque)
-    {
-      virtualScreen->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
-    }
-    else if (bitmap->_transparency >= 255)
+void ALSoftwareGraphicsDriver::DrawEntriesInRegions(const std::vector<Rect> &regions)
+{
+  const Rect old_clip = virtualScreen->GetClip();
+  for (size_t r = 0; r < regions.size(); ++r)
+  {
+    const Rect &region = regions[r];
+    virtualScreen->SetClip(region);
+    for (int i = 0; i < numToDraw; i++)
     {
-      // fully transparent... invisible, do nothing
+      ALSoftwareBitmap *bitmap = drawlist[i];
+      if (bitmap == NULL)
+        continue;
+      const Rect area = RectWH(drawx[i], drawy[i], bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+      if (IntersectRects(area, region).IsEmpty())
+        continue;
+      DrawEntry(bitmap, drawx[i], drawy[i]);
     }
-    else if (bitmap->_hasAlpha)
+  }
+  virtualScreen->SetClip(old_clip);
+}
+
+void ALSoftwareGraphicsDriver::DrawEntry(ALSoftwareBitmap *bitmap, int drawAtX, int drawAtY)
+{
+  if ((bitmap->_opaque) && (bitmap->_bmp == virtualScreen))
+  { }
+  else if (bitmap->_opaque)
+  {
+    virtualScreen->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+  }
+  else if (bitmap->_transparency >= 255)
+  {
+    // fully transparent... invisible, do nothing
+  }
+  else if (bitmap->_hasAlpha)
+  {
+    // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+    const RowBlend::BlendRowMode blend_mode = bitmap->_transparency == 0 ?
+        RowBlend::kBlendRow_Alpha : RowBlend::kBlendRow_TransAlpha;
+    if (!RowBlend::DrawBlended(virtualScreen, bitmap->_bmp, drawAtX, drawAtY, blend_mode, bitmap->_transparency))
     {
       if (bitmap->_transparency == 0) // this means opaque
         set_alpha_blender();
@@ -411,22 +560,55 @@ void ALSoftwareGraphicsDriver::RenderToBackBuffer()
         // here _transparency is used as alpha (between 1 and 254)
         set_blender_mode(NULL, NULL, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
 
-	  virtualScreen->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
-    }
-    else
-    {
-      // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
-      GfxUtil::DrawSpriteWithTransparency(virtualScreen, bitmap->_bmp, drawAtX, drawAtY,
-          bitmap->_transparency ? bitmap->_transparency : 255);
+      virtualScreen->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
     }
   }
+  else
+  {
+    // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+    GfxUtil::DrawSpriteWithTransparency(virtualScreen, bitmap->_bmp, drawAtX, drawAtY,
+        bitmap->_transparency ? bitmap->_transparency : 255);
+  }
+}
+
+void ALSoftwareGraphicsDriver::RenderToBackBuffer()
+{
+  const bool tinted = ((_tint_red > 0) || (_tint_green > 0) || (_tint_blue > 0))
+      && (_mode.ColorDepth > 8);
+
+  if (_damageTracking && IsDrawListSelfContained())
+  {
+    // tint is applied over the whole screen, so any part that was not
+    // redrawn would be tinted twice
+    if (tinted || _wasTinted)
+      _damage.MarkWhole();
+    UpdateDamageFromDrawList();
+    if (_damage.IsWhole())
+      DrawAllEntries();
+    else if (!_damage.IsEmpty())
+      DrawEntriesInRegions(_damage.GetRects());
+    _unpresented.Add(_damage);
+  }
+  else
+  {
+    // the draw list is painted over whatever the back buffer had before,
+    // so there is no way to tell which parts have changed
+    DrawAllEntries();
+    _lastDrawListValid = false;
+    _unpresented.MarkWhole();
+  }
+  _damage.Clear();
+  _wasTinted = tinted;
 
-  if (((_tint_red > 0) || (_tint_green > 0) || (_tint_blue > 0))
-      && (_mode.ColorDepth > 8)) {
+  if (tinted) {
     // Common::gl_ScreenBmp tint
     // This slows down the game no end, only experimental ATM
-    set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-    virtualScreen->LitBlendBlt(virtualScreen, 0, 0, 128);
+    if (!RowBlend::DrawBlended(virtualScreen, virtualScreen, 0, 0, RowBlend::kBlendRow_Lit, 128,
+                               makecol32(_tint_red, _tint_green, _tint_blue)))
+    {
+      set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
+      virtualScreen->LitBlendBlt(virtualScreen, 0, 0, 128);
+    }
 /*  This alternate method gives the correct (D3D-style) result, but is just too slow!
     if ((_spareTintingScreen != NULL) &&
         ((_spareTintingScreen->GetWidth() != virtualScreen->GetWidth()) || (_spareTintingScreen->GetHeight() != virtualScreen->GetHeight())))
@@ -445,6 +627,27 @@ void ALSoftwareGraphicsDriver::RenderToBackBuffer()
   ClearDrawList();
 }
 
+void ALSoftwareGraphicsDriver::PresentScreen(GlobalFlipType flip)
+{
+  const bool offset_changed = (_global_x_offset != _lastRenderX) || (_global_y_offset != _lastRenderY);
+  if (flip != kFlip_None)
+  {
+    _filter->RenderScreenFlipped(virtualScreen, _global_x_offset, _global_y_offset, flip);
+    _unpresented.MarkWhole();
+  }
+  else if (!_damageTracking || _unpresented.IsWhole() || offset_changed ||
+      !_filter->RenderScreenRegions(virtualScreen, _global_x_offset, _global_y_offset, _unpresented.GetRects()))
+  {
+    _filter->RenderScreen(virtualScreen, _global_x_offset, _global_y_offset);
+    _unpresented.MarkWhole();
+  }
+  _lastRenderX = _global_x_offset;
+  _lastRenderY = _global_y_offset;
+  _presented.Clear();
+  _presented.Add(_unpresented);
+  _unpresented.Clear();
+}
+
 void ALSoftwareGraphicsDriver::Render(GlobalFlipType flip)
 {
   RenderToBackBuffer();
@@ -452,10 +655,7 @@ void ALSoftwareGraphicsDriver::Render(GlobalFlipType flip)
   if (_autoVsync)
     this->Vsync();
 
-  if (flip == kFlip_None)
-    _filter->RenderScreen(virtualScreen, _global_x_offset, _global_y_offset);
-  else
-    _filter->RenderScreenFlipped(virtualScreen, _global_x_offset, _global_y_offset, flip);
+  PresentScreen(flip);
 }
 
 void ALSoftwareGraphicsDriver::Render()
@@ -609,6 +809,7 @@ void ALSoftwareGraphicsDriver::FadeOut(int speed, int targetColourRed, int targe
     highcolor_fade_out(speed * 4, targetColourRed, targetColourGreen, targetColourBlue);
   }
   else __fade_out_range(speed, 0, 255, targetColourRed, targetColourGreen, targetColourBlue);
+  InvalidateScreen();
 
 }
 
@@ -621,6 +822,7 @@ void ALSoftwareGraphicsDriver::FadeIn(int speed, PALLETE p, int targetColourRed,
 	  initialize_fade_256(targetColourRed, targetColourGreen, targetColourBlue);
 	  __fade_from_range(faded_out_palette, p, speed, 0,255);
   }
+  InvalidateScreen();
 }
 
 void ALSoftwareGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int delay)
@@ -656,6 +858,7 @@ bool ALSoftwareGraphicsDriver::PlayVideo(const char *filename, bool useAVISound,
 {
 #ifdef _WIN32
   int result = dxmedia_play_video(filename, useAVISound, skipType, stretchToFullScreen ? 1 : 0);
+  InvalidateScreen();
   return (result == 0);
 #else
   return 0;
@@ -27,7 +27,9 @@
 #include <ddraw.h>
 #endif
 
+#include <vector>
 #include "gfx/bitmap.h"
+#include "gfx/damageregion.h"
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
@@ -69,8 +71,11 @@ public:
     bool _opaque;
     bool _hasAlpha;
     int _transparency;
+    // Renderer-wide unique number, which is changed each time the bitmap
+    // is updated; this lets renderer know that the image has changed
+    unsigned int _version;
 
-    ALSoftwareBitmap(Bitmap *bmp, bool opaque, bool hasAlpha)
+    ALSoftwareBitmap(Bitmap *bmp, bool opaque, bool hasAlpha, unsigned int version)
     {
         _bmp = bmp;
         _width = bmp->GetWidth();
@@ -82,6 +87,7 @@ public:
         _transparency = 0;
         _opaque = opaque;
         _hasAlpha = hasAlpha;
+        _version = version;
     }
 
     int GetWidthToRender() { return (_stretchToWidth > 0) ? _stretchToWidth : _width; }
@@ -165,7 +171,12 @@ public:
     virtual bool HasAcceleratedStretchAndFlip() { return false; }
     virtual bool UsesMemoryBackBuffer() { return true; }
     virtual Bitmap *GetMemoryBackBuffer() { return virtualScreen; }
-    virtual void SetMemoryBackBuffer(Bitmap *backBuffer) { virtualScreen = backBuffer; }
+    virtual void SetMemoryBackBuffer(Bitmap *backBuffer);
+    virtual bool UsesDamageTracking() { return _damageTracking; }
+    virtual void EnableDamageTracking(bool enabled);
+    virtual void InvalidateRect(const Rect &rc);
+    virtual void InvalidateScreen();
+    virtual bool GetDamagedRegions(std::vector<Rect> &rects);
     virtual void SetScreenTint(int red, int green, int blue) { 
         _tint_red = red; _tint_green = green; _tint_blue = blue; }
     virtual ~ALSoftwareGraphicsDriver();
@@ -174,7 +185,17 @@ public:
 
     void SetGraphicsFilter(PALSWFilter filter);
 
-private:
+protected:
+    // State of the draw list entry, remembered to find out what has changed
+    // since the previous frame
+    struct DrawListState
+    {
+        const ALSoftwareBitmap *Ddb;
+        unsigned int Version;
+        Rect         Area;
+        int          Transparency;
+    };
+
     PALSWFilter _filter;
 
     bool _autoVsync;
@@ -194,6 +215,23 @@ private:
     int drawx[MAX_DRAW_LIST_SIZE], drawy[MAX_DRAW_LIST_SIZE];
     int numToDraw;
     GFX_MODE_LIST *_gfxModeList;
+    // Last assigned bitmap version
+    unsigned int _ddbVersion;
+
+    // Damage tracking: when enabled the renderer compares draw list with the
+    // previous frame's one, and only redraws and presents changed regions
+    bool _damageTracking;
+    // Regions of the back buffer that have to be redrawn on next render
+    DamageRegion _damage;
+    // Regions which were redrawn but not yet presented on screen
+    DamageRegion _unpresented;
+    // Regions presented on screen by the last render
+    DamageRegion _presented;
+    std::vector<DrawListState> _lastDrawList;
+    std::vector<DrawListState> _curDrawList;
+    bool _lastDrawListValid;
+    bool _wasTinted;
+    int  _lastRenderX, _lastRenderY;
 
 #ifdef _WIN32
     IDirectDrawGammaControl* dxGammaControl;
@@ -207,8 +245,22 @@ private:
 
     // Use gfx filter to create a new virtual screen
     void CreateVirtualScreen();
+    // Tells if the current draw list describes whole back buffer contents,
+    // that is it begins with an opaque bitmap covering the buffer, and so
+    // any part of the buffer may be reconstructed from the draw list alone
+    bool IsDrawListSelfContained() const;
+    // Compares current draw list with the previous frame's one and adds
+    // regions which have changed to the damage
+    void UpdateDamageFromDrawList();
+    // Draws all of the draw list entries, calling null sprite callback
+    void DrawAllEntries();
+    // Draws draw list entries only within the damaged regions
+    void DrawEntriesInRegions(const std::vector<Rect> &regions);
+    void DrawEntry(ALSoftwareBitmap *bitmap, int drawAtX, int drawAtY);
+    // Presents the back buffer on screen, whole or only changed regions
+    void PresentScreen(GlobalFlipType flip);
     // Unset parameters and release resources related to the display mode
-    void ReleaseDisplayMode();
+    virtual void ReleaseDisplayMode();
 
     void highcolor_fade_out(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void highcolor_fade_in(Bitmap *bmp_orig, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
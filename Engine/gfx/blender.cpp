@@ -132,6 +132,19 @@ unsigned long _myblender_color32(unsigned long x, unsigned long y, unsigned long
     return makeacol32(r, g, b, geta32(y));
 }
 
+void make_tint_table32(uint32_t *table, int red, int grn, int blu, int luminance)
+{
+    const unsigned long color = makeacol32(red, grn, blu, 0);
+    for (int v = 0; v < 256; ++v)
+    {
+        const unsigned long pixel = v << _rgb_r_shift_32;
+        const unsigned long res = (luminance >= 250) ?
+            _myblender_color32(color, pixel, luminance) :
+            _myblender_color32_light(color, pixel, luminance);
+        table[v] = res & ~(0xFF << _rgb_a_shift_32);
+    }
+}
+
 // trans24 blender, but preserve alpha channel from image
 unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n)
 {
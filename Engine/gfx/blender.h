@@ -19,6 +19,8 @@
 #ifndef __AC_BLENDER_H
 #define __AC_BLENDER_H
 
+#include "core/types.h"
+
 enum GameSpriteAlphaRenderingStyle
 {
     kSpriteAlphaRender_Classic = 0,
@@ -50,6 +52,11 @@ unsigned long _myblender_color32(unsigned long x, unsigned long y, unsigned long
 unsigned long _myblender_color15_light(unsigned long x, unsigned long y, unsigned long n);
 unsigned long _myblender_color16_light(unsigned long x, unsigned long y, unsigned long n);
 unsigned long _myblender_color32_light(unsigned long x, unsigned long y, unsigned long n);
+// Fills 256-entry table for RowBlend::TintRow with the results of the 32-bit
+// colourising blender (the one tint_image uses for the given luminance). The
+// blender only takes the value (max of RGB) from the image pixel, so the whole
+// image may be tinted with a table lookup per pixel.
+void make_tint_table32(uint32_t *table, int red, int grn, int blu, int luminance);
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
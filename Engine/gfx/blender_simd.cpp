@@ -0,0 +1,888 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// All kernels follow the same packed-channel arithmetic as the Allegro's
+// _blender_trans24 and related callbacks: red and blue are processed as one
+// 32-bit value (0xFF00FF), and green separately (0xFF00). The intermediate
+// results are calculated modulo 2^32, which gives bit-exact results for the
+// lower 24 bits, regardless of the "unsigned long" size used by Allegro.
+//
+//=============================================================================
+
+#include "gfx/blender_simd.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define AGS_BLEND_X86
+#endif
+
+#if defined(AGS_BLEND_X86) && (defined(_MSC_VER) || defined(__GNUC__))
+#define AGS_BLEND_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(AGS_BLEND_X86) && \
+    ((defined(_MSC_VER) && _MSC_VER >= 1800) || defined(__clang__) || \
+     (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define AGS_BLEND_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(AGS_BLEND_X86)
+#include <intrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define AGS_BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang require instruction sets to be enabled per function, unless
+// the whole unit is compiled with corresponding flags
+#if defined(__GNUC__) && defined(AGS_BLEND_X86)
+#define AGS_TARGET_SSE2 __attribute__((target("sse2")))
+#define AGS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AGS_TARGET_SSE2
+#define AGS_TARGET_AVX2
+#endif
+
+namespace AGS
+{
+namespace Engine
+{
+namespace RowBlend
+{
+
+typedef void (*PfnBlendRow)(uint32_t *dst, const uint32_t *src, int count,
+                            uint32_t mask_color, int alpha, uint32_t color);
+typedef void (*PfnTintRow)(uint32_t *dst, const uint32_t *src, int count,
+                           uint32_t mask_color, const uint32_t *table, int amount);
+
+const uint32_t RB_MASK = 0x00FF00FF;
+const uint32_t G_MASK  = 0x0000FF00;
+const uint32_t A_MASK  = 0xFF000000;
+
+//-----------------------------------------------------------------------------
+// Scalar kernels
+//-----------------------------------------------------------------------------
+
+// Combines x and y proportionally to n (0 - 256), final alpha is zero
+FORCEINLINE uint32_t trans_blend(uint32_t x, uint32_t y, uint32_t n)
+{
+    uint32_t res = ((x & RB_MASK) - (y & RB_MASK)) * n / 256 + y;
+    uint32_t g   = ((x & G_MASK)  - (y & G_MASK))  * n / 256 + (y & G_MASK);
+    return (res & RB_MASK) | (g & G_MASK);
+}
+
+// Allegro's convention for converting alpha into a multiplier
+FORCEINLINE uint32_t alpha_to_factor(uint32_t a)
+{
+    return a ? a + 1 : 0;
+}
+
+static void BlendRow_Alpha_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int, uint32_t)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+            dst[i] = trans_blend(s, dst[i], alpha_to_factor(s >> 24));
+    }
+}
+
+static void BlendRow_TransAlpha_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+            dst[i] = trans_blend(s, dst[i], alpha_to_factor((alpha * (s >> 24)) / 256));
+    }
+}
+
+static void BlendRow_Trans_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t)
+{
+    const uint32_t n = alpha_to_factor(alpha);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+            dst[i] = trans_blend(s, dst[i], n);
+    }
+}
+
+static void BlendRow_Additive_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int, uint32_t)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+        {
+            uint32_t a = (s >> 24) + (dst[i] >> 24);
+            if (a > 0xFF)
+                a = 0xFF;
+            dst[i] = (a << 24) | (s & ~A_MASK);
+        }
+    }
+}
+
+static void BlendRow_Lit_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32_t n = alpha_to_factor(alpha);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+            dst[i] = trans_blend(color, s, n);
+    }
+}
+
+static void BlendRow_LitKeepAlpha_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32_t n = alpha_to_factor(alpha);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s != mask_color)
+            dst[i] = trans_blend(color, s, n) | (s & A_MASK);
+    }
+}
+
+static const PfnBlendRow ScalarKernels[kNumBlendRowModes] =
+{
+    BlendRow_Alpha_Scalar,
+    BlendRow_TransAlpha_Scalar,
+    BlendRow_Trans_Scalar,
+    BlendRow_Additive_Scalar,
+    BlendRow_Lit_Scalar,
+    BlendRow_LitKeepAlpha_Scalar
+};
+
+// The value (as in HSV) of the pixel, which is the index in the tint table
+FORCEINLINE uint32_t max_rgb(uint32_t c)
+{
+    uint32_t m = c & 0xFF;
+    const uint32_t g = (c >> 8) & 0xFF;
+    const uint32_t b = (c >> 16) & 0xFF;
+    if (g > m)
+        m = g;
+    if (b > m)
+        m = b;
+    return m;
+}
+
+static void TintRow_Scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, const uint32_t *table, int amount)
+{
+    const uint32_t n = alpha_to_factor(amount);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        if (s == mask_color)
+        {
+            dst[i] = s;
+            continue;
+        }
+        const uint32_t t = table[max_rgb(s)] | (s & A_MASK);
+        if (amount < 0)
+            dst[i] = t;
+        else if (t == mask_color)
+            dst[i] = s; // transparent pixels of the tinted image are skipped
+        else
+            dst[i] = trans_blend(t, s, n) | (s & A_MASK);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 kernels
+//-----------------------------------------------------------------------------
+#if defined(AGS_BLEND_SSE2)
+
+// SSE2 has no 32-bit low multiplication, so emulate one with two 32x32->64 ones
+AGS_TARGET_SSE2 static FORCEINLINE __m128i mullo32_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+AGS_TARGET_SSE2 static FORCEINLINE __m128i trans_blend_sse2(__m128i x, __m128i y, __m128i n)
+{
+    const __m128i rb = _mm_set1_epi32(RB_MASK);
+    const __m128i g  = _mm_set1_epi32(G_MASK);
+    __m128i yg  = _mm_and_si128(y, g);
+    __m128i res = _mm_sub_epi32(_mm_and_si128(x, rb), _mm_and_si128(y, rb));
+    res = _mm_add_epi32(_mm_srli_epi32(mullo32_sse2(res, n), 8), y);
+    __m128i gr  = _mm_sub_epi32(_mm_and_si128(x, g), yg);
+    gr  = _mm_add_epi32(_mm_srli_epi32(mullo32_sse2(gr, n), 8), yg);
+    return _mm_or_si128(_mm_and_si128(res, rb), _mm_and_si128(gr, g));
+}
+
+// Returns a + 1 where a is non-zero, and 0 otherwise
+AGS_TARGET_SSE2 static FORCEINLINE __m128i alpha_to_factor_sse2(__m128i a)
+{
+    return _mm_add_epi32(_mm_add_epi32(a, _mm_set1_epi32(1)),
+                         _mm_cmpeq_epi32(a, _mm_setzero_si128()));
+}
+
+// Keeps old dst value where src pixel equals to mask color
+AGS_TARGET_SSE2 static FORCEINLINE __m128i apply_mask_sse2(__m128i s, __m128i d, __m128i res, __m128i mask)
+{
+    __m128i is_mask = _mm_cmpeq_epi32(s, mask);
+    return _mm_or_si128(_mm_and_si128(is_mask, d), _mm_andnot_si128(is_mask, res));
+}
+
+AGS_TARGET_SSE2 static void BlendRow_Alpha_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i n = alpha_to_factor_sse2(_mm_srli_epi32(s, 24));
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, trans_blend_sse2(s, d, n), mask));
+    }
+    BlendRow_Alpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_SSE2 static void BlendRow_TransAlpha_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    // alpha * src alpha always fits into 16 bits
+    const __m128i alpha4 = _mm_set1_epi32(alpha & 0xFF);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i a = _mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(s, 24), alpha4), 8);
+        __m128i n = alpha_to_factor_sse2(a);
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, trans_blend_sse2(s, d, n), mask));
+    }
+    BlendRow_TransAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_SSE2 static void BlendRow_Trans_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    const __m128i n = _mm_set1_epi32(alpha_to_factor(alpha));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, trans_blend_sse2(s, d, n), mask));
+    }
+    BlendRow_Trans_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_SSE2 static void BlendRow_Additive_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    const __m128i amask = _mm_set1_epi32(A_MASK);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        // saturated byte addition of the alpha channels
+        __m128i a = _mm_adds_epu8(_mm_and_si128(s, amask), _mm_and_si128(d, amask));
+        __m128i res = _mm_or_si128(a, _mm_andnot_si128(amask, s));
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, res, mask));
+    }
+    BlendRow_Additive_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_SSE2 static void BlendRow_Lit_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    const __m128i n = _mm_set1_epi32(alpha_to_factor(alpha));
+    const __m128i c = _mm_set1_epi32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, trans_blend_sse2(c, s, n), mask));
+    }
+    BlendRow_Lit_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_SSE2 static void BlendRow_LitKeepAlpha_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    const __m128i amask = _mm_set1_epi32(A_MASK);
+    const __m128i n = _mm_set1_epi32(alpha_to_factor(alpha));
+    const __m128i c = _mm_set1_epi32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i res = _mm_or_si128(trans_blend_sse2(c, s, n), _mm_and_si128(s, amask));
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, d, res, mask));
+    }
+    BlendRow_LitKeepAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static const PfnBlendRow SSE2Kernels[kNumBlendRowModes] =
+{
+    BlendRow_Alpha_SSE2,
+    BlendRow_TransAlpha_SSE2,
+    BlendRow_Trans_SSE2,
+    BlendRow_Additive_SSE2,
+    BlendRow_Lit_SSE2,
+    BlendRow_LitKeepAlpha_SSE2
+};
+
+AGS_TARGET_SSE2 static FORCEINLINE __m128i max_rgb_sse2(__m128i c)
+{
+    __m128i m = _mm_max_epu8(c, _mm_srli_epi32(c, 8));
+    m = _mm_max_epu8(m, _mm_srli_epi32(c, 16));
+    return _mm_and_si128(m, _mm_set1_epi32(0xFF));
+}
+
+// SSE2 has no gather instruction, so table lookups are done one by one
+AGS_TARGET_SSE2 static void TintRow_SSE2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, const uint32_t *table, int amount)
+{
+    const __m128i mask = _mm_set1_epi32(mask_color);
+    const __m128i amask = _mm_set1_epi32(A_MASK);
+    const __m128i n = _mm_set1_epi32(alpha_to_factor(amount));
+    uint32_t idx[4];
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)idx, max_rgb_sse2(s));
+        __m128i sa = _mm_and_si128(s, amask);
+        __m128i t = _mm_or_si128(_mm_setr_epi32(table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]), sa);
+        if (amount >= 0)
+            t = apply_mask_sse2(t, s, _mm_or_si128(trans_blend_sse2(t, s, n), sa), mask);
+        _mm_storeu_si128((__m128i*)(dst + i), apply_mask_sse2(s, s, t, mask));
+    }
+    TintRow_Scalar(dst + i, src + i, count - i, mask_color, table, amount);
+}
+
+#endif // AGS_BLEND_SSE2
+
+//-----------------------------------------------------------------------------
+// AVX2 kernels
+//-----------------------------------------------------------------------------
+#if defined(AGS_BLEND_AVX2)
+
+AGS_TARGET_AVX2 static FORCEINLINE __m256i trans_blend_avx2(__m256i x, __m256i y, __m256i n)
+{
+    const __m256i rb = _mm256_set1_epi32(RB_MASK);
+    const __m256i g  = _mm256_set1_epi32(G_MASK);
+    __m256i yg  = _mm256_and_si256(y, g);
+    __m256i res = _mm256_sub_epi32(_mm256_and_si256(x, rb), _mm256_and_si256(y, rb));
+    res = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(res, n), 8), y);
+    __m256i gr  = _mm256_sub_epi32(_mm256_and_si256(x, g), yg);
+    gr  = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(gr, n), 8), yg);
+    return _mm256_or_si256(_mm256_and_si256(res, rb), _mm256_and_si256(gr, g));
+}
+
+AGS_TARGET_AVX2 static FORCEINLINE __m256i alpha_to_factor_avx2(__m256i a)
+{
+    return _mm256_add_epi32(_mm256_add_epi32(a, _mm256_set1_epi32(1)),
+                            _mm256_cmpeq_epi32(a, _mm256_setzero_si256()));
+}
+
+AGS_TARGET_AVX2 static FORCEINLINE __m256i apply_mask_avx2(__m256i s, __m256i d, __m256i res, __m256i mask)
+{
+    return _mm256_blendv_epi8(res, d, _mm256_cmpeq_epi32(s, mask));
+}
+
+AGS_TARGET_AVX2 static void BlendRow_Alpha_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i n = alpha_to_factor_avx2(_mm256_srli_epi32(s, 24));
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, trans_blend_avx2(s, d, n), mask));
+    }
+    BlendRow_Alpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_AVX2 static void BlendRow_TransAlpha_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i alpha8 = _mm256_set1_epi32(alpha & 0xFF);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i a = _mm256_srli_epi32(_mm256_mullo_epi16(_mm256_srli_epi32(s, 24), alpha8), 8);
+        __m256i n = alpha_to_factor_avx2(a);
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, trans_blend_avx2(s, d, n), mask));
+    }
+    BlendRow_TransAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_AVX2 static void BlendRow_Trans_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i n = _mm256_set1_epi32(alpha_to_factor(alpha));
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, trans_blend_avx2(s, d, n), mask));
+    }
+    BlendRow_Trans_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_AVX2 static void BlendRow_Additive_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i amask = _mm256_set1_epi32(A_MASK);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i a = _mm256_adds_epu8(_mm256_and_si256(s, amask), _mm256_and_si256(d, amask));
+        __m256i res = _mm256_or_si256(a, _mm256_andnot_si256(amask, s));
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, res, mask));
+    }
+    BlendRow_Additive_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_AVX2 static void BlendRow_Lit_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i n = _mm256_set1_epi32(alpha_to_factor(alpha));
+    const __m256i c = _mm256_set1_epi32(color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, trans_blend_avx2(c, s, n), mask));
+    }
+    BlendRow_Lit_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+AGS_TARGET_AVX2 static void BlendRow_LitKeepAlpha_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i amask = _mm256_set1_epi32(A_MASK);
+    const __m256i n = _mm256_set1_epi32(alpha_to_factor(alpha));
+    const __m256i c = _mm256_set1_epi32(color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i res = _mm256_or_si256(trans_blend_avx2(c, s, n), _mm256_and_si256(s, amask));
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, d, res, mask));
+    }
+    BlendRow_LitKeepAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static const PfnBlendRow AVX2Kernels[kNumBlendRowModes] =
+{
+    BlendRow_Alpha_AVX2,
+    BlendRow_TransAlpha_AVX2,
+    BlendRow_Trans_AVX2,
+    BlendRow_Additive_AVX2,
+    BlendRow_Lit_AVX2,
+    BlendRow_LitKeepAlpha_AVX2
+};
+
+AGS_TARGET_AVX2 static FORCEINLINE __m256i max_rgb_avx2(__m256i c)
+{
+    __m256i m = _mm256_max_epu8(c, _mm256_srli_epi32(c, 8));
+    m = _mm256_max_epu8(m, _mm256_srli_epi32(c, 16));
+    return _mm256_and_si256(m, _mm256_set1_epi32(0xFF));
+}
+
+AGS_TARGET_AVX2 static void TintRow_AVX2(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, const uint32_t *table, int amount)
+{
+    const __m256i mask = _mm256_set1_epi32(mask_color);
+    const __m256i amask = _mm256_set1_epi32(A_MASK);
+    const __m256i n = _mm256_set1_epi32(alpha_to_factor(amount));
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i sa = _mm256_and_si256(s, amask);
+        __m256i t = _mm256_i32gather_epi32((const int*)table, max_rgb_avx2(s), 4);
+        t = _mm256_or_si256(t, sa);
+        if (amount >= 0)
+            t = apply_mask_avx2(t, s, _mm256_or_si256(trans_blend_avx2(t, s, n), sa), mask);
+        _mm256_storeu_si256((__m256i*)(dst + i), apply_mask_avx2(s, s, t, mask));
+    }
+    TintRow_Scalar(dst + i, src + i, count - i, mask_color, table, amount);
+}
+
+#endif // AGS_BLEND_AVX2
+
+//-----------------------------------------------------------------------------
+// NEON kernels
+//-----------------------------------------------------------------------------
+#if defined(AGS_BLEND_NEON)
+
+static FORCEINLINE uint32x4_t trans_blend_neon(uint32x4_t x, uint32x4_t y, uint32x4_t n)
+{
+    const uint32x4_t rb = vdupq_n_u32(RB_MASK);
+    const uint32x4_t g  = vdupq_n_u32(G_MASK);
+    uint32x4_t yg  = vandq_u32(y, g);
+    uint32x4_t res = vsubq_u32(vandq_u32(x, rb), vandq_u32(y, rb));
+    res = vaddq_u32(vshrq_n_u32(vmulq_u32(res, n), 8), y);
+    uint32x4_t gr  = vsubq_u32(vandq_u32(x, g), yg);
+    gr  = vaddq_u32(vshrq_n_u32(vmulq_u32(gr, n), 8), yg);
+    return vorrq_u32(vandq_u32(res, rb), vandq_u32(gr, g));
+}
+
+static FORCEINLINE uint32x4_t alpha_to_factor_neon(uint32x4_t a)
+{
+    // comparison gives all bits set (-1) where a is zero
+    return vaddq_u32(vaddq_u32(a, vdupq_n_u32(1)), vceqq_u32(a, vdupq_n_u32(0)));
+}
+
+static FORCEINLINE uint32x4_t apply_mask_neon(uint32x4_t s, uint32x4_t d, uint32x4_t res, uint32x4_t mask)
+{
+    return vbslq_u32(vceqq_u32(s, mask), d, res);
+}
+
+static void BlendRow_Alpha_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        uint32x4_t n = alpha_to_factor_neon(vshrq_n_u32(s, 24));
+        vst1q_u32(dst + i, apply_mask_neon(s, d, trans_blend_neon(s, d, n), mask));
+    }
+    BlendRow_Alpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static void BlendRow_TransAlpha_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t alpha4 = vdupq_n_u32(alpha & 0xFF);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        uint32x4_t n = alpha_to_factor_neon(vshrq_n_u32(vmulq_u32(vshrq_n_u32(s, 24), alpha4), 8));
+        vst1q_u32(dst + i, apply_mask_neon(s, d, trans_blend_neon(s, d, n), mask));
+    }
+    BlendRow_TransAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static void BlendRow_Trans_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t n = vdupq_n_u32(alpha_to_factor(alpha));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        vst1q_u32(dst + i, apply_mask_neon(s, d, trans_blend_neon(s, d, n), mask));
+    }
+    BlendRow_Trans_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static void BlendRow_Additive_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t amask = vdupq_n_u32(A_MASK);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        uint32x4_t a = vreinterpretq_u32_u8(vqaddq_u8(vreinterpretq_u8_u32(vandq_u32(s, amask)),
+                                                      vreinterpretq_u8_u32(vandq_u32(d, amask))));
+        uint32x4_t res = vorrq_u32(a, vbicq_u32(s, amask));
+        vst1q_u32(dst + i, apply_mask_neon(s, d, res, mask));
+    }
+    BlendRow_Additive_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static void BlendRow_Lit_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t n = vdupq_n_u32(alpha_to_factor(alpha));
+    const uint32x4_t c = vdupq_n_u32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        vst1q_u32(dst + i, apply_mask_neon(s, d, trans_blend_neon(c, s, n), mask));
+    }
+    BlendRow_Lit_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static void BlendRow_LitKeepAlpha_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, int alpha, uint32_t color)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t amask = vdupq_n_u32(A_MASK);
+    const uint32x4_t n = vdupq_n_u32(alpha_to_factor(alpha));
+    const uint32x4_t c = vdupq_n_u32(color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t d = vld1q_u32(dst + i);
+        uint32x4_t res = vorrq_u32(trans_blend_neon(c, s, n), vandq_u32(s, amask));
+        vst1q_u32(dst + i, apply_mask_neon(s, d, res, mask));
+    }
+    BlendRow_LitKeepAlpha_Scalar(dst + i, src + i, count - i, mask_color, alpha, color);
+}
+
+static const PfnBlendRow NEONKernels[kNumBlendRowModes] =
+{
+    BlendRow_Alpha_NEON,
+    BlendRow_TransAlpha_NEON,
+    BlendRow_Trans_NEON,
+    BlendRow_Additive_NEON,
+    BlendRow_Lit_NEON,
+    BlendRow_LitKeepAlpha_NEON
+};
+
+static FORCEINLINE uint32x4_t max_rgb_neon(uint32x4_t c)
+{
+    uint8x16_t m = vmaxq_u8(vreinterpretq_u8_u32(c), vreinterpretq_u8_u32(vshrq_n_u32(c, 8)));
+    m = vmaxq_u8(m, vreinterpretq_u8_u32(vshrq_n_u32(c, 16)));
+    return vandq_u32(vreinterpretq_u32_u8(m), vdupq_n_u32(0xFF));
+}
+
+static void TintRow_NEON(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color, const uint32_t *table, int amount)
+{
+    const uint32x4_t mask = vdupq_n_u32(mask_color);
+    const uint32x4_t amask = vdupq_n_u32(A_MASK);
+    const uint32x4_t n = vdupq_n_u32(alpha_to_factor(amount));
+    uint32_t idx[4];
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t s = vld1q_u32(src + i);
+        vst1q_u32(idx, max_rgb_neon(s));
+        const uint32_t lookup[4] = { table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]] };
+        uint32x4_t sa = vandq_u32(s, amask);
+        uint32x4_t t = vorrq_u32(vld1q_u32(lookup), sa);
+        if (amount >= 0)
+            t = apply_mask_neon(t, s, vorrq_u32(trans_blend_neon(t, s, n), sa), mask);
+        vst1q_u32(dst + i, apply_mask_neon(s, s, t, mask));
+    }
+    TintRow_Scalar(dst + i, src + i, count - i, mask_color, table, amount);
+}
+
+#endif // AGS_BLEND_NEON
+
+//-----------------------------------------------------------------------------
+// CPU detection and kernel selection
+//-----------------------------------------------------------------------------
+
+static const char *ImplNames[kNumBlendImpls] = { "Scalar", "SSE2", "AVX2", "NEON" };
+
+static bool                 Initialized = false;
+static bool                 ImplSupported[kNumBlendImpls] = { true, false, false, false };
+static BlendRowImpl         CurrentImpl = kBlendImpl_Scalar;
+static const PfnBlendRow   *CurrentKernels = ScalarKernels;
+static PfnTintRow           CurrentTintKernel = TintRow_Scalar;
+
+#if defined(AGS_BLEND_X86)
+static void DetectX86Features(bool &has_sse2, bool &has_avx2)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    has_sse2 = (info[3] & (1 << 26)) != 0;
+    has_avx2 = false;
+#if defined(AGS_BLEND_AVX2)
+    // AVX2 also requires OS support for saving YMM registers
+    const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    if (max_leaf >= 7 && os_saves_ymm)
+    {
+        __cpuidex(info, 7, 0);
+        has_avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#endif
+#else // __GNUC__
+    __builtin_cpu_init();
+    has_sse2 = __builtin_cpu_supports("sse2") != 0;
+    has_avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // AGS_BLEND_X86
+
+static const PfnBlendRow *GetKernels(BlendRowImpl impl)
+{
+    switch (impl)
+    {
+#if defined(AGS_BLEND_SSE2)
+    case kBlendImpl_SSE2: return SSE2Kernels;
+#endif
+#if defined(AGS_BLEND_AVX2)
+    case kBlendImpl_AVX2: return AVX2Kernels;
+#endif
+#if defined(AGS_BLEND_NEON)
+    case kBlendImpl_NEON: return NEONKernels;
+#endif
+    default: return ScalarKernels;
+    }
+}
+
+static PfnTintRow GetTintKernel(BlendRowImpl impl)
+{
+    switch (impl)
+    {
+#if defined(AGS_BLEND_SSE2)
+    case kBlendImpl_SSE2: return TintRow_SSE2;
+#endif
+#if defined(AGS_BLEND_AVX2)
+    case kBlendImpl_AVX2: return TintRow_AVX2;
+#endif
+#if defined(AGS_BLEND_NEON)
+    case kBlendImpl_NEON: return TintRow_NEON;
+#endif
+    default: return TintRow_Scalar;
+    }
+}
+
+void Init()
+{
+    if (Initialized)
+        return;
+#if defined(AGS_BLEND_X86)
+    bool has_sse2, has_avx2;
+    DetectX86Features(has_sse2, has_avx2);
+#if defined(AGS_BLEND_SSE2)
+    ImplSupported[kBlendImpl_SSE2] = has_sse2;
+#endif
+#if defined(AGS_BLEND_AVX2)
+    ImplSupported[kBlendImpl_AVX2] = has_avx2;
+#endif
+#endif // AGS_BLEND_X86
+#if defined(AGS_BLEND_NEON)
+    ImplSupported[kBlendImpl_NEON] = true;
+#endif
+    Initialized = true;
+
+    // Choose the widest supported implementation
+    for (int impl = kNumBlendImpls - 1; impl >= 0; --impl)
+    {
+        if (SetImpl((BlendRowImpl)impl))
+            break;
+    }
+}
+
+BlendRowImpl GetImpl()
+{
+    Init();
+    return CurrentImpl;
+}
+
+const char *GetImplName()
+{
+    return ImplNames[GetImpl()];
+}
+
+bool IsImplSupported(BlendRowImpl impl)
+{
+    Init();
+    return impl >= 0 && impl < kNumBlendImpls && ImplSupported[impl];
+}
+
+bool SetImpl(BlendRowImpl impl)
+{
+    if (!IsImplSupported(impl))
+        return false;
+    CurrentImpl = impl;
+    CurrentKernels = GetKernels(impl);
+    CurrentTintKernel = GetTintKernel(impl);
+    return true;
+}
+
+void BlendRow(BlendRowMode mode, uint32_t *dst, const uint32_t *src, int count,
+              uint32_t mask_color, int alpha, uint32_t color)
+{
+    Init();
+    CurrentKernels[mode](dst, src, count, mask_color, alpha, color);
+}
+
+void TintRow(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color,
+             const uint32_t *table, int amount)
+{
+    Init();
+    CurrentTintKernel(dst, src, count, mask_color, table, amount);
+}
+
+bool DrawBlended(Bitmap *ds, Bitmap *src, int x, int y, BlendRowMode mode, int alpha, color_t color)
+{
+    if (mode < 0 || mode >= kNumBlendRowModes ||
+        ds->GetColorDepth() != 32 || src->GetColorDepth() != 32 ||
+        !ds->IsMemoryBitmap() || !src->IsMemoryBitmap())
+        return false;
+    Init();
+
+    // Clip against destination's clipping rectangle, like Allegro does
+    Rect clip = ds->GetClip();
+    if (clip.Left < 0) clip.Left = 0;
+    if (clip.Top < 0) clip.Top = 0;
+    if (clip.Right >= ds->GetWidth()) clip.Right = ds->GetWidth() - 1;
+    if (clip.Bottom >= ds->GetHeight()) clip.Bottom = ds->GetHeight() - 1;
+
+    int src_x = 0, src_y = 0;
+    int width = src->GetWidth(), height = src->GetHeight();
+    if (x < clip.Left)
+    {
+        src_x = clip.Left - x;
+        width -= src_x;
+        x = clip.Left;
+    }
+    if (y < clip.Top)
+    {
+        src_y = clip.Top - y;
+        height -= src_y;
+        y = clip.Top;
+    }
+    if (x + width - 1 > clip.Right)
+        width = clip.Right - x + 1;
+    if (y + height - 1 > clip.Bottom)
+        height = clip.Bottom - y + 1;
+    if (width <= 0 || height <= 0)
+        return true;
+
+    const PfnBlendRow kernel = CurrentKernels[mode];
+    const uint32_t mask_color = src->GetMaskColor();
+    for (int row = 0; row < height; ++row)
+    {
+        const uint32_t *src_line = (const uint32_t*)src->GetScanLine(src_y + row) + src_x;
+        uint32_t       *dst_line = (uint32_t*)ds->GetScanLineForWriting(y + row) + x;
+        kernel(dst_line, src_line, width, mask_color, alpha, (uint32_t)color);
+    }
+    return true;
+}
+
+} // namespace RowBlend
+} // namespace Engine
+} // namespace AGS
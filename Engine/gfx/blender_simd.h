@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Row blending kernels for the software renderer.
+//
+// These produce exactly the same results as the Allegro blender callbacks
+// used by the software renderer (see blender.h), but process whole scanlines
+// at once instead of calling blender through function pointer for every
+// pixel. SSE2, AVX2 and NEON implementations are chosen at runtime, depending
+// on what the CPU supports.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__BLENDERSIMD_H
+#define __AGS_EE_GFX__BLENDERSIMD_H
+
+#include "core/types.h"
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+
+namespace RowBlend
+{
+    enum BlendRowMode
+    {
+        // Allegro's alpha blender (set_alpha_blender): RGBs are combined
+        // proportionally to src alpha, final alpha is zero
+        kBlendRow_Alpha,
+        // Same as above, but src alpha is also multiplied by the overall alpha
+        kBlendRow_TransAlpha,
+        // Allegro's translucency blender (set_trans_blender): RGBs are combined
+        // proportionally to the overall alpha, final alpha is zero
+        kBlendRow_Trans,
+        // Plain copy of src RGB, final alpha is a sum of src and dst alphas
+        kBlendRow_Additive,
+        // Allegro's lit drawing with translucency blender: constant colour is
+        // drawn over the src with the given light amount, final alpha is zero
+        kBlendRow_Lit,
+        // Same as above, but using AGS's translucency blender
+        // (set_my_trans_blender), which keeps src alpha
+        kBlendRow_LitKeepAlpha,
+        kNumBlendRowModes
+    };
+
+    enum BlendRowImpl
+    {
+        kBlendImpl_Scalar,
+        kBlendImpl_SSE2,
+        kBlendImpl_AVX2,
+        kBlendImpl_NEON,
+        kNumBlendImpls
+    };
+
+    // Detects CPU features and selects the best available implementation;
+    // it is safe to call this more than once
+    void            Init();
+    BlendRowImpl    GetImpl();
+    const char     *GetImplName();
+    // Tells if the given implementation is supported by both build and CPU
+    bool            IsImplSupported(BlendRowImpl impl);
+    // Forces particular implementation, returns false if it is not supported
+    bool            SetImpl(BlendRowImpl impl);
+
+    // Blends a row of 32-bit src pixels over dst; src pixels which equal to
+    // mask_color are skipped. 'alpha' is the overall alpha, or light amount
+    // for kBlendRow_Lit; 'color' is only used by kBlendRow_Lit.
+    void BlendRow(BlendRowMode mode, uint32_t *dst, const uint32_t *src, int count,
+                  uint32_t mask_color, int alpha, uint32_t color);
+
+    // Tints a row of 32-bit src pixels into dst (which may be the same as
+    // src), using a table made by make_tint_table32: every pixel is replaced
+    // by table[max(r,g,b)], keeping its alpha. If 'amount' is not negative,
+    // the tinted pixel is then drawn over the original one as with
+    // set_my_trans_blender using that alpha. Src pixels which equal to
+    // mask_color are copied as is.
+    void TintRow(uint32_t *dst, const uint32_t *src, int count, uint32_t mask_color,
+                 const uint32_t *table, int amount);
+
+    // Draws src bitmap over ds at (x, y), clipped by ds' clipping rectangle,
+    // same as Bitmap::TransBlendBlt (or LitBlendBlt for kBlendRow_Lit) would
+    // after setting corresponding Allegro blender. Returns false if the
+    // bitmaps are not supported (both must be 32-bit memory bitmaps), in which
+    // case the caller should fallback to the generic Allegro drawing.
+    bool DrawBlended(Bitmap *ds, Bitmap *src, int x, int y, BlendRowMode mode,
+                     int alpha = 0, color_t color = 0);
+} // namespace RowBlend
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__BLENDERSIMD_H
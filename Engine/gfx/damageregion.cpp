@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "gfx/damageregion.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+DamageRegion::DamageRegion()
+    : _whole(false)
+{
+}
+
+void DamageRegion::SetBounds(const Rect &bounds)
+{
+    _bounds = bounds;
+    MarkWhole();
+}
+
+void DamageRegion::Clear()
+{
+    _whole = false;
+    _rects.clear();
+}
+
+void DamageRegion::MarkWhole()
+{
+    _whole = true;
+    _rects.clear();
+    if (!_bounds.IsEmpty())
+        _rects.push_back(_bounds);
+}
+
+void DamageRegion::Add(const Rect &rc)
+{
+    if (_whole)
+        return;
+    Rect r = IntersectRects(rc, _bounds);
+    if (r.IsEmpty())
+        return;
+
+    // Merge with any rectangle the new one touches; since the merged one
+    // grows it may now touch those that were tested earlier, so restart
+    for (size_t i = 0; i < _rects.size();)
+    {
+        if (AreRectsAdjacent(_rects[i], r))
+        {
+            r = UnionRects(_rects[i], r);
+            _rects[i] = _rects.back();
+            _rects.pop_back();
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    _rects.push_back(r);
+
+    if (_rects.size() > MaxRects)
+    {
+        Rect all;
+        for (size_t i = 0; i < _rects.size(); ++i)
+            all = UnionRects(all, _rects[i]);
+        _rects.clear();
+        _rects.push_back(all);
+    }
+
+    int area = 0;
+    for (size_t i = 0; i < _rects.size(); ++i)
+        area += _rects[i].GetWidth() * _rects[i].GetHeight();
+    if (area >= (_bounds.GetWidth() * _bounds.GetHeight() / 4) * 3)
+        MarkWhole();
+}
+
+void DamageRegion::Add(const DamageRegion &other)
+{
+    if (other._whole)
+    {
+        MarkWhole();
+        return;
+    }
+    for (size_t i = 0; i < other._rects.size() && !_whole; ++i)
+        Add(other._rects[i]);
+}
+
+bool DamageRegion::Intersects(const Rect &rc) const
+{
+    for (size_t i = 0; i < _rects.size(); ++i)
+    {
+        if (!IntersectRects(_rects[i], rc).IsEmpty())
+            return true;
+    }
+    return false;
+}
+
+} // namespace Engine
+} // namespace AGS
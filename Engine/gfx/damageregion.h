@@ -0,0 +1,75 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// DamageRegion is a set of rectangles describing which parts of a surface
+// were changed and need to be redrawn or presented.
+//
+// Rectangles that overlap or touch each other are merged, so the resulting
+// list never contains intersecting rectangles. When there are too many of
+// them, or they cover most of the surface, the region is simply marked as
+// "whole", because redrawing everything at once is cheaper at that point.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__DAMAGEREGION_H
+#define __AGS_EE_GFX__DAMAGEREGION_H
+
+#include <vector>
+#include "core/types.h"
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class DamageRegion
+{
+public:
+    // Max number of separate rectangles before they are merged into one
+    static const size_t MaxRects = 16;
+
+    DamageRegion();
+
+    // Sets the surface bounds; damage outside of them is ignored.
+    // Changing bounds marks the whole region damaged.
+    void SetBounds(const Rect &bounds);
+    const Rect &GetBounds() const { return _bounds; }
+
+    // Resets region to the undamaged state
+    void Clear();
+    // Marks whole surface as damaged
+    void MarkWhole();
+    // Adds rectangle to the region
+    void Add(const Rect &rc);
+    // Adds all of the other region's rectangles
+    void Add(const DamageRegion &other);
+
+    bool IsEmpty() const { return _rects.empty(); }
+    bool IsWhole() const { return _whole; }
+    // Tells if the given rectangle intersects any part of the region
+    bool Intersects(const Rect &rc) const;
+    // Returns list of damaged rectangles; if whole region is damaged this
+    // is a single rectangle equal to bounds
+    const std::vector<Rect> &GetRects() const { return _rects; }
+
+private:
+    Rect _bounds;
+    bool _whole;
+    std::vector<Rect> _rects;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__DAMAGEREGION_H
@@ -14,6 +14,7 @@
 
 #include "gfx/gfx_util.h"
 #include "gfx/blender.h"
+#include "gfx/blender_simd.h"
 
 // CHECKME: is this hack still relevant?
 #if defined(IOS_VERSION) || defined(ANDROID_VERSION) || defined(WINDOWS_VERSION)
@@ -146,8 +147,11 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
     {
         if (alpha < 0xFF && surface_depth > 8 && sprite_depth > 8) 
         {
-            set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(sprite, x, y);
+            if (!RowBlend::DrawBlended(ds, sprite, x, y, RowBlend::kBlendRow_Trans, alpha))
+            {
+                set_trans_blender(0, 0, 0, alpha);
+                ds->TransBlendBlt(sprite, x, y);
+            }
         }
         else
         {
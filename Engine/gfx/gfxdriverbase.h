@@ -40,6 +40,14 @@ public:
     virtual Size        GetNativeSize() const;
     virtual Rect        GetRenderDestination() const;
     virtual void        SetRenderOffset(int x, int y);
+    // Every frame is shown by default
+    virtual bool        SkipsRendering() { return false; }
+    // Damage tracking is not supported by default
+    virtual bool        UsesDamageTracking() { return false; }
+    virtual void        EnableDamageTracking(bool enabled) { }
+    virtual void        InvalidateRect(const Rect &rc) { }
+    virtual void        InvalidateScreen() { }
+    virtual bool        GetDamagedRegions(std::vector<Rect> &rects) { return false; }
 
 protected:
     // Called after graphics driver was initialized for use for the first time
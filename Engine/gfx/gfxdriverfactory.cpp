@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "gfx/gfxdriverfactory.h"
+#include "gfx/ali3dnull.h"
 #include "gfx/ali3dsw.h"
 #include "gfx/gfxfilter_allegro.h"
 
@@ -44,6 +45,8 @@ void GetGfxDriverFactoryNames(StringV &ids)
     ids.push_back("OGL");
 #endif
     ids.push_back("DX5");
+    // NOTE: the null driver does not display anything, so it is never
+    // chosen in place of the failed one, and only used when requested
 }
 
 IGfxDriverFactory *GetGfxDriverFactory(const String id)
@@ -58,6 +61,8 @@ IGfxDriverFactory *GetGfxDriverFactory(const String id)
 #endif
     if (id.CompareNoCase("DX5") == 0)
         return ALSW::ALSWGraphicsFactory::GetFactory();
+    if (id.CompareNoCase("NULL") == 0)
+        return Null::NullGraphicsFactory::GetFactory();
     set_allegro_error("No graphics factory with such id: %s", id.GetCStr());
     return NULL;
 }
@@ -95,6 +95,37 @@ void AllegroGfxFilter::RenderScreen(Bitmap *toRender, int x, int y) {
     lastBlitY = y;
 }
 
+bool AllegroGfxFilter::RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions)
+{
+    if (toRender != realScreen)
+    {
+        // Nearest-neighbour stretching of a part of the image only gives the
+        // same pixels as stretching whole image if the scale is integral
+        const int scale_x = _scaling.X.ScaleDistance(1);
+        const int scale_y = _scaling.Y.ScaleDistance(1);
+        if (scale_x < 1 || scale_y < 1 ||
+            _scaling.X.ScaleDistance(toRender->GetWidth()) != toRender->GetWidth() * scale_x ||
+            _scaling.Y.ScaleDistance(toRender->GetHeight()) != toRender->GetHeight() * scale_y)
+            return false;
+
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            const Rect &rc = regions[i];
+            const int dst_x = _scaling.X.ScalePt(x + rc.Left);
+            const int dst_y = _scaling.Y.ScalePt(y + rc.Top);
+            if (scale_x == 1 && scale_y == 1)
+                realScreen->Blit(toRender, rc.Left, rc.Top, dst_x, dst_y, rc.GetWidth(), rc.GetHeight());
+            else
+                realScreen->StretchBlt(toRender, rc,
+                    RectWH(dst_x, dst_y, rc.GetWidth() * scale_x, rc.GetHeight() * scale_y));
+        }
+    }
+    lastBlitFrom = toRender;
+    lastBlitX = _scaling.X.ScalePt(x);
+    lastBlitY = _scaling.Y.ScalePt(y);
+    return true;
+}
+
 void AllegroGfxFilter::RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType) {
 
     if (toRender == virtualScreen)
@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_GFX__ALLEGROGFXFILTER_H
 #define __AGS_EE_GFX__ALLEGROGFXFILTER_H
 
+#include <vector>
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter_scaling.h"
 #include "gfx/gfxdefines.h"
@@ -43,6 +44,10 @@ public:
     virtual Bitmap *ShutdownAndReturnRealScreen();
     virtual void RenderScreen(Bitmap *toRender, int x, int y);
     virtual void RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType);
+    // Renders only the given regions of the bitmap; returns false if the
+    // filter cannot do this without changing the result, in which case
+    // the caller should render the whole screen instead
+    virtual bool RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions);
     virtual void ClearRect(int x1, int y1, int x2, int y2, int color);
     virtual void GetCopyOfScreenIntoBitmap(Bitmap *copyBitmap);
     virtual void GetCopyOfScreenIntoBitmap(Bitmap *copyBitmap, bool copy_with_yoffset);
@@ -78,6 +78,12 @@ Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
     return real_screen;
 }
 
+bool HqxGfxFilter::RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions)
+{
+    // hqx result depends on the surrounding pixels, so always process full image
+    return false;
+}
+
 Bitmap *HqxGfxFilter::PreRenderPass(Bitmap *toRender)
 {
     _hqxScalingBuffer->Acquire();
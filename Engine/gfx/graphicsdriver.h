@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_GFX__GRAPHICSDRIVER_H
 #define __AGS_EE_GFX__GRAPHICSDRIVER_H
 
+#include <vector>
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
 #include "gfx/gfxdefines.h"
@@ -119,6 +120,21 @@ public:
   virtual bool RequiresFullRedrawEachFrame() = 0;
   virtual bool HasAcceleratedStretchAndFlip() = 0;
   virtual bool UsesMemoryBackBuffer() = 0;
+  // Tells if the renderer does not show the frames anywhere, in which case
+  // the engine does not have to prepare them at all
+  virtual bool SkipsRendering() = 0;
+  // Tells if the renderer keeps track of changed screen regions and only
+  // redraws and presents those instead of the whole screen
+  virtual bool UsesDamageTracking() = 0;
+  virtual void EnableDamageTracking(bool enabled) = 0;
+  // Notifies renderer that the part of memory back buffer was changed
+  // outside of the draw list, and has to be reconstructed on next render
+  virtual void InvalidateRect(const Rect &rc) = 0;
+  virtual void InvalidateScreen() = 0;
+  // Gets the list of regions that were changed by the last render, in the
+  // native game coordinates. Returns false if this information is not
+  // available, in which case the whole screen should be considered changed.
+  virtual bool GetDamagedRegions(std::vector<Rect> &rects) = 0;
   virtual ~IGraphicsDriver() { }
 };
 
@@ -0,0 +1,213 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "gfx/spritetinter.h"
+#include "debug/out.h"
+#include "gfx/blender_simd.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/mutex_lock.h"
+
+using namespace AGS::Common;
+
+extern AGSPlatformDriver *platform;
+
+namespace AGS
+{
+namespace Engine
+{
+
+SpriteTinter *SpriteTinter::_workerTinter = NULL;
+
+SpriteTinter::SpriteTinter()
+    : _threadCount(0)
+    , _batching(false)
+    , _jobCount(0)
+    , _nextJob(0)
+    , _doneJobs(0)
+{
+}
+
+SpriteTinter::~SpriteTinter()
+{
+    EndBatch();
+    StopThreads();
+}
+
+bool SpriteTinter::StartThreads(int threads)
+{
+    StopThreads();
+    if (threads <= 0 || _workerTinter != NULL)
+        return false;
+    if (threads > MaxThreads)
+        threads = MaxThreads;
+
+    // kernel selection must be done before workers may use them
+    RowBlend::Init();
+    _workerTinter = this;
+    for (; _threadCount < threads; ++_threadCount)
+    {
+        if (!_threads[_threadCount].CreateAndStart(WorkerThread, true))
+            break;
+    }
+    if (_threadCount == 0)
+    {
+        _workerTinter = NULL;
+        Debug::Printf(kDbgMsg_Error, "Failed to start sprite tint threads");
+        return false;
+    }
+    Debug::Printf("Started %d sprite tint thread(s)", _threadCount);
+    return true;
+}
+
+void SpriteTinter::StopThreads()
+{
+    if (_threadCount == 0)
+        return;
+    for (int i = 0; i < _threadCount; ++i)
+        _threads[i].Stop();
+    _threadCount = 0;
+    _workerTinter = NULL;
+}
+
+void SpriteTinter::BeginBatch()
+{
+    _batching = true;
+}
+
+void SpriteTinter::EndBatch()
+{
+    _batching = false;
+    if (_jobs.empty())
+        return;
+
+    {
+        MutexLock lock(_jobMutex);
+        _jobCount = _jobs.size();
+        _nextJob = 0;
+        _doneJobs = 0;
+    }
+
+    // work along with the threads, then wait for the jobs they took
+    size_t index;
+    while (TakeJob(index))
+    {
+        DoJob(_jobs[index]);
+        FinishJob();
+    }
+    for (;;)
+    {
+        MutexLock lock(_jobMutex);
+        if (_doneJobs == _jobCount)
+        {
+            _jobCount = 0;
+            break;
+        }
+        lock.Release();
+        platform->YieldCPU();
+    }
+    _jobs.clear();
+}
+
+bool SpriteTinter::IsSupported(Bitmap *dst, Bitmap *src)
+{
+    return dst->GetColorDepth() == 32 && src->GetColorDepth() == 32 &&
+        dst->IsMemoryBitmap() && src->IsMemoryBitmap() &&
+        dst->GetWidth() == src->GetWidth() && dst->GetHeight() == src->GetHeight();
+}
+
+void SpriteTinter::Tint(Bitmap *dst, Bitmap *src, const uint32_t *table, int amount)
+{
+    TintJob job;
+    job.Dst = dst;
+    job.Src = src;
+    job.IsLight = false;
+    job.Color = 0;
+    job.Amount = amount;
+    memcpy(job.Table, table, sizeof(job.Table));
+    AddJob(job);
+}
+
+void SpriteTinter::Light(Bitmap *dst, Bitmap *src, uint32_t color, int amount)
+{
+    TintJob job;
+    job.Dst = dst;
+    job.Src = src;
+    job.IsLight = true;
+    job.Color = color;
+    job.Amount = amount;
+    AddJob(job);
+}
+
+void SpriteTinter::AddJob(const TintJob &job)
+{
+    RowBlend::Init();
+    if (_batching)
+        _jobs.push_back(job);
+    else
+        DoJob(job);
+}
+
+bool SpriteTinter::TakeJob(size_t &index)
+{
+    MutexLock lock(_jobMutex);
+    if (_nextJob >= _jobCount)
+        return false;
+    index = _nextJob++;
+    return true;
+}
+
+void SpriteTinter::FinishJob()
+{
+    MutexLock lock(_jobMutex);
+    _doneJobs++;
+}
+
+void SpriteTinter::DoJob(const TintJob &job)
+{
+    const int width = job.Src->GetWidth();
+    const int height = job.Src->GetHeight();
+    const uint32_t mask_color = job.Src->GetMaskColor();
+    for (int y = 0; y < height; ++y)
+    {
+        const uint32_t *src = (const uint32_t*)job.Src->GetScanLine(y);
+        uint32_t *dst = (uint32_t*)job.Dst->GetScanLineForWriting(y);
+        if (!job.IsLight)
+        {
+            RowBlend::TintRow(dst, src, width, mask_color, job.Table, job.Amount);
+            continue;
+        }
+        // lit drawing skips transparent pixels, which must become
+        // transparent in the result too
+        if (dst != src)
+            memcpy(dst, src, width * sizeof(uint32_t));
+        RowBlend::BlendRow(RowBlend::kBlendRow_LitKeepAlpha, dst, dst, width, mask_color, job.Amount, job.Color);
+    }
+}
+
+void SpriteTinter::WorkerThread()
+{
+    SpriteTinter *tinter = _workerTinter;
+    size_t index;
+    if (!tinter->TakeJob(index))
+    {
+        platform->Delay(1);
+        return;
+    }
+    tinter->DoJob(tinter->_jobs[index]);
+    tinter->FinishJob();
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// SpriteTinter applies tint and light level to 32-bit images using the
+// RowBlend kernels, giving the same results as the Allegro blenders set up
+// by tint_image and apply_tint_or_light.
+//
+// Normally each image is processed at once. Between BeginBatch and EndBatch
+// the jobs are queued instead, and EndBatch processes all of them, sharing
+// the work between the calling thread and optional worker threads. Workers
+// never call Allegro: tint tables are made by the main thread, and kernels
+// only access bitmap lines directly.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__SPRITETINTER_H
+#define __AGS_EE_GFX__SPRITETINTER_H
+
+#include <vector>
+#include "core/types.h"
+#include "gfx/bitmap.h"
+#include "util/mutex.h"
+#include "util/thread.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+
+class SpriteTinter
+{
+public:
+    static const int MaxThreads = 4;
+
+    SpriteTinter();
+    ~SpriteTinter();
+
+    // Starts given number of worker threads
+    bool StartThreads(int threads);
+    void StopThreads();
+    int  GetThreadCount() const { return _threadCount; }
+
+    // Starts queuing the jobs; bitmaps passed to Tint and Light must stay
+    // valid and unchanged until EndBatch
+    void BeginBatch();
+    // Does all the queued jobs and waits until they are finished
+    void EndBatch();
+    bool IsBatching() const { return _batching; }
+
+    // Tells if the bitmaps may be processed by the tinter: both must be
+    // 32-bit memory bitmaps of the same size
+    static bool IsSupported(Bitmap *dst, Bitmap *src);
+    // Draws src tinted with the table made by make_tint_table32 onto dst;
+    // 'amount' is the alpha of the tinted image drawn over the original one,
+    // or -1 to fully replace it. dst may be the same bitmap as src.
+    void Tint(Bitmap *dst, Bitmap *src, const uint32_t *table, int amount);
+    // Draws constant colour over src onto dst with the given light amount,
+    // keeping src alpha. dst may be the same bitmap as src.
+    void Light(Bitmap *dst, Bitmap *src, uint32_t color, int amount);
+
+private:
+    struct TintJob
+    {
+        Bitmap  *Dst;
+        Bitmap  *Src;
+        bool     IsLight;
+        uint32_t Color;
+        int      Amount;
+        uint32_t Table[256];
+    };
+
+    void AddJob(const TintJob &job);
+    // Takes next queued job, returns false if there are none left
+    bool TakeJob(size_t &index);
+    void FinishJob();
+
+    static void DoJob(const TintJob &job);
+    static void WorkerThread();
+
+    Thread   _threads[MaxThreads];
+    int      _threadCount;
+    bool     _batching;
+    // The job list is only changed by the main thread while workers are
+    // idle; job counters are guarded by _jobMutex
+    std::vector<TintJob> _jobs;
+    Mutex    _jobMutex;
+    size_t   _jobCount;
+    size_t   _nextJob;
+    size_t   _doneJobs;
+
+    // The tinter that worker threads work for; only one tinter may have
+    // workers at a time
+    static SpriteTinter *_workerTinter;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__SPRITETINTER_H
@@ -0,0 +1,387 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "gfx/spritetransformcache.h"
+#include "debug/out.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/mutex_lock.h"
+
+using namespace AGS::Common;
+
+extern AGSPlatformDriver *platform;
+
+namespace AGS
+{
+namespace Engine
+{
+
+SpriteTransformKey::SpriteTransformKey()
+    : Sprite(0)
+    , Width(0)
+    , Height(0)
+    , Flip(false)
+    , AntiAlias(false)
+    , TintAmount(0)
+    , TintRed(0)
+    , TintGreen(0)
+    , TintBlue(0)
+    , TintLight(0)
+    , LightLevel(0)
+{
+}
+
+SpriteTransformKey::SpriteTransformKey(int sprite, int width, int height, bool flip, bool anti_alias)
+    : Sprite(sprite)
+    , Width(width)
+    , Height(height)
+    , Flip(flip)
+    , AntiAlias(anti_alias)
+    , TintAmount(0)
+    , TintRed(0)
+    , TintGreen(0)
+    , TintBlue(0)
+    , TintLight(0)
+    , LightLevel(0)
+{
+}
+
+bool SpriteTransformKey::operator <(const SpriteTransformKey &other) const
+{
+    if (Sprite != other.Sprite) return Sprite < other.Sprite;
+    if (Width != other.Width) return Width < other.Width;
+    if (Height != other.Height) return Height < other.Height;
+    if (Flip != other.Flip) return Flip < other.Flip;
+    if (AntiAlias != other.AntiAlias) return AntiAlias < other.AntiAlias;
+    if (TintAmount != other.TintAmount) return TintAmount < other.TintAmount;
+    if (TintRed != other.TintRed) return TintRed < other.TintRed;
+    if (TintGreen != other.TintGreen) return TintGreen < other.TintGreen;
+    if (TintBlue != other.TintBlue) return TintBlue < other.TintBlue;
+    if (TintLight != other.TintLight) return TintLight < other.TintLight;
+    return LightLevel < other.LightLevel;
+}
+
+
+SpriteTransformCache *SpriteTransformCache::_prefilterCache = NULL;
+
+SpriteTransformCache::SpriteTransformCache()
+    : _maxSize(0)
+    , _curSize(0)
+    , _threadCount(0)
+    , _generation(0)
+{
+}
+
+SpriteTransformCache::~SpriteTransformCache()
+{
+    StopPrefilter();
+    Clear();
+}
+
+void SpriteTransformCache::SetMaxSize(size_t max_size)
+{
+    _maxSize = max_size;
+    FreeUpSpace(0);
+}
+
+Bitmap *SpriteTransformCache::Get(const SpriteTransformKey &key)
+{
+    CollectPrefiltered();
+    CacheMap::iterator it = _cache.find(key);
+    if (it == _cache.end())
+        return NULL;
+    // move to the front of the LRU list
+    _lru.splice(_lru.begin(), _lru, it->second.LruPos);
+    return it->second.Image;
+}
+
+void SpriteTransformCache::Put(const SpriteTransformKey &key, Bitmap *image)
+{
+    const size_t size = image->GetDataSize();
+    if (size > _maxSize)
+    {
+        delete image;
+        return;
+    }
+
+    CacheMap::iterator it = _cache.find(key);
+    if (it != _cache.end())
+        Remove(it);
+    FreeUpSpace(size);
+
+    _lru.push_front(key);
+    CacheEntry &entry = _cache[key];
+    entry.Image = image;
+    entry.LruPos = _lru.begin();
+    _curSize += size;
+}
+
+void SpriteTransformCache::InvalidateSprite(int sprite)
+{
+    CacheMap::iterator it = _cache.lower_bound(SpriteTransformKey(sprite, 0, 0, false, false));
+    while (it != _cache.end() && it->first.Sprite == sprite)
+    {
+        CacheMap::iterator next = it;
+        ++next;
+        Remove(it);
+        it = next;
+    }
+    // Results of the jobs already queued may be made of the old image;
+    // bump the generation so that they are discarded when collected
+    if (!_pending.empty())
+        _generation++;
+}
+
+void SpriteTransformCache::Clear()
+{
+    for (CacheMap::iterator it = _cache.begin(); it != _cache.end(); ++it)
+        delete it->second.Image;
+    _cache.clear();
+    _lru.clear();
+    _curSize = 0;
+    _generation++;
+}
+
+void SpriteTransformCache::Remove(CacheMap::iterator it)
+{
+    _curSize -= it->second.Image->GetDataSize();
+    delete it->second.Image;
+    _lru.erase(it->second.LruPos);
+    _cache.erase(it);
+}
+
+void SpriteTransformCache::FreeUpSpace(size_t space_needed)
+{
+    while (!_lru.empty() && _curSize + space_needed > _maxSize)
+        Remove(_cache.find(_lru.back()));
+}
+
+bool SpriteTransformCache::StartPrefilter(int threads)
+{
+    StopPrefilter();
+    if (threads <= 0 || _prefilterCache != NULL)
+        return false;
+    if (threads > MaxPrefilterThreads)
+        threads = MaxPrefilterThreads;
+
+    _prefilterCache = this;
+    for (; _threadCount < threads; ++_threadCount)
+    {
+        if (!_threads[_threadCount].CreateAndStart(PrefilterThread, true))
+            break;
+    }
+    if (_threadCount == 0)
+    {
+        _prefilterCache = NULL;
+        Debug::Printf(kDbgMsg_Error, "Failed to start sprite prefilter threads");
+        return false;
+    }
+    Debug::Printf("Started %d sprite prefilter thread(s)", _threadCount);
+    return true;
+}
+
+void SpriteTransformCache::StopPrefilter()
+{
+    if (_threadCount == 0)
+        return;
+    for (int i = 0; i < _threadCount; ++i)
+        _threads[i].Stop();
+    _threadCount = 0;
+    _prefilterCache = NULL;
+
+    DeleteJobs(_jobs);
+    DeleteJobs(_doneJobs);
+    _pending.clear();
+}
+
+void SpriteTransformCache::Prefilter(const SpriteTransformKey &key, Bitmap *sprite)
+{
+    if (!IsPrefiltering() || !IsEnabled() || key.HasTint() || key.AntiAlias)
+        return;
+    CollectPrefiltered();
+    if (_pending.size() >= MaxPrefilterJobs ||
+        _pending.count(key) > 0 || _cache.count(key) > 0)
+        return;
+
+    PrefilterJob job;
+    job.Key = key;
+    job.Source = BitmapHelper::CreateBitmapCopy(sprite);
+    job.Result = BitmapHelper::CreateTransparentBitmap(key.Width, key.Height, sprite->GetColorDepth());
+    job.Generation = _generation;
+    if (!job.Source || !job.Result)
+    {
+        delete job.Source;
+        delete job.Result;
+        return;
+    }
+    _pending.insert(key);
+
+    MutexLock lock(_jobMutex);
+    _jobs.push_back(job);
+}
+
+void SpriteTransformCache::CollectPrefiltered()
+{
+    if (_pending.empty())
+        return;
+
+    std::vector<PrefilterJob> done;
+    {
+        MutexLock lock(_jobMutex);
+        if (_doneJobs.empty())
+            return;
+        done.swap(_doneJobs);
+    }
+
+    for (size_t i = 0; i < done.size(); ++i)
+    {
+        PrefilterJob &job = done[i];
+        _pending.erase(job.Key);
+        delete job.Source;
+        if (job.Generation == _generation)
+            Put(job.Key, job.Result);
+        else
+            delete job.Result;
+    }
+}
+
+void SpriteTransformCache::DeleteJobs(std::vector<PrefilterJob> &jobs)
+{
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        delete jobs[i].Source;
+        delete jobs[i].Result;
+    }
+    jobs.clear();
+}
+
+void SpriteTransformCache::PrefilterThread()
+{
+    SpriteTransformCache *cache = _prefilterCache;
+    PrefilterJob job;
+    {
+        MutexLock lock(cache->_jobMutex);
+        if (cache->_jobs.empty())
+        {
+            lock.Release();
+            platform->Delay(2);
+            return;
+        }
+        job = cache->_jobs.back();
+        cache->_jobs.pop_back();
+    }
+
+    StretchAndFlip(job.Result, job.Source, job.Key.Flip);
+
+    MutexLock lock(cache->_jobMutex);
+    cache->_doneJobs.push_back(job);
+}
+
+
+// Precalculated steps of Allegro's line stretcher (see c/cstretch.c):
+// the source advances by 'inc' every destination pixel, plus one more
+// whenever the counter drops to zero or below
+struct StretchSteps
+{
+    int Inc;
+    int CounterDec;
+    int CounterInc;
+    int Counter;
+    int Pos;
+
+    StretchSteps(int src_len, int dst_len)
+    {
+        Inc = src_len / dst_len;
+        CounterDec = src_len - Inc * dst_len;
+        CounterInc = dst_len - CounterDec;
+        Counter = CounterInc;
+        Pos = 0;
+    }
+
+    inline void Next()
+    {
+        if (Counter <= 0)
+        {
+            Pos++;
+            Counter += CounterInc;
+        }
+        else
+            Counter -= CounterDec;
+        Pos += Inc;
+    }
+};
+
+template <class TPixel>
+static void StretchRows(Bitmap *dst, const Bitmap *src, const std::vector<int> &src_x, const TPixel mask)
+{
+    const int dw = dst->GetWidth();
+    const int dh = dst->GetHeight();
+    StretchSteps sy(src->GetHeight(), dh);
+    for (int y = 0; y < dh; ++y, sy.Next())
+    {
+        const TPixel *s = (const TPixel*)src->GetScanLine(sy.Pos);
+        TPixel *d = (TPixel*)dst->GetScanLineForWriting(y);
+        for (int x = 0; x < dw; ++x)
+        {
+            const TPixel c = s[src_x[x]];
+            if (c != mask)
+                d[x] = c;
+        }
+    }
+}
+
+static void StretchRows24(Bitmap *dst, const Bitmap *src, const std::vector<int> &src_x, const int mask)
+{
+    const int dw = dst->GetWidth();
+    const int dh = dst->GetHeight();
+    StretchSteps sy(src->GetHeight(), dh);
+    for (int y = 0; y < dh; ++y, sy.Next())
+    {
+        const uint8_t *s = src->GetScanLine(sy.Pos);
+        uint8_t *d = dst->GetScanLineForWriting(y);
+        for (int x = 0; x < dw; ++x)
+        {
+            const uint8_t *sp = s + src_x[x] * 3;
+            const int c = sp[0] | (sp[1] << 8) | (sp[2] << 16);
+            if (c != mask)
+                memcpy(d + x * 3, sp, 3);
+        }
+    }
+}
+
+void SpriteTransformCache::StretchAndFlip(Bitmap *dst, const Bitmap *src, bool flip)
+{
+    const int dw = dst->GetWidth();
+    if (dw <= 0 || dst->GetHeight() <= 0 || src->GetWidth() <= 0 || src->GetHeight() <= 0)
+        return;
+
+    // Source column for every destination column; flipping is simply
+    // reading this table backwards
+    std::vector<int> src_x(dw);
+    StretchSteps sx(src->GetWidth(), dw);
+    for (int x = 0; x < dw; ++x, sx.Next())
+        src_x[flip ? dw - 1 - x : x] = sx.Pos;
+
+    const int mask = src->GetMaskColor();
+    switch (src->GetBPP())
+    {
+    case 1: StretchRows<uint8_t>(dst, src, src_x, (uint8_t)mask); break;
+    case 2: StretchRows<uint16_t>(dst, src, src_x, (uint16_t)mask); break;
+    case 3: StretchRows24(dst, src, src_x, mask); break;
+    case 4: StretchRows<uint32_t>(dst, src, src_x, (uint32_t)mask); break;
+    }
+}
+
+} // namespace Engine
+} // namespace AGS
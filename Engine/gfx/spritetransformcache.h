@@ -0,0 +1,166 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// SpriteTransformCache keeps scaled, flipped and tinted variants of sprites,
+// so that characters and objects showing the same frame at the same scale
+// share one image instead of each of them redoing the transformation.
+//
+// The cache is bounded by the total size of stored images; the least
+// recently used ones are dropped first.
+//
+// Optionally the cache runs prefilter threads, which produce scaled and
+// flipped (but not tinted) images ahead of use. Prefilter threads never
+// call Allegro: the bitmaps are allocated by the main thread, and stretching
+// is done by a reentrant copy of Allegro's own masked stretcher, so results
+// are identical to Bitmap::StretchBlt.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__SPRITETRANSFORMCACHE_H
+#define __AGS_EE_GFX__SPRITETRANSFORMCACHE_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include "core/types.h"
+#include "gfx/bitmap.h"
+#include "util/mutex.h"
+#include "util/thread.h"
+
+// Default max size of the transform cache, in bytes
+#if defined (PSP_VERSION)
+#define DEFAULTTRANSFORMCACHESIZE 1 * 1024 * 1024
+#elif defined (ANDROID_VERSION) || defined (IOS_VERSION)
+#define DEFAULTTRANSFORMCACHESIZE 4 * 1024 * 1024
+#else
+#define DEFAULTTRANSFORMCACHESIZE 16 * 1024 * 1024
+#endif
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+
+struct SpriteTransformKey
+{
+    int  Sprite;
+    int  Width;
+    int  Height;
+    bool Flip;
+    bool AntiAlias;
+    int  TintAmount;
+    int  TintRed;
+    int  TintGreen;
+    int  TintBlue;
+    int  TintLight;
+    int  LightLevel;
+
+    SpriteTransformKey();
+    SpriteTransformKey(int sprite, int width, int height, bool flip, bool anti_alias);
+
+    // Tells if key has any tint or light level set
+    bool HasTint() const { return TintAmount != 0 || LightLevel != 0; }
+    bool operator <(const SpriteTransformKey &other) const;
+};
+
+class SpriteTransformCache
+{
+public:
+    // Max number of queued prefilter jobs; further requests are ignored
+    static const size_t MaxPrefilterJobs = 64;
+    static const int    MaxPrefilterThreads = 4;
+
+    SpriteTransformCache();
+    ~SpriteTransformCache();
+
+    // Sets max size of all cached images, in bytes; 0 disables the cache
+    void   SetMaxSize(size_t max_size);
+    size_t GetMaxSize() const { return _maxSize; }
+    bool   IsEnabled() const { return _maxSize > 0; }
+
+    // Returns cached image, or NULL if there's none; cache keeps ownership
+    Bitmap *Get(const SpriteTransformKey &key);
+    // Stores image in cache; cache takes ownership
+    void    Put(const SpriteTransformKey &key, Bitmap *image);
+    // Removes all images made of the given sprite; must be called whenever
+    // sprite's image is changed or deleted
+    void    InvalidateSprite(int sprite);
+    // Removes all images
+    void    Clear();
+
+    // Starts given number of prefilter threads
+    bool    StartPrefilter(int threads);
+    void    StopPrefilter();
+    bool    IsPrefiltering() const { return _threadCount > 0; }
+    // Queues the untinted transformation of the given sprite image; the
+    // image is copied, so caller does not have to keep it
+    void    Prefilter(const SpriteTransformKey &key, Bitmap *sprite);
+
+    // Stretches source onto the whole destination, optionally flipping it
+    // horizontally, skipping transparent source pixels; gives the same result
+    // as StretchBlt with kBitmap_Transparency (and then FlipBlt if flipped).
+    // This does not use Allegro, so may be called from any thread.
+    static void StretchAndFlip(Bitmap *dst, const Bitmap *src, bool flip);
+
+private:
+    struct CacheEntry
+    {
+        Bitmap *Image;
+        std::list<SpriteTransformKey>::iterator LruPos;
+    };
+
+    struct PrefilterJob
+    {
+        SpriteTransformKey Key;
+        Bitmap  *Source;
+        Bitmap  *Result;
+        unsigned Generation;
+    };
+
+    typedef std::map<SpriteTransformKey, CacheEntry> CacheMap;
+
+    void Remove(CacheMap::iterator it);
+    void FreeUpSpace(size_t space_needed);
+    // Moves finished prefilter results into the cache
+    void CollectPrefiltered();
+    void DeleteJobs(std::vector<PrefilterJob> &jobs);
+
+    static void PrefilterThread();
+
+    size_t   _maxSize;
+    size_t   _curSize;
+    CacheMap _cache;
+    std::list<SpriteTransformKey> _lru; // most recently used at front
+
+    // Prefilter state; job lists are shared with threads and are guarded by
+    // _jobMutex, the rest are only accessed by the main thread
+    Thread   _threads[MaxPrefilterThreads];
+    int      _threadCount;
+    Mutex    _jobMutex;
+    std::vector<PrefilterJob> _jobs;
+    std::vector<PrefilterJob> _doneJobs;
+    std::set<SpriteTransformKey> _pending;
+    unsigned _generation;
+
+    // The cache that prefilter threads work for; only one cache may be
+    // prefiltering at a time
+    static SpriteTransformCache *_prefilterCache;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__SPRITETRANSFORMCACHE_H
@@ -23,6 +23,7 @@
 #include "ac/mouse.h"
 #include "ac/record.h"
 #include "ac/runtime_defines.h"
+#include "ac/timer.h"
 #include "font/fonts.h"
 #include "gui/cscidialog.h"
 #include "gui/guidialog.h"
@@ -191,7 +192,7 @@ int WINAPI _export CSCIWaitMessage(Bitmap *ds, CSCIMessage * cscim)
             break;
 
         update_polled_audio_and_crossfade();
-        while (timerloop == 0) ;
+        wait_for_timer_tick();
     }
 
     clear_gui_screen();
@@ -19,6 +19,7 @@
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
+#include "game/savegamewriter.h"
 #include "gui/cscidialog.h"
 #include <cctype> //isdigit()
 #include "gfx/bitmap.h"
@@ -29,6 +30,7 @@ using namespace AGS::Engine;
 
 extern IGraphicsDriver *gfxDriver;
 extern GameSetup usetup;
+extern SavegameWriter savegameWriter;
 
 // from ac_game
 extern char saveGameDirectory[260];
@@ -89,6 +91,8 @@ void refresh_gui_screen()
 
     // Copy it back, because the mouse will have been drawn on top
     ds->Blit(windowBuffer, 0, 0, windowPosX, windowPosY, windowPosWidth, windowPosHeight);
+    // the screen no longer matches what was rendered there
+    invalidate_rect(windowPosX, windowPosY, windowPosX + windowPosWidth - 1, windowPosY + windowPosHeight - 1);
 }
 
 int loadgamedialog()
@@ -287,6 +291,9 @@ void preparesavegamelist(int ctrllist)
   char curdir[255];
   _getcwd(curdir, 255);
 
+  // the saves still being written must be complete before they are listed
+  savegameWriter.Wait();
+
   char searchPath[260];
   sprintf(searchPath, "%s""agssave.*%s", saveGameDirectory, saveGameSuffix.GetCStr());
 
@@ -298,15 +305,12 @@ void preparesavegamelist(int ctrllist)
       break;
     }
 
-    // only list games .000 to .099 (to allow higher slots for other purposes)
-    if (strstr(ffb.name, ".0") == NULL) {
+    int sgNumber = get_save_slot_from_file_name(ffb.name);
+    if (sgNumber < 0) {
       don = al_findnext(&ffb);
       continue;
     }
 
-    const char *numberExtension = strstr(ffb.name, ".0") + 1;
-    int sgNumber = atoi(numberExtension);
-
     String thisGamePath = get_save_game_path(sgNumber);
 
     // get description
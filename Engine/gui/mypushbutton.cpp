@@ -17,6 +17,7 @@
 #include "ac/common.h"
 #include "ac/mouse.h"
 #include "ac/record.h"
+#include "ac/timer.h"
 #include "font/fonts.h"
 #include "gui/mypushbutton.h"
 #include "gui/guidialog.h"
@@ -93,7 +94,7 @@ int MyPushButton::pressedon()
 
         refresh_gui_screen();
 
-        while (timerloop == 0) ;
+        wait_for_timer_tick();
     }
     wasstat = state;
     state = 0;
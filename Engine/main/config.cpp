@@ -22,6 +22,7 @@
 #include "ac/path_helper.h"
 #include "ac/spritecache.h"
 #include "debug/debug_log.h"
+#include "gfx/spritetransformcache.h"
 #include "main/mainheader.h"
 #include "main/config.h"
 #include "platform/base/agsplatformdriver.h"
@@ -344,10 +345,11 @@ void read_config(const ConfigTree &cfg)
         read_legacy_graphics_config(cfg, should_read_filter);
 
         // Graphics mode
-#if defined (WINDOWS_VERSION)
         usetup.Screen.DriverID = INIreadstring(cfg, "graphics", "driver");
-#else
-        usetup.Screen.DriverID = "DX5";
+#if !defined (WINDOWS_VERSION)
+        // besides the software renderer, only the null one may be chosen here
+        if (usetup.Screen.DriverID.CompareNoCase("NULL") != 0)
+            usetup.Screen.DriverID = "DX5";
 #endif
         usetup.Screen.DisplayMode.Windowed = INIreadint(cfg, "graphics", "windowed") > 0;
         const char *screen_sz_def_options[kNumScreenDef] = { "explicit", "scaling", "max" };
@@ -382,6 +384,11 @@ void read_config(const ConfigTree &cfg)
         usetup.Screen.DisplayMode.RefreshRate = INIreadint(cfg, "graphics", "refresh");
         usetup.Screen.DisplayMode.VSync = INIreadint(cfg, "graphics", "vsync") > 0;
         usetup.Screen.RenderAtScreenRes = INIreadint(cfg, "graphics", "render_at_screenres") > 0;
+        usetup.Screen.DamageTracking = INIreadint(cfg, "graphics", "damage_tracking", 1) != 0;
+        usetup.Screen.Headless.SkipRender = INIreadint(cfg, "graphics", "null_skip_render") > 0;
+        usetup.Screen.Headless.CaptureInterval = INIreadint(cfg, "graphics", "null_capture_interval", 0);
+        usetup.Screen.Headless.CaptureDir = INIreadstring(cfg, "graphics", "null_capture_dir");
+        usetup.Screen.Headless.CaptureFormat = INIreadstring(cfg, "graphics", "null_capture_format", "bmp");
 
         usetup.enable_antialiasing = INIreadint(cfg, "misc", "antialias") > 0;
         usetup.force_hicolor_mode = INIreadint(cfg, "misc", "notruecolor") > 0;
@@ -398,6 +405,16 @@ void read_config(const ConfigTree &cfg)
         // the config file specifies cache size in KB, here we convert it to bytes
         spriteset.maxCacheSize = INIreadint (cfg, "misc", "cachemax", DEFAULTCACHESIZE / 1024) * 1024;
 #endif
+        usetup.transform_cache_size = INIreadint(cfg, "misc", "transformcachemax", DEFAULTTRANSFORMCACHESIZE / 1024) * 1024;
+        usetup.sprite_prefilter_threads = INIreadint(cfg, "misc", "prefilter_threads", 0);
+        usetup.sprite_tint_threads = INIreadint(cfg, "misc", "tint_threads", 0);
+        usetup.unthrottled = INIreadint(cfg, "misc", "unthrottled") > 0;
+        usetup.unthrottled_render_interval = INIreadint(cfg, "misc", "unthrottled_render", 1);
+        usetup.replay_verify_interval = INIreadint(cfg, "misc", "replay_verify", 0);
+        usetup.compress_saves = INIreadint(cfg, "misc", "save_compress", 1) != 0;
+        usetup.save_in_background = INIreadint(cfg, "misc", "save_background", 1) != 0;
+        usetup.checkpoint_interval = INIreadint(cfg, "misc", "checkpoint_interval", 0);
+        usetup.preload_rooms = INIreadint(cfg, "misc", "room_preload", 1) != 0;
 
         String repfile = INIreadstring(cfg, "misc", "replay");
         if (repfile != NULL) {
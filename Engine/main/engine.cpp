@@ -23,6 +23,7 @@
 #include "ac/characterextras.h"
 #include "ac/characterinfo.h"
 #include "ac/draw.h"
+#include "ac/dynamicsprite.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
@@ -35,6 +36,7 @@
 #include "ac/record.h"
 #include "ac/roomstatus.h"
 #include "ac/speech.h"
+#include "ac/timer.h"
 #include "ac/translation.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/scriptobject.h"
@@ -56,6 +58,10 @@
 #include "ac/spritecache.h"
 #include "util/filestream.h"
 #include "gfx/graphicsdriver.h"
+#include "game/roompreloader.h"
+#include "game/savegamewriter.h"
+#include "gfx/spritetinter.h"
+#include "gfx/spritetransformcache.h"
 #include "core/assetmanager.h"
 #include "util/misc.h"
 #include "platform/util/pe.h"
@@ -78,6 +84,10 @@ extern char pexbuf[STD_BUFFER_SIZE];
 extern char saveGameDirectory[260];
 extern int spritewidth[MAX_SPRITES],spriteheight[MAX_SPRITES];
 extern SpriteCache spriteset;
+extern SpriteTransformCache spriteTransformCache;
+extern SpriteTinter spriteTinter;
+extern SavegameWriter savegameWriter;
+extern RoomPreloader roomPreloader;
 extern ObjectCache objcache[MAX_INIT_SPR];
 extern ScriptObject scrObj[MAX_INIT_SPR];
 extern ViewStruct*views;
@@ -87,6 +97,7 @@ extern int eip_guiobj;
 extern const char *replayTempFile;
 extern SpeechLipSyncLine *splipsync;
 extern int numLipLines, curLipLine, curLipLinePhoneme;
+extern bool speech_lipsync_pending;
 extern ScriptSystem scsystem;
 extern IGraphicsDriver *gfxDriver;
 extern Bitmap **actsps;
@@ -119,9 +130,12 @@ bool engine_init_allegro()
     Debug::Printf(kDbgMsg_Init, "Initializing allegro");
 
     our_eip = -199;
-    // Initialize allegro
+    // Initialize allegro; the null renderer does not need a system driver,
+    // so when it is requested on the command line the engine may run where
+    // there is no display at all
     set_uformat(U_ASCII);
-    if (install_allegro(SYSTEM_AUTODETECT, &myerrno, atexit))
+    const int system_id = force_gfxdriver.CompareNoCase("NULL") == 0 ? SYSTEM_NONE : SYSTEM_AUTODETECT;
+    if (install_allegro(system_id, &myerrno, atexit))
     {
         const char *al_err = get_allegro_error();
         const char *user_hint = platform->GetAllegroFailUserHint();
@@ -423,8 +437,19 @@ void engine_init_fonts()
     init_font_renderer();
 }
 
+// Tells if the game runs by the null renderer, which does not take any input
+bool engine_is_headless()
+{
+    return usetup.Screen.DriverID.CompareNoCase("NULL") == 0;
+}
+
 int engine_init_mouse()
 {
+    if (engine_is_headless())
+    {
+        Debug::Printf(kDbgMsg_Init, "Initializing mouse: skipped, no display");
+        return RETURN_CONTINUE;
+    }
     int res = minstalled();
     if (res < 0)
         Debug::Printf(kDbgMsg_Init, "Initializing mouse: failed");
@@ -470,29 +495,8 @@ int engine_init_speech()
                 platform->DisplayAlert("Unable to initialize speech sample file - check for corruption and that\nit belongs to this game.\n");
                 return EXIT_NORMAL;
             }
-            Stream *speechsync = Common::AssetManager::OpenAsset("syncdata.dat");
-            if (speechsync != NULL) {
-                // this game has voice lip sync
-                if (speechsync->ReadInt32() != 4)
-                { 
-                    // Don't display this warning.
-                    // platform->DisplayAlert("Unknown speech lip sync format (might be from older or newer version); lip sync disabled");
-                }
-                else {
-                    numLipLines = speechsync->ReadInt32();
-                    splipsync = (SpeechLipSyncLine*)malloc (sizeof(SpeechLipSyncLine) * numLipLines);
-                    for (int ee = 0; ee < numLipLines; ee++)
-                    {
-                        splipsync[ee].numPhonemes = speechsync->ReadInt16();
-                        speechsync->Read(splipsync[ee].filename, 14);
-                        splipsync[ee].endtimeoffs = (int*)malloc(splipsync[ee].numPhonemes * sizeof(int));
-                        speechsync->ReadArrayOfInt32(splipsync[ee].endtimeoffs, splipsync[ee].numPhonemes);
-                        splipsync[ee].frame = (short*)malloc(splipsync[ee].numPhonemes * sizeof(short));
-                        speechsync->ReadArrayOfInt16(splipsync[ee].frame, splipsync[ee].numPhonemes);
-                    }
-                }
-                delete speechsync;
-            }
+            // The lip sync data is only read when the first speech is played
+            speech_lipsync_pending = true;
             Common::AssetManager::SetDataFile(game_file_name);
             Debug::Printf(kDbgMsg_Init, "Speech sample file found and initialized.");
             play.want_speech=1;
@@ -527,6 +531,11 @@ int engine_init_music()
 void engine_init_keyboard()
 {
 #ifdef ALLEGRO_KEYBOARD_HANDLER
+    if (engine_is_headless())
+    {
+        Debug::Printf(kDbgMsg_Init, "Initializing keyboard: skipped, no display");
+        return;
+    }
     Debug::Printf(kDbgMsg_Init, "Initializing keyboard");
 
     install_keyboard();
@@ -537,6 +546,12 @@ void engine_init_timer()
 {
     Debug::Printf(kDbgMsg_Init, "Install timer");
     install_timer();
+    if (usetup.unthrottled)
+    {
+        Debug::Printf(kDbgMsg_Init, "Game ticks are not limited by the timer; drawing every %d tick(s)",
+            usetup.unthrottled_render_interval);
+        set_timer_unthrottled(true);
+    }
 }
 
 typedef char AlIDStr[5];
@@ -936,6 +951,9 @@ int engine_init_sprites()
 {
     Debug::Printf(kDbgMsg_Init, "Initialize sprites");
 
+    // restored dynamic sprites are only made when they are used
+    spriteset.deferredLoader = load_deferred_dynamic_sprite;
+
     if (spriteset.initFile ("acsprset.spr")) 
     {
         platform->FinishedUsingGraphicsMode();
@@ -947,6 +965,16 @@ int engine_init_sprites()
         return EXIT_NORMAL;
     }
 
+    spriteTransformCache.SetMaxSize(usetup.transform_cache_size);
+    if (usetup.sprite_prefilter_threads > 0)
+        spriteTransformCache.StartPrefilter(usetup.sprite_prefilter_threads);
+    if (usetup.sprite_tint_threads > 0)
+        spriteTinter.StartThreads(usetup.sprite_tint_threads);
+    if (usetup.save_in_background)
+        savegameWriter.StartThread();
+    if (usetup.preload_rooms)
+        roomPreloader.StartThread();
+
     return RETURN_CONTINUE;
 }
 
@@ -1326,6 +1354,10 @@ bool engine_read_config(const String &exe_path, ConfigTree &cfg)
         INIwriteint(cfg, "misc", "log", 0);
     else if (enable_log_file)
         INIwriteint(cfg, "misc", "log", 1);
+    if (!force_gfxdriver.IsEmpty())
+        INIwritestring(cfg, "graphics", "driver", force_gfxdriver);
+    if (force_unthrottled)
+        INIwriteint(cfg, "misc", "unthrottled", 1);
 
     // Parse and set up game config
     read_config(cfg);
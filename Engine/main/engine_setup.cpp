@@ -203,6 +203,7 @@ void engine_post_gfxmode_driver_setup()
     gfxDriver->SetCallbackToDrawScreen(draw_screen_callback);
     gfxDriver->SetCallbackForNullSprite(GfxDriverNullSpriteCallback);
     gfxDriver->SetRenderOffset(play.viewport.Left, play.viewport.Top);
+    gfxDriver->EnableDamageTracking(usetup.Screen.DamageTracking);
 }
 
 // Reset gfx driver callbacks
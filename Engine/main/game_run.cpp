@@ -30,6 +30,7 @@
 #include "ac/global_gui.h"
 #include "ac/global_region.h"
 #include "ac/gui.h"
+#include "ac/hittestindex.h"
 #include "ac/hotspot.h"
 #include "ac/keycode.h"
 #include "ac/mouse.h"
@@ -39,8 +40,11 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/roomstruct.h"
+#include "ac/timer.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/out.h"
+#include "game/savegamewriter.h"
 #include "gui/guiinv.h"
 #include "gui/guimain.h"
 #include "gui/guitextbox.h"
@@ -86,6 +90,8 @@ extern int offsetx, offsety;
 extern unsigned int loopcounter,lastcounter;
 extern volatile int timerloop;
 extern int cur_mode,cur_cursor;
+extern int frames_per_second;
+extern AGS::Engine::SavegameWriter savegameWriter;
 
 // Checks if user interface should remain disabled for now
 int ShouldStayInWaitMode();
@@ -523,6 +529,10 @@ void game_loop_do_render_and_check_mouse(IDriverDependantBitmap *extraBitmap, in
 {
     if (!play.fast_forward) {
         int mwasatx=mousex,mwasaty=mousey;
+        // nothing moves until the mouse check is done, so the hit tests
+        // made by the overhotspot labels, cursor and the check may share
+        // the index
+        begin_hit_test_scope();
 
         // Only do this if we are not skipping a cutscene
         render_graphics(extraBitmap, extraX, extraY);
@@ -544,6 +554,7 @@ void game_loop_do_render_and_check_mouse(IDriverDependantBitmap *extraBitmap, in
 
         offsetxWas = offsetx;
         offsetyWas = offsety;
+        end_hit_test_scope();
 
 #ifdef MAC_VERSION
         // take a breather after the heavy work
@@ -607,6 +618,37 @@ void game_loop_check_replay_record()
         replay_start_this_time = 0;
         start_replay_record();
     }
+    rec_verify_state();
+}
+
+// Game loop at which the last checkpoint was saved
+unsigned int checkpoint_loop = 0;
+
+void game_loop_check_checkpoint()
+{
+    if (usetup.checkpoint_interval <= 0)
+        return;
+    // the state of blocked scripts can not be saved
+    if (inside_script || displayed_room < 0 || in_new_room > 0)
+        return;
+    if (loopcounter - checkpoint_loop < (unsigned)(usetup.checkpoint_interval * frames_per_second))
+        return;
+    checkpoint_loop = loopcounter;
+    save_game_checkpoint();
+}
+
+// Tells the player about the saves which failed to be written in the background
+void game_loop_check_failed_saves()
+{
+    if (inside_script)
+        return;
+    for (String filename = savegameWriter.GetFailedSave(); !filename.IsEmpty();
+         filename = savegameWriter.GetFailedSave())
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to write savegame %s", filename.GetCStr());
+        Display("ERROR: Unable to save the game to %s. Check that there is enough disk space free and try again.",
+            filename.GetCStr());
+    }
 }
 
 void game_loop_update_fps()
@@ -620,6 +662,12 @@ void game_loop_update_fps()
 
 void PollUntilNextFrame()
 {
+    if (is_timer_unthrottled())
+    {
+        // don't wait, but let the game time go on as if we did
+        tick_virtual_clock();
+        return;
+    }
     // make sure we poll, cos a low framerate (eg 5 fps) could stutter
     // mp3 music
     while (timerloop == 0 && play.fast_forward == 0) {
@@ -698,6 +746,10 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_check_replay_record();
 
+    game_loop_check_checkpoint();
+
+    game_loop_check_failed_saves();
+
     // Immediately start the next frame if we are skipping a cutscene
     if (play.fast_forward)
         return;
@@ -21,7 +21,9 @@
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/ali3dnull.h"
 #include "gfx/bitmap.h"
+#include "gfx/blender_simd.h"
 #include "gfx/gfxdriverfactory.h"
 #include "gfx/gfxfilter.h"
 #include "gfx/graphicsdriver.h"
@@ -70,8 +72,15 @@ DisplayModeSetup::DisplayModeSetup()
 {
 }
 
+HeadlessSetup::HeadlessSetup()
+    : SkipRender(false)
+    , CaptureInterval(0)
+{
+}
+
 ScreenSetup::ScreenSetup()
     : RenderAtScreenRes(false)
+    , DamageTracking(true)
 {
 }
 
@@ -107,6 +116,8 @@ bool create_gfx_driver(const String &gfx_driver_id)
         return false;
     }
     Debug::Printf("Created graphics driver: %s", gfxDriver->GetDriverName());
+    RowBlend::Init();
+    Debug::Printf("Software blending kernels: %s", RowBlend::GetImplName());
     return true;
 }
 
@@ -454,6 +465,35 @@ void display_gfx_mode_error(const Size game_size, const GfxFilterSetup &setup, c
             main_error.GetCStr(), get_allegro_error(), platform->GetGraphicsTroubleshootingText());
 }
 
+// Creates the null renderer, and sets the display mode of exactly the native game size
+bool init_headless_mode(const Size &game_size, const ScreenSetup &setup, const ColorDepthOption &color_depths)
+{
+    if (!graphics_mode_create_renderer(setup.DriverID))
+        return false;
+    const HeadlessSetup &headless = setup.Headless;
+    // the factory of this id only creates the null driver
+    Null::NullGraphicsDriver *null_driver = static_cast<Null::NullGraphicsDriver*>(gfxDriver);
+    null_driver->SetRenderOptions(headless.SkipRender, headless.CaptureInterval, headless.CaptureDir,
+        headless.CaptureFormat.CompareNoCase("raw") == 0 ? Null::kNullFrame_Raw : Null::kNullFrame_Bmp);
+
+    DisplayMode dm(GraphicResolution(game_size.Width, game_size.Height, color_depths.Prime), true, 0, false);
+    if (!graphics_mode_set_dm(dm))
+    {
+        dm.ColorDepth = color_depths.Alternate;
+        if (!graphics_mode_set_dm(dm))
+            return false;
+    }
+
+    GameFrameSetup frame_setup; // x1 scaling by default
+    if (!graphics_mode_set_native_size(game_size) || !graphics_mode_set_render_frame(frame_setup))
+        return false;
+
+    GfxFilterSetup filter_setup;
+    filter_setup.ID = GfxFactory->GetDefaultFilterID();
+    filter_setup.UserRequest = filter_setup.ID;
+    return graphics_mode_set_filter_any(filter_setup);
+}
+
 bool graphics_mode_init_any(const Size game_size, const ScreenSetup &setup, const ColorDepthOption &color_depths)
 {
     // Log out display information
@@ -471,6 +511,16 @@ bool graphics_mode_init_any(const Size game_size, const ScreenSetup &setup, cons
         setup.DisplayMode.Size.Width, setup.DisplayMode.Size.Height,
         ignore_device_ratio ? "ignore" : (setup.DisplayMode.MatchDeviceRatio ? "yes" : "no"), scale_option.GetCStr());
 
+    // Null renderer is only used on request, and does not depend on the display
+    if (setup.DriverID.CompareNoCase("NULL") == 0)
+    {
+        if (init_headless_mode(game_size, setup, color_depths))
+            return true;
+        graphics_mode_shutdown();
+        display_gfx_mode_error(game_size, setup.Filter, color_depths.Prime);
+        return false;
+    }
+
     // Prepare the list of available gfx factories, having the one requested by user at first place
     StringV ids;
     GetGfxDriverFactoryNames(ids);
@@ -87,6 +87,17 @@ struct DisplayModeSetup
     DisplayModeSetup();
 };
 
+// Headless (null) renderer configuration
+struct HeadlessSetup
+{
+    bool                 SkipRender;      // don't prepare nor draw the frames at all
+    int                  CaptureInterval; // save every Nth frame, 0 to save none
+    String               CaptureDir;      // directory to save frames to
+    String               CaptureFormat;   // frame file format: "bmp" or "raw"
+
+    HeadlessSetup();
+};
+
 // General display configuration
 struct ScreenSetup
 {
@@ -97,6 +108,8 @@ struct ScreenSetup
     GameFrameSetup       GameFrame;     // definition of the game frame's position on screen
 
     bool                 RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
+    bool                 DamageTracking; // only redraw and present changed parts of the screen (software renderer)
+    HeadlessSetup        Headless;      // options of the null renderer
 
     ScreenSetup();
 };
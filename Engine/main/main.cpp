@@ -82,6 +82,8 @@ extern char editor_debugger_instance_token[100];
 
 // Startup flags, set from parameters to engine
 int datafile_argv=0, change_to_game_dir = 0, force_window = 0;
+String force_gfxdriver;
+bool force_unthrottled = false;
 int override_start_room = 0, force_16bit = 0;
 bool justDisplayHelp = false;
 bool justDisplayVersion = false;
@@ -189,10 +191,14 @@ void main_print_help() {
            "  --windowed                   Force display mode to windowed\n"
            "  --fullscreen                 Force display mode to fullscreen\n"
            "  --hicolor                    Downmix 32bit colors to 16bit\n"
+           "  --gfxdriver <id>             Request graphics driver; \"null\" runs the game\n"
+           "                                 without a display\n"
            "  --gfxfilter <filter> [<scaling>]\n"
            "                               Request graphics filter. Available options:\n"
            "                                 none, stdscale, hqx;\n"
            "                                 scaling is specified by integer number\n"
+           "  --unthrottled                Run the game as fast as possible, keeping\n"
+           "                                 the game time counted by game ticks\n"
            "  --log                        Enable program output to the log file\n"
            "  --no-log                     Disable program output to the log file,\n"
            "                                 overriding configuration file setting\n"
@@ -225,6 +231,10 @@ int main_process_cmdline(int argc,char*argv[])
             force_window = 2;
         else if (stricmp(argv[ee],"-hicolor") == 0 || stricmp(argv[ee],"--hicolor") == 0)
             force_16bit = 1;
+        else if (stricmp(argv[ee],"--gfxdriver") == 0 && (argc > ee + 1))
+            force_gfxdriver = argv[++ee];
+        else if (stricmp(argv[ee],"--unthrottled") == 0)
+            force_unthrottled = true;
         else if (stricmp(argv[ee],"-record") == 0)
             play.recording = 1;
         else if (stricmp(argv[ee],"-playback") == 0)
@@ -47,6 +47,8 @@ AGS::Common::String GetPathFromCmdArg(int arg_index);
 
 // Startup flags, set from parameters to engine
 extern int datafile_argv, change_to_game_dir, force_window;
+extern AGS::Common::String force_gfxdriver;
+extern bool force_unthrottled;
 extern int override_start_room, force_16bit;
 extern bool justRegisterGame;
 extern bool justUnRegisterGame;
@@ -35,6 +35,10 @@
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
+#include "game/roompreloader.h"
+#include "game/savegamewriter.h"
+#include "gfx/spritetinter.h"
+#include "gfx/spritetransformcache.h"
 #include "core/assetmanager.h"
 #include "plugin/agsplugin.h"
 
@@ -55,6 +59,10 @@ extern IAGSEditorDebugger *editor_debugger;
 extern int need_to_stop_cd;
 extern int use_cdplayer;
 extern IGraphicsDriver *gfxDriver;
+extern SpriteTransformCache spriteTransformCache;
+extern SpriteTinter spriteTinter;
+extern SavegameWriter savegameWriter;
+extern RoomPreloader roomPreloader;
 
 bool handledErrorInEditor;
 
@@ -267,6 +275,10 @@ void quit(const char *quitmsg)
 
     stop_recording();
 
+    // finish writing the saves before anything is shut down
+    savegameWriter.StopThread();
+    roomPreloader.StopThread();
+
     quit_stop_cd();
 
     our_eip = 9020;
@@ -278,6 +290,10 @@ void quit(const char *quitmsg)
     our_eip = 9019;
 
     quit_shutdown_audio();
+
+    spriteTransformCache.StopPrefilter();
+    spriteTinter.StopThreads();
+    spriteTransformCache.Clear();
     
     our_eip = 9901;
 
@@ -28,6 +28,7 @@
 #include "ac/global_audio.h"
 #include "ac/global_plugin.h"
 #include "ac/global_walkablearea.h"
+#include "ac/hittestindex.h"
 #include "ac/keycode.h"
 #include "ac/mouse.h"
 #include "ac/movelist.h"
@@ -37,6 +38,7 @@
 #include "ac/record.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
+#include "ac/walkablearea.h"
 #include "font/fonts.h"
 #include "util/string_utils.h"
 #include "debug/debug_log.h"
@@ -417,7 +419,11 @@ BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
+    {
+        // plugin may change the mask
+        invalidate_walkable_areas_temp();
         return (BITMAP*)thisroom.walls->GetAllegroBitmap();
+    }
     else if (index == MASK_WALKBEHIND)
         return (BITMAP*)thisroom.object->GetAllegroBitmap();
     else if (index == MASK_HOTSPOT)
@@ -615,6 +621,7 @@ int IAGSEngine::CallGameScriptFunction(const char *name, int32 globalScript, int
 
 void IAGSEngine::NotifySpriteUpdated(int32 slot) {
     int ff;
+    invalidate_sprite_transforms(slot);
     // wipe the character cache when we change rooms
     for (ff = 0; ff < game.numcharacters; ff++) {
         if ((charcache[ff].inUse) && (charcache[ff].sppic == slot)) {
@@ -796,6 +803,8 @@ void pl_startup_plugins() {
 
 int pl_run_plugin_hooks (int event, long data) {
     int i, retval = 0;
+    // plugins may change anything, e.g. move characters
+    invalidate_hit_test_index();
     for (i = 0; i < numPlugins; i++) {
         if (plugins[i].wantHook & event) {
             retval = plugins[i].onEvent (event, data);
@@ -806,6 +815,16 @@ int pl_run_plugin_hooks (int event, long data) {
     return 0;
 }
 
+bool pl_any_want_hook(int event)
+{
+    for (int i = 0; i < numPlugins; i++)
+    {
+        if (plugins[i].wantHook & event)
+            return true;
+    }
+    return false;
+}
+
 int pl_run_plugin_debug_hooks (const char *scriptfile, int linenum) {
     int i, retval = 0;
     for (i = 0; i < numPlugins; i++) {
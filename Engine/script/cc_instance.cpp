@@ -14,6 +14,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <map>
+#include <set>
 #include "ac/common.h"
 #include "ac/event.h"
 #include "ac/mouse.h"
@@ -52,6 +54,12 @@ extern new_line_hook_type new_line_hook;
 
 extern ScriptString myScriptStringImpl;
 
+// Layouts of the loaded scripts; the weak reference tells whether the script
+// is still alive, since its address may be reused by another script later
+typedef std::pair<stdtr1compat::weak_ptr<ccScript>, PScriptLayout> ScriptLayoutRef;
+typedef std::map<const ccScript*, ScriptLayoutRef> ScriptLayoutCache;
+static ScriptLayoutCache ScriptLayouts;
+
 enum ScriptOpArgIsReg
 {
     kScOpNoArgIsReg     = 0,
@@ -1658,19 +1666,25 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     if (joined)
     {
         resolved_imports = joined->resolved_imports;
+        layout = joined->layout;
         code_fixups = joined->code_fixups;
     }
     else
     {
+        layout = GetScriptLayout(scri);
+        if (!layout)
+        {
+            return false;
+        }
         if (!ResolveScriptImports(scri))
         {
             return false;
         }
-        if (!CreateGlobalVars(scri))
+        if (!CreateGlobalVars(*layout))
         {
             return false;
         }
-        if (!CreateRuntimeCodeFixups(scri))
+        if (!CreateRuntimeCodeFixups(*layout))
         {
             return false;
         }
@@ -1759,9 +1773,9 @@ void ccInstance::Free()
     if ((flags & INSTF_SHAREDATA) == 0)
     {
         delete [] resolved_imports;
-        delete [] code_fixups;
     }
     resolved_imports = NULL;
+    layout.reset();
     code_fixups = NULL;
 }
 
@@ -1800,13 +1814,40 @@ bool ccInstance::ResolveScriptImports(PScript scri)
     return true;
 }
 
+PScriptLayout ccInstance::GetScriptLayout(PScript scri)
+{
+    ScriptLayoutCache::iterator it = ScriptLayouts.find(scri.get());
+    if (it != ScriptLayouts.end() && !it->second.first.expired())
+    {
+        return it->second.second;
+    }
+
+    // forget the layouts of the scripts which were freed since
+    for (it = ScriptLayouts.begin(); it != ScriptLayouts.end();)
+    {
+        if (it->second.first.expired())
+            ScriptLayouts.erase(it++);
+        else
+            ++it;
+    }
+
+    PScriptLayout script_layout = CreateScriptLayout(scri);
+    if (script_layout)
+    {
+        ScriptLayouts[scri.get()] = ScriptLayoutRef(scri, script_layout);
+    }
+    return script_layout;
+}
+
 // TODO: it is possible to deduce global var's size at start with
 // certain accuracy after all global vars are registered. Each
 // global var's size would be limited by closest next var's ScAddress
 // and globaldatasize.
-bool ccInstance::CreateGlobalVars(PScript scri)
+PScriptLayout ccInstance::CreateScriptLayout(PScript scri)
 {
-    ScriptVariable glvar;
+    PScriptLayout script_layout(new ScriptLayout());
+    std::set<int32_t> known_vars;
+    ScriptLayout::GlobalVar glvar;
 
     // Step One: deduce global variables from fixups
     for (int i = 0; i < scri->numfixups; ++i)
@@ -1816,23 +1857,23 @@ bool ccInstance::CreateGlobalVars(PScript scri)
         case FIXUP_GLOBALDATA:
             // GLOBALDATA fixup takes relative address of global data element from code array;
             // this is the address of actual data
-            glvar.ScAddress = (int32_t)code[scri->fixups[i]];
-            glvar.RValue.SetData(globaldata + glvar.ScAddress, 0);
+            glvar.ScAddress = (int32_t)scri->code[scri->fixups[i]];
+            glvar.StringAddress = -1;
             break;
         case FIXUP_DATADATA:
             {
             // DATADATA fixup takes relative address of global data element from fixups array;
             // this is the address of element, which stores address of actual data
             glvar.ScAddress = scri->fixups[i];
-            int32_t data_addr = BBOp::Int32FromLE(*(int32_t*)&globaldata[glvar.ScAddress]);
+            int32_t data_addr = BBOp::Int32FromLE(*(int32_t*)&scri->globaldata[glvar.ScAddress]);
             if (glvar.ScAddress - data_addr != 200 /* size of old AGS string */)
             {
                 // CHECKME: probably replace with mere warning in the log?
                 cc_error("unexpected old-style string's alignment");
-                return false;
+                return PScriptLayout();
             }
             // TODO: register this explicitly as a string instead (can do this later)
-            glvar.RValue.SetStaticObject(globaldata + data_addr, &GlobalStaticManager);
+            glvar.StringAddress = data_addr;
             }
             break;
         default:
@@ -1840,7 +1881,9 @@ bool ccInstance::CreateGlobalVars(PScript scri)
             continue;
         }
 
-        AddGlobalVar(glvar);
+        // the first variable registered at the address is the one kept
+        if (known_vars.insert(glvar.ScAddress).second)
+            script_layout->GlobalVars.push_back(glvar);
     }
 
     // Step Two: deduce global variables from exports
@@ -1853,11 +1896,55 @@ bool ccInstance::CreateGlobalVars(PScript scri)
             // NOTE: old-style strings could not be exported in AGS,
             // no need to worry about these here
             glvar.ScAddress = eaddr;
-            glvar.RValue.SetData(globaldata + glvar.ScAddress, 0);
-            AddGlobalVar(glvar);
+            glvar.StringAddress = -1;
+            if (known_vars.insert(glvar.ScAddress).second)
+                script_layout->GlobalVars.push_back(glvar);
+        }
+    }
+
+    // Step Three: mark the code which refers to data, imports and so on
+    script_layout->CodeFixups.resize(scri->codesize, 0);
+    for (int i = 0; i < scri->numfixups; ++i)
+    {
+        if (scri->fixuptypes[i] == FIXUP_DATADATA)
+        {
+            continue;
+        }
+
+        int32_t fixup = scri->fixups[i];
+        script_layout->CodeFixups[fixup] = scri->fixuptypes[i];
+
+        switch (scri->fixuptypes[i])
+        {
+        case FIXUP_GLOBALDATA:
+        case FIXUP_IMPORT:
+            script_layout->RuntimeFixups.push_back(fixup);
+            break;
+        case FIXUP_FUNCTION:
+        case FIXUP_STRING:
+        case FIXUP_STACK:
+            break; // do nothing yet
+        default:
+            cc_error("internal fixup index error: %d", scri->fixuptypes[i]);
+            return PScriptLayout();
         }
     }
+    return script_layout;
+}
 
+bool ccInstance::CreateGlobalVars(const ScriptLayout &script_layout)
+{
+    ScriptVariable glvar;
+    for (size_t i = 0; i < script_layout.GlobalVars.size(); ++i)
+    {
+        const ScriptLayout::GlobalVar &layout_var = script_layout.GlobalVars[i];
+        glvar.ScAddress = layout_var.ScAddress;
+        if (layout_var.StringAddress < 0)
+            glvar.RValue.SetData(globaldata + glvar.ScAddress, 0);
+        else
+            glvar.RValue.SetStaticObject(globaldata + layout_var.StringAddress, &GlobalStaticManager);
+        AddGlobalVar(glvar);
+    }
     return true;
 }
 
@@ -1894,21 +1981,13 @@ ScriptVariable *ccInstance::FindGlobalVar(int32_t var_addr)
     return it != globalvars->end() ? &it->second : NULL;
 }
 
-bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
+bool ccInstance::CreateRuntimeCodeFixups(const ScriptLayout &script_layout)
 {
-    code_fixups = new char[scri->codesize];
-    memset(code_fixups, 0, scri->codesize);
-    for (int i = 0; i < scri->numfixups; ++i)
+    code_fixups = script_layout.CodeFixups.empty() ? NULL : &script_layout.CodeFixups[0];
+    for (size_t i = 0; i < script_layout.RuntimeFixups.size(); ++i)
     {
-        if (scri->fixuptypes[i] == FIXUP_DATADATA)
-        {
-            continue;
-        }
-
-        int32_t fixup = scri->fixups[i];
-        code_fixups[fixup] = scri->fixuptypes[i];
-
-        switch (scri->fixuptypes[i])
+        int32_t fixup = script_layout.RuntimeFixups[i];
+        switch (code_fixups[fixup])
         {
         case FIXUP_GLOBALDATA:
             {
@@ -1921,10 +2000,6 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
                 code[fixup] = (intptr_t)gl_var;
             }
             break;
-        case FIXUP_FUNCTION:
-        case FIXUP_STRING:
-        case FIXUP_STACK:
-            break; // do nothing yet
         case FIXUP_IMPORT:
             // we do not need to save import's address now when we have
             // resolved imports kept so far as instance exists, but we
@@ -1946,9 +2021,6 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
                 }
             }
             break;
-        default:
-            cc_error("internal fixup index error: %d", scri->fixuptypes[i]);
-            return false;
         }
     }
     return true;
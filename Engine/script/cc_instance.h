@@ -22,6 +22,7 @@
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
 #include TR1INCLUDE(unordered_map)
+#include <vector>
 
 #include "script/script_common.h"
 #include "script/cc_script.h"  // ccScript
@@ -84,6 +85,25 @@ struct ScriptVariable
     RuntimeScriptValue  RValue;
 };
 
+// Parts of the instance setup which depend only on the script; these are
+// prepared once and shared by all the instances created from that script
+struct ScriptLayout
+{
+    struct GlobalVar
+    {
+        int32_t ScAddress;      // relative data address, as in ScriptVariable
+        int32_t StringAddress;  // address of the old-style string data, or -1
+    };
+
+    std::vector<GlobalVar>  GlobalVars;
+    // fixup type for each code element, or 0 if it has none
+    std::vector<char>       CodeFixups;
+    // code elements which have to be rewritten in every instance
+    std::vector<int32_t>    RuntimeFixups;
+};
+
+typedef stdtr1compat::shared_ptr<ScriptLayout> PScriptLayout;
+
 struct FunctionCallStack;
 
 struct ScriptPosition
@@ -145,7 +165,8 @@ public:
     int  *resolved_imports;
     int  numimports;
 
-    char *code_fixups;
+    PScriptLayout layout;
+    const char *code_fixups;  // points into the layout
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -185,11 +206,15 @@ protected:
     // free the memory associated with the instance
     void    Free();
 
+    // returns the layout of the script, making it on first request
+    static PScriptLayout GetScriptLayout(PScript scri);
+    static PScriptLayout CreateScriptLayout(PScript scri);
+
     bool    ResolveScriptImports(PScript scri);
-    bool    CreateGlobalVars(PScript scri);
+    bool    CreateGlobalVars(const ScriptLayout &script_layout);
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
-    bool    CreateRuntimeCodeFixups(PScript scri);
+    bool    CreateRuntimeCodeFixups(const ScriptLayout &script_layout);
 	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
 
     // Runtime fixups
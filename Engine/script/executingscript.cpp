@@ -28,6 +28,7 @@ int ExecutingScript::queue_action(PostScriptAction act, int data, const char *an
     case ePSANewRoom:
     case ePSARestoreGame:
     case ePSARestoreGameDialog:
+    case ePSAQuickRestore:
     case ePSARunAGSGame:
     case ePSARestartGame:
         quitprintf("!%s: Cannot run this command, since there was a %s command already queued to run in \"%s\", line %d",
@@ -29,7 +29,9 @@ enum PostScriptAction {
     ePSARunDialog,
     ePSARestartGame,
     ePSASaveGame,
-    ePSASaveGameDialog
+    ePSASaveGameDialog,
+    ePSAQuickSave,
+    ePSAQuickRestore
 };
 
 #define MAX_QUEUED_SCRIPTS 4
@@ -16,6 +16,13 @@
 //
 //=============================================================================
 
+#include "script/systemimports.h"
+
+// Roughly the number of the symbols registered below, for the script and
+// for the plugins, so that the import tables are made large enough at once
+const int ScriptAPISymbolCount = 1200;
+const int PluginAPISymbolCount = 1000;
+
 extern void RegisterAudioChannelAPI();
 extern void RegisterAudioClipAPI();
 extern void RegisterButtonAPI();
@@ -53,6 +60,9 @@ extern void RegisterStaticObjects();
 
 void setup_script_exports()
 {
+    simp.reserve(ScriptAPISymbolCount);
+    simp_for_plugin.reserve(PluginAPISymbolCount);
+
     RegisterAudioChannelAPI();
     RegisterAudioClipAPI();
     RegisterButtonAPI();
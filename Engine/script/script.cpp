@@ -383,6 +383,13 @@ void post_script_cleanup() {
     case ePSASaveGameDialog:
         save_game_dialog();
         break;
+    case ePSAQuickSave:
+        quick_save_game(thisData);
+        break;
+    case ePSAQuickRestore:
+        cancel_all_scripts();
+        quick_restore_game(thisData);
+        return;
     default:
         quitprintf("undefined post script action found: %d", copyof.postScriptActions[ii]);
         }
@@ -23,6 +23,14 @@ extern void quit(const char *);
 SystemImports simp;
 SystemImports simp_for_plugin;
 
+void SystemImports::reserve(int count)
+{
+    const int total = imports.size() + count;
+    imports.reserve(total);
+    nameIndex.reserve(total);
+    mangledIndex.reserve(total);
+}
+
 int SystemImports::add(const String &name, const RuntimeScriptValue &value, ccInstance *anotherscr)
 {
     int ixof;
@@ -36,33 +44,74 @@ int SystemImports::add(const String &name, const RuntimeScriptValue &value, ccIn
         return 0;
     }
 
-    ixof = imports.size();
-    for (size_t i = 0; i < imports.size(); ++i)
+    if (!freeSlots.empty())
     {
-        if (imports[i].Name == NULL)
-        {
-            ixof = i;
-            break;
-        }
+        ixof = freeSlots.top();
+        freeSlots.pop();
+    }
+    else
+    {
+        ixof = imports.size();
+        imports.push_back(ScriptImport());
     }
 
     btree[name] = ixof;
-    if (ixof == imports.size())
-        imports.push_back(ScriptImport());
+    nameIndex.addEntry(name.GetCStr(), ixof);
     imports[ixof].Name          = name; // TODO: rather make a string copy here for safety reasons
     imports[ixof].Value         = value;
     imports[ixof].InstancePtr   = anotherscr;
+    add_mangled(name, ixof);
     return 0;
 }
 
+// Makes the import found by each part of its name that ends before a '$',
+// unless there is an import with the same prefix which comes before it
+void SystemImports::add_mangled(const String &name, int index)
+{
+    for (int c = name.FindChar('$'); c >= 0; c = name.FindChar('$', c + 1))
+    {
+        String prefix = name.Left(c);
+        int current = mangledIndex.findValue(prefix.GetCStr());
+        if (current < 0 || name.Compare(imports[current].Name) < 0)
+            mangledIndex.addEntry(prefix.GetCStr(), index);
+    }
+}
+
+// Passes the prefixes of the removed import on to the next import that
+// has them; must be called after the name is gone from btree
+void SystemImports::remove_mangled(const String &name, int index)
+{
+    for (int c = name.FindChar('$'); c >= 0; c = name.FindChar('$', c + 1))
+    {
+        String prefix = name.Left(c);
+        if (mangledIndex.findValue(prefix.GetCStr()) != index)
+            continue;
+        String mangled_name = name.Left(c + 1);
+        IndexMap::const_iterator it = btree.lower_bound(mangled_name);
+        if (it != btree.end() && it->first.CompareLeft(mangled_name) == 0)
+            mangledIndex.addEntry(prefix.GetCStr(), it->second);
+        else
+            mangledIndex.addEntry(prefix.GetCStr(), -1);
+    }
+}
+
+void SystemImports::remove_at(int index)
+{
+    String name = imports[index].Name;
+    btree.erase(name);
+    nameIndex.addEntry(name.GetCStr(), -1);
+    remove_mangled(name, index);
+    imports[index].Name = NULL;
+    imports[index].Value.Invalidate();
+    imports[index].InstancePtr = NULL;
+    freeSlots.push(index);
+}
+
 void SystemImports::remove(const String &name) {
     int idx = get_index_of(name);
     if (idx < 0)
         return;
-    btree.erase(imports[idx].Name);
-    imports[idx].Name = NULL;
-    imports[idx].Value.Invalidate();
-    imports[idx].InstancePtr = NULL;
+    remove_at(idx);
 }
 
 const ScriptImport *SystemImports::getByName(const String &name)
@@ -84,16 +133,15 @@ const ScriptImport *SystemImports::getByIndex(int index)
 
 int SystemImports::get_index_of(const String &name)
 {
-    IndexMap::const_iterator it = btree.find(name);
-    if (it != btree.end())
-        return it->second;
+    int index = nameIndex.findValue(name.GetCStr());
+    if (index >= 0)
+        return index;
 
     // CHECKME: what are "mangled names" and where do they come from?
-    String mangled_name = String::FromFormat("%s$", name.GetCStr());
     // if it's a function with a mangled name, allow it
-    it = btree.lower_bound(mangled_name);
-    if (it != btree.end() && it->first.CompareLeft(mangled_name) == 0)
-        return it->second;
+    index = mangledIndex.findValue(name.GetCStr());
+    if (index >= 0)
+        return index;
 
     if (name.GetLength() > 3)
     {
@@ -121,17 +169,15 @@ void SystemImports::RemoveScriptExports(ccInstance *inst)
             continue;
 
         if (imports[i].InstancePtr == inst)
-        {
-            btree.erase(imports[i].Name);
-            imports[i].Name = NULL;
-            imports[i].Value.Invalidate();
-            imports[i].InstancePtr = 0;
-        }
+            remove_at(i);
     }
 }
 
 void SystemImports::clear()
 {
     btree.clear();
+    nameIndex.clear();
+    mangledIndex.clear();
+    freeSlots = SlotQueue();
     imports.clear();
 }
@@ -15,8 +15,11 @@
 #ifndef __CC_SYSTEMIMPORTS_H
 #define __CC_SYSTEMIMPORTS_H
 
+#include <functional>
 #include <map>
+#include <queue>
 #include "script/cc_instance.h"    // ccInstance
+#include "script/cc_treemap.h"
 
 struct ICCDynamicObject;
 struct ICCStaticObject;
@@ -38,14 +41,25 @@ struct ScriptImport
 struct SystemImports
 {
 private:
-    // Note we can't use a hash-map here, because we sometimes need to search
-    // by partial keys.
+    // The names are found in the hash tables; the ordered map is only used
+    // to find the next name with the same prefix when one is removed.
     typedef std::map<String, int> IndexMap;
+    typedef std::priority_queue<int, std::vector<int>, std::greater<int> > SlotQueue;
 
     std::vector<ScriptImport> imports;
+    SlotQueue freeSlots;        // unused entries of imports, lowest first
     IndexMap btree;
+    ccTreeMap nameIndex;        // full name to import, -1 if removed
+    ccTreeMap mangledIndex;     // part of a name before '$' to the first
+                                // import in btree order with that prefix
+
+    void add_mangled(const String &name, int index);
+    void remove_mangled(const String &name, int index);
+    void remove_at(int index);
 
 public:
+    // makes room for the given number of new imports
+    void reserve(int count);
     int  add(const String &name, const RuntimeScriptValue &value, ccInstance *inst);
     void remove(const String &name);
     const ScriptImport *getByName(const String &name);
@@ -26,8 +26,15 @@ void Test_DoAllTests()
     Test_Version();
     Test_File();
     Test_IniFile();
+    Test_Savegame();
+    Test_Room();
+    Test_SystemImports();
+    Test_ScriptLayout();
 
     Test_Gfx();
+    Test_Route();
+    Test_HitTest();
+    Test_Replay();
 }
 
 #endif // _DEBUG
@@ -20,10 +20,20 @@ void Test_Math();
 // File tests
 void Test_File();
 void Test_IniFile();
+void Test_Savegame();
+void Test_Room();
 // Graphics tests
 void Test_Gfx();
+// Pathfinding tests
+void Test_Route();
+void Test_Replay();
+// Hit test
+void Test_HitTest();
 // Memory / bit-byte operations
 void Test_Memory();
+// Script system tests
+void Test_SystemImports();
+void Test_ScriptLayout();
 // String tests
 void Test_ScriptSprintf();
 void Test_String();
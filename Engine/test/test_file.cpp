@@ -18,6 +18,9 @@
 #include <string.h>
 #include "util/alignedstream.h"
 #include "util/filestream.h"
+#include "util/lzstream.h"
+#include "util/lzw.h"
+#include "util/memorystream.h"
 #include "debug/assert.h"
 
 using namespace AGS::Common;
@@ -49,6 +52,88 @@ struct TTrickyAlignedData
     char    final;
 };
 
+static void Test_LzStream()
+{
+    // data with long repeats and a run of random bytes, over a few chunks
+    std::vector<uint8_t> data(LZ::ChunkSize * 2 + 1000);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        if (i >= LZ::ChunkSize && i < LZ::ChunkSize + 5000)
+            data[i] = (uint8_t)(seed >> 16);
+        else
+            data[i] = (uint8_t)((i / 7) % 13);
+    }
+
+    MemoryStream mem;
+    mem.WriteInt32(55);
+    LZ::WriteStream(&mem, &data[0], data.size());
+    mem.WriteInt32(66);
+    assert(mem.GetLength() < data.size() / 4);
+
+    mem.Seek(0, kSeekBegin);
+    assert(mem.ReadInt32() == 55);
+    {
+        LzReadStream lz(&mem);
+        std::vector<uint8_t> unpacked(data.size());
+        assert(lz.ReadInt32() == *(const int32_t*)&data[0]);
+        lz.Seek(LZ::ChunkSize - 4, kSeekCurrent);
+        assert(lz.Read(&unpacked[LZ::ChunkSize], data.size() - LZ::ChunkSize) == data.size() - LZ::ChunkSize);
+        assert(memcmp(&unpacked[LZ::ChunkSize], &data[LZ::ChunkSize], data.size() - LZ::ChunkSize) == 0);
+        assert(lz.GetPosition() == data.size());
+        assert(lz.ReadByte() == -1 && lz.EOS());
+    }
+    // the source is left right after the compressed stream
+    assert(mem.ReadInt32() == 66);
+
+    // broken data is detected
+    std::vector<uint8_t> packed;
+    LZ::Compress(&data[0], 1000, packed);
+    std::vector<uint8_t> unpacked(1000);
+    assert(LZ::Decompress(&packed[0], packed.size(), &unpacked[0], 1000));
+    assert(!LZ::Decompress(&packed[0], packed.size() - 1, &unpacked[0], 1000));
+    assert(!LZ::Decompress(&packed[0], packed.size(), &unpacked[0], 999));
+}
+
+static void Test_LzwExpander()
+{
+    std::vector<uint8_t> data(50000);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (uint8_t)((i / 5) % 17 + ((seed >> 28) == 0 ? 1 : 0));
+    }
+
+    MemoryStream src;
+    src.Write(&data[0], data.size());
+    src.Seek(0, kSeekBegin);
+    MemoryStream packed;
+    lzwcompress(&src, &packed);
+    const size_t packed_size = packed.GetLength();
+    packed.WriteInt32(77);
+    packed.Seek(0, kSeekBegin);
+    {
+        // expand in the parts of various sizes, splitting the matches
+        LzwExpander lzw(&packed, packed_size);
+        std::vector<uint8_t> unpacked(data.size());
+        size_t part = 1;
+        for (size_t pos = 0; pos < data.size(); pos += part, part = part * 3 % 1001 + 1)
+        {
+            if (part > data.size() - pos)
+                part = data.size() - pos;
+            assert(lzw.Expand(&unpacked[pos], part));
+        }
+        assert(memcmp(&unpacked[0], &data[0], data.size()) == 0);
+        uint8_t extra;
+        assert(!lzw.Expand(&extra, 1));
+    }
+    // the stream is not read past the packed data
+    assert(packed.GetPosition() == packed_size);
+    assert(packed.ReadInt32() == 77);
+}
+
 void Test_File()
 {
     //-----------------------------------------------------
@@ -203,6 +288,9 @@ void Test_File()
     assert(ptr32_array_in[3] == 0xBEEFFEED);
 
     assert(!File::TestReadFile("test.tmp"));
+
+    Test_LzStream();
+    Test_LzwExpander();
 }
 
 #endif // _DEBUG
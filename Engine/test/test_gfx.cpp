@@ -14,10 +14,381 @@
 
 #ifdef _DEBUG
 
+#include <stdlib.h>
+#include <string.h>
+#include <allegro.h>
+#include "ac/walkbehind.h"
+#include "gfx/ali3dnull.h"
+#include "gfx/blender_simd.h"
+#include "gfx/damageregion.h"
 #include "gfx/gfx_def.h"
+#include "gfx/spritetransformcache.h"
 #include "debug/assert.h"
 
+extern "C" {
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
+}
+// in ali3dsw.cpp
+unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
+// in blender.cpp
+unsigned long _additive_alpha_copysrc_blender(unsigned long x, unsigned long y, unsigned long n);
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
+
+namespace BitmapHelper = AGS::Common::BitmapHelper;
 namespace GfxDef = AGS::Common::GfxDef;
+namespace RowBlend = AGS::Engine::RowBlend;
+using AGS::Common::Bitmap;
+using AGS::Engine::DamageRegion;
+using AGS::Engine::DisplayMode;
+using AGS::Engine::GraphicResolution;
+using AGS::Engine::Null::NullGraphicsDriver;
+using AGS::Engine::SpriteTransformCache;
+using AGS::Engine::SpriteTransformKey;
+
+// Tests that every supported SIMD implementation of the row blenders gives
+// exactly the same results as the scalar one
+static void Test_GfxBlendRows()
+{
+    const int row_len = 67; // not a multiple of any vector size
+    const uint32_t mask_color = 0x00FF00FF;
+    uint32_t src[row_len], dst_ref[row_len], dst[row_len];
+
+    const RowBlend::BlendRowImpl was_impl = RowBlend::GetImpl();
+    for (int impl = RowBlend::kBlendImpl_Scalar + 1; impl < RowBlend::kNumBlendImpls; ++impl)
+    {
+        if (!RowBlend::IsImplSupported((RowBlend::BlendRowImpl)impl))
+            continue;
+        for (int mode = 0; mode < RowBlend::kNumBlendRowModes; ++mode)
+        {
+            for (int alpha = 0; alpha < 256; alpha += 15)
+            {
+                const uint32_t color = (rand() << 16) ^ rand();
+                for (int i = 0; i < row_len; ++i)
+                {
+                    src[i] = (i % 9 == 0) ? mask_color : ((rand() << 16) ^ rand());
+                    dst_ref[i] = dst[i] = (rand() << 16) ^ rand();
+                }
+                RowBlend::SetImpl(RowBlend::kBlendImpl_Scalar);
+                RowBlend::BlendRow((RowBlend::BlendRowMode)mode, dst_ref, src, row_len, mask_color, alpha, color);
+                RowBlend::SetImpl((RowBlend::BlendRowImpl)impl);
+                RowBlend::BlendRow((RowBlend::BlendRowMode)mode, dst, src, row_len, mask_color, alpha, color);
+                for (int i = 0; i < row_len; ++i)
+                    assert(dst[i] == dst_ref[i]);
+            }
+        }
+    }
+    RowBlend::SetImpl(was_impl);
+}
+
+// The blender which the row mode replaces, called as the sprite drawing does
+static uint32_t BlendPixelAllegro(RowBlend::BlendRowMode mode, uint32_t d, uint32_t s, int alpha, uint32_t color)
+{
+    switch (mode)
+    {
+    case RowBlend::kBlendRow_Alpha:        return _blender_alpha32(s, d, alpha);
+    case RowBlend::kBlendRow_TransAlpha:   return _trans_alpha_blender32(s, d, alpha);
+    case RowBlend::kBlendRow_Trans:        return _blender_trans24(s, d, alpha);
+    case RowBlend::kBlendRow_Additive:     return _additive_alpha_copysrc_blender(s, d, alpha);
+    case RowBlend::kBlendRow_Lit:          return _blender_trans24(color, s, alpha);
+    case RowBlend::kBlendRow_LitKeepAlpha: return _myblender_alpha_trans24(color, s, alpha);
+    default:                               return d;
+    }
+}
+
+// Tests that the scalar row blenders give exactly the same results as the
+// Allegro and AGS blender callbacks, for every alpha and channel extremes
+static void Test_GfxBlendRowsMatchAllegro()
+{
+    const int row_len = 64;
+    const uint32_t mask_color = 0x00FF00FF;
+    const uint32_t edge_colors[] = { 0x00000000, 0xFFFFFFFF, 0xFF000000, 0x00FFFFFF,
+                                     0x80FF0000, 0x7F00FF00, 0x010000FF, 0xFE808080 };
+    const int num_edges = sizeof(edge_colors) / sizeof(edge_colors[0]);
+    uint32_t src[row_len], dst[row_len], dst_ref[row_len];
+
+    const RowBlend::BlendRowImpl was_impl = RowBlend::GetImpl();
+    RowBlend::SetImpl(RowBlend::kBlendImpl_Scalar);
+    for (int mode = 0; mode < RowBlend::kNumBlendRowModes; ++mode)
+    {
+        for (int alpha = 0; alpha < 256; ++alpha)
+        {
+            const uint32_t color = (alpha & 1) ? edge_colors[alpha % num_edges] : (uint32_t)((rand() << 16) ^ rand());
+            for (int i = 0; i < row_len; ++i)
+            {
+                // pair up every edge colour with every other, the rest is random
+                if (i < num_edges * num_edges)
+                {
+                    src[i] = edge_colors[i / num_edges];
+                    dst[i] = edge_colors[i % num_edges];
+                }
+                else
+                {
+                    src[i] = (rand() << 16) ^ rand();
+                    dst[i] = (rand() << 16) ^ rand();
+                }
+                dst_ref[i] = src[i] == mask_color ? dst[i] :
+                    BlendPixelAllegro((RowBlend::BlendRowMode)mode, dst[i], src[i], alpha, color);
+            }
+            RowBlend::BlendRow((RowBlend::BlendRowMode)mode, dst, src, row_len, mask_color, alpha, color);
+            for (int i = 0; i < row_len; ++i)
+                assert(dst[i] == dst_ref[i]);
+        }
+    }
+    RowBlend::SetImpl(was_impl);
+}
+
+// Tests tinting rows with a table, comparing SIMD implementations with the
+// scalar one, and the scalar one with the original two-step drawing
+static void Test_GfxTintRows()
+{
+    const int row_len = 67;
+    const uint32_t mask_color = 0x00FF00FF;
+    uint32_t table[256];
+    uint32_t src[row_len], dst_ref[row_len], dst[row_len];
+    for (int i = 0; i < 256; ++i)
+        table[i] = ((rand() << 16) ^ rand()) & 0x00FFFFFF;
+    table[100] = mask_color; // tinted pixels may become transparent too
+
+    const RowBlend::BlendRowImpl was_impl = RowBlend::GetImpl();
+    for (int amount = -1; amount < 256; amount += 16)
+    {
+        for (int i = 0; i < row_len; ++i)
+        {
+            src[i] = (i % 9 == 0) ? mask_color : ((rand() << 16) ^ rand());
+            if (i % 7 == 0)
+                src[i] = (src[i] & 0xFF000000) | 100;
+        }
+
+        RowBlend::SetImpl(RowBlend::kBlendImpl_Scalar);
+        RowBlend::TintRow(dst_ref, src, row_len, mask_color, table, amount);
+        // tinted image drawn over the source must give the same result
+        uint32_t tinted[row_len];
+        for (int i = 0; i < row_len; ++i)
+        {
+            tinted[i] = src[i];
+            dst[i] = src[i];
+        }
+        RowBlend::TintRow(tinted, src, row_len, mask_color, table, -1);
+        if (amount >= 0)
+        {
+            RowBlend::BlendRow(RowBlend::kBlendRow_Trans, dst, tinted, row_len, mask_color, amount, 0);
+            for (int i = 0; i < row_len; ++i)
+            {
+                if (tinted[i] != mask_color)
+                    dst[i] = (dst[i] & 0x00FFFFFF) | (src[i] & 0xFF000000);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < row_len; ++i)
+                dst[i] = tinted[i];
+        }
+        for (int i = 0; i < row_len; ++i)
+            assert(dst[i] == dst_ref[i]);
+
+        for (int impl = RowBlend::kBlendImpl_Scalar + 1; impl < RowBlend::kNumBlendImpls; ++impl)
+        {
+            if (!RowBlend::IsImplSupported((RowBlend::BlendRowImpl)impl))
+                continue;
+            RowBlend::SetImpl((RowBlend::BlendRowImpl)impl);
+            RowBlend::TintRow(dst, src, row_len, mask_color, table, amount);
+            for (int i = 0; i < row_len; ++i)
+                assert(dst[i] == dst_ref[i]);
+        }
+    }
+    RowBlend::SetImpl(was_impl);
+}
+
+static void Test_GfxDamageRegion()
+{
+    DamageRegion damage;
+    damage.SetBounds(RectWH(0, 0, 320, 200));
+    assert(damage.IsWhole());
+    damage.Clear();
+    assert(damage.IsEmpty());
+
+    // rectangles are clipped by bounds
+    damage.Add(Rect(-10, -10, 9, 9));
+    assert(damage.GetRects().size() == 1);
+    assert(damage.GetRects()[0].Left == 0 && damage.GetRects()[0].Top == 0);
+    assert(damage.GetRects()[0].Right == 9 && damage.GetRects()[0].Bottom == 9);
+    damage.Add(Rect(400, 0, 410, 10));
+    assert(damage.GetRects().size() == 1);
+
+    // separate rectangles are kept separate
+    damage.Add(Rect(100, 100, 109, 109));
+    assert(damage.GetRects().size() == 2);
+    assert(damage.Intersects(Rect(105, 105, 120, 120)));
+    assert(!damage.Intersects(Rect(50, 50, 60, 60)));
+
+    // touching rectangle is merged, and then merges with the next one
+    damage.Add(Rect(10, 0, 99, 9));
+    assert(damage.GetRects().size() == 2);
+    damage.Add(Rect(50, 10, 60, 99));
+    assert(damage.GetRects().size() == 1);
+    assert(damage.GetRects()[0].Left == 0 && damage.GetRects()[0].Top == 0);
+    assert(damage.GetRects()[0].Right == 109 && damage.GetRects()[0].Bottom == 109);
+    assert(!damage.IsWhole());
+
+    // too many rectangles are merged into one
+    damage.Clear();
+    for (size_t i = 0; i <= DamageRegion::MaxRects; ++i)
+        damage.Add(RectWH(i * 10, 150, 5, 5));
+    assert(damage.GetRects().size() == 1);
+
+    // covering most of the bounds makes region whole
+    damage.Add(Rect(0, 0, 319, 160));
+    assert(damage.IsWhole());
+    assert(damage.GetRects().size() == 1);
+    assert(damage.GetRects()[0].GetWidth() == 320 && damage.GetRects()[0].GetHeight() == 200);
+}
+
+// Tests that walk-behinds copy the background only where the character is
+// opaque, for 16-bit mask colours on both sides of the sign bit
+static void Test_GfxWalkBehindRun()
+{
+    const int row_len = 5;
+    const uint16_t check[row_len] = { 0xF81F, 0x8000, 0x7FFF, 0xFFFF, 0xF81E };
+    const uint16_t bg[row_len + 1] = { 0, 0x1111, 0x2222, 0x3333, 0x4444, 0x5555 };
+    const int zoom_x[row_len] = { 0, 1, 2, 3, 4 };
+    for (int zoomed = 0; zoomed < 2; ++zoomed)
+    {
+        // magenta is transparent, every other colour is opaque
+        uint16_t dst[row_len] = { 0xAAAA, 0xAAAA, 0xAAAA, 0xAAAA, 0xAAAA };
+        assert(copy_walk_behind_run<2>((uint8_t*)dst, (const uint8_t*)bg, (const uint8_t*)check,
+            0, row_len, 1, 0xF81F, zoomed ? zoom_x : NULL) == 1);
+        assert(dst[0] == 0xAAAA);
+        assert(dst[1] == 0x2222 && dst[2] == 0x3333 && dst[3] == 0x4444 && dst[4] == 0x5555);
+
+        // 15-bit magenta is below the sign bit; whole row transparent copies nothing
+        const uint16_t check15[row_len] = { 0x7C1F, 0x7C1F, 0x7C1F, 0x7C1F, 0x7C1F };
+        uint16_t dst15[row_len] = { 0xAAAA, 0xAAAA, 0xAAAA, 0xAAAA, 0xAAAA };
+        assert(copy_walk_behind_run<2>((uint8_t*)dst15, (const uint8_t*)bg, (const uint8_t*)check15,
+            0, row_len, 1, 0x7C1F, zoomed ? zoom_x : NULL) == 0);
+        for (int i = 0; i < row_len; ++i)
+            assert(dst15[i] == 0xAAAA);
+    }
+}
+
+// Transformed images for the cache test; the cache only measures and deletes
+// them, so they wrap bare Allegro bitmap headers without any pixel data
+static GFX_VTABLE TestImageVtable;
+static BITMAP TestImageHeaders[3];
+
+static Bitmap *CreateTestImage(int index, int width, int height)
+{
+    TestImageVtable.color_depth = 32;
+    BITMAP &al_bmp = TestImageHeaders[index];
+    memset(&al_bmp, 0, sizeof(al_bmp));
+    al_bmp.w = width;
+    al_bmp.h = height;
+    al_bmp.vtable = &TestImageVtable;
+    return BitmapHelper::CreateRawBitmapWrapper(&al_bmp);
+}
+
+// Tests that images made for one game are not given out for the same
+// sprite number after switching to another game
+static void Test_GfxTransformCacheGameSwitch()
+{
+    SpriteTransformCache cache;
+    cache.SetMaxSize(4 * 4 * 4 * 2);
+    const SpriteTransformKey key(5, 4, 4, false, false);
+    const SpriteTransformKey other_key(6, 4, 4, true, false);
+
+    Bitmap *old_image = CreateTestImage(0, 4, 4);
+    cache.Put(key, old_image);
+    cache.Put(other_key, CreateTestImage(1, 4, 4));
+    assert(cache.Get(key) == old_image);
+
+    // what RunAGSGame does when it unloads the game and its sprites
+    cache.Clear();
+    assert(cache.Get(key) == NULL);
+    assert(cache.Get(other_key) == NULL);
+
+    // the new game's image fits in whole cache again and is the one returned
+    Bitmap *new_image = CreateTestImage(2, 8, 4);
+    cache.Put(key, new_image);
+    assert(cache.Get(key) == new_image);
+}
+
+// Tests that stretching and flipping in one pass gives the same image as
+// Allegro's masked stretch followed by the flip, as the sprite drawing did
+// it before, when scaling up and down, with and without the flip
+static void Test_GfxStretchAndFlipMatchAllegro()
+{
+    const int color_depths[] = { 8, 16, 24, 32 };
+    const int dst_sizes[][2] = { { 17, 11 }, { 3, 2 }, { 7, 13 } };
+    const int src_w = 7, src_h = 5;
+    // the bitmaps need the system driver, which is not installed yet
+    int err = 0;
+    const int result = install_allegro(SYSTEM_NONE, &err, NULL);
+    assert(result == 0);
+    for (int d = 0; d < 4; ++d)
+    {
+        const int depth = color_depths[d];
+        Bitmap *src = BitmapHelper::CreateBitmap(src_w, src_h, depth);
+        const color_t mask_color = src->GetMaskColor();
+        const color_t value_mask = depth == 32 ? 0xFFFFFFFF : ((1u << depth) - 1);
+        for (int y = 0; y < src_h; ++y)
+        {
+            for (int x = 0; x < src_w; ++x)
+            {
+                // every third pixel is transparent, and the whole left column
+                const bool transparent = (x + y * src_w) % 3 == 0 || x == 0;
+                src->PutPixel(x, y, transparent ? mask_color : (((rand() << 16) ^ rand()) & value_mask));
+            }
+        }
+        const color_t bg_color = mask_color ^ 1;
+
+        for (int s = 0; s < 3; ++s)
+        {
+            const int dst_w = dst_sizes[s][0], dst_h = dst_sizes[s][1];
+            for (int flip = 0; flip < 2; ++flip)
+            {
+                Bitmap *ref = BitmapHelper::CreateBitmap(dst_w, dst_h, depth);
+                ref->Fill(bg_color);
+                if (flip)
+                {
+                    Bitmap *temp = BitmapHelper::CreateBitmap(dst_w, dst_h, depth);
+                    temp->Fill(mask_color);
+                    temp->StretchBlt(src, RectWH(0, 0, dst_w, dst_h), AGS::Common::kBitmap_Transparency);
+                    ref->FlipBlt(temp, 0, 0, AGS::Common::kBitmap_HFlip);
+                    delete temp;
+                }
+                else
+                {
+                    ref->StretchBlt(src, RectWH(0, 0, dst_w, dst_h), AGS::Common::kBitmap_Transparency);
+                }
+
+                Bitmap *dst = BitmapHelper::CreateBitmap(dst_w, dst_h, depth);
+                dst->Fill(bg_color);
+                SpriteTransformCache::StretchAndFlip(dst, src, flip != 0);
+                for (int y = 0; y < dst_h; ++y)
+                    assert(memcmp(dst->GetScanLine(y), ref->GetScanLine(y), dst_w * dst->GetBPP()) == 0);
+                delete dst;
+                delete ref;
+            }
+        }
+        delete src;
+    }
+    allegro_exit();
+}
+
+// Tests that the null renderer accepts any mode without asking the system;
+// only the driver object is made, setting its mode would replace the
+// engine's screen and the rest of the global graphics state
+static void Test_GfxNullDriver()
+{
+    NullGraphicsDriver driver;
+    assert(strcmp(driver.GetDriverID(), "NULL") == 0);
+    assert(driver.IsModeSupported(DisplayMode(GraphicResolution(320, 200, 32), true, 0, false)));
+    assert(driver.IsModeSupported(DisplayMode(GraphicResolution(1920, 1080, 16), false, 0, false)));
+    assert(driver.GetSupportedModeList(32) == NULL);
+    assert(!driver.SkipsRendering());
+    driver.SetRenderOptions(true, 5, "", AGS::Engine::Null::kNullFrame_Bmp);
+    assert(driver.SkipsRendering());
+}
 
 void Test_Gfx()
 {
@@ -34,6 +405,15 @@ void Test_Gfx()
         trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
         assert(trans100[i] == trans100_back[i]);
     }
+
+    Test_GfxBlendRowsMatchAllegro();
+    Test_GfxBlendRows();
+    Test_GfxTintRows();
+    Test_GfxDamageRegion();
+    Test_GfxWalkBehindRun();
+    Test_GfxTransformCacheGameSwitch();
+    Test_GfxStretchAndFlipMatchAllegro();
+    Test_GfxNullDriver();
 }
 
 #endif // _DEBUG
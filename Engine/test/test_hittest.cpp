@@ -0,0 +1,80 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <vector>
+#include "ac/hittestindex.h"
+#include "debug/assert.h"
+
+static void Test_HitTestIndex()
+{
+    const int cell = HitTestIndex::CellSize;
+    HitTestIndex index;
+    index.Reset(cell * 4, cell * 3);
+    // overlapping character and object, character spanning several cells
+    index.Add(kHitTest_Character, 3, Rect(10, 10, cell * 2 + 5, 20));
+    index.Add(kHitTest_Object, 1, Rect(15, 15, 25, 25));
+    index.Add(kHitTest_Character, 0, Rect(0, 0, 15, 15));
+    // partly outside of the room, and wholly outside of it
+    index.Add(kHitTest_Object, 2, Rect(-10, cell * 3 - 5, 5, cell * 3 + 10));
+    index.Add(kHitTest_Object, 4, Rect(cell * 5, 0, cell * 6, 10));
+
+    std::vector<int> items;
+    // items of the requested type only, in the order they were added
+    assert(index.GetAt(kHitTest_Character, 12, 12, items));
+    assert(items.size() == 2 && items[0] == 3 && items[1] == 0);
+    assert(index.GetAt(kHitTest_Object, 20, 20, items));
+    assert(items.size() == 1 && items[0] == 1);
+
+    // bounds are inclusive, and checked exactly, not by cell
+    assert(index.GetAt(kHitTest_Character, cell * 2 + 5, 20, items));
+    assert(items.size() == 1 && items[0] == 3);
+    assert(index.GetAt(kHitTest_Character, cell * 2 + 6, 20, items));
+    assert(items.empty());
+    assert(index.GetAt(kHitTest_Object, 26, 20, items));
+    assert(items.empty());
+
+    // item clipped by the room is still found inside of it
+    assert(index.GetAt(kHitTest_Object, 0, cell * 3 - 1, items));
+    assert(items.size() == 1 && items[0] == 2);
+
+    // outside of the room every item has to be checked by the caller
+    assert(!index.GetAt(kHitTest_Object, cell * 5 + 1, 5, items));
+    assert(items.empty());
+    assert(!index.GetAt(kHitTest_Character, -1, 12, items));
+
+    // reset for a smaller room drops the old items
+    index.Reset(cell, cell);
+    assert(index.GetAt(kHitTest_Character, 12, 12, items));
+    assert(items.empty());
+    index.Add(kHitTest_Character, 7, Rect(0, 0, 5, 5));
+    assert(index.GetAt(kHitTest_Character, 5, 5, items));
+    assert(items.size() == 1 && items[0] == 7);
+}
+
+static void Test_HitTestScope()
+{
+    std::vector<int> items;
+    // outside of the scope the index is never used
+    assert(!get_hit_test_candidates(kHitTest_Character, 0, 0, items));
+}
+
+void Test_HitTest()
+{
+    Test_HitTestIndex();
+    Test_HitTestScope();
+}
+
+#endif // _DEBUG
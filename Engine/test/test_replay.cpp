@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <string.h>
+#include "ac/replaystream.h"
+#include "debug/assert.h"
+#include "util/memorystream.h"
+
+using AGS::Common::MemoryStream;
+using AGS::Common::kSeekBegin;
+
+static ReplayEvent MakeEvent(short step, int type, int count, int d0 = 0, int d1 = 0, int d2 = 0)
+{
+    ReplayEvent evt;
+    evt.Step = step;
+    evt.Type = type;
+    evt.DataCount = count;
+    evt.Data[0] = d0;
+    evt.Data[1] = d1;
+    evt.Data[2] = d2;
+    return evt;
+}
+
+static bool IsSameEvent(const ReplayEvent &a, const ReplayEvent &b)
+{
+    if (a.Step != b.Step || a.Type != b.Type || a.DataCount != b.DataCount)
+        return false;
+    for (int i = 0; i < a.DataCount; ++i)
+    {
+        if (a.Data[i] != b.Data[i])
+            return false;
+    }
+    return true;
+}
+
+// Tests that the stream read from file is checked against the file size
+static void Test_ReplayFile(const ReplayStream &stream)
+{
+    MemoryStream file;
+    stream.WriteToFile(&file);
+    file.WriteInt32(1); // following data
+    file.Seek(0, kSeekBegin);
+    ReplayStream copy;
+    assert(copy.ReadFromFile(&file));
+    assert(copy.GetSize() == stream.GetSize());
+    assert(memcmp(copy.GetData(), stream.GetData(), stream.GetSize()) == 0);
+    assert(file.ReadInt32() == 1);
+
+    // size exactly up to the end of file is accepted
+    const int32_t max_size = (int32_t)(file.GetLength() - sizeof(int32_t));
+    file.Seek(0, kSeekBegin);
+    file.WriteInt32(max_size);
+    file.Seek(0, kSeekBegin);
+    assert(copy.ReadFromFile(&file));
+    assert(copy.GetSize() == (size_t)max_size);
+
+    // size past the end of file, or negative, is not
+    const int32_t bad_sizes[] = { max_size + 1, -1, (int32_t)0x80000000 };
+    for (size_t i = 0; i < sizeof(bad_sizes) / sizeof(bad_sizes[0]); ++i)
+    {
+        file.Seek(0, kSeekBegin);
+        file.WriteInt32(bad_sizes[i]);
+        file.Seek(0, kSeekBegin);
+        assert(!copy.ReadFromFile(&file));
+        assert(copy.GetSize() == 0);
+    }
+}
+
+void Test_Replay()
+{
+    const ReplayEvent events[] = {
+        MakeEvent(0, 2, 2, 160, 100),
+        MakeEvent(1, 2, 2, 161, 98),
+        MakeEvent(5, 1, 3, 0, 161, 98),
+        MakeEvent(300, 9, 1, 1234567),
+        MakeEvent(301, 10, 1, (int)0x80000001),
+        MakeEvent(302, 10, 1, 0x7fffffff),
+        MakeEvent(32767, 4, 0),
+        // the step counter wraps around
+        MakeEvent(-32768, 2, 2, -5, 0),
+        MakeEvent(2, 0x6f, 0)
+    };
+    const int count = sizeof(events) / sizeof(events[0]);
+
+    ReplayStream stream;
+    stream.Write(events[0]);
+    const size_t first_size = stream.GetSize();
+    assert(first_size == 6);
+    // small step and move take a byte per value
+    stream.Write(events[1]);
+    assert(stream.GetSize() == first_size + 4);
+    for (int i = 2; i < count; ++i)
+        stream.Write(events[i]);
+
+    ReplayEvent evt;
+    for (int i = 0; i < count; ++i)
+    {
+        assert(stream.Read(evt));
+        assert(IsSameEvent(evt, events[i]));
+    }
+    assert(!stream.Read(evt));
+
+    // same events are read from the copied data
+    ReplayStream copy;
+    copy.SetData(stream.GetData(), stream.GetSize());
+    for (int i = 0; i < count; ++i)
+    {
+        assert(copy.Read(evt));
+        assert(IsSameEvent(evt, events[i]));
+    }
+
+    Test_ReplayFile(stream);
+
+    // broken data is not read past its end
+    copy.SetData(stream.GetData(), first_size + 3);
+    assert(copy.Read(evt) && IsSameEvent(evt, events[0]));
+    assert(!copy.Read(evt));
+    stream.Clear();
+    assert(stream.GetSize() == 0 && !stream.Read(evt));
+}
+
+#endif // _DEBUG
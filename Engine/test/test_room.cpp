@@ -0,0 +1,182 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <string.h>
+#include <allegro.h>
+#include "ac/roomstruct.h"
+#include "debug/assert.h"
+#include "gfx/bitmap.h"
+#include "util/compress.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+extern void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_file_header rfh);
+
+static Bitmap *CreateTestImage(int width, int height, int color_depth, int seed)
+{
+    Bitmap *bmp = BitmapHelper::CreateBitmap(width, height, color_depth);
+    const int line_len = width * bmp->GetBPP();
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *line = &bmp->GetScanLineForWriting(y)[0];
+        for (int x = 0; x < line_len; ++x)
+            line[x] = (uint8_t)(x * 7 + y * 13 + seed);
+    }
+    return bmp;
+}
+
+static bool SameImages(Bitmap *bmp1, Bitmap *bmp2)
+{
+    if (bmp1 == NULL || bmp2 == NULL || bmp1->GetWidth() != bmp2->GetWidth() ||
+        bmp1->GetHeight() != bmp2->GetHeight() || bmp1->GetBPP() != bmp2->GetBPP())
+        return false;
+    for (int y = 0; y < bmp1->GetHeight(); ++y)
+    {
+        if (memcmp(bmp1->GetScanLine(y), bmp2->GetScanLine(y), bmp1->GetWidth() * bmp1->GetBPP()) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Writes the main block of a room with one hotspot and nothing else,
+// and the images in the LZ format
+static void WriteTestRoom(Stream *out, Bitmap *images[5], const color *pal)
+{
+    out->WriteInt32(images[0]->GetBPP());
+    out->WriteInt16(0);                 // walk-behinds
+    out->WriteInt32(1);                 // hotspots
+    out->WriteInt16(0);                 // walk-to point
+    out->WriteInt16(0);
+    out->WriteByte(0);                  // name
+    char script_name[MAX_SCRIPT_NAME_LEN] = { 0 };
+    out->Write(script_name, MAX_SCRIPT_NAME_LEN);
+    out->WriteInt32(0);                 // walkable area polygons
+    out->WriteInt16(40);                // edges
+    out->WriteInt16(199);
+    out->WriteInt16(0);
+    out->WriteInt16(317);
+    out->WriteInt16(0);                 // objects
+    out->WriteInt32(0);                 // local variables
+    out->WriteInt32(0);                 // regions
+    out->WriteInt32(0);                 // room events
+    out->WriteInt32(0);                 // hotspot events
+    out->WriteInt16(images[0]->GetWidth());
+    out->WriteInt16(images[0]->GetHeight());
+    out->WriteInt16(1);                 // resolution
+    out->WriteInt32(0);                 // walkable areas
+    char options[21] = { 0 };
+    out->Write(options, 21);            // password and options
+    out->WriteInt16(0);                 // messages
+    out->WriteInt32(0);                 // game id
+    out->WriteInt16(0);                 // animations
+    for (int i = 0; i < 16; ++i)
+        out->WriteInt16(0);             // shading
+    out->WriteByte(kRoomImage_LZ);
+    save_lz_image(out, images[0], pal);
+    for (int i = 1; i < 5; ++i)
+        save_lz_image(out, images[i], NULL);
+}
+
+static void Test_RoomImageLZ()
+{
+    Bitmap *images[5];
+    images[0] = CreateTestImage(40, 30, 32, 1);
+    for (int i = 1; i < 5; ++i)
+        images[i] = CreateTestImage(40, 30, 8, i * 50);
+    color pal[256];
+    for (int i = 0; i < 256; ++i)
+    {
+        pal[i].r = i / 4;
+        pal[i].g = 63 - i / 4;
+        pal[i].b = i % 64;
+        pal[i].filler = 0;
+    }
+
+    MemoryStream room;
+    WriteTestRoom(&room, images, pal);
+    const size_t room_end = room.GetPosition();
+    room.WriteInt32(0x12345678);        // the next block
+    room.Seek(0, kSeekBegin);
+
+    room_file_header rfh;
+    rfh.version = kRoomVersion_3405;
+    roomstruct *rstruc = new roomstruct();
+    load_main_block(rstruc, NULL, &room, rfh);
+
+    assert(room.GetPosition() == room_end);
+    assert(room.ReadInt32() == 0x12345678);
+    assert(rstruc->bytes_per_pixel == 4);
+    assert(rstruc->width == 40 && rstruc->height == 30);
+    assert(SameImages(rstruc->ebscene[0], images[0]));
+    assert(SameImages(rstruc->regions, images[1]));
+    assert(SameImages(rstruc->walls, images[2]));
+    assert(SameImages(rstruc->object, images[3]));
+    assert(SameImages(rstruc->lookat, images[4]));
+    assert(memcmp(rstruc->pal, pal, sizeof(pal)) == 0);
+
+    for (int i = 0; i < 5; ++i)
+        delete images[i];
+    delete rstruc->ebscene[0];
+    delete rstruc->regions;
+    delete rstruc->walls;
+    delete rstruc->object;
+    delete rstruc->lookat;
+    rstruc->freescripts();
+    delete rstruc;
+}
+
+static void Test_RoomMaskLegacy()
+{
+    // a run and a sequence going past the end of the line, as in some old
+    // rooms, are cut at the line end
+    const uint8_t packed[] = {
+        0xFB, 7,                        // run of 6
+        0x05, 1, 2, 3, 4,               // sequence of 6, cut after 4
+        0x01, 8, 9, 0xFE, 3             // next tokens; the run is cut too
+    };
+    const uint8_t expected[3][4] = { { 7, 7, 7, 7 }, { 1, 2, 3, 4 }, { 8, 9, 3, 3 } };
+
+    MemoryStream in;
+    in.WriteInt16(4);
+    in.WriteInt16(3);
+    in.Write(packed, sizeof(packed));
+    for (int i = 0; i < 768; ++i)
+        in.WriteByte(0);                // palette, which is skipped
+    in.WriteInt32(0x12345678);
+    in.Seek(0, kSeekBegin);
+
+    Bitmap *mask = NULL;
+    loadcompressed_allegro(&in, &mask, NULL, 0);
+    assert(mask != NULL && mask->GetWidth() == 4 && mask->GetHeight() == 3);
+    for (int y = 0; y < 3; ++y)
+        assert(memcmp(mask->GetScanLine(y), expected[y], 4) == 0);
+    assert(in.ReadInt32() == 0x12345678);
+    delete mask;
+}
+
+void Test_Room()
+{
+    // the bitmaps need the system driver, which is not installed yet
+    int err = 0;
+    const int result = install_allegro(SYSTEM_NONE, &err, NULL);
+    assert(result == 0);
+    Test_RoomImageLZ();
+    Test_RoomMaskLegacy();
+    allegro_exit();
+}
+
+#endif // _DEBUG
@@ -0,0 +1,186 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdlib.h>
+#include <vector>
+#include <allegro.h>
+#include "ac/navgrid.h"
+#include "ac/routecache.h"
+#include "debug/assert.h"
+#include "gfx/bitmap.h"
+
+namespace BitmapHelper = AGS::Common::BitmapHelper;
+using AGS::Common::Bitmap;
+
+static const int MaskWidth = 12;
+static const int MaskHeight = 8;
+// Two areas on the left side are joined by the corridor in the bottom row;
+// the right side is a separate area, touching the others by a corner only
+static const char *MaskRows[MaskHeight] = {
+    "111.22.33333",
+    "111.22.33333",
+    "111.22..3333",
+    "111.22....33",
+    "111.22....33",
+    ".11.22......",
+    ".111222.....",
+    "............"
+};
+
+// Tells if the straight line between two points goes over walkable pixels
+static bool IsLineWalkable(const std::vector<uint8_t> &mask, int x1, int y1, int x2, int y2)
+{
+    const int steps = abs(x2 - x1) > abs(y2 - y1) ? abs(x2 - x1) : abs(y2 - y1);
+    for (int i = 0; i <= steps; ++i)
+    {
+        const int x = steps > 0 ? x1 + (x2 - x1) * i / steps : x1;
+        const int y = steps > 0 ? y1 + (y2 - y1) * i / steps : y1;
+        if (mask[y * MaskWidth + x] == 0)
+            return false;
+    }
+    return true;
+}
+
+static void MakeMask(std::vector<uint8_t> &mask)
+{
+    mask.resize(MaskWidth * MaskHeight);
+    for (int y = 0; y < MaskHeight; ++y)
+        for (int x = 0; x < MaskWidth; ++x)
+            mask[y * MaskWidth + x] = MaskRows[y][x] == '.' ? 0 : MaskRows[y][x] - '0';
+}
+
+// Wraps the packed mask into a bitmap; only the header is made here, and
+// the scanlines point into the mask, so no Allegro calls are needed
+static Bitmap *WrapMask(std::vector<uint8_t> &mask, std::vector<char> &header)
+{
+    header.assign(sizeof(BITMAP) + MaskHeight * sizeof(unsigned char*), 0);
+    BITMAP *al_bmp = (BITMAP*)&header[0];
+    al_bmp->w = MaskWidth;
+    al_bmp->h = MaskHeight;
+    for (int y = 0; y < MaskHeight; ++y)
+        al_bmp->line[y] = &mask[y * MaskWidth];
+    return BitmapHelper::CreateRawBitmapWrapper(al_bmp);
+}
+
+static void Test_RouteNavGrid()
+{
+    std::vector<uint8_t> mask;
+    MakeMask(mask);
+
+    NavGrid grid;
+    assert(grid.Update(&mask[0], MaskWidth, MaskHeight));
+    assert(!grid.Update(&mask[0], MaskWidth, MaskHeight));
+    assert(grid.GetMaxValue() == 3);
+
+    // different areas that touch by the side form one component
+    assert(grid.AreConnected(0, 0, 5, 0));
+    assert(grid.GetComponent(3, 0) == 0);
+    assert(grid.GetComponent(-1, 0) == 0);
+    assert(!grid.AreConnected(0, 0, 11, 0));
+    assert(!grid.AreConnected(0, 0, 3, 0));
+    const Rect &bounds = grid.GetComponentBounds(grid.GetComponent(0, 0));
+    assert(bounds.Left == 0 && bounds.Top == 0 && bounds.Right == 6 && bounds.Bottom == 6);
+
+    // path goes around the wall, and every segment of it is walkable
+    std::vector<Point> path;
+    assert(grid.FindPath(0, 0, 5, 0, path));
+    assert(path.size() > 1);
+    assert(path[0].X == 5 && path[0].Y == 0);
+    int x = 5, y = 0;
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        assert(IsLineWalkable(mask, x, y, path[i].X, path[i].Y));
+        x = path[i].X;
+        y = path[i].Y;
+    }
+    assert(IsLineWalkable(mask, x, y, 0, 0));
+    assert(!grid.FindPath(0, 0, 11, 0, path));
+    assert(path.empty());
+
+    // changed mask is noticed, and the wall between the areas is opened
+    mask[0 * MaskWidth + 3] = 1;
+    assert(grid.Update(&mask[0], MaskWidth, MaskHeight));
+    assert(grid.FindPath(0, 0, 5, 0, path));
+    assert(path.size() == 1);
+}
+
+// Tests that the mask version lets the grid skip comparing the pixels
+static void Test_RouteNavGridVersion()
+{
+    std::vector<uint8_t> mask;
+    MakeMask(mask);
+    std::vector<char> header;
+    Bitmap *bmp = WrapMask(mask, header);
+
+    NavGrid grid;
+    assert(grid.Update(bmp, 1));
+    assert(grid.GetComponent(3, 0) == 0);
+
+    // same version is trusted without looking at the pixels
+    mask[0 * MaskWidth + 3] = 1;
+    assert(!grid.Update(bmp, 1));
+    assert(grid.GetComponent(3, 0) == 0);
+
+    // new version is compared, and rebuilt only if the pixels differ
+    assert(grid.Update(bmp, 2));
+    assert(grid.GetComponent(3, 0) != 0);
+    assert(!grid.Update(bmp, 3));
+
+    // zero version is always compared
+    assert(!grid.Update(bmp, 0));
+    mask[0 * MaskWidth + 3] = 0;
+    assert(grid.Update(bmp, 0));
+    assert(grid.GetComponent(3, 0) == 0);
+    delete bmp;
+}
+
+static void Test_RouteCache()
+{
+    RouteCache cache;
+    const int stages[] = { 0x00010001, 0x00080001, 0x00080010 };
+    cache.Put(1, 1, 1, 8, 16, 5, 0, stages, 3);
+
+    // same cells on the same mask give the route
+    const RouteCache::Stages *route = cache.Get(1, 2, 3, 9, 17, 5, 0);
+    assert(route != NULL && route->size() == 3 && (*route)[1] == stages[1]);
+    assert(cache.Get(1, 1, 1, 8, 16, 6, 0) == NULL);
+    assert(cache.Get(2, 1, 1, 8, 16, 5, 0) == NULL);
+    assert(cache.Get(1, 1, 1, 30, 16, 5, 0) == NULL);
+
+    // nearby routes are found for any mask, most recent first
+    const int other[] = { 0x00030001, 0x00030003, 0x00090012 };
+    cache.Put(1, 3, 1, 9, 18, 6, 0, other, 3);
+    std::vector<const RouteCache::Stages*> nearby;
+    cache.GetNearby(1, 4, 4, 12, 20, 5, 0, nearby);
+    assert(nearby.size() == 2 && (*nearby[0])[0] == other[0]);
+    cache.GetNearby(1, 4, 4, 12, 20, 2, 0, nearby);
+    assert(nearby.empty());
+
+    // the least recently used route is dropped when full
+    for (int i = 0; i < (int)RouteCache::MaxRoutes; ++i)
+        cache.Put(1, 100 + i * RouteCache::CellSize, 1, 8, 16, 5, 0, stages, 3);
+    assert(cache.Get(1, 1, 1, 8, 16, 5, 0) == NULL);
+    assert(cache.Get(1, 100, 1, 8, 16, 5, 0) != NULL);
+}
+
+void Test_Route()
+{
+    Test_RouteNavGrid();
+    Test_RouteNavGridVersion();
+    Test_RouteCache();
+}
+
+#endif // _DEBUG
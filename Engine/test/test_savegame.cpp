@@ -0,0 +1,150 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <string.h>
+#include <vector>
+#include "ac/game.h"
+#include "game/savegamesnapshot.h"
+#include "util/memorystream.h"
+#include "debug/assert.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+static void MakeSnapshot(SavegameSnapshot &snap, const std::vector<uint8_t> &data)
+{
+    MemoryStream mem;
+    mem.Write(&data[0], data.size());
+    snap.Swap(mem);
+}
+
+static bool ApplyDelta(const SavegameSnapshot &base, const SavegameSnapshot &state,
+                       size_t &changed, std::vector<uint8_t> &result)
+{
+    MemoryStream delta;
+    changed = state.WriteDelta(base, &delta);
+    MemoryStream base_in;
+    base_in.Write(base.GetData(), base.GetSize());
+    base_in.Seek(0, kSeekBegin);
+    delta.Seek(0, kSeekBegin);
+    return SavegameSnapshot::ReadDelta(&delta, &base_in, result);
+}
+
+// Writes the delta header, as WriteDelta does, with no operations after it
+static void WriteDeltaHeader(Stream *out, uint32_t base_size, uint32_t size, uint32_t op_count)
+{
+    out->WriteInt32(base_size);
+    out->WriteInt32(0);
+    out->WriteInt32(size);
+    out->WriteInt32(0);
+    out->WriteInt32(op_count);
+    out->Seek(0, kSeekBegin);
+}
+
+// Tests that the sizes in the broken delta are refused before the data of
+// such size is allocated
+static void Test_SavegameBrokenDelta()
+{
+    std::vector<uint8_t> result;
+    MemoryStream base_in;
+    base_in.Write("base", 4);
+    base_in.Seek(0, kSeekBegin);
+
+    MemoryStream huge_base;
+    WriteDeltaHeader(&huge_base, 0xFFFFFFF0, 4, 1);
+    assert(!SavegameSnapshot::ReadDelta(&huge_base, &base_in, result));
+    MemoryStream long_base;
+    WriteDeltaHeader(&long_base, 5, 4, 1);
+    assert(!SavegameSnapshot::ReadDelta(&long_base, &base_in, result));
+    MemoryStream huge_state;
+    WriteDeltaHeader(&huge_state, 4, 0xFFFFFFF0, 1);
+    assert(!SavegameSnapshot::ReadDelta(&huge_state, &base_in, result));
+    MemoryStream many_ops;
+    WriteDeltaHeader(&many_ops, 4, 1000, 1000);
+    assert(!SavegameSnapshot::ReadDelta(&many_ops, &base_in, result));
+    assert(result.empty());
+}
+
+// Tests that only the complete saves of the listed slots are found by name
+static void Test_SavegameSlotNames()
+{
+    assert(get_save_slot_from_file_name("agssave.000") == 0);
+    assert(get_save_slot_from_file_name("agssave.042") == 42);
+    assert(get_save_slot_from_file_name("AGSSAVE.099") == 99);
+    // save being written, higher slots and unrelated files
+    assert(get_save_slot_from_file_name("agssave.042.tmp") == -1);
+    assert(get_save_slot_from_file_name("agssave.100") == -1);
+    assert(get_save_slot_from_file_name("agssave.999") == -1);
+    assert(get_save_slot_from_file_name("agssave.0") == -1);
+    assert(get_save_slot_from_file_name("agssave.txt") == -1);
+}
+
+void Test_Savegame()
+{
+    std::vector<uint8_t> data(100000);
+    uint32_t seed = 7;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+    SavegameSnapshot base;
+    MakeSnapshot(base, data);
+    assert(base.GetSize() == data.size());
+
+    size_t changed;
+    std::vector<uint8_t> result;
+
+    // same state makes the delta without data
+    assert(ApplyDelta(base, base, changed, result));
+    assert(changed == 0 && result == data);
+
+    // a few changed bytes only take their chunks
+    std::vector<uint8_t> data2 = data;
+    data2[10] ^= 0xFF;
+    data2[50000] ^= 0xFF;
+    SavegameSnapshot state;
+    MakeSnapshot(state, data2);
+    assert(ApplyDelta(base, state, changed, result));
+    assert(changed > 0 && changed < data.size() / 10 && result == data2);
+
+    // inserted data does not shift the chunks after it
+    std::vector<uint8_t> data3 = data;
+    data3.insert(data3.begin() + 30000, 100, 0xAB);
+    MakeSnapshot(state, data3);
+    assert(ApplyDelta(base, state, changed, result));
+    assert(changed < data.size() / 10 && result == data3);
+
+    // the delta is not applied to the other base
+    MemoryStream delta;
+    state.WriteDelta(base, &delta);
+    MemoryStream other_base;
+    other_base.Write(&data2[0], data2.size());
+    other_base.Seek(0, kSeekBegin);
+    delta.Seek(0, kSeekBegin);
+    assert(!SavegameSnapshot::ReadDelta(&delta, &other_base, result));
+
+    // the state is given back to the stream
+    MemoryStream mem;
+    state.Swap(mem);
+    assert(state.IsEmpty() && mem.GetLength() == data3.size());
+    assert(memcmp(mem.GetData(), &data3[0], data3.size()) == 0);
+
+    Test_SavegameBrokenDelta();
+    Test_SavegameSlotNames();
+}
+
+#endif // _DEBUG
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdlib.h>
+#include <string.h>
+#include "script/cc_instance.h"
+#include "script/script_common.h"
+#include "debug/assert.h"
+
+// Makes a script with one global variable, which the code loads; there
+// has to be an import for the script to be instantiated, an empty one
+// is not looked for
+static PScript CreateTestScript()
+{
+    PScript scri(new ccScript());
+    scri->globaldatasize = sizeof(int32_t);
+    scri->globaldata = (char*)malloc(scri->globaldatasize);
+    memset(scri->globaldata, 0, scri->globaldatasize);
+    scri->codesize = 4;
+    scri->code = (intptr_t*)malloc(scri->codesize * sizeof(intptr_t));
+    scri->code[0] = SCMD_LITTOREG;
+    scri->code[1] = SREG_MAR;
+    scri->code[2] = 0;
+    scri->code[3] = SCMD_RET;
+    scri->numfixups = 1;
+    scri->fixups = (int32_t*)malloc(sizeof(int32_t));
+    scri->fixuptypes = (char*)malloc(1);
+    scri->fixups[0] = 2;
+    scri->fixuptypes[0] = FIXUP_GLOBALDATA;
+    scri->numimports = 1;
+    scri->importsCapacity = 1;
+    scri->imports = (char**)malloc(sizeof(char*));
+    scri->imports[0] = NULL;
+    return scri;
+}
+
+void Test_ScriptLayout()
+{
+    PScript scri = CreateTestScript();
+    ccInstance *inst1 = ccInstance::CreateFromScript(scri);
+    ccInstance *inst2 = ccInstance::CreateFromScript(scri);
+    assert(inst1 != NULL && inst2 != NULL);
+
+    // both instances use the same layout, made once for the script
+    assert(inst1->layout != NULL);
+    assert(inst1->layout == inst2->layout);
+    assert(inst1->layout->GlobalVars.size() == 1);
+    assert(inst1->layout->RuntimeFixups.size() == 1);
+    // but each one has the code fixed up to its own variables
+    assert(inst1->code[2] != inst2->code[2]);
+
+    stdtr1compat::weak_ptr<ScriptLayout> layout = inst1->layout;
+    delete inst1;
+    delete inst2;
+    assert(!layout.expired());
+    scri.reset();
+
+    // the layout of the freed script is dropped when another one is made
+    PScript other = CreateTestScript();
+    ccInstance *inst3 = ccInstance::CreateFromScript(other);
+    assert(inst3 != NULL);
+    assert(layout.expired());
+    delete inst3;
+}
+
+#endif // _DEBUG
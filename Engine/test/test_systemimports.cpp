@@ -0,0 +1,65 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include "script/systemimports.h"
+#include "debug/assert.h"
+
+void Test_SystemImports()
+{
+    SystemImports imports;
+    imports.reserve(100);
+    RuntimeScriptValue value;
+
+    imports.add("Foo^2", value, NULL);
+    imports.add("Bar$3", value, NULL);
+    imports.add("Bar$1", value, NULL);
+    imports.add("Baz", value, NULL);
+    assert(imports.get_index_of("Foo^2") == 0);
+    assert(imports.get_index_of("Baz") == 3);
+    // the param count is dropped from the name looked for
+    assert(imports.get_index_of("Baz^1") == 3);
+    // the mangled names are found by the part before '$', first in order
+    assert(imports.get_index_of("Bar") == 2);
+
+    imports.remove("Bar$1");
+    assert(imports.get_index_of("Bar$1") == -1);
+    assert(imports.get_index_of("Bar") == 1);
+    // the free slot is used again
+    imports.add("Qux", value, NULL);
+    assert(imports.get_index_of("Qux") == 2);
+    imports.remove("Bar$3");
+    assert(imports.get_index_of("Bar") == -1);
+    imports.add("Bar$3", value, NULL);
+    assert(imports.get_index_of("Bar") == 1);
+
+    imports.clear();
+    assert(imports.get_index_of("Foo^2") == -1);
+
+    char name[40];
+    for (int i = 0; i < 5000; ++i)
+    {
+        sprintf(name, "Sym%d$%d", i, i % 5);
+        imports.add(name, value, NULL);
+    }
+    for (int i = 0; i < 5000; ++i)
+    {
+        sprintf(name, "Sym%d", i);
+        assert(imports.get_index_of(name) == i);
+    }
+}
+
+#endif // _DEBUG